@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/rtengine.h"
+#include "../src/renderer/renderQueueCapture.h"
+#include "helpers.h"
+#include <chrono>
+#include <string>
+#include <stdlib.h>
+
+// Replays frame captured by LayerActors::captureNextFrame
+// Arguments: capture path, amount of iterations, renderer "null" or "opengl"
+APPMAIN
+{
+#ifdef _WIN32
+    int argc = __argc;
+    char **argv = __argv;
+#endif
+    std::string path = argc > 1 ? argv[1] : "./capture.rtq";
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+    std::string rendererName = argc > 3 ? argv[3] : "null";
+    if (iterations < 1)
+        iterations = 1;
+
+    // Engine setup
+    auto engine = RTEngine::getInstance();
+
+    auto configController = engine->getConfigController();
+    auto config = configController->getConfig();
+
+    // Setup configuration, null renderer makes hidden window and only measures work of CPU
+    config->setWindowWidth(1280);
+    config->setWindowHeight(720);
+    config->setFullscreenState(false);
+    config->setRendererType(Config::stringToRendererType(rendererName));
+
+    // View setup
+    auto viewController = engine->getViewController();
+    auto view = viewController->createView("Example \"25. Hello Replay\"");
+    auto renderer = view->getRenderer();
+
+    auto logController = engine->getLogController();
+
+    RenderQueueCapture capture;
+    if (!capture.load(path))
+    {
+        logController->logff("Replay: unable to load capture %s\n", path.c_str());
+        engine->destroy();
+        return 1;
+    }
+
+    logController->logff("Replay: %s, %i main, %i blending, %i shadow casters, %i lights\n", path.c_str(),
+                         capture.getMainPhaseAmount(), capture.getBlendingPhaseAmount(),
+                         capture.getShadowCastersAmount(), capture.getLightsAmount());
+
+    const char *phaseNames[RENDER_PHASES] = {"main", "lightning", "blending", "debug", "final"};
+    float phaseTotals[RENDER_PHASES] = {};
+    float submitTotal = 0.0f;
+    long long drawCalls = 0;
+    long long stateChanges = 0;
+
+    int done = 0;
+    while (done < iterations && !engine->isTerminationIntended())
+    {
+        auto start = std::chrono::steady_clock::now();
+        capture.submit(renderer);
+        submitTotal += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        renderer->render(view->getRenderTarget());
+        view->swapBuffers();
+
+        for (int j = 0; j < RENDER_PHASES; j++)
+            phaseTotals[j] += renderer->getPhaseTime((RenderPhase)j);
+        drawCalls += renderer->getDrawCalls();
+        stateChanges += renderer->getStateChanges();
+
+        viewController->processEvents();
+        done++;
+    }
+    if (done == 0)
+        done = 1;
+
+    logController->logff("Replay: %i iterations with %s renderer, average per frame:\n", done,
+                         Config::rendererTypeToString(config->getRendererType()).c_str());
+    logController->logff("  submit %.3f ms\n", submitTotal / done);
+    for (int j = 0; j < RENDER_PHASES; j++)
+        logController->logff("  %s %.3f ms\n", phaseNames[j], phaseTotals[j] / done);
+    logController->logff("  %lli draw calls, %lli state changes\n", drawCalls / done, stateChanges / done);
+
+    capture.releaseResources(renderer);
+
+    engine->destroy();
+    return 0;
+}
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/rtengine.h"
+#include "../src/renderer/blockEncoder.h"
+#include "helpers.h"
+#include <stdio.h>
+#include <string>
+
+// Cooks image into block compressed one, ResourceImage takes it instead of the source if it lies next to it
+// Arguments: source image, result .ktx2 or .dds, format bc1, bc3, bc5 or bc7
+APPMAIN
+{
+#ifdef _WIN32
+    int argc = __argc;
+    char **argv = __argv;
+#endif
+    if (argc < 3)
+    {
+        printf("Usage: 26-helloTextureCooking source.png result.ktx2 [bc1|bc3|bc5|bc7]\n");
+        return 1;
+    }
+
+    std::string source = argv[1];
+    std::string result = argv[2];
+    std::string formatName = argc > 3 ? argv[3] : "bc7";
+
+    TextureFormat format = TextureFormat::BC7;
+    if (formatName == "bc1")
+        format = TextureFormat::BC1;
+    else if (formatName == "bc3")
+        format = TextureFormat::BC3;
+    else if (formatName == "bc5")
+        format = TextureFormat::BC5;
+
+    // Encoder works on CPU only, engine and window are not needed
+    CompressedImage image;
+    if (!BlockEncoder::encodeFile(source, format, true, &image))
+    {
+        printf("Unable to read %s\n", source.c_str());
+        return 1;
+    }
+
+    bool bDDS = result.size() > 4 && result.substr(result.size() - 4) == ".dds";
+    if (!(bDDS ? image.saveDDS(result) : image.saveKTX2(result)))
+    {
+        printf("Unable to write %s\n", result.c_str());
+        return 1;
+    }
+
+    int size = 0;
+    for (int i = 0; i < image.getLevelsAmount(); i++)
+        size += image.getLevel(i)->data.size();
+    printf("%s: %ix%i, %i levels, %i bytes instead of %i\n", result.c_str(), image.getWidth(), image.getHeight(),
+           image.getLevelsAmount(), size, image.getWidth() * image.getHeight() * 4 * 4 / 3);
+    return 0;
+}
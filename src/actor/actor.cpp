@@ -3,6 +3,13 @@
 
 #include "actor/actor.h"
 #include "stage/layerActors.h"
+#include <float.h>
+
+// Removed component passes its counters to the actor, so version of render bounds never goes back
+static inline unsigned int getComponentChanges(Component *component)
+{
+    return component->transform.getChanges() + component->getBoundsChanges() + 1;
+}
 
 Actor::Actor()
 {
@@ -53,6 +60,7 @@ void Actor::removeComponents()
 {
     for (auto it = components.begin(); it != components.end(); it++)
     {
+        renderBoundsChanges += getComponentChanges(*it);
         delete (*it);
     }
     components.clear();
@@ -65,6 +73,7 @@ void Actor::removeComponent(Component *component)
     {
         if (*it == component)
         {
+            renderBoundsChanges += getComponentChanges(*it);
             delete *it;
         }
         return;
@@ -76,6 +85,7 @@ void Actor::prepareNewComponent(Component *component)
     this->components.push_back(component);
     component->prepare(this);
     bPhysicsNeedsToBeRebuild = true;
+    renderBoundsChanges++;
 }
 
 void Actor::setPhysicsWorld(PhysicsWorld *physicsWorld)
@@ -112,6 +122,7 @@ void Actor::process(float delta)
             (*it)->process(delta);
             if ((*it)->isDestroyed())
             {
+                renderBoundsChanges += getComponentChanges(*it);
                 delete (*it);
                 it = components.erase(it);
                 bPhysicsNeedsToBeRebuild = true;
@@ -217,6 +228,39 @@ void Actor::childUpdated()
     bPhysicsNeedsToBeRebuild = true;
 }
 
+bool Actor::getRenderBounds(AABB &bounds)
+{
+    if (bShowBoundingBox || bShowNormals || bShowBoundingVolume)
+        return false;
+
+    bounds = AABB(Vector3(FLT_MAX), Vector3(-FLT_MAX));
+    for (auto component = components.begin(); component != components.end(); component++)
+    {
+        if (!(*component)->getRenderBounds(bounds))
+            return false;
+    }
+
+    // Actor without anything to render may still do something in onRenderQueue
+    return bounds.start.x <= bounds.end.x;
+}
+
+bool Actor::hasOccluders()
+{
+    for (auto component = components.begin(); component != components.end(); component++)
+        if ((*component)->getOccluder())
+            return true;
+    return false;
+}
+
+// Counters only grow, so their sum changes whenever any of them does
+unsigned int Actor::getRenderBoundsVersion()
+{
+    unsigned int version = transform.getChanges() + renderBoundsChanges;
+    for (auto component = components.begin(); component != components.end(); component++)
+        version += (*component)->transform.getChanges() + (*component)->getBoundsChanges();
+    return version;
+}
+
 void Actor::updatePhysics()
 {
     bPhysicsNeedsToBeRebuild = false;
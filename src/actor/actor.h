@@ -10,6 +10,7 @@
 #include "connector/withLogger.h"
 #include "math/math.h"
 #include "math/transformation.h"
+#include "math/AABBTree.h"
 #include "component/component.h"
 #include "physics/shapes/shape.h"
 #include "physics/physicsWorld.h"
@@ -19,6 +20,16 @@
 #include <list>
 #include <vector>
 
+// Place of actor in spatial index of its layer
+struct ActorSpatialState
+{
+    int proxy = AABB_TREE_NULL;
+    unsigned int version = 0;
+    bool bIndexed = false;
+    bool bUnbounded = false;
+    bool bOccluder = false;
+};
+
 class Actor : public Entity, public Watchable<Actor>, public Destroyable, public WithDebug, public WithLogger
 {
 public:
@@ -67,9 +78,9 @@ public:
     EXPORT virtual void onCollideStopped(Actor *hitWith);
 
     EXPORT inline bool hasDebugView() { return bShowBoundingBox || bShowNormals; }
-    EXPORT inline void showBoundingBox(bool state) { bShowBoundingBox = state; }
-    EXPORT inline void showNormals(bool state) { bShowNormals = state; }
-    EXPORT inline void showBoundingVolume(bool state) { bShowBoundingVolume = state; }
+    EXPORT inline void showBoundingBox(bool state) { bShowBoundingBox = state; renderBoundsChanges++; }
+    EXPORT inline void showNormals(bool state) { bShowNormals = state; renderBoundsChanges++; }
+    EXPORT inline void showBoundingVolume(bool state) { bShowBoundingVolume = state; renderBoundsChanges++; }
 
     inline bool isBoundingBoxShown() { return bShowBoundingBox; }
     inline bool isNormalsShown() { return bShowNormals; }
@@ -79,6 +90,15 @@ public:
 
     inline const std::list<Component *> *getComponents() { return &components; }
 
+    // World space union of render bounds of components, false if actor must be visited every frame
+    // Actors adding elements to render queue by themselves have to override it
+    EXPORT virtual bool getRenderBounds(AABB &bounds);
+    EXPORT bool hasOccluders();
+    // Grows with every change of actor or component transform, components or their bounds
+    EXPORT unsigned int getRenderBoundsVersion();
+
+    ActorSpatialState spatial;
+
 protected:
     void updatePhysics();
 
@@ -98,6 +118,7 @@ protected:
     float restitution = 0.5f;
     float friction = 1.0f;
     float zLockedPosition = 0.0f;
+    unsigned int renderBoundsChanges = 0;
 
     std::list<Component *> components;
     std::string name = "actor";
@@ -43,6 +43,8 @@ bool Config::loadConfig()
                 shadowQuality = stringToQuality(it->value);
             if (it->name == "antialiasing")
                 antialiasing = stringToAntialiasing(it->value);
+            if (it->name == "renderer")
+                rendererType = stringToRendererType(it->value);
         }
 
         bIsLoaded = true;
@@ -75,6 +77,8 @@ bool Config::saveConfig()
         fputs(buffer, cfgFile);
         sprintf(buffer, "%s=%s\n", "antialiasing", antialiasingToString(antialiasing).c_str());
         fputs(buffer, cfgFile);
+        sprintf(buffer, "%s=%s\n", "renderer", rendererTypeToString(rendererType).c_str());
+        fputs(buffer, cfgFile);
 
         fclose(cfgFile);
         return true;
@@ -207,6 +211,16 @@ float Config::getMultisamplingFactor()
     }
 }
 
+RendererType Config::getRendererType()
+{
+    return rendererType;
+}
+
+void Config::setRendererType(RendererType type)
+{
+    rendererType = type;
+}
+
 bool Config::isSameWith(Config *otherConfig)
 {
     bool same = true;
@@ -218,6 +232,7 @@ bool Config::isSameWith(Config *otherConfig)
     same &= getAnialiasing() == otherConfig->getAnialiasing();
     same &= getCurrentVideoDevice() == otherConfig->getCurrentVideoDevice();
     same &= getCurrentAudioDevice() == otherConfig->getCurrentAudioDevice();
+    same &= getRendererType() == otherConfig->getRendererType();
     return same;
 }
 
@@ -231,6 +246,7 @@ void Config::copyFrom(Config *otherConfig)
     setAnialiasing(otherConfig->getAnialiasing());
     setCurrentVideoDevice(otherConfig->getCurrentVideoDevice());
     setCurrentAudioDevice(otherConfig->getCurrentAudioDevice());
+    setRendererType(otherConfig->getRendererType());
 }
 
 std::string Config::qualityToString(RenderQuality quality)
@@ -289,6 +305,20 @@ AntiAliasing Config::stringToAntialiasing(std::string quality)
     return AntiAliasing::None;
 }
 
+std::string Config::rendererTypeToString(RendererType type)
+{
+    if (type == RendererType::Null)
+        return "null";
+    return "opengl";
+}
+
+RendererType Config::stringToRendererType(std::string type)
+{
+    if (type == "null")
+        return RendererType::Null;
+    return RendererType::OpenGL;
+}
+
 bool Config::getPairFromString(char *buffer, int limit, ConfigPair *pair)
 {
     if (strlen(buffer) >= limit)
@@ -24,6 +24,13 @@ enum class AntiAliasing{
     SSAA4,
 };
 
+// Null renderer consumes render queue without any graphics API, for servers, tests and CPU profiling
+enum class RendererType
+{
+    OpenGL = 0,
+    Null
+};
+
 struct ConfigPair
 {
     std::string name;
@@ -60,6 +67,8 @@ public:
     EXPORT AntiAliasing getAnialiasing();
     EXPORT void setAnialiasing(AntiAliasing state);
     EXPORT float getMultisamplingFactor();
+    EXPORT RendererType getRendererType();
+    EXPORT void setRendererType(RendererType type);
 
     EXPORT bool isSameWith(Config *otherConfig);
     EXPORT void copyFrom(Config *otherConfig);
@@ -68,6 +77,8 @@ public:
     EXPORT static RenderQuality stringToQuality(std::string quality);
     EXPORT static std::string antialiasingToString(AntiAliasing quality);
     EXPORT static AntiAliasing stringToAntialiasing(std::string quality);
+    EXPORT static std::string rendererTypeToString(RendererType type);
+    EXPORT static RendererType stringToRendererType(std::string type);
 
 protected:
     bool getPairFromString(char *buffer, int limit, ConfigPair *pair);
@@ -83,4 +94,5 @@ protected:
 
     RenderQuality shadowQuality = RenderQuality::High;
     AntiAliasing antialiasing = AntiAliasing::None;
+    RendererType rendererType = RendererType::OpenGL;
 };
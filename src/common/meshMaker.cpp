@@ -22,7 +22,7 @@ MeshStatic *MeshMaker::createBox(Vector3 dimensions)
     }
     auto newMesh = getRenderer()->createStaticMesh();
     int attributeSizes[3] = {3, 3, 2};
-    newMesh->setupFloatsArray(data, 36, 3, attributeSizes, true);
+    newMesh->setupIndexedFloatsArray(data, 36, 3, attributeSizes, true);
     return newMesh;
 }
 
@@ -59,7 +59,7 @@ MeshStatic *MeshMaker::createPlane(Vector2 dimensions, float UVScale, int subdiv
 
     auto newMesh = getRenderer()->createStaticMesh();
     int attributeSizes[3] = {3, 3, 2};
-    newMesh->setupFloatsArray(data, 6 * subdivision * subdivision, 3, attributeSizes, true);
+    newMesh->setupIndexedFloatsArray(data, 6 * subdivision * subdivision, 3, attributeSizes, true);
     return newMesh;
 }
 
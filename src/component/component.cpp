@@ -182,6 +182,24 @@ MeshStatic *Component::getStaticMesh()
     return nullptr;
 }
 
+bool Component::getRenderBounds(AABB &bounds)
+{
+    return false;
+}
+
+MeshStatic *Component::getOccluder()
+{
+    return nullptr;
+}
+
+void Component::extendBoundsBySphere(AABB &bounds, const Matrix4 &mModel, Sphere *sphere)
+{
+    Matrix4 mSphere = mModel;
+    Vector3 center = Vector3(mModel * Vector4(sphere->center, 1.0f));
+    Vector3 radius = Vector3(sphere->recalcRadius(&mSphere));
+    bounds.extend(AABB(center - radius, center + radius));
+}
+
 void Component::renderDebugVolume(Renderer *renderer, Matrix4 *mProjectionView, float thickness, Vector3 color)
 {
 }
@@ -50,6 +50,14 @@ public:
     EXPORT Matrix4 getWorldModelMatrix();
 
     EXPORT virtual MeshStatic *getStaticMesh();
+
+    // Extends bounds by world space volume of everything the component adds to render queue
+    // Returns false if volume is unknown, such component is never culled
+    EXPORT virtual bool getRenderBounds(AABB &bounds);
+    // Grows when render bounds change without change of transform
+    inline unsigned int getBoundsChanges() { return boundsChanges; }
+    // Simplified mesh hiding things behind it, rasterized on CPU with world model matrix of component
+    EXPORT virtual MeshStatic *getOccluder();
     EXPORT virtual void renderDebugVolume(Renderer *renderer, Matrix4 *mProjectionView, float thickness, Vector3 color);
 
     EXPORT inline void setVisibility(bool state) { bIsVisible = state; }
@@ -63,7 +71,11 @@ public:
     ColorMode colorMode = ColorMode::Lit;
 
 protected:
+    EXPORT void extendBoundsBySphere(AABB &bounds, const Matrix4 &mModel, Sphere *sphere);
+    inline void markBoundsChanged() { boundsChanges++; }
+
     bool bIsVisible = true;
+    unsigned int boundsChanges = 0;
     Entity *owner = nullptr;
     ShaderParameter **parametersList = nullptr;
     int parametersAmount = 0;
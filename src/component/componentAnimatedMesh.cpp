@@ -144,26 +144,7 @@ void ComponentAnimatedMesh::renderDebugVolume(Renderer *renderer, Matrix4 *mProj
             float radius = volume->recalcRadius(&fullNodeTransform);
             Vector3 absoluteCenter = fullNodeTransform * Vector4(volume->center, 1.0f);
 
-            for (int i = 0; i < 16; i++)
-            {
-                float lA = (float)i / 16.0f * CONST_PI * 2.0f;
-                float lB = (float)(i + 1) / 16.0f * CONST_PI * 2.0f;
-
-                renderer->renderDebugLine(
-                    (absoluteCenter + Vector3(radius * sinf(lA), radius * cosf(lA), 0.0f)),
-                    (absoluteCenter + Vector3(radius * sinf(lB), radius * cosf(lB), 0.0f)),
-                    mProjectionView, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
-
-                renderer->renderDebugLine(
-                    (absoluteCenter + Vector3(0.0f, radius * sinf(lA), radius * cosf(lA))),
-                    (absoluteCenter + Vector3(0.0f, radius * sinf(lB), radius * cosf(lB))),
-                    mProjectionView, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
-
-                renderer->renderDebugLine(
-                    (absoluteCenter + Vector3(radius * cosf(lA), 0.0f, radius * sinf(lA))),
-                    (absoluteCenter + Vector3(radius * cosf(lB), 0.0f, radius * sinf(lB))),
-                    mProjectionView, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
-            }
+            renderer->getDebugLines()->addSphere(absoluteCenter, radius, color);
         }
     }
 }
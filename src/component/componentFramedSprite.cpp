@@ -32,8 +32,9 @@ void ComponentFramedSprite::onRenderQueue(RenderQueue *renderQueue)
     if (texture && owner)
     {
         Matrix4 mModel = *owner->transform.getModelMatrix() * *transform.getModelMatrix() * mAnchor;
-        shadersParameters[0]->set(1, frameShift);
-        shadersParameters[1]->set(1, frameRenderSize);
+        texture->toPageCoords(frameShift, frameRenderSize, pageShift, pageSize);
+        shadersParameters[0]->set(1, pageShift);
+        shadersParameters[1]->set(1, pageSize);
 
         if (colorMode == ColorMode::Lit)
         {
@@ -45,6 +45,9 @@ protected:
     float frameShift[2] = {0.0f, 0.0f};
     float frameSize[2] = {1.0f, 1.0f};
     float frameRenderSize[2] = {1.0f, 1.0f};
+    // Frame in coordinates of the bound texture, differs from the frame for atlas region
+    float pageShift[2] = {0.0f, 0.0f};
+    float pageSize[2] = {1.0f, 1.0f};
 
     float opacity = 1.0f;
     Texture *texture = nullptr;
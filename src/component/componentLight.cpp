@@ -16,6 +16,7 @@ void ComponentLight::setupSunLight(Vector3 color, bool bCastShadows, float affec
     this->color = color;
     this->affectDistance = affectDistance;
     this->bCastShadows = bCastShadows;
+    markBoundsChanged();
 }
 
 void ComponentLight::setupOmniLight(float affectDistance, Vector3 color, bool bCastShadows)
@@ -24,6 +25,7 @@ void ComponentLight::setupOmniLight(float affectDistance, Vector3 color, bool bC
     this->affectDistance = affectDistance;
     this->color = color;
     this->bCastShadows = bCastShadows;
+    markBoundsChanged();
 }
 
 void ComponentLight::onRenderQueue(RenderQueue *renderQueue)
@@ -33,6 +35,19 @@ void ComponentLight::onRenderQueue(RenderQueue *renderQueue)
     renderQueue->addLight(type, Vector3(v4Position), color, affectDistance, bCastShadows);
 }
 
+// Affect distance is in G buffer space scaled by 0.1, sun lights everything and is never culled
+bool ComponentLight::getRenderBounds(AABB &bounds)
+{
+    if (type != LightType::Omni)
+        return type == LightType::None;
+
+    Matrix4 mModel = *owner->transform.getModelMatrix() * *transform.getModelMatrix();
+    Vector3 position = Vector3(mModel * Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+    Vector3 radius = Vector3(affectDistance * 10.0f);
+    bounds.extend(AABB(position - radius, position + radius));
+    return true;
+}
+
 void ComponentLight::enableShadows()
 {
     bCastShadows = true;
@@ -16,6 +16,7 @@ public:
     EXPORT void setupOmniLight(float affectDistance, Vector3 color, bool bCastShadows = false);
 
     EXPORT void onRenderQueue(RenderQueue *renderQueue) override;
+    EXPORT bool getRenderBounds(AABB &bounds) override;
 
     EXPORT void enableShadows();
     EXPORT void disableShadows();
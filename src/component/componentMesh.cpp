@@ -30,9 +30,9 @@ void ComponentMesh::onRenderQueue(RenderQueue *renderQueue)
             if (bRenderShape)
             {
                 if (colorMode == ColorMode::Lit)
-                    renderQueue->addMainPhase(mModel, shader, nullptr, toRender->getAsStatic(), parametersList, parametersAmount);
+                    renderQueue->addMainPhase(mModel, shader, nullptr, toRender->getAsStatic(), parametersList, parametersAmount, &lodState);
                 else
-                    renderQueue->addBlendingPhase(mModel, colorMode, shader, nullptr, toRender->getAsStatic(), 1.0f, parametersList, parametersAmount);
+                    renderQueue->addBlendingPhase(mModel, colorMode, shader, nullptr, toRender->getAsStatic(), 1.0f, parametersList, parametersAmount, &lodState);
             }
 
             if (bCastShadows)
@@ -43,9 +43,9 @@ void ComponentMesh::onRenderQueue(RenderQueue *renderQueue)
             if (bRenderShape)
             {
                 if (colorMode == ColorMode::Lit)
-                    renderQueue->addMainPhase(mModel, shader, nullptr, mesh->getAsStatic(), parametersList, parametersAmount);
+                    renderQueue->addMainPhase(mModel, shader, nullptr, mesh->getAsStatic(), parametersList, parametersAmount, &lodState);
                 else
-                    renderQueue->addBlendingPhase(mModel, colorMode, shader, nullptr, mesh->getAsStatic(), 1.0f, parametersList, parametersAmount);
+                    renderQueue->addBlendingPhase(mModel, colorMode, shader, nullptr, mesh->getAsStatic(), 1.0f, parametersList, parametersAmount, &lodState);
             }
 
             if (bCastShadows)
@@ -59,11 +59,23 @@ void ComponentMesh::setMesh(Mesh *mesh)
     if (this->mesh != mesh)
     {
         this->mesh = mesh;
+        markBoundsChanged();
         if (owner)
             owner->childUpdated();
     }
 }
 
+MeshStatic *ComponentMesh::getOccluder()
+{
+    return occluder;
+}
+
+void ComponentMesh::setOccluder(MeshStatic *occluder)
+{
+    this->occluder = occluder;
+    markBoundsChanged();
+}
+
 void ComponentMesh::setShader(Shader *shader)
 {
     this->shader = shader;
@@ -81,6 +93,28 @@ MeshStatic *ComponentMesh::getStaticMesh()
     return mesh->getAsStatic();
 }
 
+// Bound volume of mesh that is not loaded yet says nothing about its size
+bool ComponentMesh::getRenderBounds(AABB &bounds)
+{
+    if (!mesh)
+        return true;
+
+    Matrix4 mModel = *owner->transform.getModelMatrix() * *transform.getModelMatrix();
+    MeshStatic *staticMesh = mesh->getAsStatic();
+    if (!staticMesh || !staticMesh->isRendarable())
+        return false;
+    extendBoundsBySphere(bounds, mModel, staticMesh->getBoundVolumeSphere());
+
+    for (auto &lod : lods)
+    {
+        staticMesh = lod.mesh->getAsStatic();
+        if (!staticMesh || !staticMesh->isRendarable())
+            return false;
+        extendBoundsBySphere(bounds, mModel, staticMesh->getBoundVolumeSphere());
+    }
+    return true;
+}
+
 void ComponentMesh::lookAt(Vector3 &point, bool bUseGlobalTranformation)
 {
     transform.setRotation(Vector3(0.0f, 0.0f, 0.0f));
@@ -93,6 +127,7 @@ void ComponentMesh::lookAt(Vector3 &point, bool bUseGlobalTranformation)
 void ComponentMesh::addLod(Mesh *mesh, float distance)
 {
     lods.push_back({mesh, distance});
+    markBoundsChanged();
 }
 
 void ComponentMesh::renderDebugVolume(Renderer *renderer, Matrix4 *mProjectionView, float thickness, Vector3 color)
@@ -104,25 +139,6 @@ void ComponentMesh::renderDebugVolume(Renderer *renderer, Matrix4 *mProjectionVi
         float radius = volume->recalcRadius(&worldTransform);
         Vector3 absoluteCenter = worldTransform * Vector4(volume->center, 1.0f);
 
-        for (int i = 0; i < 16; i++)
-        {
-            float lA = (float)i / 16.0f * CONST_PI * 2.0f;
-            float lB = (float)(i + 1) / 16.0f * CONST_PI * 2.0f;
-
-            renderer->renderDebugLine(
-                (absoluteCenter + Vector3(radius * sinf(lA), radius * cosf(lA), 0.0f)),
-                (absoluteCenter + Vector3(radius * sinf(lB), radius * cosf(lB), 0.0f)),
-                mProjectionView, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
-
-            renderer->renderDebugLine(
-                (absoluteCenter + Vector3(0.0f, radius * sinf(lA), radius * cosf(lA))),
-                (absoluteCenter + Vector3(0.0f, radius * sinf(lB), radius * cosf(lB))),
-                mProjectionView, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
-
-            renderer->renderDebugLine(
-                (absoluteCenter + Vector3(radius * cosf(lA), 0.0f, radius * sinf(lA))),
-                (absoluteCenter + Vector3(radius * cosf(lB), 0.0f, radius * sinf(lB))),
-                mProjectionView, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
-        }
+        renderer->getDebugLines()->addSphere(absoluteCenter, radius, color);
     }
 }
\ No newline at end of file
@@ -29,6 +29,11 @@ public:
     EXPORT Matrix4 getLocalspaceMatrix() override;
 
     EXPORT MeshStatic *getStaticMesh() override;
+    EXPORT bool getRenderBounds(AABB &bounds) override;
+    EXPORT MeshStatic *getOccluder() override;
+
+    // Occluder has to be inside of the mesh, triangles of it are kept on CPU
+    EXPORT void setOccluder(MeshStatic *occluder);
 
     EXPORT void lookAt(Vector3 &point, bool bUseGlobalTranformation = true);
 
@@ -48,9 +53,12 @@ public:
 
 protected:
     Mesh *mesh = nullptr;
+    MeshStatic *occluder = nullptr;
     Shader *shader = nullptr;
 
     std::vector<ComponentMeshLod> lods;
+    // Level of detail of the static mesh chosen last frame
+    int lodState = -1;
     bool bCastShadows = true;
     bool bRenderShape = true;
 
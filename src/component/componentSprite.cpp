@@ -15,18 +15,27 @@ ComponentSprite::ComponentSprite() : Component()
     mesh = getRenderer()->getDefaultSpriteMesh();
 }
 
+ComponentSprite::~ComponentSprite()
+{
+    releaseRegionShader();
+}
+
 void ComponentSprite::onRenderQueue(RenderQueue *renderQueue)
 {
     if (texture && owner)
     {
         Matrix4 mModel = *owner->transform.getModelMatrix() * *transform.getModelMatrix() * mAnchor;
+        // Region parameters belong to framed shader, parameters set by user are kept for the own shader
+        Shader *drawShader = regionShader ? regionShader : shader;
+        ShaderParameter **drawParameters = regionShader ? regionParameters : parametersList;
+        int drawParametersAmount = regionShader ? 2 : parametersAmount;
         if (colorMode == ColorMode::Lit)
         {
-            renderQueue->addMainPhase(mModel, shader, texture, mesh, parametersList, parametersAmount);
+            renderQueue->addMainPhase(mModel, drawShader, texture, mesh, drawParameters, drawParametersAmount);
         }
         else
         {
-            renderQueue->addBlendingPhase(mModel, colorMode, shader, texture, mesh, opacity, parametersList, parametersAmount);
+            renderQueue->addBlendingPhase(mModel, colorMode, drawShader, texture, mesh, opacity, drawParameters, drawParametersAmount);
         }
     }
 }
@@ -71,6 +80,7 @@ void ComponentSprite::setTexture(Texture *texture)
 {
     this->texture = texture;
     setRelativeScale(1.0f, 1.0f);
+    updateRegionShader();
 }
 
 Texture *ComponentSprite::getTexture()
@@ -81,6 +91,7 @@ Texture *ComponentSprite::getTexture()
 void ComponentSprite::setShader(Shader *shader)
 {
     this->shader = shader;
+    updateRegionShader();
 }
 
 Matrix4 ComponentSprite::getLocalspaceMatrix()
@@ -88,3 +99,37 @@ Matrix4 ComponentSprite::getLocalspaceMatrix()
     Matrix4 mModelTransform = *transform.getModelMatrix();
     return mModelTransform * mAnchor;
 }
+
+void ComponentSprite::updateRegionShader()
+{
+    if (!texture || !texture->isAtlasRegion() || shader != getRenderer()->getDefaultSpriteShader())
+    {
+        releaseRegionShader();
+        return;
+    }
+
+    if (!regionShader)
+    {
+        regionShader = getRenderer()->getDefaultFramedSpriteShader();
+        regionParameters[0] = regionShader->createShaderParameter("aTexCoordShift", ShaderParameterType::Float2);
+        regionParameters[1] = regionShader->createShaderParameter("aTexCoordMul", ShaderParameterType::Float2);
+    }
+
+    float shift[2] = {0.0f, 0.0f};
+    float size[2] = {1.0f, 1.0f};
+    texture->toPageCoords(shift, size, regionShift, regionSize);
+    regionParameters[0]->set(1, regionShift);
+    regionParameters[1]->set(1, regionSize);
+}
+
+void ComponentSprite::releaseRegionShader()
+{
+    if (!regionShader)
+        return;
+
+    regionShader->destroyShaderParameter(regionParameters[0]);
+    regionShader->destroyShaderParameter(regionParameters[1]);
+    regionParameters[0] = nullptr;
+    regionParameters[1] = nullptr;
+    regionShader = nullptr;
+}
@@ -6,12 +6,14 @@
 #include "renderer/texture.h"
 #include "component/component.h"
 #include "renderer/shader.h"
+#include "renderer/shaderParameter.h"
 #include "connector/withRenderer.h"
 
 class ComponentSprite : public Component, public WithRenderer
 {
 public:
     EXPORT ComponentSprite();
+    EXPORT ~ComponentSprite();
 
     EXPORT void onRenderQueue(RenderQueue *renderQueue) override final;
 
@@ -28,9 +30,19 @@ public:
     EXPORT Matrix4 getLocalspaceMatrix() override;
 
 protected:
+    // Atlas region drawn with default shader goes through framed sprite shader with coordinates of the region
+    // Region parameters are drawn instead of parameters list, so the list set by user stays as it is
+    void updateRegionShader();
+    void releaseRegionShader();
+
     float opacity = 1.0f;
     Texture *texture = nullptr;
     Shader *shader = nullptr;
     MeshStatic *mesh = nullptr;
     Matrix4 mAnchor;
+
+    Shader *regionShader = nullptr;
+    ShaderParameter *regionParameters[2] = {nullptr, nullptr};
+    float regionShift[2] = {0.0f, 0.0f};
+    float regionSize[2] = {1.0f, 1.0f};
 };
@@ -8,7 +8,7 @@ class WithCore
 {
 public:
     EXPORT WithCore();
-    static void setGlobalCore(Core *coreGlobal);
+    EXPORT static void setGlobalCore(Core *coreGlobal);
 
 protected:
     Core *core;
@@ -8,7 +8,7 @@ class WithLogger
 {
 public:
     EXPORT WithLogger();
-    static void setLogController(LogController *logController);
+    EXPORT static void setLogController(LogController *logController);
 
     LogController *getLogger() { return logger; }
 
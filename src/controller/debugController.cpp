@@ -94,20 +94,7 @@ void DebugController::disableVisibility()
 
 void DebugController::addDebugLine(Vector3 a, Vector3 b, float time, float thickness, Vector3 color)
 {
-    Vector3 p = (a + b) / 2.0f;
-    Vector3 dif = glm::normalize(b - a);
-    float y = atan2f(dif.z, dif.x);
-    float len = sqrtf(dif.x * dif.x + dif.z * dif.z);
-    float x = atan2(len, dif.y);
-    float lineLength = glm::length(a - b);
-
-    Transformation tf;
-    tf.setPosition(p);
-    tf.setRotation(Vector3(CONST_PI / 2 - x, -y - CONST_PI / 2.0f, 0.0f));
-    tf.setScale(Vector3(thickness, thickness, lineLength));
-    Matrix4 *mOut = tf.getModelMatrix();
-
-    DebugBox *newDebugBox = new DebugBox({*mOut, time, color});
+    DebugBox *newDebugBox = new DebugBox({Matrix4(1.0f), time, color, true, a, b});
     debugFigures.push_back(newDebugBox);
 }
 
@@ -123,34 +110,23 @@ void DebugController::addDebugBox(Vector3 p, float size, float time, Vector3 col
 
 void DebugController::renderAll(Matrix4 *mProjectionView)
 {
-    if (!debugFigures.empty())
+    if (!getRenderer())
+        return;
+
+    auto lines = getRenderer()->getDebugLines();
+    for (auto figure = debugFigures.begin(); figure != debugFigures.end(); ++figure)
     {
-        for (auto figure = debugFigures.begin(); figure != debugFigures.end(); ++figure)
-        {
-            renderLine(&(*figure)->m, mProjectionView, (*figure)->color);
-        }
+        if ((*figure)->bLine)
+            lines->addLine((*figure)->a, (*figure)->b, (*figure)->color);
+        else
+            lines->addBox((*figure)->m, (*figure)->color);
     }
 }
 
 void DebugController::renderBoundingBox(AABB aabb, Matrix4 *mProjectionView, float f, float thickness, Vector3 color)
 {
-    Vector3 start = aabb.start / f;
-    Vector3 end = aabb.end / f;
-
-    renderLine(Vector3(start.x, end.y, start.z), Vector3(end.x, end.y, start.z), mProjectionView, thickness, color);
-    renderLine(Vector3(start.x, end.y, start.z), Vector3(start.x, end.y, end.z), mProjectionView, thickness, color);
-    renderLine(Vector3(end.x, end.y, end.z), Vector3(end.x, end.y, start.z), mProjectionView, thickness, color);
-    renderLine(Vector3(end.x, end.y, end.z), Vector3(start.x, end.y, end.z), mProjectionView, thickness, color);
-
-    renderLine(Vector3(start.x, start.y, start.z), Vector3(end.x, start.y, start.z), mProjectionView, thickness, color);
-    renderLine(Vector3(start.x, start.y, start.z), Vector3(start.x, start.y, end.z), mProjectionView, thickness, color);
-    renderLine(Vector3(end.x, start.y, end.z), Vector3(end.x, start.y, start.z), mProjectionView, thickness, color);
-    renderLine(Vector3(end.x, start.y, end.z), Vector3(start.x, start.y, end.z), mProjectionView, thickness, color);
-
-    renderLine(Vector3(start.x, start.y, start.z), Vector3(start.x, end.y, start.z), mProjectionView, thickness, color);
-    renderLine(Vector3(end.x, start.y, start.z), Vector3(end.x, end.y, start.z), mProjectionView, thickness, color);
-    renderLine(Vector3(start.x, start.y, end.z), Vector3(start.x, end.y, end.z), mProjectionView, thickness, color);
-    renderLine(Vector3(end.x, start.y, end.z), Vector3(end.x, end.y, end.z), mProjectionView, thickness, color);
+    if (getRenderer())
+        getRenderer()->getDebugLines()->addBox(aabb.start / f, aabb.end / f, color);
 }
 
 void DebugController::renderLine(Vector3 a, Vector3 b, Matrix4 *mProjectionView, float thickness, Vector3 color)
@@ -163,4 +139,16 @@ void DebugController::renderLine(Matrix4 *model, Matrix4 *mProjectionView, Vecto
 {
     if (getRenderer())
         getRenderer()->renderDebugLine(model, mProjectionView, color);
+}
+
+void DebugController::renderSphere(Vector3 center, float radius, Vector3 color)
+{
+    if (getRenderer())
+        getRenderer()->getDebugLines()->addSphere(center, radius, color);
+}
+
+void DebugController::renderPoint(Vector3 point, float size, Vector3 color)
+{
+    if (getRenderer())
+        getRenderer()->getDebugLines()->addPoint(point, size, color);
 }
\ No newline at end of file
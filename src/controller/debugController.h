@@ -21,11 +21,15 @@ struct DebugEntry
     Color color;
 };
 
+// Box keeps model matrix of unit cube, line keeps its ends
 struct DebugBox
 {
     Matrix4 m;
     float timer;
     Vector3 color;
+    bool bLine = false;
+    Vector3 a;
+    Vector3 b;
 };
 
 class DebugController : public WithRenderer
@@ -54,6 +58,8 @@ public:
 
     EXPORT void renderLine(Vector3 a, Vector3 b, Matrix4 *mProjectionView, float thickness, Vector3 color);
     EXPORT void renderLine(Matrix4 *model, Matrix4 *mProjectionView, Vector3 color);
+    EXPORT void renderSphere(Vector3 center, float radius, Vector3 color);
+    EXPORT void renderPoint(Vector3 point, float size, Vector3 color);
 
 protected:
     std::vector<DebugBox *> debugFigures;
@@ -28,6 +28,24 @@ ResourceImage *ResourceController::getImageByPath(std::string path)
     return nullptr;
 }
 
+ResourceImage *ResourceController::addAtlasImage(std::string path)
+{
+    ResourceImage *image = getImageByPath(path);
+    if (!image)
+    {
+        image = addImage(path);
+        image->setAtlas(getAtlas());
+    }
+    return image;
+}
+
+TextureAtlas *ResourceController::getAtlas()
+{
+    if (!atlas)
+        atlas = new TextureAtlas();
+    return atlas;
+}
+
 ResourceHDR *ResourceController::addHDRImage(std::string path, float ldrScale, float ldrGamma)
 {
     ResourceHDR *hdr = getHDRImageByPath(path);
@@ -17,6 +17,9 @@ public:
 
     EXPORT ResourceImage *addImage(std::string path, ByteMap byteMap = ByteMap::None, int byteMapScale = 1);
     EXPORT ResourceImage *getImageByPath(std::string path);
+    // Image packed into the shared atlas, image added before with addImage is returned as it is
+    EXPORT ResourceImage *addAtlasImage(std::string path);
+    EXPORT TextureAtlas *getAtlas();
 
     EXPORT ResourceHDR *addHDRImage(std::string path, float ldrScale = 1.0f, float ldrGamma = 1.0f);
     EXPORT ResourceHDR *getHDRImageByPath(std::string path);
@@ -35,6 +38,7 @@ public:
 
 protected:
     std::vector<ResourceImage *> images;
+    TextureAtlas *atlas = nullptr;
     std::vector<ResourceHDR *> HDRs;
     std::vector<ResourceSound *> sounds;
     std::vector<ResourceFont *> fonts;
@@ -56,7 +56,8 @@ View *ViewController::createView(std::string name, unsigned int flags)
 
 RenderTarget *ViewController::createRenderTarget(int width, int height, RenderQuality renderQuality)
 {
-    return new RenderTarget(width, height, renderQuality, 1.0f);
+    bool bHeadless = mainView && mainView->getRenderer()->isHeadless();
+    return new RenderTarget(width, height, renderQuality, 1.0f, bHeadless);
 }
 
 void ViewController::destroyRenderTarget(RenderTarget *renderTarget)
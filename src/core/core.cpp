@@ -18,6 +18,24 @@ void Core::queueJob(const std::function<void()> &job)
     mutex_condition.notify_one();
 }
 
+void Core::queueJob(const std::function<void()> &job, std::atomic<int> *counter)
+{
+    (*counter)++;
+    queueJob([job, counter]
+             {
+                job();
+                (*counter)--; });
+}
+
+void Core::waitForJobs(std::atomic<int> *counter)
+{
+    while (*counter > 0)
+    {
+        if (!runPendingJob())
+            std::this_thread::yield();
+    }
+}
+
 bool Core::isBusy()
 {
     bool poolbusy;
@@ -42,6 +60,22 @@ void Core::stop()
     threads.clear();
 }
 
+bool Core::runPendingJob()
+{
+    std::function<void()> job;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (jobs.empty())
+            return false;
+        inProgress++;
+        job = jobs.front();
+        jobs.pop();
+    }
+    job();
+    inProgress--;
+    return true;
+}
+
 void Core::threadLoop()
 {
     while (true)
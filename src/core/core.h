@@ -6,20 +6,31 @@
 #include <vector>
 #include <functional>
 #include <queue>
+#include <atomic>
+#include <condition_variable>
 
 class Core
 {
 public:
-    Core();
+    EXPORT Core();
 
     EXPORT void queueJob(const std::function<void()> &job);
     EXPORT bool isBusy();
 
+    // Counter is increased on queueing and decreased when the job is finished
+    // Allows to wait for own group of jobs without waiting for the whole pool
+    EXPORT void queueJob(const std::function<void()> &job, std::atomic<int> *counter);
+
+    // Waits until counter reaches zero, calling thread executes queued jobs meanwhile
+    // Safe to call from inside of a job
+    EXPORT void waitForJobs(std::atomic<int> *counter);
+
     inline int getMaxJobs() { return threads.size(); }
 
 private:
     void stop();
     void threadLoop();
+    bool runPendingJob();
 
     bool should_terminate = false;           // Tells threads to stop looking for jobs
     std::mutex queue_mutex;                  // Prevents data races to the job queue
@@ -153,10 +153,14 @@ void LoaderFBX::reload()
 
             // create static mesh with gathered data
             MeshStatic *mesh = getRenderer()->createStaticMesh();
+            mesh->setVertexFormat(bPackedVertices ? MeshVertexFormat::Packed : MeshVertexFormat::Float);
 
             int amountOfVertexes = amountOfFloats / 8;
             int attributeSizes[3] = {3, 3, 2};
-            mesh->setupFloatsArray(data, amountOfVertexes, 3, attributeSizes, true);
+            if (data)
+                mesh->setupIndexedFloatsArray(data, amountOfVertexes, 3, attributeSizes, true, lodLevels, LOADER_LOD_REDUCTION);
+            else
+                mesh->setupFloatsArray(data, amountOfVertexes, 3, attributeSizes, true);
 
             delete[] data;
 
@@ -2,6 +2,11 @@
 // SPDX-License-Identifier: MIT
 
 #include "loaders3d/loader3d.h"
+#include "mesh/meshStatic.h"
+#include <algorithm>
+
+int Loader3d::lodLevels = 1;
+bool Loader3d::bPackedVertices = false;
 
 Loader3d::Loader3d(std::string path)
 {
@@ -38,4 +43,23 @@ std::vector<Animation *> Loader3d::getAnimations()
 {
     std::vector<Animation *> v;
     return v;
-}
\ No newline at end of file
+}
+void Loader3d::setLodLevels(int levels)
+{
+    lodLevels = std::max(1, std::min(levels, MESH_MAX_LODS));
+}
+
+int Loader3d::getLodLevels()
+{
+    return lodLevels;
+}
+
+void Loader3d::setPackedVertices(bool bPacked)
+{
+    bPackedVertices = bPacked;
+}
+
+bool Loader3d::isPackedVertices()
+{
+    return bPackedVertices;
+}
@@ -7,6 +7,9 @@
 #include <string>
 #include <vector>
 
+// Every next level of detail keeps this part of triangles of the previous one
+#define LOADER_LOD_REDUCTION 0.5f
+
 enum class File3dFormat
 {
     Unknown,
@@ -26,4 +29,16 @@ public:
     virtual MeshCompound *getMeshCompound();
 
     virtual std::vector<Animation *> getAnimations();
+
+    // Levels of detail built for loaded meshes including the full one, 1 turns simplification off
+    EXPORT static void setLodLevels(int levels);
+    EXPORT static int getLodLevels();
+
+    // Loaded meshes are packed to 16 bit positions and normals and half float uv, see MeshVertexFormat
+    EXPORT static void setPackedVertices(bool bPacked);
+    EXPORT static bool isPackedVertices();
+
+protected:
+    static int lodLevels;
+    static bool bPackedVertices;
 };
\ No newline at end of file
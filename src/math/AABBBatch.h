@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "math/AABB.h"
+#include "math/segment.h"
+#include <vector>
+#include <float.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define AABB_BATCH_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AABB_BATCH_NEON
+#endif
+
+#define AABB_BATCH_WIDTH 4
+
+// Structure of arrays storage of bounding boxes
+// One box or one ray is tested against 4 boxes per instruction, scalar code is used if SIMD is not available
+// Size is padded to AABB_BATCH_WIDTH with empty boxes which never overlap anything
+class AABBBatch
+{
+public:
+    inline void resize(int amount)
+    {
+        this->amount = amount;
+        int padded = (amount + AABB_BATCH_WIDTH - 1) & ~(AABB_BATCH_WIDTH - 1);
+        minX.resize(padded);
+        minY.resize(padded);
+        minZ.resize(padded);
+        maxX.resize(padded);
+        maxY.resize(padded);
+        maxZ.resize(padded);
+        for (int i = amount; i < padded; i++)
+            setEmpty(i);
+    }
+
+    inline int size() { return amount; }
+
+    inline void set(int index, const AABB &aabb)
+    {
+        minX[index] = aabb.start.x;
+        minY[index] = aabb.start.y;
+        minZ[index] = aabb.start.z;
+        maxX[index] = aabb.end.x;
+        maxY[index] = aabb.end.y;
+        maxZ[index] = aabb.end.z;
+    }
+
+    // Inverted box, fails every test
+    inline void setEmpty(int index)
+    {
+        minX[index] = minY[index] = minZ[index] = FLT_MAX;
+        maxX[index] = maxY[index] = maxZ[index] = -FLT_MAX;
+    }
+
+    inline AABB get(int index)
+    {
+        return AABB(Vector3(minX[index], minY[index], minZ[index]), Vector3(maxX[index], maxY[index], maxZ[index]));
+    }
+
+    // Pushes indexes of boxes in range [from, to) overlapping aabb, same rules as AABB::test
+    inline void testAABB(const AABB &aabb, int from, int to, std::vector<int> *out)
+    {
+        if (to > amount)
+            to = amount;
+        for (int block = from & ~(AABB_BATCH_WIDTH - 1); block < to; block += AABB_BATCH_WIDTH)
+        {
+            int mask = testAABBBlock(aabb, block);
+            pushMask(mask, block, from, to, out);
+        }
+    }
+
+    // Pushes indexes of boxes in range [from, to) crossed by segment, same rules as AABB::test
+    inline void testRay(const Segment &ray, int from, int to, std::vector<int> *out)
+    {
+        if (to > amount)
+            to = amount;
+
+        Vector3 direction = ray.b - ray.a;
+        Vector3 invDirection = Vector3(getSafeInverse(direction.x), getSafeInverse(direction.y), getSafeInverse(direction.z));
+
+        for (int block = from & ~(AABB_BATCH_WIDTH - 1); block < to; block += AABB_BATCH_WIDTH)
+        {
+            int mask = testRayBlock(ray.a, invDirection, block);
+            pushMask(mask, block, from, to, out);
+        }
+    }
+
+protected:
+    inline void pushMask(int mask, int block, int from, int to, std::vector<int> *out)
+    {
+        while (mask)
+        {
+            int lane = getLowestBit(mask);
+            int index = block + lane;
+            if (index >= from && index < to)
+                out->push_back(index);
+            mask &= mask - 1;
+        }
+    }
+
+    static inline int getLowestBit(int mask)
+    {
+        int lane = 0;
+        while (!(mask & (1 << lane)))
+            lane++;
+        return lane;
+    }
+
+    // Slab test is using 0 * large instead of 0 * infinity to avoid NaN on axis aligned rays
+    static inline float getSafeInverse(float v)
+    {
+        if (fabsf(v) < 1.0e-20f)
+            return v < 0.0f ? -1.0e30f : 1.0e30f;
+        return 1.0f / v;
+    }
+
+#if defined(AABB_BATCH_SSE)
+    inline int testAABBBlock(const AABB &aabb, int block)
+    {
+        __m128 overlap = _mm_and_ps(
+            _mm_cmplt_ps(_mm_loadu_ps(&minX[block]), _mm_set1_ps(aabb.end.x)),
+            _mm_cmpgt_ps(_mm_loadu_ps(&maxX[block]), _mm_set1_ps(aabb.start.x)));
+        overlap = _mm_and_ps(overlap, _mm_cmplt_ps(_mm_loadu_ps(&minY[block]), _mm_set1_ps(aabb.end.y)));
+        overlap = _mm_and_ps(overlap, _mm_cmpgt_ps(_mm_loadu_ps(&maxY[block]), _mm_set1_ps(aabb.start.y)));
+        overlap = _mm_and_ps(overlap, _mm_cmplt_ps(_mm_loadu_ps(&minZ[block]), _mm_set1_ps(aabb.end.z)));
+        overlap = _mm_and_ps(overlap, _mm_cmpgt_ps(_mm_loadu_ps(&maxZ[block]), _mm_set1_ps(aabb.start.z)));
+        return _mm_movemask_ps(overlap);
+    }
+
+    inline int testRayBlock(const Vector3 &origin, const Vector3 &invDirection, int block)
+    {
+        __m128 tMin = _mm_setzero_ps();
+        __m128 tMax = _mm_set1_ps(1.0f);
+        slabSSE(&minX[block], &maxX[block], origin.x, invDirection.x, tMin, tMax);
+        slabSSE(&minY[block], &maxY[block], origin.y, invDirection.y, tMin, tMax);
+        slabSSE(&minZ[block], &maxZ[block], origin.z, invDirection.z, tMin, tMax);
+        return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+    }
+
+    static inline void slabSSE(const float *min, const float *max, float origin, float invDirection, __m128 &tMin, __m128 &tMax)
+    {
+        __m128 o = _mm_set1_ps(origin);
+        __m128 inv = _mm_set1_ps(invDirection);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(min), o), inv);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(max), o), inv);
+        tMin = _mm_max_ps(tMin, _mm_min_ps(t1, t2));
+        tMax = _mm_min_ps(tMax, _mm_max_ps(t1, t2));
+    }
+#elif defined(AABB_BATCH_NEON)
+    static inline int getMaskNEON(uint32x4_t v)
+    {
+        return (vgetq_lane_u32(v, 0) & 1) | (vgetq_lane_u32(v, 1) & 2) | (vgetq_lane_u32(v, 2) & 4) | (vgetq_lane_u32(v, 3) & 8);
+    }
+
+    inline int testAABBBlock(const AABB &aabb, int block)
+    {
+        uint32x4_t overlap = vandq_u32(
+            vcltq_f32(vld1q_f32(&minX[block]), vdupq_n_f32(aabb.end.x)),
+            vcgtq_f32(vld1q_f32(&maxX[block]), vdupq_n_f32(aabb.start.x)));
+        overlap = vandq_u32(overlap, vcltq_f32(vld1q_f32(&minY[block]), vdupq_n_f32(aabb.end.y)));
+        overlap = vandq_u32(overlap, vcgtq_f32(vld1q_f32(&maxY[block]), vdupq_n_f32(aabb.start.y)));
+        overlap = vandq_u32(overlap, vcltq_f32(vld1q_f32(&minZ[block]), vdupq_n_f32(aabb.end.z)));
+        overlap = vandq_u32(overlap, vcgtq_f32(vld1q_f32(&maxZ[block]), vdupq_n_f32(aabb.start.z)));
+        return getMaskNEON(overlap);
+    }
+
+    inline int testRayBlock(const Vector3 &origin, const Vector3 &invDirection, int block)
+    {
+        float32x4_t tMin = vdupq_n_f32(0.0f);
+        float32x4_t tMax = vdupq_n_f32(1.0f);
+        slabNEON(&minX[block], &maxX[block], origin.x, invDirection.x, tMin, tMax);
+        slabNEON(&minY[block], &maxY[block], origin.y, invDirection.y, tMin, tMax);
+        slabNEON(&minZ[block], &maxZ[block], origin.z, invDirection.z, tMin, tMax);
+        return getMaskNEON(vcleq_f32(tMin, tMax));
+    }
+
+    static inline void slabNEON(const float *min, const float *max, float origin, float invDirection, float32x4_t &tMin, float32x4_t &tMax)
+    {
+        float32x4_t o = vdupq_n_f32(origin);
+        float32x4_t inv = vdupq_n_f32(invDirection);
+        float32x4_t t1 = vmulq_f32(vsubq_f32(vld1q_f32(min), o), inv);
+        float32x4_t t2 = vmulq_f32(vsubq_f32(vld1q_f32(max), o), inv);
+        tMin = vmaxq_f32(tMin, vminq_f32(t1, t2));
+        tMax = vminq_f32(tMax, vmaxq_f32(t1, t2));
+    }
+#else
+    inline int testAABBBlock(const AABB &aabb, int block)
+    {
+        int mask = 0;
+        for (int lane = 0; lane < AABB_BATCH_WIDTH; lane++)
+        {
+            int i = block + lane;
+            if (minX[i] < aabb.end.x && maxX[i] > aabb.start.x &&
+                minY[i] < aabb.end.y && maxY[i] > aabb.start.y &&
+                minZ[i] < aabb.end.z && maxZ[i] > aabb.start.z)
+                mask |= 1 << lane;
+        }
+        return mask;
+    }
+
+    inline int testRayBlock(const Vector3 &origin, const Vector3 &invDirection, int block)
+    {
+        int mask = 0;
+        for (int lane = 0; lane < AABB_BATCH_WIDTH; lane++)
+        {
+            int i = block + lane;
+            float tMin = 0.0f;
+            float tMax = 1.0f;
+            slabScalar(minX[i], maxX[i], origin.x, invDirection.x, tMin, tMax);
+            slabScalar(minY[i], maxY[i], origin.y, invDirection.y, tMin, tMax);
+            slabScalar(minZ[i], maxZ[i], origin.z, invDirection.z, tMin, tMax);
+            if (tMin <= tMax)
+                mask |= 1 << lane;
+        }
+        return mask;
+    }
+
+    static inline void slabScalar(float min, float max, float origin, float invDirection, float &tMin, float &tMax)
+    {
+        float t1 = (min - origin) * invDirection;
+        float t2 = (max - origin) * invDirection;
+        tMin = fmaxf(tMin, fminf(t1, t2));
+        tMax = fminf(tMax, fmaxf(t1, t2));
+    }
+#endif
+
+    int amount = 0;
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+};
@@ -0,0 +1,336 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "math/AABBTree.h"
+
+enum class VolumeTest
+{
+    Outside,
+    Intersects,
+    Inside
+};
+
+static inline VolumeTest testFrustum(const AABB &aabb, const Vector4 *planes, int planesAmount)
+{
+    Vector3 center = (aabb.start + aabb.end) * 0.5f;
+    Vector3 extents = (aabb.end - aabb.start) * 0.5f;
+    VolumeTest result = VolumeTest::Inside;
+    for (int i = 0; i < planesAmount; i++)
+    {
+        Vector3 normal = Vector3(planes[i]);
+        float distance = glm::dot(normal, center) + planes[i].w;
+        float radius = glm::dot(glm::abs(normal), extents);
+        if (distance < -radius)
+            return VolumeTest::Outside;
+        if (distance < radius)
+            result = VolumeTest::Intersects;
+    }
+    return result;
+}
+
+static inline VolumeTest testSphere(const AABB &aabb, const Sphere *sphere)
+{
+    float radius2 = sphere->radius * sphere->radius;
+    Vector3 closest = glm::clamp(sphere->center, aabb.start, aabb.end);
+    if (glm::length2(closest - sphere->center) > radius2)
+        return VolumeTest::Outside;
+    Vector3 farthest = glm::max(glm::abs(aabb.start - sphere->center), glm::abs(aabb.end - sphere->center));
+    if (glm::length2(farthest) <= radius2)
+        return VolumeTest::Inside;
+    return VolumeTest::Intersects;
+}
+
+AABBTree::AABBTree(float margin)
+{
+    this->margin = margin;
+}
+
+int AABBTree::createProxy(const AABB &aabb, void *userData)
+{
+    int proxy = allocateNode();
+    Vector3 fat = Vector3(margin);
+    nodes[proxy].aabb = AABB(aabb.start - fat, aabb.end + fat);
+    nodes[proxy].userData = userData;
+    nodes[proxy].height = 0;
+    insertLeaf(proxy);
+    proxiesAmount++;
+    return proxy;
+}
+
+void AABBTree::destroyProxy(int proxy)
+{
+    removeLeaf(proxy);
+    freeNode(proxy);
+    proxiesAmount--;
+}
+
+bool AABBTree::moveProxy(int proxy, const AABB &aabb)
+{
+    if (contains(nodes[proxy].aabb, aabb))
+        return false;
+
+    removeLeaf(proxy);
+    Vector3 fat = Vector3(margin);
+    nodes[proxy].aabb = AABB(aabb.start - fat, aabb.end + fat);
+    insertLeaf(proxy);
+    return true;
+}
+
+void AABBTree::clear()
+{
+    nodes.clear();
+    root = AABB_TREE_NULL;
+    freeList = AABB_TREE_NULL;
+    proxiesAmount = 0;
+}
+
+void AABBTree::queryFrustum(const Vector4 *planes, int planesAmount, std::vector<void *> *out, const Sphere *extraVolume)
+{
+    if (root == AABB_TREE_NULL)
+        return;
+
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        AABBTreeNode &node = nodes[index];
+
+        VolumeTest frustum = testFrustum(node.aabb, planes, planesAmount);
+        VolumeTest sphere = extraVolume ? testSphere(node.aabb, extraVolume) : VolumeTest::Outside;
+        if (frustum == VolumeTest::Inside || sphere == VolumeTest::Inside)
+        {
+            collectLeaves(index, out);
+            continue;
+        }
+        if (frustum == VolumeTest::Outside && sphere == VolumeTest::Outside)
+            continue;
+
+        if (node.isLeaf())
+            out->push_back(node.userData);
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+int AABBTree::allocateNode()
+{
+    int node;
+    if (freeList != AABB_TREE_NULL)
+    {
+        node = freeList;
+        freeList = nodes[node].parent;
+    }
+    else
+    {
+        node = nodes.size();
+        nodes.push_back(AABBTreeNode());
+    }
+
+    nodes[node].parent = AABB_TREE_NULL;
+    nodes[node].child1 = AABB_TREE_NULL;
+    nodes[node].child2 = AABB_TREE_NULL;
+    nodes[node].userData = nullptr;
+    nodes[node].height = 0;
+    return node;
+}
+
+void AABBTree::freeNode(int node)
+{
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+void AABBTree::insertLeaf(int leaf)
+{
+    if (root == AABB_TREE_NULL)
+    {
+        root = leaf;
+        nodes[root].parent = AABB_TREE_NULL;
+        return;
+    }
+
+    // Descend to the sibling which grows the total area least
+    AABB leafAABB = nodes[leaf].aabb;
+    int index = root;
+    while (!nodes[index].isLeaf())
+    {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = getArea(nodes[index].aabb);
+        float combinedArea = getArea(getUnion(nodes[index].aabb, leafAABB));
+
+        // Cost of making new parent for this node and the leaf, and minimum cost of pushing the leaf further down
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float cost1 = getArea(getUnion(leafAABB, nodes[child1].aabb)) + inheritanceCost;
+        if (!nodes[child1].isLeaf())
+            cost1 -= getArea(nodes[child1].aabb);
+        float cost2 = getArea(getUnion(leafAABB, nodes[child2].aabb)) + inheritanceCost;
+        if (!nodes[child2].isLeaf())
+            cost2 -= getArea(nodes[child2].aabb);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].aabb = getUnion(leafAABB, nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != AABB_TREE_NULL)
+    {
+        if (nodes[oldParent].child1 == sibling)
+            nodes[oldParent].child1 = newParent;
+        else
+            nodes[oldParent].child2 = newParent;
+    }
+    else
+        root = newParent;
+
+    // Walk back up fixing heights and boxes
+    index = nodes[leaf].parent;
+    while (index != AABB_TREE_NULL)
+    {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].aabb = getUnion(nodes[child1].aabb, nodes[child2].aabb);
+
+        index = nodes[index].parent;
+    }
+}
+
+void AABBTree::removeLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = AABB_TREE_NULL;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != AABB_TREE_NULL)
+    {
+        // Sibling takes place of the parent
+        if (nodes[grandParent].child1 == parent)
+            nodes[grandParent].child1 = sibling;
+        else
+            nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != AABB_TREE_NULL)
+        {
+            index = balance(index);
+
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+            nodes[index].aabb = getUnion(nodes[child1].aabb, nodes[child2].aabb);
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+            index = nodes[index].parent;
+        }
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = AABB_TREE_NULL;
+        freeNode(parent);
+    }
+}
+
+// Rotates the higher grandchild up if children heights differ by more than one, returns index of the new subtree root
+int AABBTree::balance(int iA)
+{
+    AABBTreeNode *A = &nodes[iA];
+    if (A->isLeaf() || A->height < 2)
+        return iA;
+
+    int iB = A->child1;
+    int iC = A->child2;
+    AABBTreeNode *B = &nodes[iB];
+    AABBTreeNode *C = &nodes[iC];
+
+    int difference = C->height - B->height;
+    if (difference > 1 || difference < -1)
+    {
+        // Higher child goes up, A becomes its child
+        bool bRotateC = difference > 1;
+        int iUp = bRotateC ? iC : iB;
+        int iOther = bRotateC ? iB : iC;
+        AABBTreeNode *Up = &nodes[iUp];
+        AABBTreeNode *Other = &nodes[iOther];
+
+        int iF = Up->child1;
+        int iG = Up->child2;
+        AABBTreeNode *F = &nodes[iF];
+        AABBTreeNode *G = &nodes[iG];
+
+        Up->child1 = iA;
+        Up->parent = A->parent;
+        A->parent = iUp;
+
+        if (Up->parent != AABB_TREE_NULL)
+        {
+            if (nodes[Up->parent].child1 == iA)
+                nodes[Up->parent].child1 = iUp;
+            else
+                nodes[Up->parent].child2 = iUp;
+        }
+        else
+            root = iUp;
+
+        // Higher grandchild stays with the rotated node, lower one replaces it under A
+        int iKeep = F->height > G->height ? iF : iG;
+        int iMove = F->height > G->height ? iG : iF;
+        Up->child2 = iKeep;
+        if (bRotateC)
+            A->child2 = iMove;
+        else
+            A->child1 = iMove;
+        nodes[iMove].parent = iA;
+
+        A->aabb = getUnion(Other->aabb, nodes[iMove].aabb);
+        A->height = 1 + std::max(Other->height, nodes[iMove].height);
+        Up->aabb = getUnion(A->aabb, nodes[iKeep].aabb);
+        Up->height = 1 + std::max(A->height, nodes[iKeep].height);
+
+        return iUp;
+    }
+
+    return iA;
+}
+
+void AABBTree::collectLeaves(int node, std::vector<void *> *out)
+{
+    if (nodes[node].isLeaf())
+    {
+        out->push_back(nodes[node].userData);
+        return;
+    }
+    collectLeaves(nodes[node].child1, out);
+    collectLeaves(nodes[node].child2, out);
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "math/AABB.h"
+#include "math/sphere.h"
+#include <vector>
+
+#define AABB_TREE_NULL -1
+
+struct AABBTreeNode
+{
+    // Leaves keep the fattened box of the proxy, inner nodes keep union of children
+    AABB aabb;
+    void *userData;
+    // Next free node for nodes in the free list
+    int parent;
+    int child1;
+    int child2;
+    // Leaf is 0, free node is -1
+    int height;
+
+    inline bool isLeaf() { return child1 == AABB_TREE_NULL; }
+};
+
+// Dynamic bounding volume hierarchy, leaves are inserted by cheapest union area and kept balanced by rotations
+// Boxes are fattened by margin, so moves within it don't touch the tree at all
+class AABBTree
+{
+public:
+    EXPORT AABBTree(float margin = 1.0f);
+
+    EXPORT int createProxy(const AABB &aabb, void *userData);
+    EXPORT void destroyProxy(int proxy);
+    // Returns true if proxy left its fattened box and was reinserted
+    EXPORT bool moveProxy(int proxy, const AABB &aabb);
+    EXPORT void clear();
+
+    // Pushes user data of every leaf touching volume made of planes, whole subtrees inside or outside are taken without tests of their leaves
+    // Planes point inwards, extraVolume is united with the frustum if set
+    EXPORT void queryFrustum(const Vector4 *planes, int planesAmount, std::vector<void *> *out, const Sphere *extraVolume = nullptr);
+
+    inline void *getUserData(int proxy) { return nodes[proxy].userData; }
+    inline const AABB &getFatAABB(int proxy) { return nodes[proxy].aabb; }
+    inline int getProxiesAmount() { return proxiesAmount; }
+    inline int getHeight() { return root == AABB_TREE_NULL ? 0 : nodes[root].height; }
+
+    inline void setMargin(float margin) { this->margin = margin; }
+    inline float getMargin() { return margin; }
+
+protected:
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int node);
+    void collectLeaves(int node, std::vector<void *> *out);
+
+    static inline float getArea(const AABB &aabb)
+    {
+        Vector3 size = aabb.end - aabb.start;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    static inline AABB getUnion(const AABB &a, const AABB &b)
+    {
+        return AABB(glm::min(a.start, b.start), glm::max(a.end, b.end));
+    }
+
+    static inline bool contains(const AABB &outer, const AABB &inner)
+    {
+        return outer.start.x <= inner.start.x && outer.start.y <= inner.start.y && outer.start.z <= inner.start.z &&
+               outer.end.x >= inner.end.x && outer.end.y >= inner.end.y && outer.end.z >= inner.end.z;
+    }
+
+    std::vector<AABBTreeNode> nodes;
+    std::vector<int> stack;
+    int root = AABB_TREE_NULL;
+    int freeList = AABB_TREE_NULL;
+    int proxiesAmount = 0;
+    float margin = 1.0f;
+};
@@ -5,7 +5,7 @@
 #include "math/sphere.h"
 #include <algorithm>
 
-Sphere makeSmallestSphere(const float *vData, int vertexAmount, int floatsPerVertex)
+inline Sphere makeSmallestSphere(const float *vData, int vertexAmount, int floatsPerVertex)
 {
     Sphere sphere;
     if (vertexAmount <= 0)
@@ -9,48 +9,56 @@ void Transformation::setPosition(Vector3 v)
 {
     this->position = v;
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setPosition(Vector2 v)
 {
     this->position = Vector3(v.x, v.y, 0.0f);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setPosition(float x, float y, float z)
 {
     this->position = Vector3(x, y, z);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setPosition(float x, float y)
 {
     this->position = Vector3(x, y, 0.0f);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::translate(float x, float y, float z)
 {
     this->position += Vector3(x, y, z);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::translate(float x, float y)
 {
     this->position += Vector3(x, y, 0.0f);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::translate(Vector3 v)
 {
     this->position += v;
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::translate(Vector2 v)
 {
     this->position += Vector3(v.x, v.y, 0.0f);
     bIsDirty = true;
+    changes++;
 }
 
 Vector3 Transformation::getPosition()
@@ -62,12 +70,14 @@ void Transformation::setRotation(Vector3 r)
 {
     this->rotation = Quat(r);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setRotation(Quat r)
 {
     this->rotation = r;
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setRotation(float z)
@@ -75,24 +85,28 @@ void Transformation::setRotation(float z)
 
     this->rotation = Quat(Vector3(0.0f, 0.0f, z));
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::rotate(float z)
 {
     this->rotation *= Quat(Vector3(0.0f, 0.0f, z));
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::rotate(Vector3 r)
 {
     this->rotation *= Quat(r);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::rotate(Quat r)
 {
     this->rotation *= r;
     bIsDirty = true;
+    changes++;
 }
 
 Quat Transformation::getRotation()
@@ -114,29 +128,34 @@ void Transformation::setScale(Vector3 v)
 {
     this->scale = v;
     bIsDirty = true;
+    changes++;
 }
 void Transformation::setScale(Vector2 v)
 {
     this->scale = Vector3(v.x, v.y, 1.0f);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setScale(float x, float y, float z)
 {
     this->scale = Vector3(x, y, z);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setScale(float x, float y)
 {
     this->scale = Vector3(x, y, 1.0f);
     bIsDirty = true;
+    changes++;
 }
 
 void Transformation::setScale(float xy)
 {
     this->scale = Vector3(xy, xy, 1.0f);
     bIsDirty = true;
+    changes++;
 }
 
 Vector3 Transformation::getScale()
@@ -39,10 +39,14 @@ public:
     EXPORT bool isDirty();
     EXPORT Matrix4 *getModelMatrix();
 
+    // Grows on every change, lets watchers notice movement without keeping a copy of the transformation
+    inline unsigned int getChanges() { return changes; }
+
 protected:
     Vector3 position = {0.0f, 0.0f, 0.0f};
     Quat rotation = Quat(1.0f, 0.0f, 0.0f, 0.0f);
     Vector3 scale = {1.0f, 1.0f, 1.0f};
     Matrix4 mModel;
     bool bIsDirty = true;
+    unsigned int changes = 0;
 };
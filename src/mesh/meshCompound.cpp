@@ -133,6 +133,10 @@ MeshStatic *MeshCompound::getAsStatic()
     int dataShift = 0;
     for (auto &node : nodes)
     {
+        // Merged mesh is packed if any of its parts was
+        if (node->mesh->getVertexFormat() == MeshVertexFormat::Packed)
+            meshStatic->setVertexFormat(MeshVertexFormat::Packed);
+
         int meshFloatsPerVertex = node->mesh->getFloatsPerVertex();
         int meshVertexAmount = node->mesh->getVertexAmount();
         float *meshVertexData = node->mesh->getVertexData();
@@ -166,7 +170,7 @@ MeshStatic *MeshCompound::getAsStatic()
     }
 
     int attributeSizes[3] = {3, 3, 2};
-    meshStatic->setupFloatsArray(data, amountOfVerticies, 3, attributeSizes, true);
+    meshStatic->setupIndexedFloatsArray(data, amountOfVerticies, 3, attributeSizes, true);
 
     delete[] data;
     return meshStatic;
@@ -0,0 +1,284 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "mesh/meshOptimizer.h"
+#include <algorithm>
+#include <string.h>
+
+// Recently used vertices score higher, the last triangle's ones a bit lower so strips don't go back and forth
+// Vertices with few triangles left score higher as well, so lone triangles don't stay behind
+static inline float getVertexScore(int cachePosition, int trianglesLeft)
+{
+    if (trianglesLeft == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = powf(1.0f - (cachePosition - 3) * (1.0f / (OPTIMIZER_CACHE_SIZE - 3)), 1.5f);
+    }
+    return score + 2.0f * powf((float)trianglesLeft, -0.5f);
+}
+
+void MeshOptimizer::optimizeVertexCache(unsigned int *indexes, int indexAmount, int vertexAmount)
+{
+    int trianglesAmount = indexAmount / 3;
+    if (trianglesAmount < 2)
+        return;
+
+    // Triangles of every vertex, first trianglesLeft of them are not emitted yet
+    std::vector<int> trianglesLeft(vertexAmount, 0);
+    std::vector<int> offsets(vertexAmount + 1, 0);
+    for (int i = 0; i < trianglesAmount * 3; i++)
+        trianglesLeft[indexes[i]]++;
+    for (int v = 0; v < vertexAmount; v++)
+        offsets[v + 1] = offsets[v] + trianglesLeft[v];
+    std::vector<int> adjacency(trianglesAmount * 3);
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < trianglesAmount * 3; i++)
+        adjacency[cursor[indexes[i]]++] = i / 3;
+
+    std::vector<int> cachePosition(vertexAmount, -1);
+    std::vector<float> vertexScore(vertexAmount);
+    for (int v = 0; v < vertexAmount; v++)
+        vertexScore[v] = getVertexScore(-1, trianglesLeft[v]);
+
+    std::vector<float> triangleScore(trianglesAmount);
+    std::vector<bool> emitted(trianglesAmount, false);
+    int best = 0;
+    for (int t = 0; t < trianglesAmount; t++)
+    {
+        const unsigned int *tri = &indexes[t * 3];
+        triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+        if (triangleScore[t] > triangleScore[best])
+            best = t;
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(trianglesAmount * 3);
+    int cache[OPTIMIZER_CACHE_SIZE + 3];
+    int cacheAmount = 0;
+    int scanCursor = 0;
+    while (true)
+    {
+        // Nothing in cache has triangles left, the next one in original order starts again
+        if (best < 0)
+        {
+            while (scanCursor < trianglesAmount && emitted[scanCursor])
+                scanCursor++;
+            if (scanCursor == trianglesAmount)
+                break;
+            best = scanCursor;
+        }
+
+        emitted[best] = true;
+        const unsigned int *tri = &indexes[best * 3];
+        result.insert(result.end(), tri, tri + 3);
+
+        int newCache[OPTIMIZER_CACHE_SIZE + 3];
+        int newAmount = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            int v = tri[k];
+            int *list = &adjacency[offsets[v]];
+            for (int j = 0; j < trianglesLeft[v]; j++)
+            {
+                if (list[j] == best)
+                {
+                    std::swap(list[j], list[trianglesLeft[v] - 1]);
+                    trianglesLeft[v]--;
+                    break;
+                }
+            }
+            if (std::find(newCache, newCache + newAmount, v) == newCache + newAmount)
+                newCache[newAmount++] = v;
+        }
+        for (int i = 0; i < cacheAmount; i++)
+        {
+            if (std::find(newCache, newCache + newAmount, cache[i]) == newCache + newAmount)
+                newCache[newAmount++] = cache[i];
+        }
+
+        // Evicted vertices are updated too, they lose their cache score
+        for (int i = 0; i < newAmount; i++)
+        {
+            int v = newCache[i];
+            cachePosition[v] = i < OPTIMIZER_CACHE_SIZE ? i : -1;
+            vertexScore[v] = getVertexScore(cachePosition[v], trianglesLeft[v]);
+        }
+
+        best = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < newAmount; i++)
+        {
+            int v = newCache[i];
+            for (int j = 0; j < trianglesLeft[v]; j++)
+            {
+                int t = adjacency[offsets[v] + j];
+                const unsigned int *other = &indexes[t * 3];
+                triangleScore[t] = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        cacheAmount = std::min(newAmount, OPTIMIZER_CACHE_SIZE);
+        memcpy(cache, newCache, cacheAmount * sizeof(int));
+    }
+
+    memcpy(indexes, result.data(), result.size() * sizeof(unsigned int));
+}
+
+struct OverdrawCluster
+{
+    int start;
+    int amount;
+    float sortKey;
+};
+
+void MeshOptimizer::optimizeOverdraw(unsigned int *indexes, int indexAmount, const float *vertices, int vertexAmount, int floatsPerVertex, float threshold)
+{
+    int trianglesAmount = indexAmount / 3;
+    if (trianglesAmount < 2)
+        return;
+
+    // Cluster may end where cache order starts over, if it keeps miss ratio close to the whole mesh
+    float limit = getACMR(indexes, indexAmount, vertexAmount) * threshold;
+    std::vector<OverdrawCluster> clusters;
+    std::vector<unsigned int> stamps(vertexAmount, 0);
+    unsigned int timestamp = OPTIMIZER_ACMR_CACHE_SIZE + 1;
+    int clusterStart = 0;
+    int clusterMisses = 0;
+    for (int t = 0; t < trianglesAmount; t++)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = indexes[t * 3 + k];
+            if (timestamp - stamps[v] > OPTIMIZER_ACMR_CACHE_SIZE)
+            {
+                stamps[v] = timestamp++;
+                misses++;
+            }
+        }
+
+        if (misses == 3 && t > clusterStart && (float)clusterMisses / (t - clusterStart) <= limit)
+        {
+            clusters.push_back({clusterStart, t - clusterStart, 0.0f});
+            clusterStart = t;
+            clusterMisses = 0;
+        }
+        clusterMisses += misses;
+    }
+    clusters.push_back({clusterStart, trianglesAmount - clusterStart, 0.0f});
+    if (clusters.size() < 2)
+        return;
+
+    // Centroids and normals are weighted by area, sum of cross products is normal of cluster times double area
+    std::vector<Vector3> centroids(clusters.size());
+    std::vector<Vector3> normals(clusters.size());
+    Vector3 meshCentroid = Vector3(0.0f);
+    float meshArea = 0.0f;
+    for (int c = 0; c < (int)clusters.size(); c++)
+    {
+        Vector3 centroid = Vector3(0.0f);
+        Vector3 normal = Vector3(0.0f);
+        float area = 0.0f;
+        for (int t = clusters[c].start; t < clusters[c].start + clusters[c].amount; t++)
+        {
+            const float *a = &vertices[indexes[t * 3] * floatsPerVertex];
+            const float *b = &vertices[indexes[t * 3 + 1] * floatsPerVertex];
+            const float *d = &vertices[indexes[t * 3 + 2] * floatsPerVertex];
+            Vector3 pa = Vector3(a[0], a[1], a[2]);
+            Vector3 pb = Vector3(b[0], b[1], b[2]);
+            Vector3 pd = Vector3(d[0], d[1], d[2]);
+            Vector3 cross = glm::cross(pb - pa, pd - pa);
+            float triangleArea = glm::length(cross);
+            centroid += (pa + pb + pd) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids[c] = area > 0.0f ? centroid / area : centroid;
+        normals[c] = normal;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    for (int c = 0; c < (int)clusters.size(); c++)
+    {
+        float length = glm::length(normals[c]);
+        clusters[c].sortKey = length > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const OverdrawCluster &a, const OverdrawCluster &b)
+                     { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> result;
+    result.reserve(trianglesAmount * 3);
+    for (auto &cluster : clusters)
+        result.insert(result.end(), &indexes[cluster.start * 3], &indexes[(cluster.start + cluster.amount) * 3]);
+    memcpy(indexes, result.data(), result.size() * sizeof(unsigned int));
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<float> &vertices, int floatsPerVertex, unsigned int *indexes, int indexAmount)
+{
+    int vertexAmount = vertices.size() / floatsPerVertex;
+    std::vector<int> remap(vertexAmount, -1);
+    std::vector<float> result;
+    result.reserve(vertices.size());
+    for (int i = 0; i < indexAmount; i++)
+    {
+        unsigned int v = indexes[i];
+        if (remap[v] < 0)
+        {
+            remap[v] = result.size() / floatsPerVertex;
+            result.insert(result.end(), &vertices[v * floatsPerVertex], &vertices[v * floatsPerVertex] + floatsPerVertex);
+        }
+        indexes[i] = remap[v];
+    }
+    vertices.swap(result);
+}
+
+void MeshOptimizer::optimizeLodChain(MeshLodChain &chain)
+{
+    if (chain.floatsPerVertex <= 0)
+        return;
+
+    int vertexAmount = chain.vertices.size() / chain.floatsPerVertex;
+    for (auto &lod : chain.lods)
+    {
+        unsigned int *indexes = &chain.indexes[lod.indexOffset];
+        optimizeVertexCache(indexes, lod.indexAmount, vertexAmount);
+        optimizeOverdraw(indexes, lod.indexAmount, chain.vertices.data(), vertexAmount, chain.floatsPerVertex);
+    }
+    optimizeVertexFetch(chain.vertices, chain.floatsPerVertex, chain.indexes.data(), chain.indexes.size());
+}
+
+float MeshOptimizer::getACMR(const unsigned int *indexes, int indexAmount, int vertexAmount, int cacheSize)
+{
+    int trianglesAmount = indexAmount / 3;
+    if (trianglesAmount == 0)
+        return 0.0f;
+
+    // Vertex is in cache if less than cache size vertices were added after it
+    std::vector<unsigned int> stamps(vertexAmount, 0);
+    unsigned int timestamp = cacheSize + 1;
+    int misses = 0;
+    for (int i = 0; i < trianglesAmount * 3; i++)
+    {
+        unsigned int v = indexes[i];
+        if (timestamp - stamps[v] > (unsigned int)cacheSize)
+        {
+            stamps[v] = timestamp++;
+            misses++;
+        }
+    }
+    return (float)misses / trianglesAmount;
+}
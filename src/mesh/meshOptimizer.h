@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "math/math.h"
+#include "mesh/meshStatic.h"
+#include <vector>
+
+// Size of cache of transformed vertices the order is made for, usual hardware keeps 16 to 32
+#define OPTIMIZER_CACHE_SIZE 32
+// Size of FIFO cache used to measure average cache miss ratio
+#define OPTIMIZER_ACMR_CACHE_SIZE 16
+// Clusters for overdraw ordering may have this much worse miss ratio than the whole mesh
+#define OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+// Reorders indexes and vertices so GPU transforms fewer vertices and shades fewer hidden pixels
+// Triangles stay the same, only their order and order of vertices change
+class MeshOptimizer
+{
+public:
+    // Forsyth's linear-speed vertex cache optimisation, triangles using recently used vertices go first
+    EXPORT static void optimizeVertexCache(unsigned int *indexes, int indexAmount, int vertexAmount);
+
+    // Splits cache ordered triangles into clusters and puts clusters facing outwards first, they hide the inner ones
+    // Position is the first 3 floats of vertex
+    EXPORT static void optimizeOverdraw(unsigned int *indexes, int indexAmount, const float *vertices, int vertexAmount, int floatsPerVertex, float threshold = OPTIMIZER_OVERDRAW_THRESHOLD);
+
+    // Vertices go in order of the first use, so memory is read forward
+    EXPORT static void optimizeVertexFetch(std::vector<float> &vertices, int floatsPerVertex, unsigned int *indexes, int indexAmount);
+
+    // Every level of chain is optimised on its own, vertices follow the full level
+    EXPORT static void optimizeLodChain(MeshLodChain &chain);
+
+    // Average cache miss ratio, transformed vertices per triangle with FIFO cache, 0.5 is the best and 3 is the worst
+    EXPORT static float getACMR(const unsigned int *indexes, int indexAmount, int vertexAmount, int cacheSize = OPTIMIZER_ACMR_CACHE_SIZE);
+};
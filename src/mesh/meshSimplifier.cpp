@@ -0,0 +1,395 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "mesh/meshSimplifier.h"
+#include <algorithm>
+#include <numeric>
+#include <string.h>
+#include <float.h>
+
+static inline void addQuadric(SimplifierQuadric &q, const SimplifierQuadric &other)
+{
+    q.a2 += other.a2, q.ab += other.ab, q.ac += other.ac, q.ad += other.ad;
+    q.b2 += other.b2, q.bc += other.bc, q.bd += other.bd;
+    q.c2 += other.c2, q.cd += other.cd;
+    q.d2 += other.d2;
+}
+
+static inline double evaluateQuadric(const SimplifierQuadric &q, const Vector3 &p)
+{
+    double x = p.x, y = p.y, z = p.z;
+    return q.a2 * x * x + 2.0 * q.ab * x * y + 2.0 * q.ac * x * z + 2.0 * q.ad * x +
+           q.b2 * y * y + 2.0 * q.bc * y * z + 2.0 * q.bd * y +
+           q.c2 * z * z + 2.0 * q.cd * z +
+           q.d2;
+}
+
+static inline Vector3 getTriangleCross(const Vector3 &a, const Vector3 &b, const Vector3 &c)
+{
+    return glm::cross(b - a, c - a);
+}
+
+MeshSimplifier::MeshSimplifier(const float *vertices, int vertexAmount, int floatsPerVertex, const unsigned int *indexes, int indexAmount, int normalOffset)
+{
+    // Copies of a vertex which differ only by normal are one vertex of the surface
+    int skipFrom = normalOffset >= 0 ? normalOffset : floatsPerVertex;
+    int skipTo = normalOffset >= 0 ? normalOffset + 3 : floatsPerVertex;
+    auto compareSurface = [vertices, floatsPerVertex, skipFrom, skipTo](int a, int b)
+    {
+        for (int f = 0; f < floatsPerVertex; f++)
+        {
+            if (f >= skipFrom && f < skipTo)
+                continue;
+            float va = vertices[a * floatsPerVertex + f];
+            float vb = vertices[b * floatsPerVertex + f];
+            if (va != vb)
+                return va < vb ? -1 : 1;
+        }
+        return 0;
+    };
+
+    std::vector<int> copyOrder(vertexAmount);
+    std::iota(copyOrder.begin(), copyOrder.end(), 0);
+    std::sort(copyOrder.begin(), copyOrder.end(), [&compareSurface](int a, int b)
+              { return compareSurface(a, b) < 0; });
+    surfaceVertices.resize(vertexAmount);
+    for (int i = 0; i < vertexAmount; i++)
+    {
+        int vertex = copyOrder[i];
+        if (i == 0 || compareSurface(vertex, copyOrder[i - 1]) != 0)
+        {
+            positions.push_back(Vector3(vertices[vertex * floatsPerVertex], vertices[vertex * floatsPerVertex + 1], vertices[vertex * floatsPerVertex + 2]));
+            surfaceCopies.emplace_back();
+        }
+        surfaceVertices[vertex] = positions.size() - 1;
+        surfaceCopies.back().push_back(vertex);
+    }
+
+    if (normalOffset >= 0)
+    {
+        normals.resize(vertexAmount);
+        for (int i = 0; i < vertexAmount; i++)
+            normals[i] = Vector3(vertices[i * floatsPerVertex + normalOffset], vertices[i * floatsPerVertex + normalOffset + 1], vertices[i * floatsPerVertex + normalOffset + 2]);
+    }
+
+    int surfaceAmount = positions.size();
+    corners.assign(indexes, indexes + indexAmount - indexAmount % 3);
+    triangles.resize(corners.size());
+    for (int i = 0; i < (int)corners.size(); i++)
+        triangles[i] = surfaceVertices[corners[i]];
+    trianglesAmount = triangles.size() / 3;
+    removed.assign(trianglesAmount, false);
+    vertexTriangles.resize(surfaceAmount);
+    for (int t = 0; t < trianglesAmount; t++)
+        for (int k = 0; k < 3; k++)
+            vertexTriangles[triangles[t * 3 + k]].push_back(t);
+
+    quadrics.assign(surfaceAmount, SimplifierQuadric{0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    stamps.assign(surfaceAmount, 0);
+    locked.assign(surfaceAmount, false);
+
+    // Surface vertices with the same position and different attributes are seams
+    std::vector<int> order(surfaceAmount);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b)
+              {
+                  const Vector3 &pa = positions[a];
+                  const Vector3 &pb = positions[b];
+                  return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z); });
+    for (int i = 1; i < surfaceAmount; i++)
+        if (positions[order[i]] == positions[order[i - 1]])
+            locked[order[i]] = locked[order[i - 1]] = true;
+
+    for (int t = 0; t < trianglesAmount; t++)
+    {
+        const unsigned int *tri = &triangles[t * 3];
+        Vector3 normal = getTriangleCross(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+        float length = glm::length(normal);
+        if (length < 1.0e-12f)
+            continue;
+        normal /= length;
+        for (int k = 0; k < 3; k++)
+            addPlane(tri[k], normal, positions[tri[0]], 1.0);
+    }
+
+    // Every edge once, edges of one triangle only are open
+    std::vector<std::pair<uint64_t, int>> edges;
+    edges.reserve(triangles.size());
+    for (int t = 0; t < trianglesAmount; t++)
+        for (int k = 0; k < 3; k++)
+        {
+            uint64_t a = triangles[t * 3 + k];
+            uint64_t b = triangles[t * 3 + (k + 1) % 3];
+            edges.push_back({a < b ? (a << 32) | b : (b << 32) | a, t});
+        }
+    std::sort(edges.begin(), edges.end());
+
+    for (int i = 0; i < (int)edges.size();)
+    {
+        int end = i + 1;
+        while (end < (int)edges.size() && edges[end].first == edges[i].first)
+            end++;
+
+        int a = (int)(edges[i].first >> 32);
+        int b = (int)(edges[i].first & 0xFFFFFFFF);
+        if (end - i == 1)
+        {
+            const unsigned int *tri = &triangles[edges[i].second * 3];
+            Vector3 normal = getTriangleCross(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+            Vector3 border = glm::cross(positions[b] - positions[a], normal);
+            float length = glm::length(border);
+            if (length > 1.0e-12f)
+            {
+                border /= length;
+                addPlane(a, border, positions[a], SIMPLIFIER_BORDER_WEIGHT);
+                addPlane(b, border, positions[a], SIMPLIFIER_BORDER_WEIGHT);
+            }
+        }
+        pushCollapses(a, b);
+        i = end;
+    }
+}
+
+float MeshSimplifier::simplify(int targetTriangles)
+{
+    while (trianglesAmount > targetTriangles && !heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end());
+        SimplifierCollapse candidate = heap.back();
+        heap.pop_back();
+
+        // Any collapse around the vertices makes the entry outdated, a fresh one is already pushed
+        if (candidate.fromStamp != stamps[candidate.from] || candidate.toStamp != stamps[candidate.to])
+            continue;
+        if (!isCollapseValid(candidate.from, candidate.to))
+            continue;
+
+        maxError = fmaxf(maxError, sqrtf(candidate.cost));
+        collapse(candidate.from, candidate.to);
+    }
+    return maxError;
+}
+
+void MeshSimplifier::getIndexes(std::vector<unsigned int> &out)
+{
+    out.clear();
+    out.reserve(trianglesAmount * 3);
+    for (int t = 0; t < (int)removed.size(); t++)
+        if (!removed[t])
+            out.insert(out.end(), &corners[t * 3], &corners[t * 3] + 3);
+}
+
+void MeshSimplifier::weld(const float *data, int vertexAmount, int floatsPerVertex, std::vector<float> &vertices, std::vector<unsigned int> &indexes)
+{
+    size_t vertexSize = floatsPerVertex * sizeof(float);
+    std::vector<int> order(vertexAmount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [data, floatsPerVertex, vertexSize](int a, int b)
+                     { return memcmp(&data[a * floatsPerVertex], &data[b * floatsPerVertex], vertexSize) < 0; });
+
+    // Every vertex points to its first copy, new vertices go in order of the first use
+    std::vector<int> first(vertexAmount);
+    for (int i = 0; i < vertexAmount; i++)
+    {
+        bool bSame = i > 0 && memcmp(&data[order[i] * floatsPerVertex], &data[order[i - 1] * floatsPerVertex], vertexSize) == 0;
+        first[order[i]] = bSame ? first[order[i - 1]] : order[i];
+    }
+
+    std::vector<int> remap(vertexAmount, -1);
+    vertices.clear();
+    indexes.resize(vertexAmount);
+    for (int i = 0; i < vertexAmount; i++)
+    {
+        int source = first[i];
+        if (remap[source] < 0)
+        {
+            remap[source] = vertices.size() / floatsPerVertex;
+            vertices.insert(vertices.end(), &data[source * floatsPerVertex], &data[source * floatsPerVertex] + floatsPerVertex);
+        }
+        indexes[i] = remap[source];
+    }
+}
+
+void MeshSimplifier::buildLodChain(const float *data, int vertexAmount, int floatsPerVertex, int levels, float reduction, MeshLodChain &chain, int normalOffset)
+{
+    chain.floatsPerVertex = floatsPerVertex;
+    weld(data, vertexAmount, floatsPerVertex, chain.vertices, chain.indexes);
+    chain.lods.clear();
+    chain.lods.push_back({0, (int)chain.indexes.size(), 0.0f});
+    if (levels <= 1)
+        return;
+
+    int weldedAmount = chain.vertices.size() / floatsPerVertex;
+    MeshSimplifier simplifier(chain.vertices.data(), weldedAmount, floatsPerVertex, chain.indexes.data(), chain.indexes.size(), normalOffset);
+    std::vector<unsigned int> levelIndexes;
+    int target = simplifier.getTrianglesAmount();
+    for (int level = 1; level < std::min(levels, MESH_MAX_LODS); level++)
+    {
+        target = (int)(target * reduction);
+        if (target < 4)
+            break;
+
+        float error = simplifier.simplify(target);
+        simplifier.getIndexes(levelIndexes);
+        if (levelIndexes.size() >= chain.lods.back().indexAmount * 0.9f)
+            break;
+
+        chain.lods.push_back({(int)chain.indexes.size(), (int)levelIndexes.size(), error});
+        chain.indexes.insert(chain.indexes.end(), levelIndexes.begin(), levelIndexes.end());
+        target = levelIndexes.size() / 3;
+    }
+}
+
+void MeshSimplifier::addPlane(int vertex, const Vector3 &normal, const Vector3 &point, double weight)
+{
+    double a = normal.x, b = normal.y, c = normal.z;
+    double d = -glm::dot(normal, point);
+    SimplifierQuadric plane = {a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+                               b * b * weight, b * c * weight, b * d * weight,
+                               c * c * weight, c * d * weight,
+                               d * d * weight};
+    addQuadric(quadrics[vertex], plane);
+}
+
+void MeshSimplifier::pushCollapses(int a, int b)
+{
+    if (!locked[a])
+    {
+        heap.push_back({getCost(a, b), a, b, stamps[a], stamps[b]});
+        std::push_heap(heap.begin(), heap.end());
+    }
+    if (!locked[b])
+    {
+        heap.push_back({getCost(b, a), b, a, stamps[b], stamps[a]});
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+float MeshSimplifier::getCost(int from, int to)
+{
+    SimplifierQuadric q = quadrics[from];
+    addQuadric(q, quadrics[to]);
+    return (float)std::max(0.0, evaluateQuadric(q, positions[to]));
+}
+
+// Triangles must not flip and the edge must not glue two surfaces together
+bool MeshSimplifier::isCollapseValid(int from, int to)
+{
+    int sharedTriangles = 0;
+    std::vector<int> fromNeighbours;
+    for (auto t : vertexTriangles[from])
+    {
+        if (removed[t])
+            continue;
+
+        const unsigned int *tri = &triangles[t * 3];
+        if (tri[0] == (unsigned int)to || tri[1] == (unsigned int)to || tri[2] == (unsigned int)to)
+        {
+            sharedTriangles++;
+            continue;
+        }
+
+        Vector3 before = getTriangleCross(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+        Vector3 moved[3];
+        for (int k = 0; k < 3; k++)
+        {
+            moved[k] = positions[tri[k] == (unsigned int)from ? to : tri[k]];
+            if (tri[k] != (unsigned int)from)
+                fromNeighbours.push_back(tri[k]);
+        }
+        Vector3 after = getTriangleCross(moved[0], moved[1], moved[2]);
+
+        float lengthBefore = glm::length(before);
+        float lengthAfter = glm::length(after);
+        if (lengthAfter < 1.0e-12f)
+            return false;
+        if (lengthBefore > 1.0e-12f && glm::dot(before, after) < SIMPLIFIER_MIN_NORMAL_DOT * lengthBefore * lengthAfter)
+            return false;
+    }
+    if (sharedTriangles == 0)
+        return false;
+
+    // Vertices around both ends may only be the ones of the shared triangles
+    std::sort(fromNeighbours.begin(), fromNeighbours.end());
+    fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+    std::vector<int> common;
+    for (auto t : vertexTriangles[to])
+    {
+        if (removed[t])
+            continue;
+        for (int k = 0; k < 3; k++)
+        {
+            int v = triangles[t * 3 + k];
+            if (v != to && v != from && std::binary_search(fromNeighbours.begin(), fromNeighbours.end(), v))
+                common.push_back(v);
+        }
+    }
+    std::sort(common.begin(), common.end());
+    common.erase(std::unique(common.begin(), common.end()), common.end());
+    return (int)common.size() <= sharedTriangles;
+}
+
+void MeshSimplifier::collapse(int from, int to)
+{
+    for (auto t : vertexTriangles[from])
+    {
+        if (removed[t])
+            continue;
+
+        unsigned int *tri = &triangles[t * 3];
+        if (tri[0] == (unsigned int)to || tri[1] == (unsigned int)to || tri[2] == (unsigned int)to)
+        {
+            removed[t] = true;
+            trianglesAmount--;
+            continue;
+        }
+        for (int k = 0; k < 3; k++)
+            if (tri[k] == (unsigned int)from)
+            {
+                tri[k] = to;
+                corners[t * 3 + k] = getClosestCopy(to, corners[t * 3 + k]);
+            }
+        vertexTriangles[to].push_back(t);
+    }
+    vertexTriangles[from].clear();
+
+    std::vector<int> &around = vertexTriangles[to];
+    around.erase(std::remove_if(around.begin(), around.end(), [this](int t)
+                                { return (bool)removed[t]; }),
+                 around.end());
+
+    addQuadric(quadrics[to], quadrics[from]);
+    stamps[from]++;
+    stamps[to]++;
+
+    std::vector<int> neighbours;
+    for (auto t : around)
+        for (int k = 0; k < 3; k++)
+            if (triangles[t * 3 + k] != (unsigned int)to)
+                neighbours.push_back(triangles[t * 3 + k]);
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    for (auto neighbour : neighbours)
+        pushCollapses(to, neighbour);
+}
+
+// Corner keeps the side of a hard edge it was on
+int MeshSimplifier::getClosestCopy(int surfaceVertex, int vertex)
+{
+    std::vector<int> &copies = surfaceCopies[surfaceVertex];
+    if (copies.size() == 1 || normals.empty())
+        return copies[0];
+
+    int closest = copies[0];
+    float closestDot = -FLT_MAX;
+    for (auto copy : copies)
+    {
+        float dot = glm::dot(normals[copy], normals[vertex]);
+        if (dot > closestDot)
+        {
+            closestDot = dot;
+            closest = copy;
+        }
+    }
+    return closest;
+}
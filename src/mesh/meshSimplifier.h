@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "math/math.h"
+#include "mesh/meshStatic.h"
+#include <vector>
+
+// Penalty of moving away from open edges, they are silhouettes and seams of texture coordinates
+#define SIMPLIFIER_BORDER_WEIGHT 10.0
+// Collapse is rejected if a triangle turns further than this cosine
+#define SIMPLIFIER_MIN_NORMAL_DOT 0.2f
+
+// Symmetric 4x4 matrix of summed squared distances to planes
+struct SimplifierQuadric
+{
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+};
+
+struct SimplifierCollapse
+{
+    float cost;
+    int from;
+    int to;
+    unsigned int fromStamp;
+    unsigned int toStamp;
+
+    inline bool operator<(const SimplifierCollapse &other) const { return cost > other.cost; }
+};
+
+// Quadric error edge collapse, vertex goes into one of its neighbours, so vertices are never moved or added
+// Copies of a vertex which differ only by normal move together, so hard edges don't stop simplification
+// Other vertices sharing position are seams of attributes and stay in place
+class MeshSimplifier
+{
+public:
+    // Position is the first 3 floats of vertex, normal is 3 floats at normalOffset or is treated as any other attribute if it's negative
+    EXPORT MeshSimplifier(const float *vertices, int vertexAmount, int floatsPerVertex, const unsigned int *indexes, int indexAmount, int normalOffset = -1);
+
+    // Collapses the cheapest edges until amount of triangles is reached or nothing can be collapsed
+    // Returns the largest error so far as distance in space of the mesh
+    EXPORT float simplify(int targetTriangles);
+    EXPORT void getIndexes(std::vector<unsigned int> &out);
+    EXPORT inline int getTrianglesAmount() { return trianglesAmount; }
+
+    // Merges equal vertices of plain list of triangles
+    EXPORT static void weld(const float *data, int vertexAmount, int floatsPerVertex, std::vector<float> &vertices, std::vector<unsigned int> &indexes);
+    // Every next level keeps reduction part of triangles of the previous one, levels which fail to get simpler are dropped
+    EXPORT static void buildLodChain(const float *data, int vertexAmount, int floatsPerVertex, int levels, float reduction, MeshLodChain &chain, int normalOffset = -1);
+
+protected:
+    void addPlane(int vertex, const Vector3 &normal, const Vector3 &point, double weight);
+    void pushCollapses(int a, int b);
+    float getCost(int from, int to);
+    bool isCollapseValid(int from, int to);
+    void collapse(int from, int to);
+    int getClosestCopy(int surfaceVertex, int vertex);
+
+    // Simplification runs on surface vertices, corners keep the original vertex of every triangle corner
+    std::vector<int> surfaceVertices;
+    std::vector<std::vector<int>> surfaceCopies;
+    std::vector<Vector3> normals;
+    std::vector<unsigned int> corners;
+
+    std::vector<Vector3> positions;
+    std::vector<unsigned int> triangles;
+    std::vector<bool> removed;
+    std::vector<std::vector<int>> vertexTriangles;
+    std::vector<SimplifierQuadric> quadrics;
+    std::vector<unsigned int> stamps;
+    std::vector<bool> locked;
+    std::vector<SimplifierCollapse> heap;
+
+    int trianglesAmount = 0;
+    float maxError = 0.0f;
+};
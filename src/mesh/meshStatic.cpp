@@ -2,8 +2,13 @@
 // SPDX-License-Identifier: MIT
 
 #include "mesh/meshStatic.h"
+#include "mesh/meshSimplifier.h"
+#include "mesh/meshOptimizer.h"
 #include "math/math.h"
 #include <string.h>
+#include <algorithm>
+
+std::atomic<unsigned int> MeshStatic::nextSortId = 1;
 
 MeshStatic::MeshStatic()
 {
@@ -47,6 +52,25 @@ void MeshStatic::setupFloatsArray(const float *data, int vertexAmount, int attri
 {
 }
 
+void MeshStatic::setupLodChain(const MeshLodChain &chain, int attributesAmount, int *attributeSize, bool buildTangents)
+{
+}
+
+void MeshStatic::setupIndexedFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents, int lodLevels, float lodReduction)
+{
+    int floatsPerVertex = 0;
+    for (int i = 0; i < attributesAmount; i++)
+        floatsPerVertex += attributeSize[i];
+
+    // Normal goes right after position
+    int normalOffset = (attributesAmount > 1 && attributeSize[1] == 3) ? attributeSize[0] : -1;
+
+    MeshLodChain chain;
+    MeshSimplifier::buildLodChain(data, vertexAmount, floatsPerVertex, lodLevels, lodReduction, chain, normalOffset);
+    MeshOptimizer::optimizeLodChain(chain);
+    setupLodChain(chain, attributesAmount, attributeSize, buildTangents);
+}
+
 EXPORT void MeshStatic::setOtherMeshAsInstanceOfThis(MeshStatic *mesh)
 {
 }
@@ -59,6 +83,29 @@ void MeshStatic::useVertexArray()
 {
 }
 
+void MeshStatic::renderLod(int lod)
+{
+    render();
+}
+
+// Finer levels are taken right when error gets too big, coarser ones only with margin
+int MeshStatic::selectLod(float errorScale, float threshold, int previous)
+{
+    int amount = lods.size();
+    if (amount < 2)
+        return 0;
+
+    int lod = std::max(0, std::min(previous, amount - 1));
+    while (lod > 0 && lods[lod].error * errorScale > threshold)
+        lod--;
+
+    float coarserThreshold = previous >= 0 ? threshold * MESH_LOD_HYSTERESIS : threshold;
+    while (lod + 1 < amount && lods[lod + 1].error * errorScale <= coarserThreshold)
+        lod++;
+
+    return lod;
+}
+
 MeshStatic *MeshStatic::getAsStatic()
 {
     return this;
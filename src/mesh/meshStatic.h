@@ -5,6 +5,38 @@
 
 #include "mesh/mesh.h"
 #include "math/sphere.h"
+#include <atomic>
+#include <vector>
+
+// Levels of detail including the full mesh
+#define MESH_MAX_LODS 4
+// Coarser level is taken only if its error fits in this part of the limit, so level doesn't flip on the border
+#define MESH_LOD_HYSTERESIS 0.75f
+
+// Packed vertices take 16 bytes or 20 with tangents instead of 32 or 56, see VertexQuantizer
+// Shaders of packed meshes decode them, built-in ones do it by attributes the mesh sets before drawing
+enum class MeshVertexFormat
+{
+    Float,
+    Packed
+};
+
+// Range of the shared index buffer, error is the largest deviation from the full mesh in space of the mesh
+struct MeshLod
+{
+    int indexOffset;
+    int indexAmount;
+    float error;
+};
+
+// Vertices are shared by all levels, every level is a range of indexes
+struct MeshLodChain
+{
+    std::vector<float> vertices;
+    std::vector<unsigned int> indexes;
+    std::vector<MeshLod> lods;
+    int floatsPerVertex = 0;
+};
 
 // Don't delete the main mesh if you have instances of it
 class MeshStatic : public Mesh
@@ -26,6 +58,17 @@ public:
 
     // Make original mesh by transfering geometry data to it
     EXPORT virtual void setupFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents = false);
+    // Make original mesh with levels of detail in one vertex and index buffer, vertex data keeps the full level as a plain list of triangles
+    EXPORT virtual void setupLodChain(const MeshLodChain &chain, int attributesAmount, int *attributeSize, bool buildTangents = false);
+    // Welds plain list of triangles into vertices and indexes ordered for vertex cache and overdraw, then makes chain of levels of detail from it
+    EXPORT void setupIndexedFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents = false, int lodLevels = 1, float lodReduction = 0.5f);
+
+    // Takes effect on the next setup with levels of detail, plain float arrays and unusual layouts stay floats
+    EXPORT inline void setVertexFormat(MeshVertexFormat format) { this->vertexFormat = format; }
+    EXPORT inline MeshVertexFormat getVertexFormat() { return vertexFormat; }
+    // Packed positions are offset + value * scale, float ones have zero offset and scale of 1
+    EXPORT inline Vector3 getPositionOffset() { return positionOffset; }
+    EXPORT inline Vector3 getPositionScale() { return positionScale; }
 
     // Set VAO, VBO vertex data to the mesh.
     // Target mesh becoming an instance of this mesh
@@ -37,18 +80,35 @@ public:
     EXPORT virtual void clear();
 
     EXPORT virtual void useVertexArray();
+    EXPORT virtual void renderLod(int lod);
 
     EXPORT virtual MeshStatic *getAsStatic() override;
 
     EXPORT void setBoundVolumeSphere(Vector3 &center, float radius);
     EXPORT inline Sphere *getBoundVolumeSphere() { return &boundVolume; }
 
+    // Small sequential number used in sort keys of render queue, instances share it with the main mesh
+    EXPORT inline unsigned int getSortId() { return sortId; }
+
+    EXPORT inline int getLodsAmount() { return lods.size(); }
+    EXPORT inline const MeshLod *getLods() { return lods.data(); }
+    // Error scale turns error in space of the mesh into size on screen, negative previous level means no hysteresis
+    EXPORT int selectLod(float errorScale, float threshold, int previous);
+
 protected:
     Sphere boundVolume;
+    std::vector<MeshLod> lods;
 
     int vertexAmount = 0;
     int floatsPerVertex = 0;
     int attributesAmount = 0;
     bool isInstance = false;
     float *vertexData = nullptr;
+
+    MeshVertexFormat vertexFormat = MeshVertexFormat::Float;
+    Vector3 positionOffset = Vector3(0.0f);
+    Vector3 positionScale = Vector3(1.0f);
+
+    static std::atomic<unsigned int> nextSortId;
+    unsigned int sortId = nextSortId++;
 };
\ No newline at end of file
@@ -0,0 +1,265 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "mesh/vertexQuantizer.h"
+#include <algorithm>
+#include <string.h>
+
+static inline float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// Acos of a float dot can't tell angles below a few hundredths of degree, atan2 can
+static inline float getAngle(const Vector3 &a, const Vector3 &b)
+{
+    if (glm::length2(a) == 0.0f || glm::length2(b) == 0.0f)
+        return 0.0f;
+    return glm::degrees(atan2f(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+}
+
+void VertexQuantizer::getPositionBounds(const float *vertices, int vertexAmount, int floatsPerVertex, Vector3 &offset, Vector3 &scale)
+{
+    if (vertexAmount <= 0)
+    {
+        offset = Vector3(0.0f);
+        scale = Vector3(1.0f);
+        return;
+    }
+
+    Vector3 low = Vector3(vertices[0], vertices[1], vertices[2]);
+    Vector3 high = low;
+    for (int i = 1; i < vertexAmount; i++)
+    {
+        const float *v = &vertices[i * floatsPerVertex];
+        low = glm::min(low, Vector3(v[0], v[1], v[2]));
+        high = glm::max(high, Vector3(v[0], v[1], v[2]));
+    }
+    offset = low;
+    scale = high - low;
+    for (int i = 0; i < 3; i++)
+        if (scale[i] <= 0.0f)
+            scale[i] = 1.0f;
+}
+
+void VertexQuantizer::pack(const float *vertices, int vertexAmount, int floatsPerVertex, bool hasTangents, const Vector3 &offset, const Vector3 &scale, std::vector<unsigned char> &packed)
+{
+    int vertexSize = getVertexSize(hasTangents);
+    packed.assign(vertexAmount * vertexSize, 0);
+    for (int i = 0; i < vertexAmount; i++)
+    {
+        const float *v = &vertices[i * floatsPerVertex];
+        unsigned char *out = &packed[i * vertexSize];
+
+        unsigned short position[4];
+        for (int k = 0; k < 3; k++)
+            position[k] = (unsigned short)roundf(glm::clamp((v[k] - offset[k]) / scale[k], 0.0f, 1.0f) * 65535.0f);
+        position[3] = 65535;
+
+        short normal[2];
+        encodeOctahedral(Vector3(v[3], v[4], v[5]), normal);
+
+        unsigned short uv[2] = {floatToHalf(v[6]), floatToHalf(v[7])};
+
+        if (hasTangents)
+        {
+            short tangent[2];
+            Vector3 t = Vector3(v[8], v[9], v[10]);
+            encodeOctahedral(t, tangent);
+            memcpy(out + PACKED_VERTEX_TANGENT_OFFSET, tangent, sizeof(tangent));
+
+            Vector3 b = Vector3(v[11], v[12], v[13]);
+            if (glm::dot(glm::cross(Vector3(v[3], v[4], v[5]), t), b) < 0.0f)
+                position[3] = 0;
+        }
+
+        memcpy(out, position, sizeof(position));
+        memcpy(out + PACKED_VERTEX_NORMAL_OFFSET, normal, sizeof(normal));
+        memcpy(out + PACKED_VERTEX_UV_OFFSET, uv, sizeof(uv));
+    }
+}
+
+void VertexQuantizer::unpack(const unsigned char *packed, int vertexAmount, bool hasTangents, const Vector3 &offset, const Vector3 &scale, float *vertices)
+{
+    int vertexSize = getVertexSize(hasTangents);
+    int floatsPerVertex = hasTangents ? 14 : 8;
+    for (int i = 0; i < vertexAmount; i++)
+    {
+        const unsigned char *in = &packed[i * vertexSize];
+        float *v = &vertices[i * floatsPerVertex];
+
+        unsigned short position[4];
+        short normal[2];
+        unsigned short uv[2];
+        memcpy(position, in, sizeof(position));
+        memcpy(normal, in + PACKED_VERTEX_NORMAL_OFFSET, sizeof(normal));
+        memcpy(uv, in + PACKED_VERTEX_UV_OFFSET, sizeof(uv));
+
+        for (int k = 0; k < 3; k++)
+            v[k] = offset[k] + (position[k] / 65535.0f) * scale[k];
+        Vector3 n = decodeOctahedral(normal);
+        v[3] = n.x, v[4] = n.y, v[5] = n.z;
+        v[6] = halfToFloat(uv[0]);
+        v[7] = halfToFloat(uv[1]);
+
+        if (hasTangents)
+        {
+            short tangent[2];
+            memcpy(tangent, in + PACKED_VERTEX_TANGENT_OFFSET, sizeof(tangent));
+            Vector3 t = decodeOctahedral(tangent);
+            Vector3 b = glm::cross(n, t) * (position[3] ? 1.0f : -1.0f);
+            v[8] = t.x, v[9] = t.y, v[10] = t.z;
+            v[11] = b.x, v[12] = b.y, v[13] = b.z;
+        }
+    }
+}
+
+VertexQuantizerError VertexQuantizer::measureError(const float *vertices, int vertexAmount, int floatsPerVertex, bool hasTangents)
+{
+    VertexQuantizerError error;
+    Vector3 offset, scale;
+    getPositionBounds(vertices, vertexAmount, floatsPerVertex, offset, scale);
+
+    std::vector<unsigned char> packed;
+    pack(vertices, vertexAmount, floatsPerVertex, hasTangents, offset, scale, packed);
+    int unpackedFloats = hasTangents ? 14 : 8;
+    std::vector<float> unpacked(vertexAmount * unpackedFloats);
+    unpack(packed.data(), vertexAmount, hasTangents, offset, scale, unpacked.data());
+
+    for (int i = 0; i < vertexAmount; i++)
+    {
+        const float *a = &vertices[i * floatsPerVertex];
+        const float *b = &unpacked[i * unpackedFloats];
+        for (int k = 0; k < 3; k++)
+            error.position = fmaxf(error.position, fabsf(a[k] - b[k]));
+        error.normalAngle = fmaxf(error.normalAngle, getAngle(Vector3(a[3], a[4], a[5]), Vector3(b[3], b[4], b[5])));
+        error.uv = fmaxf(error.uv, fmaxf(fabsf(a[6] - b[6]), fabsf(a[7] - b[7])));
+
+        if (hasTangents)
+        {
+            error.tangentAngle = fmaxf(error.tangentAngle, getAngle(Vector3(a[8], a[9], a[10]), Vector3(b[8], b[9], b[10])));
+            if (glm::dot(Vector3(a[11], a[12], a[13]), Vector3(b[11], b[12], b[13])) < 0.0f)
+                error.bitangentSignMismatches++;
+        }
+    }
+    return error;
+}
+
+// Normal is projected on octahedron, lower half is folded over the upper one
+// Every of 4 roundings of the result is tried, the closest one after decoding is kept
+void VertexQuantizer::encodeOctahedral(const Vector3 &normal, short *encoded)
+{
+    float sum = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+    if (sum == 0.0f)
+    {
+        encoded[0] = 0;
+        encoded[1] = 0;
+        return;
+    }
+
+    Vector3 n = normal / sum;
+    Vector2 projected = Vector2(n.x, n.y);
+    if (n.z < 0.0f)
+        projected = Vector2((1.0f - fabsf(n.y)) * signNotZero(n.x), (1.0f - fabsf(n.x)) * signNotZero(n.y));
+
+    Vector3 target = glm::normalize(normal);
+    float bestDot = -2.0f;
+    for (int i = 0; i < 4; i++)
+    {
+        float x = (i & 1) ? ceilf(projected.x * 32767.0f) : floorf(projected.x * 32767.0f);
+        float y = (i & 2) ? ceilf(projected.y * 32767.0f) : floorf(projected.y * 32767.0f);
+        short candidate[2] = {(short)glm::clamp(x, -32767.0f, 32767.0f), (short)glm::clamp(y, -32767.0f, 32767.0f)};
+        float dot = glm::dot(decodeOctahedral(candidate), target);
+        if (dot > bestDot)
+        {
+            bestDot = dot;
+            encoded[0] = candidate[0];
+            encoded[1] = candidate[1];
+        }
+    }
+}
+
+Vector3 VertexQuantizer::decodeOctahedral(const short *encoded)
+{
+    float x = fmaxf(encoded[0] / 32767.0f, -1.0f);
+    float y = fmaxf(encoded[1] / 32767.0f, -1.0f);
+    Vector3 n = Vector3(x, y, 1.0f - fabsf(x) - fabsf(y));
+    if (n.z < 0.0f)
+    {
+        n.x = (1.0f - fabsf(y)) * signNotZero(x);
+        n.y = (1.0f - fabsf(x)) * signNotZero(y);
+    }
+    return glm::normalize(n);
+}
+
+// Rounds to nearest even, values out of range become infinity, small ones become denormals
+unsigned short VertexQuantizer::floatToHalf(float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned int sign = (bits >> 16) & 0x8000;
+    int exponent = (int)((bits >> 23) & 0xff);
+    unsigned int mantissa = bits & 0x7fffff;
+
+    if (exponent == 0xff)
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+    int halfExponent = exponent - 127 + 15;
+    if (halfExponent >= 31)
+        return sign | 0x7c00;
+
+    if (halfExponent <= 0)
+    {
+        if (halfExponent < -10)
+            return sign;
+        mantissa |= 0x800000;
+        int shift = 14 - halfExponent;
+        unsigned int half = mantissa >> shift;
+        unsigned int rest = mantissa & ((1u << shift) - 1);
+        unsigned int halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return sign | half;
+    }
+
+    // Carry of rounding may go to the exponent, that's still the right value
+    unsigned int half = ((unsigned int)halfExponent << 10) | (mantissa >> 13);
+    unsigned int rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;
+    return sign | half;
+}
+
+float VertexQuantizer::halfToFloat(unsigned short value)
+{
+    unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+    int exponent = (value >> 10) & 0x1f;
+    unsigned int mantissa = value & 0x3ff;
+    unsigned int bits;
+
+    if (exponent == 0x1f)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else if (exponent == 0)
+    {
+        if (mantissa == 0)
+            bits = sign;
+        else
+        {
+            // Denormal is normalized by moving the leading bit into the hidden one
+            exponent = 1;
+            while (!(mantissa & 0x400))
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3ff;
+            bits = sign | ((unsigned int)(exponent - 15 + 127) << 23) | (mantissa << 13);
+        }
+    }
+    else
+        bits = sign | ((unsigned int)(exponent - 15 + 127) << 23) | (mantissa << 13);
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
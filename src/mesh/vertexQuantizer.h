@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "math/math.h"
+#include <vector>
+
+// Packed vertex: position as 4 normalized unsigned shorts in the box of the mesh, w is the sign of bitangent
+// Normal and tangent as 2 normalized shorts of octahedral encoding, uv as 2 half floats
+#define PACKED_VERTEX_SIZE 16
+#define PACKED_VERTEX_TANGENTS_SIZE 20
+#define PACKED_VERTEX_NORMAL_OFFSET 8
+#define PACKED_VERTEX_UV_OFFSET 12
+#define PACKED_VERTEX_TANGENT_OFFSET 16
+
+// Largest differences after packing and unpacking, position one is in space of the mesh, angles are in degrees
+struct VertexQuantizerError
+{
+    float position = 0.0f;
+    float normalAngle = 0.0f;
+    float uv = 0.0f;
+    float tangentAngle = 0.0f;
+    int bitangentSignMismatches = 0;
+};
+
+// Packs vertices of 3,3,2 floats layout with optional tangent and bitangent of 3 floats each
+class VertexQuantizer
+{
+public:
+    // Offset is the lowest corner of the box, scale is its size, flat sides get size 1 so nothing is divided by zero
+    EXPORT static void getPositionBounds(const float *vertices, int vertexAmount, int floatsPerVertex, Vector3 &offset, Vector3 &scale);
+
+    EXPORT static void pack(const float *vertices, int vertexAmount, int floatsPerVertex, bool hasTangents, const Vector3 &offset, const Vector3 &scale, std::vector<unsigned char> &packed);
+    // Bitangent is restored as cross product of normal and tangent with the stored sign
+    EXPORT static void unpack(const unsigned char *packed, int vertexAmount, bool hasTangents, const Vector3 &offset, const Vector3 &scale, float *vertices);
+
+    // Packs and unpacks vertices, so precision loss of a mesh can be checked before it's uploaded
+    EXPORT static VertexQuantizerError measureError(const float *vertices, int vertexAmount, int floatsPerVertex, bool hasTangents);
+
+    EXPORT static void encodeOctahedral(const Vector3 &normal, short *encoded);
+    EXPORT static Vector3 decodeOctahedral(const short *encoded);
+
+    EXPORT static unsigned short floatToHalf(float value);
+    EXPORT static float halfToFloat(unsigned short value);
+
+    EXPORT static inline int getVertexSize(bool hasTangents) { return hasTangents ? PACKED_VERTEX_TANGENTS_SIZE : PACKED_VERTEX_SIZE; }
+};
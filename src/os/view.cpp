@@ -3,6 +3,7 @@
 
 #include "os/view.h"
 #include "renderer/opengl/rendererOpenGL.h"
+#include "renderer/null/rendererNull.h"
 #include "renderer/vulkan/rendererVulkan.h"
 #include "connector/withRenderer.h"
 #include <SDL.h>
@@ -28,11 +29,19 @@ bool View::makeWindow()
     if (window)
         return false;
 
-    if (!RendererOpenGL::isAvailable())
-        return false;
-
-    renderer = new RendererOpenGL(config);
-    // renderer = new RendererVulkan();
+    if (config->getRendererType() == RendererType::Null)
+    {
+        if (!RendererNull::isAvailable())
+            return false;
+        renderer = new RendererNull(config);
+    }
+    else
+    {
+        if (!RendererOpenGL::isAvailable())
+            return false;
+        renderer = new RendererOpenGL(config);
+        // renderer = new RendererVulkan();
+    }
 
     renderer->preInit();
 
@@ -65,8 +74,10 @@ bool View::makeWindow()
         WithRenderer::setCurrentRenderer(renderer);
         window = newWindow;
 
-        SDL_GL_GetDrawableSize((SDL_Window *)window, &drawableWidth, &drawableHeight);
-        if (SDL_GL_SetSwapInterval(-1) == 0)
+        updateDrawableSize();
+        if (renderer->isHeadless())
+            logger->logff("Headless renderer, no frame sync");
+        else if (SDL_GL_SetSwapInterval(-1) == 0)
             logger->logff("Adaptive V-Sync enabled");
         else
         {
@@ -142,14 +153,15 @@ bool View::changeMode()
         }
     }
 
-    SDL_GL_GetDrawableSize((SDL_Window *)window, &drawableWidth, &drawableHeight);
+    updateDrawableSize();
     updateFrameBuffer();
     return true;
 }
 
 void View::swapBuffers()
 {
-    SDL_GL_SwapWindow((SDL_Window *)window);
+    if (!renderer->isHeadless())
+        SDL_GL_SwapWindow((SDL_Window *)window);
 }
 
 void View::minimize()
@@ -183,7 +195,7 @@ void View::updateSize(int width, int height)
         this->width = width;
         this->height = height;
 
-        SDL_GL_GetDrawableSize((SDL_Window *)window, &drawableWidth, &drawableHeight);
+        updateDrawableSize();
         updateFrameBuffer();
     }
 }
@@ -205,10 +217,19 @@ void View::updateSuitableDisplayMode()
     }
 }
 
+// Window without GL context has no drawable, its size is used instead
+void View::updateDrawableSize()
+{
+    if (renderer->isHeadless())
+        SDL_GetWindowSize((SDL_Window *)window, &drawableWidth, &drawableHeight);
+    else
+        SDL_GL_GetDrawableSize((SDL_Window *)window, &drawableWidth, &drawableHeight);
+}
+
 void View::updateFrameBuffer()
 {
     printf("Create render target %i %i\n", drawableWidth, drawableHeight);
     if (renderTarget)
         delete renderTarget;
-    renderTarget = new RenderTarget(drawableWidth, drawableHeight, config->getShadowQuality(), config->getMultisamplingFactor());
+    renderTarget = new RenderTarget(drawableWidth, drawableHeight, config->getShadowQuality(), config->getMultisamplingFactor(), renderer->isHeadless());
 }
\ No newline at end of file
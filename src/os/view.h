@@ -47,6 +47,7 @@ public:
 
 protected:
     void updateSuitableDisplayMode();
+    void updateDrawableSize();
     void updateFrameBuffer();
 
     void *window = nullptr;
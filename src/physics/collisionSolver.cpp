@@ -10,6 +10,12 @@ CollisionSolver::CollisionSolver(float simScale)
 }
 
 void CollisionSolver::solve(PhysicsBody *a, PhysicsBody *b, CollisionManifold &manifold, float delta)
+{
+    solvePosition(a, b, manifold);
+    solveVelocity(a, b, manifold, delta);
+}
+
+void CollisionSolver::solvePosition(PhysicsBody *a, PhysicsBody *b, CollisionManifold &manifold)
 {
     Vector3 normal = manifold.normal[0];
     float depth = manifold.depth[0];
@@ -21,6 +27,14 @@ void CollisionSolver::solve(PhysicsBody *a, PhysicsBody *b, CollisionManifold &m
         a->translate((b->getMotionType() != MotionType::Static) ? -translate / 2.0f : -translate);
     if (b->getMotionType() != MotionType::Static)
         b->translate((a->getMotionType() != MotionType::Static) ? translate / 2.0f : translate);
+}
+
+void CollisionSolver::solveVelocity(PhysicsBody *a, PhysicsBody *b, CollisionManifold &manifold, float delta)
+{
+    Vector3 normal = manifold.normal[0];
+    float depth = manifold.depth[0];
+    if (depth <= 0.0f)
+        return;
 
     Vector3 pointA = manifold.pointsOnA[0];
     Vector3 pointB = manifold.pointsOnB[0];
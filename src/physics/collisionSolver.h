@@ -16,6 +16,10 @@ public:
     CollisionSolver(float simScale);
 
     void solve(PhysicsBody *a, PhysicsBody *b, CollisionManifold &manifold, float delta);
+    // Pushes bodies apart along the normal, done once per step
+    void solvePosition(PhysicsBody *a, PhysicsBody *b, CollisionManifold &manifold);
+    // Normal and friction rows, may be repeated by velocity iterations shared with joints
+    void solveVelocity(PhysicsBody *a, PhysicsBody *b, CollisionManifold &manifold, float delta);
 
     float solveAxis(
         PhysicsBody *a,
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "physics/joint6DOF.h"
+#include "physics/physicsBody.h"
+
+Joint6DOF::Joint6DOF(PhysicsBody *a, PhysicsBody *b, const Vector3 &anchor, const Constraint6DOFDescriptor &descriptor)
+{
+    this->a = a;
+    this->b = b;
+    this->descriptor = descriptor;
+
+    Quat orientationA = a->getOrientation();
+    Quat orientationB = b ? b->getOrientation() : Quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+    localAnchorA = glm::inverse(orientationA) * (anchor - a->getCenterOfMass());
+    localAnchorB = b ? glm::inverse(orientationB) * (anchor - b->getCenterOfMass()) : anchor;
+    initialRelativeRotation = glm::inverse(orientationA) * orientationB;
+}
+
+Joint6DOF::~Joint6DOF()
+{
+}
+
+int Joint6DOF::getRowsAmount()
+{
+    return (int)descriptor.blockXMoving + (int)descriptor.blockYMoving + (int)descriptor.blockZMoving +
+           (int)descriptor.blockXRotation + (int)descriptor.blockYRotation + (int)descriptor.blockZRotation;
+}
+
+Vector3 Joint6DOF::getWorldAnchorA()
+{
+    return a->getCenterOfMass() + a->getOrientation() * localAnchorA;
+}
+
+Vector3 Joint6DOF::getWorldAnchorB()
+{
+    if (!b)
+        return localAnchorB;
+    return b->getCenterOfMass() + b->getOrientation() * localAnchorB;
+}
+
+Vector3 Joint6DOF::getLinearError()
+{
+    return getWorldAnchorB() - getWorldAnchorA();
+}
+
+Vector3 Joint6DOF::getAngularError()
+{
+    Quat orientationB = b ? b->getOrientation() : Quat(1.0f, 0.0f, 0.0f, 0.0f);
+    Quat error = orientationB * glm::inverse(a->getOrientation() * initialRelativeRotation);
+    if (error.w < 0.0f)
+        error = -error;
+    return Vector3(error.x, error.y, error.z) * 2.0f;
+}
+
+Matrix3 Joint6DOF::getBasis()
+{
+    return glm::toMat3(a->getOrientation());
+}
+
+bool Joint6DOF::isActive()
+{
+    bool bStaticA = a->getMotionType() == MotionType::Static;
+    bool bStaticB = !b || b->getMotionType() == MotionType::Static;
+    if (bStaticA && bStaticB)
+        return false;
+    if (a->isSleeping() && (!b || b->isSleeping()))
+        return false;
+    return a->isEnabled() && (!b || b->isEnabled());
+}
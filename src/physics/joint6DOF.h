@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "math/math.h"
+#include "common/utils.h"
+#include "common/destroyable.h"
+#include "physics/constraint6DOF.h"
+
+class PhysicsBody;
+
+// Joint between two bodies, or between a body and the world if second body is null
+// Blocked axes of the descriptor are local axes of the first body
+// Solved together with other joints by JointSolver, accumulated impulses are kept between steps for warm starting
+class Joint6DOF : public Destroyable
+{
+public:
+    EXPORT Joint6DOF(PhysicsBody *a, PhysicsBody *b, const Vector3 &anchor, const Constraint6DOFDescriptor &descriptor);
+    EXPORT virtual ~Joint6DOF();
+
+    EXPORT inline PhysicsBody *getBodyA() { return a; }
+    EXPORT inline PhysicsBody *getBodyB() { return b; }
+    EXPORT inline const Constraint6DOFDescriptor &getDescriptor() { return descriptor; }
+
+    EXPORT int getRowsAmount();
+
+    // Anchor points of each body in physics space
+    EXPORT Vector3 getWorldAnchorA();
+    EXPORT Vector3 getWorldAnchorB();
+
+    // Linear and angular error between bodies in physics space
+    EXPORT Vector3 getLinearError();
+    EXPORT Vector3 getAngularError();
+
+    // Axes of the first body in physics space
+    EXPORT Matrix3 getBasis();
+
+    EXPORT bool isActive();
+
+    // Impulses from the previous step, one per blocked axis in order X, Y, Z moving, X, Y, Z rotation
+    float accumulatedImpulse[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+protected:
+    PhysicsBody *a;
+    PhysicsBody *b;
+
+    Vector3 localAnchorA;
+    Vector3 localAnchorB;
+    Quat initialRelativeRotation;
+
+    Constraint6DOFDescriptor descriptor;
+};
@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "physics/jointSolver.h"
+#include "physics/physicsBody.h"
+#include <algorithm>
+
+// Part of the position error fixed on each step
+const float jointBaumgarte = 0.2f;
+
+Matrix3 _getWorldInvertedInertia(PhysicsBody *body)
+{
+    if (!body || body->getMotionType() == MotionType::Static)
+        return Matrix3(0.0f);
+    Matrix3 r = glm::toMat3(body->getOrientation());
+    return r * body->getInvertedInertia() * glm::transpose(r);
+}
+
+float _getInvMass(PhysicsBody *body)
+{
+    if (!body || body->getMotionType() == MotionType::Static)
+        return 0.0f;
+    return body->getInvMass();
+}
+
+void JointSolver::prepare(std::vector<Joint6DOF *> &joints, float delta)
+{
+    rows.clear();
+    ranges.clear();
+
+    float biasFactor = jointBaumgarte / delta;
+
+    for (auto &joint : joints)
+    {
+        if (joint->isDestroyed() || !joint->isActive())
+            continue;
+
+        PhysicsBody *a = joint->getBodyA();
+        PhysicsBody *b = joint->getBodyB();
+        const Constraint6DOFDescriptor &descriptor = joint->getDescriptor();
+
+        Matrix3 invInertiaA = _getWorldInvertedInertia(a);
+        Matrix3 invInertiaB = _getWorldInvertedInertia(b);
+        float invMassA = _getInvMass(a);
+        float invMassB = _getInvMass(b);
+
+        Vector3 anchorA = joint->getWorldAnchorA();
+        Vector3 anchorB = joint->getWorldAnchorB();
+        Vector3 rA = anchorA - a->getCenterOfMass();
+        Vector3 rB = b ? anchorB - b->getCenterOfMass() : Vector3(0.0f);
+        Vector3 linearError = joint->getLinearError();
+        Vector3 angularError = joint->getAngularError();
+        Matrix3 basis = joint->getBasis();
+
+        const bool blocked[6] = {descriptor.blockXMoving, descriptor.blockYMoving, descriptor.blockZMoving,
+                                 descriptor.blockXRotation, descriptor.blockYRotation, descriptor.blockZRotation};
+
+        JointRange range = {joint, (int)rows.size(), 0};
+        for (int i = 0; i < 6; i++)
+        {
+            if (!blocked[i])
+                continue;
+
+            Vector3 axis = basis[i % 3];
+            JointRow row;
+            row.a = a;
+            row.b = b;
+            row.invMassA = invMassA;
+            row.invMassB = invMassB;
+
+            if (i < 3)
+            {
+                row.linear = axis;
+                row.angularA = glm::cross(rA, axis);
+                row.angularB = glm::cross(rB, axis);
+                row.bias = glm::dot(linearError, axis) * biasFactor;
+            }
+            else
+            {
+                row.linear = Vector3(0.0f);
+                row.angularA = axis;
+                row.angularB = axis;
+                row.bias = glm::dot(angularError, axis) * biasFactor;
+            }
+
+            row.invInertiaAngularA = invInertiaA * row.angularA;
+            row.invInertiaAngularB = invInertiaB * row.angularB;
+
+            float invEffectiveMass = (invMassA + invMassB) * glm::dot(row.linear, row.linear) +
+                                     glm::dot(row.angularA, row.invInertiaAngularA) +
+                                     glm::dot(row.angularB, row.invInertiaAngularB);
+            row.effectiveMass = invEffectiveMass > 0.0f ? 1.0f / invEffectiveMass : 0.0f;
+
+            // warm starting with impulse of the previous step
+            row.impulse = joint->accumulatedImpulse[i];
+            applyImpulse(row, row.impulse);
+
+            rows.push_back(row);
+            range.amount++;
+        }
+
+        if (range.amount > 0)
+            ranges.push_back(range);
+    }
+}
+
+void JointSolver::solve(int iterations)
+{
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (auto &range : ranges)
+        {
+            if (bUseBlockSolving && range.amount > 1)
+                solveBlock(range.offset, range.amount);
+            else
+                for (int i = range.offset; i < range.offset + range.amount; i++)
+                    solveRow(rows[i]);
+        }
+    }
+}
+
+void JointSolver::storeImpulses()
+{
+    for (auto &range : ranges)
+    {
+        const Constraint6DOFDescriptor &descriptor = range.joint->getDescriptor();
+        const bool blocked[6] = {descriptor.blockXMoving, descriptor.blockYMoving, descriptor.blockZMoving,
+                                 descriptor.blockXRotation, descriptor.blockYRotation, descriptor.blockZRotation};
+        int row = range.offset;
+        for (int i = 0; i < 6; i++)
+            range.joint->accumulatedImpulse[i] = blocked[i] ? rows[row++].impulse : 0.0f;
+    }
+}
+
+void JointSolver::solvePositions(std::vector<Joint6DOF *> &joints, int iterations)
+{
+    for (int iteration = 0; iteration < iterations; iteration++)
+        for (auto &joint : joints)
+            if (!joint->isDestroyed() && joint->isActive())
+                correctJointPosition(joint);
+
+    for (auto &joint : joints)
+    {
+        if (joint->isDestroyed() || !joint->isActive())
+            continue;
+        if (_getInvMass(joint->getBodyA()) > 0.0f)
+            joint->getBodyA()->syncTransformation();
+        if (_getInvMass(joint->getBodyB()) > 0.0f)
+            joint->getBodyB()->syncTransformation();
+    }
+}
+
+// Error is recalculated for every row, so rotations of bodies are not linearised over the whole step
+void JointSolver::correctJointPosition(Joint6DOF *joint)
+{
+    PhysicsBody *a = joint->getBodyA();
+    PhysicsBody *b = joint->getBodyB();
+    const Constraint6DOFDescriptor &descriptor = joint->getDescriptor();
+    const bool blocked[6] = {descriptor.blockXMoving, descriptor.blockYMoving, descriptor.blockZMoving,
+                             descriptor.blockXRotation, descriptor.blockYRotation, descriptor.blockZRotation};
+
+    float invMassA = _getInvMass(a);
+    float invMassB = _getInvMass(b);
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (!blocked[i])
+            continue;
+
+        Matrix3 invInertiaA = _getWorldInvertedInertia(a);
+        Matrix3 invInertiaB = _getWorldInvertedInertia(b);
+        Vector3 axis = joint->getBasis()[i % 3];
+        Vector3 linear, angularA, angularB;
+        float error;
+
+        if (i < 3)
+        {
+            Vector3 rA = joint->getWorldAnchorA() - a->getCenterOfMass();
+            Vector3 rB = b ? joint->getWorldAnchorB() - b->getCenterOfMass() : Vector3(0.0f);
+            linear = axis;
+            angularA = glm::cross(rA, axis);
+            angularB = glm::cross(rB, axis);
+            error = glm::dot(joint->getLinearError(), axis);
+        }
+        else
+        {
+            linear = Vector3(0.0f);
+            angularA = axis;
+            angularB = axis;
+            error = glm::dot(joint->getAngularError(), axis);
+        }
+
+        Vector3 invInertiaAngularA = invInertiaA * angularA;
+        Vector3 invInertiaAngularB = invInertiaB * angularB;
+        float invEffectiveMass = (invMassA + invMassB) * glm::dot(linear, linear) +
+                                 glm::dot(angularA, invInertiaAngularA) +
+                                 glm::dot(angularB, invInertiaAngularB);
+        if (invEffectiveMass <= 0.0f)
+            continue;
+
+        float impulse = -error / invEffectiveMass;
+        if (invMassA > 0.0f)
+            a->correctPosition(-linear * (impulse * invMassA), -invInertiaAngularA * impulse);
+        if (invMassB > 0.0f)
+            b->correctPosition(linear * (impulse * invMassB), invInertiaAngularB * impulse);
+    }
+}
+
+void JointSolver::applyImpulse(JointRow &row, float impulse)
+{
+    if (impulse == 0.0f)
+        return;
+
+    if (row.invMassA > 0.0f)
+    {
+        row.a->addLinearVelocity(-row.linear * (impulse * row.invMassA));
+        row.a->addAngularVelocity(-row.invInertiaAngularA * impulse);
+    }
+    if (row.invMassB > 0.0f)
+    {
+        row.b->addLinearVelocity(row.linear * (impulse * row.invMassB));
+        row.b->addAngularVelocity(row.invInertiaAngularB * impulse);
+    }
+}
+
+float JointSolver::getVelocityError(JointRow &row)
+{
+    float velocityError = -glm::dot(row.linear, row.a->getLinearVelocity()) - glm::dot(row.angularA, row.a->getAngularVelocity());
+    if (row.b)
+        velocityError += glm::dot(row.linear, row.b->getLinearVelocity()) + glm::dot(row.angularB, row.b->getAngularVelocity());
+    return velocityError + row.bias;
+}
+
+void JointSolver::solveRow(JointRow &row)
+{
+    float impulse = -getVelocityError(row) * row.effectiveMass;
+    row.impulse += impulse;
+    applyImpulse(row, impulse);
+}
+
+// Solves K * impulse = -error for rows of one joint, K = J * M^-1 * J^T
+void JointSolver::solveBlock(int offset, int amount)
+{
+    float k[6][7];
+    JointRow *block = &rows[offset];
+
+    for (int i = 0; i < amount; i++)
+    {
+        for (int j = 0; j < amount; j++)
+        {
+            k[i][j] = (block[i].invMassA + block[i].invMassB) * glm::dot(block[i].linear, block[j].linear) +
+                      glm::dot(block[i].angularA, block[j].invInertiaAngularA) +
+                      glm::dot(block[i].angularB, block[j].invInertiaAngularB);
+        }
+        k[i][amount] = -getVelocityError(block[i]);
+    }
+
+    // Gaussian elimination with partial pivoting
+    for (int column = 0; column < amount; column++)
+    {
+        int pivot = column;
+        for (int i = column + 1; i < amount; i++)
+            if (fabsf(k[i][column]) > fabsf(k[pivot][column]))
+                pivot = i;
+
+        if (fabsf(k[pivot][column]) < 1.0e-12f)
+        {
+            // Degenerated block, rows are solved one by one
+            for (int i = 0; i < amount; i++)
+                solveRow(block[i]);
+            return;
+        }
+
+        if (pivot != column)
+            for (int j = 0; j <= amount; j++)
+                std::swap(k[column][j], k[pivot][j]);
+
+        for (int i = column + 1; i < amount; i++)
+        {
+            float factor = k[i][column] / k[column][column];
+            for (int j = column; j <= amount; j++)
+                k[i][j] -= factor * k[column][j];
+        }
+    }
+
+    float impulses[6];
+    for (int i = amount - 1; i >= 0; i--)
+    {
+        float sum = k[i][amount];
+        for (int j = i + 1; j < amount; j++)
+            sum -= k[i][j] * impulses[j];
+        impulses[i] = sum / k[i][i];
+    }
+
+    for (int i = 0; i < amount; i++)
+    {
+        block[i].impulse += impulses[i];
+        applyImpulse(block[i], impulses[i]);
+    }
+}
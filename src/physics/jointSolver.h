@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "math/math.h"
+#include "physics/joint6DOF.h"
+#include <vector>
+
+class PhysicsBody;
+
+// One constrained degree of freedom, Jacobian and effective mass are prepared once per step
+struct JointRow
+{
+    PhysicsBody *a;
+    PhysicsBody *b;
+    Vector3 linear;
+    Vector3 angularA;
+    Vector3 angularB;
+    Vector3 invInertiaAngularA;
+    Vector3 invInertiaAngularB;
+    float invMassA;
+    float invMassB;
+    float effectiveMass;
+    float bias;
+    float impulse;
+};
+
+// Solves joints iteratively with warm starting
+// Rows of all joints are stored in one array, rows of one joint are next to each other
+class JointSolver
+{
+public:
+    EXPORT void prepare(std::vector<Joint6DOF *> &joints, float delta);
+    EXPORT void solve(int iterations);
+    EXPORT void storeImpulses();
+    // Fixes remaining drift by moving bodies directly after integration
+    EXPORT void solvePositions(std::vector<Joint6DOF *> &joints, int iterations);
+
+    // Solves all rows of a joint at once instead of one by one
+    // More expensive per iteration, but converges faster for joints with coupled rows
+    EXPORT inline void setBlockSolving(bool state) { bUseBlockSolving = state; }
+    EXPORT inline bool isUsingBlockSolving() { return bUseBlockSolving; }
+
+protected:
+    void applyImpulse(JointRow &row, float impulse);
+    float getVelocityError(JointRow &row);
+    void solveRow(JointRow &row);
+    void solveBlock(int offset, int amount);
+    void correctJointPosition(Joint6DOF *joint);
+
+    struct JointRange
+    {
+        Joint6DOF *joint;
+        int offset;
+        int amount;
+    };
+
+    std::vector<JointRow> rows;
+    std::vector<JointRange> ranges;
+    bool bUseBlockSolving = false;
+};
@@ -69,15 +69,7 @@ void PhysicsBody::finishStep(float delta)
             orientation = glm::normalize(glm::angleAxis(len, angularVelocityDelta / len) * orientation);
         }
 
-        if (transformation)
-        {
-            transformation->setPosition(position / simScale);
-            transformation->setRotation(orientation);
-        }
-
-        localTransform = glm::translate(Matrix4(1.0f), Vector3(position.x, position.y, position.z));
-        localTransform *= glm::toMat4(orientation);
-        this->shape->provideTransformation(&localTransform);
+        syncTransformation();
 
         if (glm::length2(motion->linearVelocity) < delta * 0.2f && glm::length2(motion->angularVelocity) < delta * 0.2f)
         {
@@ -291,6 +283,47 @@ Matrix3 PhysicsBody::getInvertedInertia()
     return glm::inverse(inertia);
 }
 
+void PhysicsBody::correctPosition(const Vector3 &translation, const Vector3 &rotation)
+{
+    position += translation;
+
+    float len = glm::length(rotation);
+    if (len > 1.0e-6f)
+    {
+        orientation = glm::normalize(glm::angleAxis(len, rotation / len) * orientation);
+    }
+}
+
+void PhysicsBody::syncTransformation()
+{
+    if (transformation)
+    {
+        transformation->setPosition(position / simScale);
+        transformation->setRotation(orientation);
+    }
+
+    localTransform = glm::translate(Matrix4(1.0f), Vector3(position.x, position.y, position.z));
+    localTransform *= glm::toMat4(orientation);
+    this->shape->provideTransformation(&localTransform);
+}
+
+void PhysicsBody::addJointedBody(PhysicsBody *body)
+{
+    jointedBodies.push_back(body);
+}
+
+void PhysicsBody::removeJointedBody(PhysicsBody *body)
+{
+    for (auto it = jointedBodies.begin(); it != jointedBodies.end(); it++)
+    {
+        if (*it == body)
+        {
+            jointedBodies.erase(it);
+            break;
+        }
+    }
+}
+
 Vector3 PhysicsBody::getPointVelocity(const Vector3 &localPoint)
 {
     if (motion)
@@ -73,6 +73,10 @@ public:
     inline std::vector<BodyCollisionData> *getCollisionBodies() { return &bodyCollisionData; }
 
     EXPORT void translate(Vector3 v);
+    // Moves and rotates body immediately, rotation is a world space rotation vector
+    // syncTransformation has to be called after all corrections are done
+    EXPORT void correctPosition(const Vector3 &translation, const Vector3 &rotation);
+    EXPORT void syncTransformation();
 
     EXPORT void addConstraint6DOF(const Constraint6DOFDescriptor &descriptor)
     {
@@ -82,6 +86,17 @@ public:
 
     EXPORT Matrix3 getInvertedInertia();
 
+    // Bodies connected by joints don't collide with each other
+    EXPORT void addJointedBody(PhysicsBody *body);
+    EXPORT void removeJointedBody(PhysicsBody *body);
+    inline bool isJointedWith(PhysicsBody *body)
+    {
+        for (auto &jointedBody : jointedBodies)
+            if (jointedBody == body)
+                return true;
+        return false;
+    }
+
     EXPORT Vector3 getPointVelocity(const Vector3 &localPoint);
 
     EXPORT void process(float delta, const Vector3 &gravity);
@@ -138,11 +153,16 @@ public:
         this->bIsEnabled = bState;
     }
 
+    // Position of the body in the list of its world, kept up to date by the world on every step
+    inline int getWorldIndex() { return worldIndex; }
+    inline void setWorldIndex(int index) { worldIndex = index; }
+
     void setAsleep();
 
 protected:
     std::vector<Constraint *> constraints;
     std::vector<BodyCollisionData> bodyCollisionData;
+    std::vector<PhysicsBody *> jointedBodies;
 
     Vector3 translationAccumulator = Vector3(0.0f);
 
@@ -170,4 +190,5 @@ protected:
     float sleepAccumulator = 0.0f;
 
     bool bIsEnabled = true;
+    int worldIndex = 0;
 };
\ No newline at end of file
@@ -0,0 +1,294 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "physics/physicsDebris.h"
+#include "physics/physicsBody.h"
+#include "renderer/renderQueue.h"
+#include <algorithm>
+
+// Seconds of rest before piece falls asleep
+const float debrisSleepDelay = 0.5f;
+
+static inline bool isSameBox(const AABB &a, const AABB &b)
+{
+    return a.start == b.start && a.end == b.end;
+}
+
+PhysicsDebris::PhysicsDebris(float simScale)
+{
+    this->simScale = simScale;
+}
+
+bool PhysicsDebris::spawn(DebrisShape shape, const Vector3 &position, const Quat &orientation, const Vector3 &size, const Vector3 &velocity, const Vector3 &angularVelocity, float lifetime)
+{
+    if ((int)pieces.size() >= maxPieces)
+        return false;
+
+    DebrisPiece piece;
+    piece.position = position * simScale;
+    piece.velocity = velocity * simScale;
+    piece.orientation = orientation;
+    piece.angularVelocity = angularVelocity;
+    piece.size = size * simScale;
+    // Box rests on its faces, so the smallest half extent is used as collision radius
+    piece.radius = (shape == DebrisShape::Sphere ? piece.size.x : fminf(piece.size.x, fminf(piece.size.y, piece.size.z))) * 0.5f;
+    piece.lifetime = lifetime;
+    piece.sleepAccumulator = 0.0f;
+    piece.shape = shape;
+    piece.bIsSleeping = false;
+
+    pieces.push_back(piece);
+    return true;
+}
+
+void PhysicsDebris::clear()
+{
+    pieces.clear();
+}
+
+void PhysicsDebris::wake(const AABB &area)
+{
+    changedAreas.push_back(AABB(area.start * simScale, area.end * simScale));
+}
+
+void PhysicsDebris::process(float delta, const Vector3 &gravity, std::vector<PhysicsBody *> *bodies, int slices)
+{
+    if (pieces.empty())
+    {
+        changedAreas.clear();
+        return;
+    }
+
+    updateStaticBodies(bodies);
+
+    int piecesAmount = pieces.size();
+    int piecesPerThread = piecesAmount / slices;
+    int currentPiece = 0;
+
+    if ((int)slicesData.size() < slices)
+        slicesData.resize(slices);
+
+    for (int i = 0; i < slices; i++)
+    {
+        int end = (i == slices - 1) ? piecesAmount : currentPiece + piecesPerThread;
+        auto sliceData = &slicesData[i];
+
+        core->queueJob([this, currentPiece, end, delta, gravity, sliceData]
+                       { processPieces(currentPiece, end, delta, gravity, sliceData); },
+                       &jobsInFlight);
+
+        currentPiece += piecesPerThread;
+    }
+    core->waitForJobs(&jobsInFlight);
+    changedAreas.clear();
+
+    // Despawn, last piece takes place of removed one
+    int i = 0;
+    while (i < (int)pieces.size())
+    {
+        if (pieces[i].lifetime <= 0.0f)
+        {
+            pieces[i] = pieces.back();
+            pieces.pop_back();
+        }
+        else
+            i++;
+    }
+}
+
+void PhysicsDebris::onRenderQueue(RenderQueue *renderQueue)
+{
+    for (auto &piece : pieces)
+    {
+        MeshStatic *mesh = meshes[(int)piece.shape];
+        if (!mesh)
+            continue;
+
+        Matrix4 mModel = glm::translate(Matrix4(1.0f), piece.position / simScale);
+        mModel *= glm::toMat4(piece.orientation);
+        mModel = glm::scale(mModel, piece.size / simScale);
+        renderQueue->addMainPhase(mModel, shaders[(int)piece.shape], nullptr, mesh, nullptr, 0);
+    }
+}
+
+void PhysicsDebris::setRenderMesh(DebrisShape shape, MeshStatic *mesh, Shader *shader)
+{
+    meshes[(int)shape] = mesh;
+    shaders[(int)shape] = shader;
+}
+
+void PhysicsDebris::updateStaticBodies(std::vector<PhysicsBody *> *bodies)
+{
+    staticBodies.swap(previousStaticBodies);
+    staticBoxes.swap(previousStaticBoxes);
+    staticBodies.clear();
+    staticBoxes.clear();
+    for (auto &body : *bodies)
+        if (body->isEnabled() && !body->isDestroyed() && body->getMotionType() == MotionType::Static)
+        {
+            staticBodies.push_back(body);
+            staticBoxes.push_back(body->getAABB());
+        }
+
+    staticAABB.resize(staticBodies.size());
+    for (int i = 0; i < (int)staticBodies.size(); i++)
+        staticAABB.set(i, staticBoxes[i]);
+
+    findChangedAreas();
+    changedAABB.resize(changedAreas.size());
+    for (int i = 0; i < (int)changedAreas.size(); i++)
+        changedAABB.set(i, changedAreas[i]);
+}
+
+void PhysicsDebris::findChangedAreas()
+{
+    // Same bodies in the same order is the usual case, only boxes are compared
+    int amount = staticBodies.size();
+    if (amount == (int)previousStaticBodies.size() && std::equal(staticBodies.begin(), staticBodies.end(), previousStaticBodies.begin()))
+    {
+        for (int i = 0; i < amount; i++)
+            if (!isSameBox(staticBoxes[i], previousStaticBoxes[i]))
+            {
+                changedAreas.push_back(previousStaticBoxes[i]);
+                changedAreas.push_back(staticBoxes[i]);
+            }
+        return;
+    }
+
+    previousIndexes.clear();
+    for (int i = 0; i < (int)previousStaticBodies.size(); i++)
+        previousIndexes[previousStaticBodies[i]] = i;
+
+    for (int i = 0; i < amount; i++)
+    {
+        auto previous = previousIndexes.find(staticBodies[i]);
+        if (previous == previousIndexes.end())
+        {
+            changedAreas.push_back(staticBoxes[i]);
+            continue;
+        }
+        if (!isSameBox(staticBoxes[i], previousStaticBoxes[previous->second]))
+        {
+            changedAreas.push_back(previousStaticBoxes[previous->second]);
+            changedAreas.push_back(staticBoxes[i]);
+        }
+        previousIndexes.erase(previous);
+    }
+
+    // Bodies left are removed or disabled ones
+    for (auto &previous : previousIndexes)
+        changedAreas.push_back(previousStaticBoxes[previous.second]);
+}
+
+void PhysicsDebris::processPieces(int start, int end, float delta, const Vector3 &gravity, DebrisSliceData *sliceData)
+{
+    float gravityLength = glm::length(gravity);
+    Vector3 down = gravityLength > 0.0f ? gravity / gravityLength : Vector3(0.0f, -1.0f, 0.0f);
+
+    for (int i = start; i < end; i++)
+    {
+        DebrisPiece &piece = pieces[i];
+        piece.lifetime -= delta;
+        if (piece.bIsSleeping)
+        {
+            if (changedAABB.size() == 0)
+                continue;
+            // Support test reaches one radius under the piece
+            Vector3 reach = Vector3(fmaxf(piece.size.x, fmaxf(piece.size.y, piece.size.z)) * 0.5f + piece.radius);
+            sliceData->overlaps.clear();
+            changedAABB.testAABB(AABB(piece.position - reach, piece.position + reach), 0, changedAABB.size(), &sliceData->overlaps);
+            if (sliceData->overlaps.empty())
+                continue;
+            piece.bIsSleeping = false;
+            piece.sleepAccumulator = 0.0f;
+        }
+
+        piece.velocity += gravity * delta;
+        Vector3 target = piece.position + piece.velocity * delta;
+
+        // Swept test in direction of motion, then support test under piece keeps resting pieces on surface
+        Vector3 point, normal;
+        bool bHasContact = false;
+        Vector3 move = target - piece.position;
+        float moveLength = glm::length(move);
+        if (moveLength > 1.0e-6f && collide(Segment(piece.position, target + move * (piece.radius / moveLength)), piece.radius, sliceData, point, normal))
+            bHasContact = true;
+        else if (collide(Segment(target, target + down * piece.radius), piece.radius, sliceData, point, normal))
+            bHasContact = true;
+
+        if (bHasContact)
+        {
+            target = point + normal * piece.radius;
+
+            float normalVelocity = glm::dot(piece.velocity, normal);
+            if (normalVelocity < 0.0f)
+            {
+                // Slow hits don't bounce, otherwise resting pieces would jump on every step
+                float bounce = normalVelocity < -2.0f * gravityLength * delta ? restitution : 0.0f;
+                float normalImpulse = -(1.0f + bounce) * normalVelocity;
+                Vector3 tangentVelocity = piece.velocity - normal * normalVelocity;
+                float tangentSpeed = glm::length(tangentVelocity);
+                float newTangentSpeed = fmaxf(0.0f, tangentSpeed - friction * normalImpulse);
+
+                piece.velocity = normal * (normalVelocity + normalImpulse);
+                if (tangentSpeed > 1.0e-6f)
+                    piece.velocity += tangentVelocity * (newTangentSpeed / tangentSpeed);
+            }
+
+            if (piece.shape == DebrisShape::Sphere)
+                piece.angularVelocity = glm::cross(normal, piece.velocity) / piece.radius;
+            else
+                piece.angularVelocity *= 0.8f;
+        }
+
+        piece.position = target;
+
+        Vector3 angularVelocityDelta = piece.angularVelocity * delta;
+        float angle = glm::length(angularVelocityDelta);
+        if (angle > 1.0e-6f)
+            piece.orientation = glm::normalize(glm::angleAxis(angle, angularVelocityDelta / angle) * piece.orientation);
+
+        if (bHasContact && glm::length2(piece.velocity) < delta * 0.2f && glm::length2(piece.angularVelocity) < delta * 0.2f)
+        {
+            piece.sleepAccumulator += delta;
+            if (piece.sleepAccumulator > debrisSleepDelay)
+            {
+                piece.bIsSleeping = true;
+                piece.velocity = Vector3(0.0f);
+                piece.angularVelocity = Vector3(0.0f);
+            }
+        }
+        else
+            piece.sleepAccumulator = 0.0f;
+    }
+}
+
+bool PhysicsDebris::collide(const Segment &ray, float radius, DebrisSliceData *sliceData, Vector3 &point, Vector3 &normal)
+{
+    Vector3 inflate = Vector3(radius);
+    AABB rayAABB(glm::min(ray.a, ray.b) - inflate, glm::max(ray.a, ray.b) + inflate);
+
+    sliceData->overlaps.clear();
+    staticAABB.testAABB(rayAABB, 0, staticAABB.size(), &sliceData->overlaps);
+    if (sliceData->overlaps.empty())
+        return false;
+
+    sliceData->points.clear();
+    for (auto &index : sliceData->overlaps)
+        staticBodies[index]->getShape()->testRay(ray, &sliceData->points);
+
+    if (sliceData->points.empty())
+        return false;
+
+    auto closest = &sliceData->points[0];
+    for (auto &hit : sliceData->points)
+        if (hit.distance < closest->distance)
+            closest = &hit;
+
+    point = closest->point;
+    normal = closest->normal;
+    // Shapes may report normal of the back side
+    if (glm::dot(normal, ray.b - ray.a) > 0.0f)
+        normal = -normal;
+    return true;
+}
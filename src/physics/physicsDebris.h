@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "math/math.h"
+#include "math/AABBBatch.h"
+#include "physics/shapes/shape.h"
+#include "common/utils.h"
+#include "connector/withCore.h"
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+
+class PhysicsBody;
+class RenderQueue;
+class MeshStatic;
+class Shader;
+
+enum class DebrisShape
+{
+    Sphere = 0,
+    Box = 1,
+    Amount = 2
+};
+
+// Values are in physics space
+struct DebrisPiece
+{
+    Vector3 position;
+    Vector3 velocity;
+    Quat orientation;
+    Vector3 angularVelocity;
+    Vector3 size;
+    float radius;
+    float lifetime;
+    float sleepAccumulator;
+    DebrisShape shape;
+    bool bIsSleeping;
+};
+
+struct DebrisSliceData
+{
+    std::vector<int> overlaps;
+    std::vector<RayCollisionPoint> points;
+};
+
+// Lightweight pieces without actors, bodies or events
+// Pieces collide only with static bodies of the world, not with each other or with dynamic bodies
+// Sleeping pieces wake up when a static body near them is moved, added, removed or disabled
+// Size is the scale of unit mesh: box of 1x1x1 or sphere with diameter of 1
+class PhysicsDebris : public WithCore
+{
+public:
+    EXPORT PhysicsDebris(float simScale);
+
+    // Position, size and velocity are in world space, returns false if maximum amount of pieces is reached
+    EXPORT bool spawn(DebrisShape shape, const Vector3 &position, const Quat &orientation, const Vector3 &size, const Vector3 &velocity, const Vector3 &angularVelocity, float lifetime);
+    EXPORT void clear();
+    // Wakes sleeping pieces inside of the box in world space, for changes the world doesn't see, like a new shape of a static body
+    EXPORT void wake(const AABB &area);
+
+    EXPORT void process(float delta, const Vector3 &gravity, std::vector<PhysicsBody *> *bodies, int slices);
+
+    // Adds every piece as element of main phase, shapes without mesh are not rendered
+    EXPORT void onRenderQueue(RenderQueue *renderQueue);
+    EXPORT void setRenderMesh(DebrisShape shape, MeshStatic *mesh, Shader *shader);
+
+    EXPORT inline int getPiecesAmount() { return pieces.size(); }
+    EXPORT inline DebrisPiece *getPieces() { return pieces.data(); }
+
+    EXPORT inline void setMaxPieces(int maxPieces) { this->maxPieces = maxPieces; }
+    EXPORT inline int getMaxPieces() { return maxPieces; }
+
+    EXPORT inline void setRestitution(float restitution) { this->restitution = restitution; }
+    EXPORT inline void setFriction(float friction) { this->friction = friction; }
+    EXPORT inline void setSimScale(float simScale) { this->simScale = simScale; }
+
+protected:
+    void updateStaticBodies(std::vector<PhysicsBody *> *bodies);
+    void findChangedAreas();
+    void processPieces(int start, int end, float delta, const Vector3 &gravity, DebrisSliceData *sliceData);
+    bool collide(const Segment &ray, float radius, DebrisSliceData *sliceData, Vector3 &point, Vector3 &normal);
+
+    std::vector<DebrisPiece> pieces;
+    std::vector<DebrisSliceData> slicesData;
+
+    // Static bodies are gathered on every step, world may have added or removed them
+    std::vector<PhysicsBody *> staticBodies;
+    std::vector<AABB> staticBoxes;
+    AABBBatch staticAABB;
+
+    // Static bodies of the previous step, removed ones are compared by address only
+    std::vector<PhysicsBody *> previousStaticBodies;
+    std::vector<AABB> previousStaticBoxes;
+    std::unordered_map<PhysicsBody *, int> previousIndexes;
+    // Old and new boxes of changed static bodies and areas to wake, sleeping pieces inside of them wake up
+    std::vector<AABB> changedAreas;
+    AABBBatch changedAABB;
+
+    MeshStatic *meshes[(int)DebrisShape::Amount] = {nullptr, nullptr};
+    Shader *shaders[(int)DebrisShape::Amount] = {nullptr, nullptr};
+
+    float simScale = 1.0f;
+    int maxPieces = 50000;
+    float restitution = 0.3f;
+    float friction = 0.4f;
+
+    std::atomic<int> jobsInFlight = 0;
+};
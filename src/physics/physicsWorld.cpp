@@ -1,8 +1,6 @@
 #include "physicsWorld.h"
-#include <mutex>
 #include <chrono>
-
-std::mutex lock;
+#include <algorithm>
 
 void _prepareBody(std::vector<PhysicsBody *>::iterator bodyStart, std::vector<PhysicsBody *>::iterator bodyEnd)
 {
@@ -23,35 +21,37 @@ void _finishBody(std::vector<PhysicsBody *>::iterator bodyStart, std::vector<Phy
 }
 
 void _collectPairs(
-    std::vector<PhysicsBody *>::iterator bodyStart,
-    std::vector<PhysicsBody *>::iterator bodyEnd,
+    int bodyStart,
+    int bodyEnd,
     std::vector<PhysicsBody *> *bodyList,
+    AABBBatch *bodiesAABB,
     std::vector<BodyPair> *list)
 {
-    for (auto a = bodyStart; a < bodyEnd; a++)
+    // Disabled bodies are stored as empty boxes and never overlap
+    std::vector<int> overlaps;
+    for (int a = bodyStart; a < bodyEnd; a++)
     {
-        if (!(*a)->isEnabled())
+        PhysicsBody *bodyA = (*bodyList)[a];
+        if (!bodyA->isEnabled())
             continue;
-        for (auto b = bodyList->begin(); b != bodyList->end(); b++)
+
+        overlaps.clear();
+        bodiesAABB->testAABB(bodiesAABB->get(a), 0, a, &overlaps);
+
+        for (auto &b : overlaps)
         {
-            if (!(*b)->isEnabled())
-                continue;
+            PhysicsBody *bodyB = (*bodyList)[b];
 
-            if (a == b)
-                break;
+            if (bodyA->getMotionType() == MotionType::Static && bodyB->getMotionType() == MotionType::Static)
+                continue;
 
-            if ((*a)->getMotionType() == MotionType::Static && (*b)->getMotionType() == MotionType::Static)
+            if (bodyA->isSleeping() && bodyB->isSleeping())
                 continue;
 
-            if ((*a)->isSleeping() && (*b)->isSleeping())
+            if (bodyA->isJointedWith(bodyB))
                 continue;
 
-            if ((*a)->checkAABB((*b)->getAABB()))
-            {
-                lock.lock();
-                list->push_back({*a, *b});
-                lock.unlock();
-            }
+            list->push_back({bodyA, bodyB});
         }
     }
 }
@@ -72,30 +72,49 @@ void _solve(
     std::vector<CollisionPair>::iterator pairStart,
     std::vector<CollisionPair>::iterator pairEnd,
     float simScale,
-    float subStep)
+    float subStep,
+    bool bPositions)
+{
+    CollisionSolver collisionSolver(simScale);
+    for (auto pair = pairStart; pair < pairEnd; pair++)
+    {
+        if (bPositions)
+            collisionSolver.solvePosition(pair->a, pair->b, pair->manifold);
+        else
+            collisionSolver.solveVelocity(pair->a, pair->b, pair->manifold, subStep);
+    }
+}
+
+void _solveBatch(
+    std::vector<CollisionPair *>::iterator pairStart,
+    std::vector<CollisionPair *>::iterator pairEnd,
+    float simScale,
+    float subStep,
+    bool bPositions)
 {
     CollisionSolver collisionSolver(simScale);
     for (auto pair = pairStart; pair < pairEnd; pair++)
     {
-        collisionSolver.solve(pair->a, pair->b, pair->manifold, subStep);
+        if (bPositions)
+            collisionSolver.solvePosition((*pair)->a, (*pair)->b, (*pair)->manifold);
+        else
+            collisionSolver.solveVelocity((*pair)->a, (*pair)->b, (*pair)->manifold, subStep);
     }
 }
 
 void _ray(
-    std::vector<PhysicsBody *>::iterator bodyStart,
-    std::vector<PhysicsBody *>::iterator bodyEnd,
+    int bodyStart,
+    int bodyEnd,
+    std::vector<PhysicsBody *> *bodyList,
+    AABBBatch *bodiesAABB,
     const Segment &rayLocal,
     std::vector<PhysicsBodyPoint> *points)
 {
-    for (auto body = bodyStart; body < bodyEnd; body++)
-    {
-        if (!(*body)->checkAABB(rayLocal))
-            continue;
+    std::vector<int> crossed;
+    bodiesAABB->testRay(rayLocal, bodyStart, bodyEnd, &crossed);
 
-        lock.lock();
-        (*body)->castRay(rayLocal, points);
-        lock.unlock();
-    }
+    for (auto &index : crossed)
+        (*bodyList)[index]->castRay(rayLocal, points);
 }
 
 PhysicsWorld::PhysicsWorld(const Vector3 &gravity, float simScale, int stepsPerSecond)
@@ -109,11 +128,27 @@ PhysicsWorld::PhysicsWorld(const Vector3 &gravity, float simScale, int stepsPerS
     logger->logff("Max threads supported: %i (%i)", maxThreads, std::thread::hardware_concurrency());
 }
 
+PhysicsWorld::~PhysicsWorld()
+{
+    for (auto &joint : joints)
+        delete joint;
+    joints.clear();
+    if (debris)
+        delete debris;
+}
+
 void PhysicsWorld::setBasicParameters(const Vector3 &gravity, float simScale, int stepsPerSecond)
 {
     this->gravity = gravity;
     this->simScale = simScale;
     this->subStep = 1.0f / (float)stepsPerSecond;
+    if (debris)
+        debris->setSimScale(simScale);
+}
+
+void PhysicsWorld::setMaxThreads(int maxThreads)
+{
+    this->maxThreads = maxThreads > 0 ? maxThreads : 1;
 }
 
 float PhysicsWorld::getSimScale()
@@ -127,10 +162,26 @@ PhysicsBody *PhysicsWorld::createPhysicsBody(Shape *shape, Actor *actor)
         return nullptr;
     auto newBody = new PhysicsBody(shape, simScale);
     newBody->setActor(actor);
+    // Index is valid from creation, so bodies spawned by collision events have own batch mask in the rest of the step
+    newBody->setWorldIndex(bodies.size());
     bodies.push_back(newBody);
     return newBody;
 }
 
+Joint6DOF *PhysicsWorld::createJoint6DOF(PhysicsBody *a, PhysicsBody *b, const Vector3 &anchor, const Constraint6DOFDescriptor &descriptor)
+{
+    if (!a || a == b)
+        return nullptr;
+    auto newJoint = new Joint6DOF(a, b, anchor * simScale, descriptor);
+    joints.push_back(newJoint);
+    if (b)
+    {
+        a->addJointedBody(b);
+        b->addJointedBody(a);
+    }
+    return newJoint;
+}
+
 void PhysicsWorld::process(float delta)
 {
     deltaAccumulator += delta;
@@ -145,15 +196,44 @@ void PhysicsWorld::process(float delta)
         applyForces();
         findCollisionPairs(&pairs);
         findCollisions(&pairs, &collisionCollector);
-        solveSollisions(&collisionCollector);
+        prepareContactBatches(&collisionCollector);
+        solveContacts(&collisionCollector, true);
+        solveVelocities(&collisionCollector);
         finishStep();
+        solveJointPositions();
+        if (debris)
+            debris->process(subStep, gravity * simScale, &bodies, getSlicesAmount(debris->getPiecesAmount()));
+        if (bKeepContactPoints)
+            keepContactPoints(&collisionCollector);
         triggerCollisionEvents(&collisionCollector);
         removeNotPersistedCollisions();
     }
 }
 
+PhysicsDebris *PhysicsWorld::getDebris()
+{
+    if (!debris)
+        debris = new PhysicsDebris(simScale);
+    return debris;
+}
+
 void PhysicsWorld::removeDestroyed()
 {
+    auto joint = joints.begin();
+    while (joint != joints.end())
+        if ((*joint)->isDestroyed() || (*joint)->getBodyA()->isDestroyed() || ((*joint)->getBodyB() && (*joint)->getBodyB()->isDestroyed()))
+        {
+            if ((*joint)->getBodyB())
+            {
+                (*joint)->getBodyA()->removeJointedBody((*joint)->getBodyB());
+                (*joint)->getBodyB()->removeJointedBody((*joint)->getBodyA());
+            }
+            delete (*joint);
+            joint = joints.erase(joint);
+        }
+        else
+            ++joint;
+
     auto body = bodies.begin();
     while (body != bodies.end())
         if ((*body)->isDestroyed())
@@ -163,54 +243,151 @@ void PhysicsWorld::removeDestroyed()
         }
         else
             ++body;
+
+    for (int i = 0; i < (int)bodies.size(); i++)
+        bodies[i]->setWorldIndex(i);
 }
 
 std::vector<PhysicsBodyPoint> PhysicsWorld::castRay(const Segment &ray)
 {
     std::vector<PhysicsBodyPoint> points;
-    int bodiesPerThread = bodies.size() / maxThreads;
     Segment rayLocal = Segment(ray.a * simScale, ray.b * simScale);
-    std::vector<PhysicsBody *>::iterator currentBody = bodies.begin();
+    int bodiesAmount = bodies.size();
+    int slices = getSlicesAmount(bodiesAmount);
+    auto pBodies = &bodies;
+    AABBBatch rayAABB;
+    auto bodiesAABB = &rayAABB;
+    std::atomic<int> rayJobsInFlight = 0;
+
+    fillAABBBatch(bodiesAABB);
 
-    if (core->isBusy())
+    if (slices == 1)
     {
-        _ray(currentBody, bodies.end(), rayLocal, &points);
+        _ray(0, bodiesAmount, pBodies, bodiesAABB, rayLocal, &points);
     }
     else
     {
-        for (int i = 0; i < maxThreads; i++)
+        // every slice collects own points, merged in slice order
+        std::vector<std::vector<PhysicsBodyPoint>> slicePoints(slices);
+        int bodiesPerThread = bodiesAmount / slices;
+        int currentBody = 0;
+        for (int i = 0; i < slices; i++)
         {
-            auto end = (i == maxThreads - 1) ? bodies.end() : currentBody + bodiesPerThread;
+            int end = (i == slices - 1) ? bodiesAmount : currentBody + bodiesPerThread;
+            auto list = &slicePoints[i];
 
-            core->queueJob([currentBody, end, &rayLocal, &points]
-                           { _ray(currentBody, end, rayLocal, &points); });
+            core->queueJob([currentBody, end, pBodies, bodiesAABB, &rayLocal, list]
+                           { _ray(currentBody, end, pBodies, bodiesAABB, rayLocal, list); },
+                           &rayJobsInFlight);
 
             currentBody += bodiesPerThread;
         }
-        while (core->isBusy())
-        {
-        };
+        core->waitForJobs(&rayJobsInFlight);
+
+        for (auto &list : slicePoints)
+            points.insert(points.end(), list.begin(), list.end());
     }
     return points;
 }
 
+std::vector<std::vector<PhysicsBodyPoint>> PhysicsWorld::castRays(const std::vector<Segment> &rays)
+{
+    int raysAmount = rays.size();
+    std::vector<std::vector<PhysicsBodyPoint>> points(raysAmount);
+    std::vector<Segment> raysLocal(raysAmount);
+    for (int i = 0; i < raysAmount; i++)
+        raysLocal[i] = Segment(rays[i].a * simScale, rays[i].b * simScale);
+
+    AABBBatch rayAABB;
+    std::atomic<int> rayJobsInFlight = 0;
+    fillAABBBatch(&rayAABB);
+
+    // Bounding boxes are shared by all rays, every slice handles own rays
+    int bodiesAmount = bodies.size();
+    int slices = getSlicesAmount(raysAmount);
+    int raysPerThread = raysAmount / slices;
+    int currentRay = 0;
+    auto pBodies = &bodies;
+    auto bodiesAABB = &rayAABB;
+    auto pRaysLocal = &raysLocal;
+    auto pPoints = &points;
+
+    for (int i = 0; i < slices; i++)
+    {
+        int end = (i == slices - 1) ? raysAmount : currentRay + raysPerThread;
+
+        core->queueJob([currentRay, end, bodiesAmount, pBodies, bodiesAABB, pRaysLocal, pPoints]
+                       {
+                            for (int r = currentRay; r < end; r++)
+                                _ray(0, bodiesAmount, pBodies, bodiesAABB, (*pRaysLocal)[r], &(*pPoints)[r]); },
+                       &rayJobsInFlight);
+
+        currentRay += raysPerThread;
+    }
+    core->waitForJobs(&rayJobsInFlight);
+
+    return points;
+}
+
+void PhysicsWorld::processWorlds(const std::vector<PhysicsWorld *> &worlds, float delta)
+{
+    if (worlds.empty())
+        return;
+
+    // Every world is a separate job, phases of the world are queued as its own jobs
+    // Waiting threads help to execute queued jobs, so worlds don't block each other
+    Core *core = worlds[0]->core;
+    std::atomic<int> worldsInFlight = 0;
+    for (auto &world : worlds)
+    {
+        core->queueJob([world, delta]
+                       { world->process(delta); },
+                       &worldsInFlight);
+    }
+    core->waitForJobs(&worldsInFlight);
+}
+
+void PhysicsWorld::fillAABBBatch(AABBBatch *batch)
+{
+    int bodiesAmount = bodies.size();
+    batch->resize(bodiesAmount);
+    for (int i = 0; i < bodiesAmount; i++)
+    {
+        if (bodies[i]->isEnabled())
+            batch->set(i, bodies[i]->getAABB());
+        else
+            batch->setEmpty(i);
+    }
+}
+
+int PhysicsWorld::getSlicesAmount(int itemsAmount)
+{
+    // Small worlds are processed by calling thread, splitting them costs more than it gives
+    int slices = itemsAmount / MIN_ITEMS_PER_JOB;
+    if (slices > maxThreads)
+        slices = maxThreads;
+    if (slices < 1)
+        slices = 1;
+    return slices;
+}
+
 // Prepare global before multiple physics steps
 void PhysicsWorld::prepareBodies()
 {
-    int bodiesPerThread = bodies.size() / maxThreads;
+    int slices = getSlicesAmount(bodies.size());
+    int bodiesPerThread = bodies.size() / slices;
     std::vector<PhysicsBody *>::iterator currentBody = bodies.begin();
-    for (int i = 0; i < maxThreads; i++)
+    for (int i = 0; i < slices; i++)
     {
-        auto end = (i == maxThreads - 1) ? bodies.end() : currentBody + bodiesPerThread;
+        auto end = (i == slices - 1) ? bodies.end() : currentBody + bodiesPerThread;
 
         core->queueJob([currentBody, end]
-                       { _prepareBody(currentBody, end); });
+                       { _prepareBody(currentBody, end); },
+                       &jobsInFlight);
 
         currentBody += bodiesPerThread;
     }
-    while (core->isBusy())
-    {
-    };
+    core->waitForJobs(&jobsInFlight);
 }
 
 // Process gravitation and forces on each body
@@ -218,104 +395,243 @@ void PhysicsWorld::applyForces()
 {
     float subStep = this->subStep;
     Vector3 localGravity = gravity * simScale;
-    int bodiesPerThread = bodies.size() / maxThreads;
+    int slices = getSlicesAmount(bodies.size());
+    int bodiesPerThread = bodies.size() / slices;
     std::vector<PhysicsBody *>::iterator currentBody = bodies.begin();
-    for (int i = 0; i < maxThreads; i++)
+    for (int i = 0; i < slices; i++)
     {
-        auto end = (i == maxThreads - 1) ? bodies.end() : currentBody + bodiesPerThread;
+        auto end = (i == slices - 1) ? bodies.end() : currentBody + bodiesPerThread;
         core->queueJob([currentBody, end, subStep, localGravity]
-                       { _processBody(currentBody, end, subStep, localGravity); });
+                       { _processBody(currentBody, end, subStep, localGravity); },
+                       &jobsInFlight);
 
         currentBody += bodiesPerThread;
     }
-    while (core->isBusy())
-    {
-    };
+    core->waitForJobs(&jobsInFlight);
 }
 
 void PhysicsWorld::findCollisionPairs(std::vector<BodyPair> *pairs)
 {
     // find possible collision pairs
-    int bodiesPerThread = bodies.size() / maxThreads;
+    fillAABBBatch(&bodiesAABB);
+
+    int bodiesAmount = bodies.size();
+    int slices = getSlicesAmount(bodiesAmount);
+    int bodiesPerThread = bodiesAmount / slices;
     std::vector<PhysicsBody *> *pBodies = &bodies;
-    std::vector<PhysicsBody *>::iterator currentBody = pBodies->begin();
-    for (int i = 0; i < maxThreads; i++)
+    AABBBatch *bodiesAABB = &this->bodiesAABB;
+    int currentBody = 0;
+
+    // every slice collects own pairs, merged in slice order
+    if ((int)slicePairs.size() < slices)
+        slicePairs.resize(slices);
+
+    for (int i = 0; i < slices; i++)
     {
-        auto end = (i == maxThreads - 1) ? pBodies->end() : currentBody + bodiesPerThread;
+        int end = (i == slices - 1) ? bodiesAmount : currentBody + bodiesPerThread;
+        auto list = &slicePairs[i];
+        list->clear();
 
-        core->queueJob([currentBody, end, pBodies, pairs]
-                       { _collectPairs(currentBody, end, pBodies, pairs); });
+        core->queueJob([currentBody, end, pBodies, bodiesAABB, list]
+                       { _collectPairs(currentBody, end, pBodies, bodiesAABB, list); },
+                       &jobsInFlight);
 
         currentBody += bodiesPerThread;
     }
-    while (core->isBusy())
-    {
-    };
+    core->waitForJobs(&jobsInFlight);
+
+    for (int i = 0; i < slices; i++)
+        pairs->insert(pairs->end(), slicePairs[i].begin(), slicePairs[i].end());
 }
 
 void PhysicsWorld::findCollisions(std::vector<BodyPair> *pairs, CollisionCollector *collisionCollector)
 {
     // find exact collisions
-    int pairsPerThread = pairs->size() / maxThreads;
+    int slices = getSlicesAmount(pairs->size());
+    int pairsPerThread = pairs->size() / slices;
     std::vector<BodyPair>::iterator currentPair = pairs->begin();
     auto collisionDispatcher = &this->collisionDispatcher;
 
-    for (int i = 0; i < maxThreads; i++)
+    // every slice has own collector, merged in slice order so contacts keep order of pairs
+    while ((int)sliceCollectors.size() < slices)
+        sliceCollectors.emplace_back();
+
+    for (int i = 0; i < slices; i++)
     {
-        auto end = (i == maxThreads - 1) ? pairs->end() : currentPair + pairsPerThread;
+        auto end = (i == slices - 1) ? pairs->end() : currentPair + pairsPerThread;
+        auto sliceCollector = &sliceCollectors[i];
+        sliceCollector->clear();
 
-        core->queueJob([currentPair, end, collisionDispatcher, collisionCollector]
-                       { _collide(currentPair, end, collisionDispatcher, collisionCollector); });
+        core->queueJob([currentPair, end, collisionDispatcher, sliceCollector]
+                       { _collide(currentPair, end, collisionDispatcher, sliceCollector); },
+                       &jobsInFlight);
 
         currentPair += pairsPerThread;
     }
-    while (core->isBusy())
-    {
-    };
+    core->waitForJobs(&jobsInFlight);
+
+    for (int i = 0; i < slices; i++)
+        collisionCollector->pairs.insert(collisionCollector->pairs.end(), sliceCollectors[i].pairs.begin(), sliceCollectors[i].pairs.end());
 }
 
-void PhysicsWorld::solveSollisions(CollisionCollector *collisionCollector)
+void PhysicsWorld::solveContacts(CollisionCollector *collisionCollector, bool bPositions)
 {
+    if (bIsDeterministic)
+    {
+        solveContactsDeterministic(bPositions);
+        return;
+    }
+
     if (!collisionCollector->pairs.empty())
     {
-        int pairsPerThread = collisionCollector->pairs.size() / maxThreads;
+        int slices = getSlicesAmount(collisionCollector->pairs.size());
+        int pairsPerThread = collisionCollector->pairs.size() / slices;
         std::vector<CollisionPair>::iterator currentCollisionPair = collisionCollector->pairs.begin();
 
         float simScale = this->simScale;
         float subStep = this->subStep;
-        for (int i = 0; i < maxThreads; i++)
+        for (int i = 0; i < slices; i++)
         {
-            auto end = (i == maxThreads - 1) ? collisionCollector->pairs.end() : currentCollisionPair + pairsPerThread;
+            auto end = (i == slices - 1) ? collisionCollector->pairs.end() : currentCollisionPair + pairsPerThread;
 
-            core->queueJob([currentCollisionPair, end, simScale, subStep]
-                           { _solve(currentCollisionPair, end, simScale, subStep); });
+            core->queueJob([currentCollisionPair, end, simScale, subStep, bPositions]
+                           { _solve(currentCollisionPair, end, simScale, subStep, bPositions); },
+                           &jobsInFlight);
 
             currentCollisionPair += pairsPerThread;
         }
-        while (core->isBusy())
+        core->waitForJobs(&jobsInFlight);
+    }
+}
+
+// Contacts are split into batches in order of pairs, so batches don't depend on amount of threads
+// Contacts of one batch don't share dynamic bodies and can be solved in any order
+// Contacts which don't fit into 64 batches are left for the last batch solved by one thread
+// Batches are built once per step and used by the position pass and every velocity iteration
+void PhysicsWorld::prepareContactBatches(CollisionCollector *collisionCollector)
+{
+    const int maxBatches = CONTACT_BATCHES;
+
+    contactBatchesAmount = 0;
+    if (!bIsDeterministic)
+        return;
+
+    bodyBatchMasks.assign(bodies.size(), 0);
+    if ((int)contactBatches.size() < maxBatches + 1)
+        contactBatches.resize(maxBatches + 1);
+    for (auto &batch : contactBatches)
+        batch.clear();
+
+    for (auto &pair : collisionCollector->pairs)
+    {
+        bool bDynamicA = pair.a->getMotionType() != MotionType::Static;
+        bool bDynamicB = pair.b->getMotionType() != MotionType::Static;
+        unsigned long long used = (bDynamicA ? bodyBatchMasks[pair.a->getWorldIndex()] : 0) |
+                                  (bDynamicB ? bodyBatchMasks[pair.b->getWorldIndex()] : 0);
+
+        int batch = 0;
+        while (batch < maxBatches && (used & (1ULL << batch)))
+            batch++;
+
+        if (batch < maxBatches)
+        {
+            if (bDynamicA)
+                bodyBatchMasks[pair.a->getWorldIndex()] |= 1ULL << batch;
+            if (bDynamicB)
+                bodyBatchMasks[pair.b->getWorldIndex()] |= 1ULL << batch;
+        }
+
+        contactBatches[batch].push_back(&pair);
+        if (batch + 1 > contactBatchesAmount)
+            contactBatchesAmount = batch + 1;
+    }
+}
+
+void PhysicsWorld::solveContactsDeterministic(bool bPositions)
+{
+    float simScale = this->simScale;
+    float subStep = this->subStep;
+    for (int batch = 0; batch < contactBatchesAmount; batch++)
+    {
+        auto &contacts = contactBatches[batch];
+        if (contacts.empty())
+            continue;
+
+        int slices = batch < CONTACT_BATCHES ? getSlicesAmount(contacts.size()) : 1;
+        int pairsPerThread = contacts.size() / slices;
+        auto currentCollisionPair = contacts.begin();
+        for (int i = 0; i < slices; i++)
         {
-        };
+            auto end = (i == slices - 1) ? contacts.end() : currentCollisionPair + pairsPerThread;
+
+            core->queueJob([currentCollisionPair, end, simScale, subStep, bPositions]
+                           { _solveBatch(currentCollisionPair, end, simScale, subStep, bPositions); },
+                           &jobsInFlight);
+
+            currentCollisionPair += pairsPerThread;
+        }
+        core->waitForJobs(&jobsInFlight);
+    }
+}
+
+// Joint and contact rows go through the same velocity iterations, so an impulse of a joint that pushes a body
+// into the ground is answered by the contact in the next iteration instead of the next step
+// Joint chains depend on each other, so joint rows are solved by one thread
+void PhysicsWorld::solveVelocities(CollisionCollector *collisionCollector)
+{
+    bool bHasJoints = !joints.empty();
+    if (bHasJoints)
+        jointSolver.prepare(joints, subStep);
+
+    int iterations = bHasJoints ? std::max(jointIterations, 1) : 1;
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        solveContacts(collisionCollector, false);
+        if (bHasJoints)
+            jointSolver.solve(1);
     }
+
+    if (bHasJoints)
+        jointSolver.storeImpulses();
+}
+
+void PhysicsWorld::solveJointPositions()
+{
+    if (joints.empty() || jointPositionIterations <= 0)
+        return;
+
+    jointSolver.solvePositions(joints, jointPositionIterations);
 }
 
 void PhysicsWorld::finishStep()
 {
-    int bodiesPerThread = bodies.size() / maxThreads;
+    int slices = getSlicesAmount(bodies.size());
+    int bodiesPerThread = bodies.size() / slices;
     std::vector<PhysicsBody *>::iterator currentBody = bodies.begin();
     float subStep = this->subStep;
 
-    for (int i = 0; i < maxThreads; i++)
+    for (int i = 0; i < slices; i++)
     {
-        auto end = (i == maxThreads - 1) ? bodies.end() : currentBody + bodiesPerThread;
+        auto end = (i == slices - 1) ? bodies.end() : currentBody + bodiesPerThread;
 
         core->queueJob([currentBody, end, subStep]
-                       { _finishBody(currentBody, end, subStep); });
+                       { _finishBody(currentBody, end, subStep); },
+                       &jobsInFlight);
 
         currentBody += bodiesPerThread;
     }
-    while (core->isBusy())
-    {
-    };
+    core->waitForJobs(&jobsInFlight);
+}
+
+void PhysicsWorld::keepContactPoints(CollisionCollector *collisionCollector)
+{
+    contactPoints.clear();
+    for (auto &pair : collisionCollector->pairs)
+        for (int i = 0; i < pair.manifold.collisionAmount; i++)
+        {
+            contactPoints.push_back(pair.manifold.pointsOnA[i] / simScale);
+            contactPoints.push_back(pair.manifold.pointsOnB[i] / simScale);
+        }
 }
 
 void PhysicsWorld::triggerCollisionEvents(CollisionCollector *collisionCollector)
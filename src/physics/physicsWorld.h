@@ -3,10 +3,21 @@
 #include "physics/physicsBody.h"
 #include "physics/collisionSolver.h"
 #include "physics/collisionDispatcher.h"
+#include "physics/joint6DOF.h"
+#include "physics/jointSolver.h"
+#include "physics/physicsDebris.h"
 #include "physics/shapes/shape.h"
+#include "math/AABBBatch.h"
 #include "connector/withLogger.h"
 #include "connector/withCore.h"
 #include <vector>
+#include <deque>
+#include <atomic>
+
+// Phases with less items than this are not split between threads
+#define MIN_ITEMS_PER_JOB 32
+// Contacts of deterministic mode are split into this amount of batches without shared bodies plus one serial batch
+#define CONTACT_BATCHES 64
 
 struct BodyPair
 {
@@ -20,27 +31,78 @@ class PhysicsWorld : public WithLogger, public WithCore
 {
 public:
     EXPORT PhysicsWorld(const Vector3 &gravity, float simScale, int stepsPerSecond);
+    EXPORT ~PhysicsWorld();
     EXPORT void setBasicParameters(const Vector3 &gravity, float simScale, int stepsPerSecond);
 
     EXPORT float getSimScale();
 
     EXPORT PhysicsBody *createPhysicsBody(Shape *shape, Actor *actor = nullptr);
+
+    // Joins two bodies at anchor point in world space, second body may be null to join the first one with the world
+    // Joint is removed with any of its bodies or by calling destroy on it
+    EXPORT Joint6DOF *createJoint6DOF(PhysicsBody *a, PhysicsBody *b, const Vector3 &anchor, const Constraint6DOFDescriptor &descriptor);
+
+    // Amount of velocity iterations on every step of a world with joints
+    // Joint and contact rows are solved together in every iteration, world without joints solves contacts once
+    EXPORT inline void setJointIterations(int iterations) { this->jointIterations = iterations; }
+    EXPORT inline int getJointIterations() { return jointIterations; }
+    // Amount of position correction iterations after integration, fixes drift of long chains
+    EXPORT inline void setJointPositionIterations(int iterations) { this->jointPositionIterations = iterations; }
+    EXPORT inline int getJointPositionIterations() { return jointPositionIterations; }
+    EXPORT inline void setJointBlockSolving(bool state) { jointSolver.setBlockSolving(state); }
     EXPORT void process(float delta);
     EXPORT void removeDestroyed();
 
+    // Debris pieces are stepped together with bodies, created on first call
+    EXPORT PhysicsDebris *getDebris();
+    // Checks debris without creating it
+    EXPORT inline bool hasDebris() { return debris && debris->getPiecesAmount() > 0; }
+
+    // Makes results independent from amount of threads, for replays and lockstep multiplayer
+    // Bodies are ordered by creation, contacts are solved in fixed batches without shared bodies
+    EXPORT inline void setDeterministic(bool state) { bIsDeterministic = state; }
+    EXPORT inline bool isDeterministic() { return bIsDeterministic; }
+
+    // Contact points of the last step are kept for debug view, world space, points on A and on B go in turns
+    EXPORT inline void setContactPointsKept(bool state) { bKeepContactPoints = state; contactPoints.clear(); }
+    EXPORT inline bool isContactPointsKept() { return bKeepContactPoints; }
+    EXPORT inline const std::vector<Vector3> &getContactPoints() { return contactPoints; }
+
+    // Limits amount of jobs every phase is split into, hardware concurrency - 1 by default
+    EXPORT void setMaxThreads(int maxThreads);
+    EXPORT inline int getMaxThreads() { return maxThreads; }
+
     EXPORT std::vector<PhysicsBodyPoint> castRay(const Segment &ray);
 
+    // Casts many rays at once, bounding boxes of bodies are prepared once for all of them
+    // Result has list of points for every ray in the same order
+    EXPORT std::vector<std::vector<PhysicsBodyPoint>> castRays(const std::vector<Segment> &rays);
+
+    // Steps every world as separate concurrent job on the core
+    // Worlds should not share bodies, collision events are called from worker threads
+    EXPORT static void processWorlds(const std::vector<PhysicsWorld *> &worlds, float delta);
+
 protected:
+    int getSlicesAmount(int itemsAmount);
+    // Ray queries fill own batch, so they may run while other queries or the step use the shared one
+    void fillAABBBatch(AABBBatch *batch);
+
     void prepareBodies();
     void applyForces();
     void findCollisionPairs(std::vector<BodyPair> *pairs);
     void findCollisions(std::vector<BodyPair> *pairs, CollisionCollector *collisionCollector);
-    void solveSollisions(CollisionCollector *collisionCollector);
+    void prepareContactBatches(CollisionCollector *collisionCollector);
+    void solveContacts(CollisionCollector *collisionCollector, bool bPositions);
+    void solveContactsDeterministic(bool bPositions);
+    void solveVelocities(CollisionCollector *collisionCollector);
+    void solveJointPositions();
     void finishStep();
     void triggerCollisionEvents(CollisionCollector *collisionCollector);
+    void keepContactPoints(CollisionCollector *collisionCollector);
     void removeNotPersistedCollisions();
 
     std::vector<PhysicsBody *> bodies;
+    AABBBatch bodiesAABB;
     CollisionDispatcher collisionDispatcher;
 
     Vector3 gravity;
@@ -49,6 +111,25 @@ protected:
 
     float simScale = 0.01f;
     int maxThreads;
+    std::vector<Joint6DOF *> joints;
+    JointSolver jointSolver;
+    int jointIterations = 8;
+    int jointPositionIterations = 3;
+    PhysicsDebris *debris = nullptr;
+
     std::vector<BodyPair> pairs;
+    std::vector<std::vector<BodyPair>> slicePairs;
     CollisionCollector collisionCollector;
+    // Collectors are not movable, deque keeps them in place while growing
+    std::deque<CollisionCollector> sliceCollectors;
+
+    bool bIsDeterministic = false;
+    bool bKeepContactPoints = false;
+    std::vector<Vector3> contactPoints;
+    std::vector<unsigned long long> bodyBatchMasks;
+    std::vector<std::vector<CollisionPair *>> contactBatches;
+    int contactBatchesAmount = 0;
+
+    // Jobs of this world only, other worlds may use the core at the same time
+    std::atomic<int> jobsInFlight = 0;
 };
\ No newline at end of file
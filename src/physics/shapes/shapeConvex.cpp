@@ -77,7 +77,8 @@ bool ShapeConvex::testRay(const Segment &line, std::vector<RayCollisionPoint> *p
         // Test if segment runs parallel to the plane
         if (denom == 0.0f)
         {
-            if (lineOriginDistance > 0.0f)
+            // Parallel segment misses when it starts outside of the plane
+            if (lineOriginDistance < 0.0f)
                 return false;
         }
         else
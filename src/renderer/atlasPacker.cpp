@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/atlasPacker.h"
+#include <algorithm>
+
+AtlasPacker::AtlasPacker(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    reset();
+}
+
+void AtlasPacker::reset()
+{
+    skyline.clear();
+    skyline.push_back({0, 0, width});
+    usedArea = 0;
+}
+
+bool AtlasPacker::insert(int width, int height, int *x, int *y)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+
+    int bestIndex = -1, bestTop = 0, bestWidth = 0;
+    for (int i = 0; i < (int)skyline.size(); i++)
+    {
+        int top = fit(i, width, height);
+        if (top < 0)
+            continue;
+        top += height;
+        if (bestIndex < 0 || top < bestTop || (top == bestTop && skyline[i].width < bestWidth))
+        {
+            bestIndex = i;
+            bestTop = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (bestIndex < 0)
+        return false;
+
+    *x = skyline[bestIndex].x;
+    *y = bestTop - height;
+    addNode(bestIndex, *x, *y, width, height);
+    usedArea += (long long)width * height;
+    return true;
+}
+
+float AtlasPacker::getOccupancy()
+{
+    return (float)((double)usedArea / ((double)width * height));
+}
+
+int AtlasPacker::fit(int index, int width, int height)
+{
+    if (skyline[index].x + width > this->width)
+        return -1;
+
+    int y = 0;
+    int widthLeft = width;
+    for (int i = index; widthLeft > 0 && i < (int)skyline.size(); i++)
+    {
+        y = std::max(y, skyline[i].y);
+        if (y + height > this->height)
+            return -1;
+        widthLeft -= skyline[i].width;
+    }
+    return y;
+}
+
+void AtlasPacker::addNode(int index, int x, int y, int width, int height)
+{
+    skyline.insert(skyline.begin() + index, {x, y + height, width});
+
+    // Nodes covered by the new one are cut or dropped
+    int i = index + 1;
+    while (i < (int)skyline.size())
+    {
+        AtlasSkylineNode &previous = skyline[i - 1];
+        int shrink = previous.x + previous.width - skyline[i].x;
+        if (shrink <= 0)
+            break;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0)
+            break;
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // Neighbours of the same height become one node
+    for (i = 0; i + 1 < (int)skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            i++;
+    }
+}
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include <vector>
+
+// Segment of the upper outline of packed rectangles
+struct AtlasSkylineNode
+{
+    int x;
+    int y;
+    int width;
+};
+
+// Skyline packer, rectangle goes where its top ends lowest, narrowest segment wins ties
+// Works on sizes only and needs no graphics context
+class AtlasPacker
+{
+public:
+    EXPORT AtlasPacker(int width, int height);
+
+    EXPORT void reset();
+    // False when rectangle doesn't fit, position is left untouched then
+    EXPORT bool insert(int width, int height, int *x, int *y);
+
+    // Part of the area taken by rectangles
+    EXPORT float getOccupancy();
+
+    inline int getWidth() { return width; }
+    inline int getHeight() { return height; }
+
+protected:
+    // Top of the rectangle placed at the start of the node, -1 if it doesn't fit there
+    int fit(int index, int width, int height);
+    void addNode(int index, int x, int y, int width, int height);
+
+    int width;
+    int height;
+    long long usedArea = 0;
+    std::vector<AtlasSkylineNode> skyline;
+};
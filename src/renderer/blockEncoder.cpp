@@ -0,0 +1,429 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/blockEncoder.h"
+#include "loaders/stb_image.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+// Weights of 4 bit indexes of BC7 out of 64
+static const int weightsBC7[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+static inline int quantize(float value, int maximum)
+{
+    return std::max(0, std::min(maximum, (int)(value * maximum / 255.0f + 0.5f)));
+}
+
+// Bits go from the lowest one of the first byte
+static inline void writeBits(unsigned char *block, int &position, unsigned int value, int bits)
+{
+    for (int i = 0; i < bits; i++, position++)
+        if (value & (1u << i))
+            block[position >> 3] |= 1 << (position & 7);
+}
+
+bool BlockEncoder::encode(const unsigned char *rgba, int width, int height, TextureFormat format, bool bMipmaps, CompressedImage *result)
+{
+    if (!rgba || width <= 0 || height <= 0 || format == TextureFormat::ETC2RGB || format == TextureFormat::ETC2RGBA)
+        return false;
+
+    result->setup(format, width, height);
+    int blockSize = CompressedImage::getBlockSize(format);
+
+    std::vector<unsigned char> current, next;
+    const unsigned char *source = rgba;
+    unsigned char pixels[64];
+    while (true)
+    {
+        auto level = result->addLevel(width, height);
+        unsigned char *block = level->data.data();
+        for (int y = 0; y < height; y += 4)
+            for (int x = 0; x < width; x += 4, block += blockSize)
+            {
+                getBlock(source, width, height, x, y, pixels);
+                switch (format)
+                {
+                case TextureFormat::BC1:
+                    encodeBlockBC1(pixels, block);
+                    break;
+                case TextureFormat::BC3:
+                    encodeBlockBC3(pixels, block);
+                    break;
+                case TextureFormat::BC5:
+                    encodeBlockBC5(pixels, block);
+                    break;
+                default:
+                    encodeBlockBC7(pixels, block);
+                    break;
+                }
+            }
+
+        if (!bMipmaps || (width == 1 && height == 1))
+            break;
+
+        downsample(source, width, height, next);
+        current.swap(next);
+        source = current.data();
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return true;
+}
+
+bool BlockEncoder::encodeFile(const std::string &path, TextureFormat format, bool bMipmaps, CompressedImage *result)
+{
+    int width, height, channels;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data)
+        return false;
+
+    bool bEncoded = encode(data, width, height, format, bMipmaps, result);
+    stbi_image_free(data);
+    return bEncoded;
+}
+
+void BlockEncoder::encodeBlockBC1(const unsigned char *pixels, unsigned char *block)
+{
+    float points[48];
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++)
+            points[i * 3 + c] = pixels[i * 4 + c];
+
+    float mean[4], axis[4];
+    getMainAxis(points, 3, mean, axis);
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < 3; c++)
+            t += (points[i * 3 + c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float start[3], end[3];
+    for (int c = 0; c < 3; c++)
+    {
+        start[c] = mean[c] + axis[c] * maxT;
+        end[c] = mean[c] + axis[c] * minT;
+    }
+    int error = encodeColorsBC1(pixels, start, end, block);
+    if (error == 0)
+        return;
+
+    // Least squares fit of endpoints to the picked indexes, kept if it is closer
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    unsigned int indexes = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        float a = weights[(indexes >> (i * 2)) & 3];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; c++)
+        {
+            ax[c] += a * points[i * 3 + c];
+            bx[c] += b * points[i * 3 + c];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 0.0001f)
+        return;
+
+    for (int c = 0; c < 3; c++)
+    {
+        start[c] = std::max(0.0f, std::min(255.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+        end[c] = std::max(0.0f, std::min(255.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+    }
+
+    unsigned char refined[8];
+    if (encodeColorsBC1(pixels, start, end, refined) < error)
+        memcpy(block, refined, 8);
+}
+
+void BlockEncoder::encodeBlockBC3(const unsigned char *pixels, unsigned char *block)
+{
+    encodeBlockBC4(pixels, 3, block);
+    encodeBlockBC1(pixels, block + 8);
+}
+
+void BlockEncoder::encodeBlockBC4(const unsigned char *pixels, int channel, unsigned char *block)
+{
+    int minimum = 255, maximum = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minimum = std::min(minimum, (int)pixels[i * 4 + channel]);
+        maximum = std::max(maximum, (int)pixels[i * 4 + channel]);
+    }
+
+    // The first value bigger than the second one selects 8 values between them
+    int palette[8] = {maximum, minimum};
+    for (int i = 2; i < 8; i++)
+        palette[i] = ((8 - i) * maximum + (i - 1) * minimum + 3) / 7;
+
+    memset(block, 0, 8);
+    block[0] = maximum;
+    block[1] = minimum;
+    int position = 16;
+    for (int i = 0; i < 16; i++)
+    {
+        int value = pixels[i * 4 + channel];
+        int best = 0;
+        for (int j = 1; j < 8 && maximum != minimum; j++)
+            if (abs(palette[j] - value) < abs(palette[best] - value))
+                best = j;
+        writeBits(block, position, best, 3);
+    }
+}
+
+void BlockEncoder::encodeBlockBC5(const unsigned char *pixels, unsigned char *block)
+{
+    encodeBlockBC4(pixels, 0, block);
+    encodeBlockBC4(pixels, 1, block + 8);
+}
+
+void BlockEncoder::encodeBlockBC7(const unsigned char *pixels, unsigned char *block)
+{
+    float points[64];
+    for (int i = 0; i < 64; i++)
+        points[i] = pixels[i];
+
+    float mean[4], axis[4];
+    getMainAxis(points, 4, mean, axis);
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < 4; c++)
+            t += (points[i * 4 + c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    // Endpoints have 7 bits per channel and one shared lowest bit, the bit with smaller error is taken
+    int quantized[2][4], pBits[2], endpoints[2][4];
+    for (int e = 0; e < 2; e++)
+    {
+        float t = e == 0 ? minT : maxT;
+        int bestError = -1;
+        for (int p = 0; p < 2; p++)
+        {
+            int error = 0, candidate[4];
+            for (int c = 0; c < 4; c++)
+            {
+                float value = std::max(0.0f, std::min(255.0f, mean[c] + axis[c] * t));
+                candidate[c] = std::max(0, std::min(127, (int)((value - p) / 2.0f + 0.5f)));
+                int difference = ((candidate[c] << 1) | p) - (int)(value + 0.5f);
+                error += difference * difference;
+            }
+            if (bestError < 0 || error < bestError)
+            {
+                bestError = error;
+                pBits[e] = p;
+                for (int c = 0; c < 4; c++)
+                    quantized[e][c] = candidate[c];
+            }
+        }
+        for (int c = 0; c < 4; c++)
+            endpoints[e][c] = (quantized[e][c] << 1) | pBits[e];
+    }
+
+    int palette[16][4];
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 4; c++)
+            palette[i][c] = ((64 - weightsBC7[i]) * endpoints[0][c] + weightsBC7[i] * endpoints[1][c] + 32) >> 6;
+
+    int indexes[16];
+    for (int i = 0; i < 16; i++)
+    {
+        int bestError = -1;
+        for (int j = 0; j < 16; j++)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                int difference = palette[j][c] - pixels[i * 4 + c];
+                error += difference * difference;
+            }
+            if (bestError < 0 || error < bestError)
+            {
+                bestError = error;
+                indexes[i] = j;
+            }
+        }
+    }
+
+    // Highest bit of the first index is not stored, endpoints are swapped to make it zero
+    if (indexes[0] & 8)
+    {
+        for (int c = 0; c < 4; c++)
+            std::swap(quantized[0][c], quantized[1][c]);
+        std::swap(pBits[0], pBits[1]);
+        for (int i = 0; i < 16; i++)
+            indexes[i] = 15 - indexes[i];
+    }
+
+    memset(block, 0, 16);
+    int position = 0;
+    writeBits(block, position, 1 << 6, 7);
+    for (int c = 0; c < 4; c++)
+        for (int e = 0; e < 2; e++)
+            writeBits(block, position, quantized[e][c], 7);
+    writeBits(block, position, pBits[0], 1);
+    writeBits(block, position, pBits[1], 1);
+    for (int i = 0; i < 16; i++)
+        writeBits(block, position, indexes[i], i == 0 ? 3 : 4);
+}
+
+void BlockEncoder::getBlock(const unsigned char *rgba, int width, int height, int x, int y, unsigned char *pixels)
+{
+    // Blocks over the edge repeat the last row and column
+    for (int iy = 0; iy < 4; iy++)
+        for (int ix = 0; ix < 4; ix++)
+        {
+            int sx = std::min(x + ix, width - 1);
+            int sy = std::min(y + iy, height - 1);
+            memcpy(pixels + (iy * 4 + ix) * 4, rgba + (sy * width + sx) * 4, 4);
+        }
+}
+
+void BlockEncoder::downsample(const unsigned char *rgba, int width, int height, std::vector<unsigned char> &result)
+{
+    int newWidth = std::max(1, width / 2);
+    int newHeight = std::max(1, height / 2);
+    result.resize(newWidth * newHeight * 4);
+
+    for (int y = 0; y < newHeight; y++)
+        for (int x = 0; x < newWidth; x++)
+        {
+            int x0 = x * 2, x1 = std::min(x * 2 + 1, width - 1);
+            int y0 = y * 2, y1 = std::min(y * 2 + 1, height - 1);
+            for (int c = 0; c < 4; c++)
+            {
+                int sum = rgba[(y0 * width + x0) * 4 + c] + rgba[(y0 * width + x1) * 4 + c] +
+                          rgba[(y1 * width + x0) * 4 + c] + rgba[(y1 * width + x1) * 4 + c];
+                result[(y * newWidth + x) * 4 + c] = (sum + 2) / 4;
+            }
+        }
+}
+
+void BlockEncoder::getMainAxis(const float *points, int channels, float *mean, float *axis)
+{
+    for (int c = 0; c < channels; c++)
+    {
+        mean[c] = 0.0f;
+        for (int i = 0; i < 16; i++)
+            mean[c] += points[i * channels + c];
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+        for (int a = 0; a < channels; a++)
+            for (int b = 0; b < channels; b++)
+                covariance[a][b] += (points[i * channels + a] - mean[a]) * (points[i * channels + b] - mean[b]);
+
+    // Power iteration starts from the diagonal, which is already close for most blocks
+    for (int c = 0; c < channels; c++)
+        axis[c] = 1.0f;
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {}, length = 0.0f;
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+                next[a] += covariance[a][b] * axis[b];
+            length += next[a] * next[a];
+        }
+
+        length = sqrtf(length);
+        if (length < 0.0001f)
+            break;
+        for (int c = 0; c < channels; c++)
+            axis[c] = next[c] / length;
+    }
+
+    float length = 0.0f;
+    for (int c = 0; c < channels; c++)
+        length += axis[c] * axis[c];
+    length = sqrtf(length);
+    for (int c = 0; c < channels; c++)
+        axis[c] /= length;
+}
+
+int BlockEncoder::encodeColorsBC1(const unsigned char *pixels, const float *start, const float *end, unsigned char *block)
+{
+    unsigned int colors[2];
+    int palette[4][3];
+    const float *endpoints[2] = {start, end};
+    for (int e = 0; e < 2; e++)
+    {
+        int r = quantize(endpoints[e][0], 31), g = quantize(endpoints[e][1], 63), b = quantize(endpoints[e][2], 31);
+        colors[e] = (r << 11) | (g << 5) | b;
+        palette[e][0] = (r << 3) | (r >> 2);
+        palette[e][1] = (g << 2) | (g >> 4);
+        palette[e][2] = (b << 3) | (b >> 2);
+    }
+
+    // The first color bigger than the second one selects four colors without transparency
+    bool bSwapped = colors[0] < colors[1];
+    if (bSwapped)
+    {
+        std::swap(colors[0], colors[1]);
+        for (int c = 0; c < 3; c++)
+            std::swap(palette[0][c], palette[1][c]);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    int totalError = 0;
+    unsigned int indexes = 0;
+    for (int i = 0; i < 16 && colors[0] != colors[1]; i++)
+    {
+        int best = 0, bestError = -1;
+        for (int j = 0; j < 4; j++)
+        {
+            int error = 0;
+            for (int c = 0; c < 3; c++)
+            {
+                int difference = palette[j][c] - pixels[i * 4 + c];
+                error += difference * difference;
+            }
+            if (bestError < 0 || error < bestError)
+            {
+                bestError = error;
+                best = j;
+            }
+        }
+        indexes |= best << (i * 2);
+        totalError += bestError;
+    }
+
+    // Equal colors leave all indexes at the first one
+    if (colors[0] == colors[1])
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 3; c++)
+            {
+                int difference = palette[0][c] - pixels[i * 4 + c];
+                totalError += difference * difference;
+            }
+
+    block[0] = colors[0] & 0xFF;
+    block[1] = colors[0] >> 8;
+    block[2] = colors[1] & 0xFF;
+    block[3] = colors[1] >> 8;
+    for (int i = 0; i < 4; i++)
+        block[4 + i] = (indexes >> (i * 8)) & 0xFF;
+    return totalError;
+}
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "renderer/compressedImage.h"
+#include <string>
+#include <vector>
+
+// Cooks RGBA8 images into block compressed ones on CPU, needs no graphics context
+// Endpoints are taken along the main axis of block colors, BC7 is written in its single subset mode 6
+class BlockEncoder
+{
+public:
+    // Levels go down to 1x1 when mipmaps are asked, ETC2 is not encoded
+    EXPORT static bool encode(const unsigned char *rgba, int width, int height, TextureFormat format, bool bMipmaps, CompressedImage *result);
+    EXPORT static bool encodeFile(const std::string &path, TextureFormat format, bool bMipmaps, CompressedImage *result);
+
+    // Pixels are 16 RGBA8 values of 4x4 block row by row
+    EXPORT static void encodeBlockBC1(const unsigned char *pixels, unsigned char *block);
+    EXPORT static void encodeBlockBC3(const unsigned char *pixels, unsigned char *block);
+    EXPORT static void encodeBlockBC4(const unsigned char *pixels, int channel, unsigned char *block);
+    EXPORT static void encodeBlockBC5(const unsigned char *pixels, unsigned char *block);
+    EXPORT static void encodeBlockBC7(const unsigned char *pixels, unsigned char *block);
+
+protected:
+    static void getBlock(const unsigned char *rgba, int width, int height, int x, int y, unsigned char *pixels);
+    static void downsample(const unsigned char *rgba, int width, int height, std::vector<unsigned char> &result);
+    // Main axis of points through their mean, points have channels values each
+    static void getMainAxis(const float *points, int channels, float *mean, float *axis);
+    static int encodeColorsBC1(const unsigned char *pixels, const float *start, const float *end, unsigned char *block);
+};
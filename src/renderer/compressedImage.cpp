@@ -0,0 +1,384 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/compressedImage.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <algorithm>
+
+static const unsigned char ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+#define DDS_HEADER_SIZE 124
+#define DDS_DX10_HEADER_SIZE 20
+#define KTX2_HEADER_SIZE 68
+#define KTX2_LEVEL_INDEX_SIZE 24
+
+// Bigger images are taken as broken files
+#define COMPRESSED_IMAGE_MAX_SIZE 16384
+
+// Vulkan formats of KTX2 and DXGI formats of DDS, sRGB ones follow linear ones
+static const uint32_t vkFormats[6] = {133, 137, 141, 145, 147, 151};
+static const uint32_t dxgiFormats[6] = {71, 77, 83, 98, 0, 0};
+
+// Color models of KTX2 format descriptor
+static const unsigned char dfdColorModels[6] = {128, 130, 132, 134, 161, 161};
+
+static uint32_t readUint32(const unsigned char *data)
+{
+    uint32_t value;
+    memcpy(&value, data, 4);
+    return value;
+}
+
+static uint64_t readUint64(const unsigned char *data)
+{
+    uint64_t value;
+    memcpy(&value, data, 8);
+    return value;
+}
+
+static void writeUint32(std::vector<unsigned char> &target, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        target.push_back((value >> (i * 8)) & 0xFF);
+}
+
+static void writeUint64(std::vector<unsigned char> &target, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+        target.push_back((value >> (i * 8)) & 0xFF);
+}
+
+static bool writeFile(const std::string &path, const std::vector<unsigned char> &data)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool bWritten = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return bWritten;
+}
+
+bool CompressedImage::load(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0 || size > 0x7FFFFFFF)
+    {
+        fclose(file);
+        return false;
+    }
+
+    std::vector<unsigned char> data(size);
+    bool bRead = fread(data.data(), 1, size, file) == (size_t)size;
+    fclose(file);
+    if (!bRead)
+        return false;
+
+    if (size >= 12 && memcmp(data.data(), ktx2Identifier, 12) == 0)
+        return loadKTX2(data.data(), size);
+    if (size >= 4 && memcmp(data.data(), "DDS ", 4) == 0)
+        return loadDDS(data.data(), size);
+    return false;
+}
+
+bool CompressedImage::loadDDS(const unsigned char *data, int size)
+{
+    if (size < 4 + DDS_HEADER_SIZE || memcmp(data, "DDS ", 4) != 0 || readUint32(data + 4) != DDS_HEADER_SIZE)
+        return false;
+
+    const unsigned char *header = data + 4;
+    int height = readUint32(header + 8);
+    int width = readUint32(header + 12);
+    int mipmaps = std::max(1, (int)readUint32(header + 24));
+    const unsigned char *fourCC = header + 80;
+    int offset = 4 + DDS_HEADER_SIZE;
+
+    // Cube maps and volumes
+    if (readUint32(header + 112) != 0)
+        return false;
+
+    TextureFormat format;
+    if (memcmp(fourCC, "DXT1", 4) == 0)
+        format = TextureFormat::BC1;
+    else if (memcmp(fourCC, "DXT5", 4) == 0)
+        format = TextureFormat::BC3;
+    else if (memcmp(fourCC, "ATI2", 4) == 0 || memcmp(fourCC, "BC5U", 4) == 0)
+        format = TextureFormat::BC5;
+    else if (memcmp(fourCC, "DX10", 4) == 0 && size >= offset + DDS_DX10_HEADER_SIZE)
+    {
+        const unsigned char *headerDX10 = data + offset;
+        uint32_t dxgiFormat = readUint32(headerDX10);
+        offset += DDS_DX10_HEADER_SIZE;
+        if (readUint32(headerDX10 + 4) != 3 || readUint32(headerDX10 + 12) > 1)
+            return false;
+
+        // Format after BC5 is the signed one, after others it is sRGB
+        int found = -1;
+        for (int i = 0; i < 4; i++)
+            if (dxgiFormat == dxgiFormats[i] || (dxgiFormat == dxgiFormats[i] + 1 && i != (int)TextureFormat::BC5))
+                found = i;
+        if (found < 0)
+            return false;
+        format = (TextureFormat)found;
+    }
+    else
+        return false;
+
+    setup(format, width, height);
+    return readLevels(data, size, offset, mipmaps);
+}
+
+bool CompressedImage::loadKTX2(const unsigned char *data, int size)
+{
+    if (size < 12 + KTX2_HEADER_SIZE || memcmp(data, ktx2Identifier, 12) != 0)
+        return false;
+
+    const unsigned char *header = data + 12;
+    uint32_t vkFormat = readUint32(header);
+    int width = readUint32(header + 8);
+    int height = readUint32(header + 12);
+    int depth = readUint32(header + 16);
+    int layers = readUint32(header + 20);
+    int faces = readUint32(header + 24);
+    int amount = std::max(1, (int)readUint32(header + 28));
+    int supercompression = readUint32(header + 32);
+    if (depth > 1 || layers > 1 || faces != 1 || supercompression != 0)
+        return false;
+
+    // Format after BC5 is the signed one, after others it is sRGB
+    int found = -1;
+    for (int i = 0; i < 6; i++)
+        if (vkFormat == vkFormats[i] || (vkFormat == vkFormats[i] + 1 && i != (int)TextureFormat::BC5))
+            found = i;
+    // BC1 without alpha goes before the one with it
+    if (vkFormat == vkFormats[0] - 2 || vkFormat == vkFormats[0] - 1)
+        found = 0;
+    if (found < 0)
+        return false;
+
+    setup((TextureFormat)found, width, height);
+    if (width <= 0 || height <= 0 || width > COMPRESSED_IMAGE_MAX_SIZE || height > COMPRESSED_IMAGE_MAX_SIZE || amount > 16)
+        return false;
+
+    int indexOffset = 12 + KTX2_HEADER_SIZE;
+    if (size < indexOffset + amount * KTX2_LEVEL_INDEX_SIZE)
+        return false;
+
+    for (int i = 0; i < amount; i++)
+    {
+        const unsigned char *index = data + indexOffset + i * KTX2_LEVEL_INDEX_SIZE;
+        uint64_t levelOffset = readUint64(index);
+        uint64_t levelLength = readUint64(index + 8);
+
+        auto level = addLevel(std::max(1, width >> i), std::max(1, height >> i));
+        if (levelLength != level->data.size() || levelOffset > (uint64_t)size || levelLength > size - levelOffset)
+        {
+            levels.clear();
+            return false;
+        }
+        memcpy(level->data.data(), data + levelOffset, levelLength);
+    }
+    return true;
+}
+
+bool CompressedImage::readLevels(const unsigned char *data, int size, int offset, int amount)
+{
+    if (width <= 0 || height <= 0 || width > COMPRESSED_IMAGE_MAX_SIZE || height > COMPRESSED_IMAGE_MAX_SIZE || amount > 16)
+        return false;
+
+    for (int i = 0; i < amount; i++)
+    {
+        auto level = addLevel(std::max(1, width >> i), std::max(1, height >> i));
+        int length = level->data.size();
+        if (offset + length > size)
+        {
+            levels.clear();
+            return false;
+        }
+        memcpy(level->data.data(), data + offset, length);
+        offset += length;
+    }
+    return true;
+}
+
+bool CompressedImage::saveDDS(const std::string &path)
+{
+    if (levels.empty() || format == TextureFormat::ETC2RGB || format == TextureFormat::ETC2RGBA)
+        return false;
+
+    bool bDX10 = format == TextureFormat::BC7;
+    std::vector<unsigned char> data = {'D', 'D', 'S', ' '};
+
+    // Caps, height, width, pixel format, mipmap count and linear size
+    writeUint32(data, DDS_HEADER_SIZE);
+    writeUint32(data, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+    writeUint32(data, height);
+    writeUint32(data, width);
+    writeUint32(data, levels[0].data.size());
+    writeUint32(data, 0);
+    writeUint32(data, levels.size());
+    for (int i = 0; i < 11; i++)
+        writeUint32(data, 0);
+
+    // Pixel format with four character code only
+    const char *fourCC = bDX10 ? "DX10" : (format == TextureFormat::BC1 ? "DXT1" : (format == TextureFormat::BC3 ? "DXT5" : "ATI2"));
+    writeUint32(data, 32);
+    writeUint32(data, 0x4);
+    data.insert(data.end(), fourCC, fourCC + 4);
+    for (int i = 0; i < 5; i++)
+        writeUint32(data, 0);
+
+    // Texture, complex and mipmap
+    writeUint32(data, 0x1000 | (levels.size() > 1 ? 0x8 | 0x400000 : 0));
+    for (int i = 0; i < 4; i++)
+        writeUint32(data, 0);
+
+    if (bDX10)
+    {
+        writeUint32(data, dxgiFormats[(int)format]);
+        writeUint32(data, 3);
+        writeUint32(data, 0);
+        writeUint32(data, 1);
+        writeUint32(data, 0);
+    }
+
+    for (auto it = levels.begin(); it != levels.end(); ++it)
+        data.insert(data.end(), it->data.begin(), it->data.end());
+
+    return writeFile(path, data);
+}
+
+bool CompressedImage::saveKTX2(const std::string &path)
+{
+    if (levels.empty())
+        return false;
+
+    int amount = levels.size();
+    int blockSize = getBlockSize(format);
+    bool bTwoSamples = format == TextureFormat::BC3 || format == TextureFormat::BC5 || format == TextureFormat::ETC2RGBA;
+
+    // Basic data format descriptor, one sample per 64 bits of a block
+    std::vector<unsigned char> dfd;
+    int samples = bTwoSamples ? 2 : 1;
+    int blockDescriptorSize = 24 + samples * 16;
+    writeUint32(dfd, 4 + blockDescriptorSize);
+    writeUint32(dfd, 0);
+    writeUint32(dfd, 2 | (blockDescriptorSize << 16));
+    dfd.push_back(dfdColorModels[(int)format]);
+    dfd.push_back(1);
+    dfd.push_back(1);
+    dfd.push_back(0);
+    dfd.insert(dfd.end(), {3, 3, 0, 0});
+    dfd.insert(dfd.end(), {(unsigned char)blockSize, 0, 0, 0, 0, 0, 0, 0});
+    for (int i = 0; i < samples; i++)
+    {
+        // Alpha of BC3 and ETC2 comes first, BC5 keeps red and green
+        unsigned char channel = 0;
+        if (format == TextureFormat::BC5)
+            channel = i;
+        else if (bTwoSamples && i == 0)
+            channel = 15;
+        int bits = bTwoSamples ? 64 : blockSize * 8;
+        dfd.push_back((i * 64) & 0xFF);
+        dfd.push_back((i * 64) >> 8);
+        dfd.push_back(bits - 1);
+        dfd.push_back(channel);
+        writeUint32(dfd, 0);
+        writeUint32(dfd, 0);
+        writeUint32(dfd, 0xFFFFFFFF);
+    }
+
+    int dfdOffset = 12 + KTX2_HEADER_SIZE + amount * KTX2_LEVEL_INDEX_SIZE;
+    int dataOffset = dfdOffset + dfd.size();
+
+    // Levels are stored from the smallest one, every level starts at multiple of block size
+    std::vector<uint64_t> offsets(amount);
+    for (int i = amount - 1; i >= 0; i--)
+    {
+        dataOffset = (dataOffset + blockSize - 1) / blockSize * blockSize;
+        offsets[i] = dataOffset;
+        dataOffset += levels[i].data.size();
+    }
+
+    std::vector<unsigned char> data(ktx2Identifier, ktx2Identifier + 12);
+    writeUint32(data, vkFormats[(int)format]);
+    writeUint32(data, 1);
+    writeUint32(data, width);
+    writeUint32(data, height);
+    writeUint32(data, 0);
+    writeUint32(data, 0);
+    writeUint32(data, 1);
+    writeUint32(data, amount);
+    writeUint32(data, 0);
+
+    writeUint32(data, dfdOffset);
+    writeUint32(data, dfd.size());
+    writeUint32(data, 0);
+    writeUint32(data, 0);
+    writeUint64(data, 0);
+    writeUint64(data, 0);
+
+    for (int i = 0; i < amount; i++)
+    {
+        writeUint64(data, offsets[i]);
+        writeUint64(data, levels[i].data.size());
+        writeUint64(data, levels[i].data.size());
+    }
+    data.insert(data.end(), dfd.begin(), dfd.end());
+
+    for (int i = amount - 1; i >= 0; i--)
+    {
+        data.resize(offsets[i], 0);
+        data.insert(data.end(), levels[i].data.begin(), levels[i].data.end());
+    }
+
+    return writeFile(path, data);
+}
+
+void CompressedImage::setup(TextureFormat format, int width, int height)
+{
+    this->format = format;
+    this->width = width;
+    this->height = height;
+    levels.clear();
+}
+
+CompressedImageLevel *CompressedImage::addLevel(int width, int height)
+{
+    levels.emplace_back();
+    auto level = &levels.back();
+    level->width = width;
+    level->height = height;
+    level->data.resize(getLevelSize(format, width, height));
+    return level;
+}
+
+int CompressedImage::getBlockSize(TextureFormat format)
+{
+    return (format == TextureFormat::BC1 || format == TextureFormat::ETC2RGB) ? 8 : 16;
+}
+
+int CompressedImage::getLevelSize(TextureFormat format, int width, int height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+bool CompressedImage::isCompressedImagePath(const std::string &path)
+{
+    auto dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+
+    std::string extension = path.substr(dot + 1);
+    for (auto it = extension.begin(); it != extension.end(); ++it)
+        *it = tolower(*it);
+    return extension == "ktx2" || extension == "dds";
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include <string>
+#include <vector>
+
+// Block compressed formats sampled by GPU as they are, sRGB variants of files are read as linear ones like other images
+// BC5 keeps only red and green channels
+enum class TextureFormat
+{
+    BC1 = 0,
+    BC3,
+    BC5,
+    BC7,
+    ETC2RGB,
+    ETC2RGBA
+};
+
+struct CompressedImageLevel
+{
+    int width;
+    int height;
+    std::vector<unsigned char> data;
+};
+
+// Image of 4x4 blocks with prepared mip levels, the first level is the largest
+// Read from and written to KTX2 and DDS files, supercompressed KTX2 is not supported
+class CompressedImage
+{
+public:
+    EXPORT bool load(const std::string &path);
+    EXPORT bool loadDDS(const unsigned char *data, int size);
+    EXPORT bool loadKTX2(const unsigned char *data, int size);
+
+    // DDS holds BC formats only, ETC2 is written to KTX2
+    EXPORT bool saveDDS(const std::string &path);
+    EXPORT bool saveKTX2(const std::string &path);
+
+    EXPORT void setup(TextureFormat format, int width, int height);
+    EXPORT CompressedImageLevel *addLevel(int width, int height);
+
+    inline TextureFormat getFormat() { return format; }
+    inline int getWidth() { return width; }
+    inline int getHeight() { return height; }
+    inline int getLevelsAmount() { return levels.size(); }
+    inline CompressedImageLevel *getLevel(int index) { return &levels[index]; }
+
+    EXPORT static int getBlockSize(TextureFormat format);
+    EXPORT static int getLevelSize(TextureFormat format, int width, int height);
+    EXPORT static bool isCompressedImagePath(const std::string &path);
+
+protected:
+    bool readLevels(const unsigned char *data, int size, int offset, int amount);
+
+    TextureFormat format = TextureFormat::BC1;
+    int width = 0;
+    int height = 0;
+    std::vector<CompressedImageLevel> levels;
+};
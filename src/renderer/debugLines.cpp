@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/debugLines.h"
+
+// Pairs of unit cube corners connected by edges, corner bits are x, y, z
+static const int boxEdges[24] = {0, 1, 2, 3, 4, 5, 6, 7, 0, 2, 1, 3, 4, 6, 5, 7, 0, 4, 1, 5, 2, 6, 3, 7};
+
+void DebugLines::addLine(const Vector3 &a, const Vector3 &b, const Vector3 &color, bool bOverlay)
+{
+    DebugLineVertex vertices[2] = {{a, color}, {b, color}};
+    addLines(vertices, 2, bOverlay);
+}
+
+void DebugLines::addLines(const DebugLineVertex *vertices, int amount, bool bOverlay)
+{
+    lock.lock();
+    auto &target = bOverlay ? overlay : depthTested;
+    target.insert(target.end(), vertices, vertices + amount);
+    lock.unlock();
+}
+
+void DebugLines::addBox(const Matrix4 &mModel, const Vector3 &color, bool bOverlay)
+{
+    Vector3 corners[8];
+    for (int i = 0; i < 8; i++)
+    {
+        Vector4 corner = Vector4((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f, 1.0f);
+        corners[i] = Vector3(mModel * corner);
+    }
+
+    DebugLineVertex vertices[24];
+    for (int i = 0; i < 24; i++)
+        vertices[i] = {corners[boxEdges[i]], color};
+    addLines(vertices, 24, bOverlay);
+}
+
+void DebugLines::addBox(const Vector3 &start, const Vector3 &end, const Vector3 &color, bool bOverlay)
+{
+    DebugLineVertex vertices[24];
+    for (int i = 0; i < 24; i++)
+    {
+        int corner = boxEdges[i];
+        vertices[i] = {Vector3((corner & 1) ? end.x : start.x, (corner & 2) ? end.y : start.y, (corner & 4) ? end.z : start.z), color};
+    }
+    addLines(vertices, 24, bOverlay);
+}
+
+void DebugLines::addSphere(const Vector3 &center, float radius, const Vector3 &color, bool bOverlay)
+{
+    DebugLineVertex vertices[DEBUG_SPHERE_SEGMENTS * 6];
+    int n = 0;
+    for (int i = 0; i < DEBUG_SPHERE_SEGMENTS; i++)
+    {
+        float lA = (float)i / DEBUG_SPHERE_SEGMENTS * CONST_PI * 2.0f;
+        float lB = (float)(i + 1) / DEBUG_SPHERE_SEGMENTS * CONST_PI * 2.0f;
+        float sA = radius * sinf(lA), cA = radius * cosf(lA);
+        float sB = radius * sinf(lB), cB = radius * cosf(lB);
+
+        vertices[n++] = {center + Vector3(sA, cA, 0.0f), color};
+        vertices[n++] = {center + Vector3(sB, cB, 0.0f), color};
+        vertices[n++] = {center + Vector3(0.0f, sA, cA), color};
+        vertices[n++] = {center + Vector3(0.0f, sB, cB), color};
+        vertices[n++] = {center + Vector3(cA, 0.0f, sA), color};
+        vertices[n++] = {center + Vector3(cB, 0.0f, sB), color};
+    }
+    addLines(vertices, n, bOverlay);
+}
+
+void DebugLines::addPoint(const Vector3 &point, float size, const Vector3 &color, bool bOverlay)
+{
+    float half = size * 0.5f;
+    DebugLineVertex vertices[6] = {
+        {point - Vector3(half, 0.0f, 0.0f), color},
+        {point + Vector3(half, 0.0f, 0.0f), color},
+        {point - Vector3(0.0f, half, 0.0f), color},
+        {point + Vector3(0.0f, half, 0.0f), color},
+        {point - Vector3(0.0f, 0.0f, half), color},
+        {point + Vector3(0.0f, 0.0f, half), color}};
+    addLines(vertices, 6, bOverlay);
+}
+
+void DebugLines::clear()
+{
+    lock.lock();
+    depthTested.clear();
+    overlay.clear();
+    lock.unlock();
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "math/math.h"
+#include <vector>
+#include <mutex>
+
+#define DEBUG_SPHERE_SEGMENTS 16
+
+struct DebugLineVertex
+{
+    Vector3 position;
+    Vector3 color;
+};
+
+// Lines, boxes, spheres and points of a frame, every two vertices are one line
+// Adding is safe from any thread, renderer draws everything with one call for depth tested and one for overlay lines
+class DebugLines
+{
+public:
+    EXPORT void addLine(const Vector3 &a, const Vector3 &b, const Vector3 &color, bool bOverlay = false);
+    EXPORT void addLines(const DebugLineVertex *vertices, int amount, bool bOverlay = false);
+
+    // Edges of unit cube placed by model matrix
+    EXPORT void addBox(const Matrix4 &mModel, const Vector3 &color, bool bOverlay = false);
+    EXPORT void addBox(const Vector3 &start, const Vector3 &end, const Vector3 &color, bool bOverlay = false);
+    // Circles around every axis
+    EXPORT void addSphere(const Vector3 &center, float radius, const Vector3 &color, bool bOverlay = false);
+    // Cross along every axis, used for contact points
+    EXPORT void addPoint(const Vector3 &point, float size, const Vector3 &color, bool bOverlay = false);
+
+    // Only for the renderer, when nothing is added anymore
+    inline std::vector<DebugLineVertex> &getDepthTested() { return depthTested; }
+    inline std::vector<DebugLineVertex> &getOverlay() { return overlay; }
+    EXPORT void clear();
+
+protected:
+    std::mutex lock;
+    std::vector<DebugLineVertex> depthTested;
+    std::vector<DebugLineVertex> overlay;
+};
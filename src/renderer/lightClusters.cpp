@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/lightClusters.h"
+
+static inline Vector3 unproject(const Matrix4 &mInverseProjection, float x, float y, float z)
+{
+    Vector4 v = mInverseProjection * Vector4(x, y, z, 1.0f);
+    return Vector3(v) / v.w;
+}
+
+void LightClusters::build(const Matrix4 &mView, const Matrix4 &mProjection, const LightClusterSource *lights, int amount)
+{
+    setupSlices(mProjection);
+
+    bounds.resize(LIGHT_CLUSTERS_AMOUNT);
+    clusters.resize(LIGHT_CLUSTERS_AMOUNT * 2);
+    sliceIndexes.resize(LIGHT_CLUSTERS_Z);
+    indexes.clear();
+
+    // Lights are moved to view space once, slice range lets every job skip lights of other slices
+    viewLights.resize(amount);
+    lightSlices.resize(amount * 2);
+    for (int i = 0; i < amount; i++)
+    {
+        Vector4 center = mView * Vector4(lights[i].position, 1.0f);
+        float depth = -center.z;
+        viewLights[i] = Vector4(Vector3(center), lights[i].radius);
+        if (depth + lights[i].radius < zNear || depth - lights[i].radius > zFar)
+        {
+            lightSlices[i * 2] = 1;
+            lightSlices[i * 2 + 1] = 0;
+            continue;
+        }
+        lightSlices[i * 2] = getSlice(depth - lights[i].radius);
+        lightSlices[i * 2 + 1] = getSlice(depth + lights[i].radius);
+    }
+
+    Matrix4 mInverseProjection = glm::inverse(mProjection);
+    int jobs = std::max(1, std::min(core->getMaxJobs(), LIGHT_CLUSTERS_Z));
+    int slicesPerJob = LIGHT_CLUSTERS_Z / jobs;
+    int currentSlice = 0;
+    for (int i = 0; i < jobs; i++)
+    {
+        int end = (i == jobs - 1) ? LIGHT_CLUSTERS_Z : currentSlice + slicesPerJob;
+        core->queueJob([this, currentSlice, end, mProjection, mInverseProjection]
+                       {
+                           buildBounds(currentSlice, end, mProjection, mInverseProjection);
+                           assignLights(currentSlice, end); },
+                       &jobsInFlight);
+        currentSlice = end;
+    }
+    core->waitForJobs(&jobsInFlight);
+
+    // Offsets of every slice were local, slices are joined in order
+    int clustersPerSlice = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y;
+    for (int z = 0; z < LIGHT_CLUSTERS_Z; z++)
+    {
+        unsigned int base = indexes.size();
+        for (int c = z * clustersPerSlice; c < (z + 1) * clustersPerSlice; c++)
+            clusters[c * 2] += base;
+        indexes.insert(indexes.end(), sliceIndexes[z].begin(), sliceIndexes[z].end());
+    }
+}
+
+int LightClusters::getSlice(float depth)
+{
+    float value = bLogarithmic ? logf(fmaxf(depth, 0.0001f)) : depth;
+    int slice = (int)floorf(value * sliceScale + sliceBias);
+    return std::max(0, std::min(slice, LIGHT_CLUSTERS_Z - 1));
+}
+
+AABB LightClusters::getClusterBounds(int x, int y, int z)
+{
+    return bounds[getClusterIndex(x, y, z)];
+}
+
+// Near and far are taken from projection itself, so any camera type works
+void LightClusters::setupSlices(const Matrix4 &mProjection)
+{
+    Matrix4 mInverseProjection = glm::inverse(mProjection);
+    zNear = -unproject(mInverseProjection, 0.0f, 0.0f, -1.0f).z;
+    zFar = -unproject(mInverseProjection, 0.0f, 0.0f, 1.0f).z;
+
+    bLogarithmic = fabsf(mProjection[2][3]) > 0.0001f && zNear > 0.0f;
+    if (bLogarithmic)
+    {
+        float range = logf(zFar / zNear);
+        sliceScale = LIGHT_CLUSTERS_Z / range;
+        sliceBias = -LIGHT_CLUSTERS_Z * logf(zNear) / range;
+    }
+    else
+    {
+        sliceScale = LIGHT_CLUSTERS_Z / (zFar - zNear);
+        sliceBias = -zNear * sliceScale;
+    }
+}
+
+float LightClusters::getSliceDepth(int slice)
+{
+    float k = (float)slice / (float)LIGHT_CLUSTERS_Z;
+    if (bLogarithmic)
+        return zNear * powf(zFar / zNear, k);
+    return zNear + (zFar - zNear) * k;
+}
+
+void LightClusters::buildBounds(int sliceFrom, int sliceTo, const Matrix4 &mProjection, const Matrix4 &mInverseProjection)
+{
+    for (int z = sliceFrom; z < sliceTo; z++)
+    {
+        // Depth of both planes of the slice in normalized device coordinates
+        float ndcZ[2];
+        for (int i = 0; i < 2; i++)
+        {
+            Vector4 clip = mProjection * Vector4(0.0f, 0.0f, -getSliceDepth(z + i), 1.0f);
+            ndcZ[i] = clip.z / clip.w;
+        }
+
+        for (int y = 0; y < LIGHT_CLUSTERS_Y; y++)
+        {
+            float y0 = -1.0f + 2.0f * y / LIGHT_CLUSTERS_Y;
+            float y1 = -1.0f + 2.0f * (y + 1) / LIGHT_CLUSTERS_Y;
+            for (int x = 0; x < LIGHT_CLUSTERS_X; x++)
+            {
+                float x0 = -1.0f + 2.0f * x / LIGHT_CLUSTERS_X;
+                float x1 = -1.0f + 2.0f * (x + 1) / LIGHT_CLUSTERS_X;
+
+                Vector3 point = unproject(mInverseProjection, x0, y0, ndcZ[0]);
+                AABB aabb = AABB(point, point);
+                for (int i = 1; i < 8; i++)
+                {
+                    point = unproject(mInverseProjection, (i & 1) ? x1 : x0, (i & 2) ? y1 : y0, ndcZ[i >> 2]);
+                    aabb.extend(AABB(point, point));
+                }
+                bounds[getClusterIndex(x, y, z)] = aabb;
+            }
+        }
+    }
+}
+
+void LightClusters::assignLights(int sliceFrom, int sliceTo)
+{
+    std::vector<int> candidates;
+    for (int z = sliceFrom; z < sliceTo; z++)
+    {
+        candidates.clear();
+        for (int i = 0; i < (int)viewLights.size(); i++)
+        {
+            if (lightSlices[i * 2] <= z && lightSlices[i * 2 + 1] >= z)
+                candidates.push_back(i);
+        }
+
+        std::vector<unsigned int> &list = sliceIndexes[z];
+        list.clear();
+        for (int y = 0; y < LIGHT_CLUSTERS_Y; y++)
+        {
+            for (int x = 0; x < LIGHT_CLUSTERS_X; x++)
+            {
+                int cluster = getClusterIndex(x, y, z);
+                AABB &aabb = bounds[cluster];
+                unsigned int offset = list.size();
+
+                // Sphere touches box if the closest point of the box is within radius
+                for (auto index : candidates)
+                {
+                    Vector3 center = Vector3(viewLights[index]);
+                    float radius = viewLights[index].w;
+                    Vector3 closest = glm::clamp(center, aabb.start, aabb.end);
+                    if (glm::length2(closest - center) <= radius * radius)
+                        list.push_back(index);
+                }
+
+                clusters[cluster * 2] = offset;
+                clusters[cluster * 2 + 1] = list.size() - offset;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "math/math.h"
+#include "connector/withCore.h"
+#include <vector>
+#include <atomic>
+
+// Froxel grid, tiles of the screen split by depth slices
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+#define LIGHT_CLUSTERS_AMOUNT (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+
+// Sphere affected by light in world space
+struct LightClusterSource
+{
+    Vector3 position;
+    float radius;
+};
+
+// Assigns lights to clusters of the view frustum so shading only loops over lights touching the pixel's cluster
+// Depth slices grow exponentially for perspective projection and are even for orthogonal one
+// Doesn't depend on renderer, result is offset and amount of light indexes for every cluster
+class LightClusters : public WithCore
+{
+public:
+    EXPORT void build(const Matrix4 &mView, const Matrix4 &mProjection, const LightClusterSource *lights, int amount);
+
+    // Depth is distance along view direction
+    EXPORT int getSlice(float depth);
+    // Bounds are in view space
+    EXPORT AABB getClusterBounds(int x, int y, int z);
+
+    inline int getClusterIndex(int x, int y, int z) { return x + y * LIGHT_CLUSTERS_X + z * LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y; }
+
+    // Pairs of offset in indexes and amount of lights, one pair per cluster
+    inline const unsigned int *getClusters() { return clusters.data(); }
+    inline const unsigned int *getIndexes() { return indexes.data(); }
+    inline int getIndexesAmount() { return indexes.size(); }
+
+    // Slice is floor(f(depth) * scale + bias), where f is log for perspective projection
+    inline float getSliceScale() { return sliceScale; }
+    inline float getSliceBias() { return sliceBias; }
+    inline bool isLogarithmic() { return bLogarithmic; }
+
+    inline float getNear() { return zNear; }
+    inline float getFar() { return zFar; }
+
+protected:
+    void setupSlices(const Matrix4 &mProjection);
+    float getSliceDepth(int slice);
+    void buildBounds(int sliceFrom, int sliceTo, const Matrix4 &mProjection, const Matrix4 &mInverseProjection);
+    void assignLights(int sliceFrom, int sliceTo);
+
+    std::vector<AABB> bounds;
+    std::vector<unsigned int> clusters;
+    std::vector<unsigned int> indexes;
+
+    // Center in view space and radius
+    std::vector<Vector4> viewLights;
+    std::vector<int> lightSlices;
+    std::vector<std::vector<unsigned int>> sliceIndexes;
+
+    float zNear = 0.1f;
+    float zFar = 100.0f;
+    float sliceScale = 1.0f;
+    float sliceBias = 0.0f;
+    bool bLogarithmic = true;
+
+    std::atomic<int> jobsInFlight = 0;
+};
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/null/meshStaticNull.h"
+#include "math/smallestEnclosingSphere.h"
+#include <string.h>
+
+MeshStaticNull::MeshStaticNull()
+{
+}
+
+MeshStaticNull::~MeshStaticNull()
+{
+    if (!isInstance)
+        clear();
+}
+
+void MeshStaticNull::render()
+{
+}
+
+void MeshStaticNull::renderLod(int lod)
+{
+}
+
+Mesh *MeshStaticNull::createInstance()
+{
+    MeshStaticNull *newMesh = new MeshStaticNull();
+    newMesh->setupInstance(this);
+    newMesh->setDefaultShader(this->getDefaultShader());
+    return newMesh;
+}
+
+Geometry *MeshStaticNull::getGeometry()
+{
+    return geometry;
+}
+
+void MeshStaticNull::setupFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents)
+{
+    clear();
+    vertexFormat = MeshVertexFormat::Float;
+
+    int sourceFloats = 0;
+    for (int i = 0; i < attributesAmount; i++)
+        sourceFloats += attributeSize[i];
+
+    this->vertexAmount = vertexAmount;
+    this->attributesAmount = attributesAmount + (buildTangents ? 2 : 0);
+    floatsPerVertex = sourceFloats + (buildTangents ? 6 : 0);
+
+    Sphere volumeSphere = makeSmallestSphere(data, vertexAmount, sourceFloats);
+    setBoundVolumeSphere(volumeSphere.center, volumeSphere.radius);
+
+    vertexData = new float[floatsPerVertex * vertexAmount];
+    memset(vertexData, 0, floatsPerVertex * vertexAmount * sizeof(float));
+    for (int i = 0; i < vertexAmount; i++)
+        memcpy(&vertexData[i * floatsPerVertex], &data[i * sourceFloats], sourceFloats * sizeof(float));
+
+    if (buildTangents)
+    {
+        for (int i = 0; i + 2 < vertexAmount; i += 3)
+        {
+            float tg[6];
+            calcTangets(&vertexData[i * floatsPerVertex], &vertexData[(i + 1) * floatsPerVertex], &vertexData[(i + 2) * floatsPerVertex], tg);
+            for (int k = 0; k < 3; k++)
+                memcpy(&vertexData[(i + k) * floatsPerVertex + sourceFloats], tg, 6 * sizeof(float));
+        }
+    }
+
+    geometry = new Geometry(vertexData, vertexAmount, floatsPerVertex, 0);
+}
+
+void MeshStaticNull::setupLodChain(const MeshLodChain &chain, int attributesAmount, int *attributeSize, bool buildTangents)
+{
+    clear();
+    if (chain.lods.empty() || chain.floatsPerVertex <= 0)
+        return;
+
+    // Full level becomes plain list of triangles, the same vertex data GPU meshes keep for CPU users
+    const MeshLod &full = chain.lods[0];
+    int sourceFloats = chain.floatsPerVertex;
+    std::vector<float> triangles(full.indexAmount * sourceFloats);
+    for (int i = 0; i < full.indexAmount; i++)
+        memcpy(&triangles[i * sourceFloats], &chain.vertices[chain.indexes[full.indexOffset + i] * sourceFloats], sourceFloats * sizeof(float));
+
+    // Tangents stay flat per triangle, nothing draws them here
+    setupFloatsArray(triangles.data(), full.indexAmount, attributesAmount, attributeSize, buildTangents);
+
+    Sphere volumeSphere = makeSmallestSphere(chain.vertices.data(), chain.vertices.size() / sourceFloats, sourceFloats);
+    setBoundVolumeSphere(volumeSphere.center, volumeSphere.radius);
+    lods = chain.lods;
+}
+
+void MeshStaticNull::setupInstance(MeshStaticNull *mainMesh)
+{
+    isInstance = true;
+    vertexAmount = mainMesh->vertexAmount;
+    floatsPerVertex = mainMesh->floatsPerVertex;
+    attributesAmount = mainMesh->attributesAmount;
+    vertexData = mainMesh->vertexData;
+    boundVolume = mainMesh->boundVolume;
+    lods = mainMesh->lods;
+    vertexFormat = mainMesh->vertexFormat;
+    positionOffset = mainMesh->positionOffset;
+    positionScale = mainMesh->positionScale;
+    sortId = mainMesh->sortId;
+}
+
+void MeshStaticNull::setOtherMeshAsInstanceOfThis(MeshStatic *mesh)
+{
+    if (mesh)
+        reinterpret_cast<MeshStaticNull *>(mesh)->setupInstance(this);
+}
+
+void MeshStaticNull::clear()
+{
+    lods.clear();
+    positionOffset = Vector3(0.0f);
+    positionScale = Vector3(1.0f);
+    if (vertexData)
+        delete[] vertexData;
+    vertexData = nullptr;
+    if (geometry)
+        delete geometry;
+    geometry = nullptr;
+}
+
+MeshStatic *MeshStaticNull::getAsStatic()
+{
+    return this;
+}
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "mesh/meshStatic.h"
+
+// Keeps vertex data, bound volume, levels of detail and geometry the same way GPU meshes do, so CPU users work as usual
+// Vertices stay floats, nothing is uploaded
+class MeshStaticNull : public MeshStatic
+{
+public:
+    EXPORT MeshStaticNull();
+    EXPORT ~MeshStaticNull();
+
+    EXPORT void render() override;
+    EXPORT void renderLod(int lod) override;
+
+    EXPORT Mesh *createInstance() override;
+    EXPORT Geometry *getGeometry() override;
+
+    EXPORT void setupFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents = false) override;
+    EXPORT void setupLodChain(const MeshLodChain &chain, int attributesAmount, int *attributeSize, bool buildTangents = false) override;
+
+    EXPORT void setOtherMeshAsInstanceOfThis(MeshStatic *mesh) override;
+    EXPORT void clear() override;
+
+    EXPORT MeshStatic *getAsStatic() override;
+
+protected:
+    void setupInstance(MeshStaticNull *mainMesh);
+
+    Geometry *geometry = nullptr;
+};
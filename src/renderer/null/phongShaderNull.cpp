@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/null/phongShaderNull.h"
+#include "renderer/null/shaderParameterNull.h"
+
+PhongShaderNull::PhongShaderNull()
+{
+    bIsReady = true;
+}
+
+bool PhongShaderNull::build()
+{
+    return true;
+}
+
+bool PhongShaderNull::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
+{
+    currentShader = this;
+    return true;
+}
+
+void PhongShaderNull::setTexture(TextureType type, Texture *texture)
+{
+    textures[(int)type] = texture;
+}
+
+ShaderParameter *PhongShaderNull::createShaderParameter(const char *name, ShaderParameterType type)
+{
+    return new ShaderParameterNull(type);
+}
+
+ShaderParameter *PhongShaderNull::createShaderUVParameter()
+{
+    return new ShaderParameterNull(ShaderParameterType::Float4);
+}
+
+void PhongShaderNull::destroyShaderParameter(ShaderParameter *parameter)
+{
+    delete parameter;
+}
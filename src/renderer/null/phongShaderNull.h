@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "renderer/phongShader.h"
+
+// Phong shader without program, textures set to it are only remembered
+class PhongShaderNull : public PhongShader
+{
+public:
+    EXPORT PhongShaderNull();
+
+    EXPORT bool build() override;
+    EXPORT bool use(Matrix4 &mModel, Matrix4 &mModelViewProjection) override;
+    EXPORT void setTexture(TextureType type, Texture *texture) override;
+
+    EXPORT ShaderParameter *createShaderParameter(const char *name, ShaderParameterType type) override;
+    EXPORT ShaderParameter *createShaderUVParameter() override;
+    EXPORT void destroyShaderParameter(ShaderParameter *parameter) override;
+
+protected:
+    Texture *textures[6] = {};
+};
@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/null/rendererNull.h"
+#include "renderer/null/meshStaticNull.h"
+#include "renderer/null/phongShaderNull.h"
+#include "renderer/null/shaderNull.h"
+#include "renderer/null/textureNull.h"
+#include "renderer/effectBuffer.h"
+#include "common/commonTextures.h"
+#include <SDL.h>
+#include <algorithm>
+#include <thread>
+
+extern float spriteData[];
+extern float cubeData[];
+
+RendererNull::RendererNull(Config *config) : Renderer(config)
+{
+}
+
+RendererNull::~RendererNull()
+{
+    delete spriteShader;
+    delete framedSpriteShader;
+    delete cubeMapShader;
+    delete spriteMesh;
+    delete cubeMesh;
+}
+
+bool RendererNull::isAvailable()
+{
+    return true;
+}
+
+bool RendererNull::init(void *window)
+{
+    logger->logff("Initializing null renderer ...");
+
+    // 3 - position, 2 - UV
+    int fullAttributeSizes[2] = {3, 2};
+    spriteMesh = createStaticMesh();
+    spriteMesh->setupFloatsArray(spriteData, 6, 2, fullAttributeSizes);
+
+    // 3 - position
+    int triAttributeSizes[1] = {3};
+    cubeMesh = createStaticMesh();
+    cubeMesh->setupFloatsArray(cubeData, 36, 1, triAttributeSizes);
+
+    spriteShader = new ShaderNull();
+    framedSpriteShader = new ShaderNull();
+    cubeMapShader = new ShaderNull();
+
+    CommonTextures commonTextures;
+    commonTextures.build(this);
+
+    logger->logff("Null renderer initialized");
+    return true;
+}
+
+Texture *RendererNull::createTexture(int width, int height, int bytesPerPixel, const void *data, bool bCreateMipmaps)
+{
+    return new TextureNull(width, height);
+}
+
+Texture *RendererNull::createTextureEditable(int width, int height)
+{
+    return new TextureNull(width, height);
+}
+
+Texture *RendererNull::createTextureCompressed(CompressedImage *image)
+{
+    return new TextureNull(image->getWidth(), image->getHeight());
+}
+
+bool RendererNull::isTextureFormatSupported(TextureFormat format)
+{
+    return true;
+}
+
+Texture *RendererNull::createTextureRegion(Texture *page, int x, int y, int width, int height)
+{
+    return new TextureNull(page, x, y, width, height);
+}
+
+Texture *RendererNull::createTextureStreamed(const std::string &path, int width, int height)
+{
+    return new TextureNull(width, height);
+}
+
+void RendererNull::destroyTexture(Texture *texture)
+{
+    delete texture;
+}
+
+MeshStatic *RendererNull::createStaticMesh()
+{
+    return new MeshStaticNull();
+}
+
+// Window is only a source of events, it's never shown
+unsigned int RendererNull::getWindowFlags()
+{
+    return SDL_WINDOW_HIDDEN;
+}
+
+bool RendererNull::isHeadless()
+{
+    return true;
+}
+
+void RendererNull::render(RenderTarget *renderTarget)
+{
+    RenderElement **elements;
+    int amount;
+
+    stateChanges = 0;
+    stateChangesAvoided = 0;
+    drawCalls = 0;
+    stateCallsIssued = 0;
+    stateCallsSkipped = 0;
+    startPhases();
+
+    // === Main phase ===
+    elements = renderQueue->getMainPhaseElements();
+    if (renderQueue->isUsingSorting())
+    {
+        // Order is set by layer, elements are taken while they are still being added
+        int i = 0;
+        do
+        {
+            amount = renderQueue->getMainPhaseElementsAmount();
+            while (i < amount)
+            {
+                countMainPhaseElement(elements[i]);
+                i++;
+            }
+        } while (!renderQueue->bDone || i < renderQueue->getMainPhaseElementsAmount());
+    }
+    else
+    {
+        while (!renderQueue->bDone)
+            std::this_thread::yield();
+
+        renderQueue->sortMainPhase();
+        renderQueue->sortShadowCasters();
+
+        amount = renderQueue->getMainPhaseElementsAmount();
+        for (int i = 0; i < amount; i++)
+            countMainPhaseElement(elements[i]);
+    }
+    lastShader = nullptr;
+    lastTexture = nullptr;
+    lastParameters = nullptr;
+    finishPhase(RenderPhase::Main);
+
+    // === Lightning phase ===
+    countLights(renderTarget);
+    finishPhase(RenderPhase::Lightning);
+
+    // === Blending phase ===
+    elements = renderQueue->getBlendingPhaseElements();
+    amount = renderQueue->getBlendingPhaseElementsAmount();
+    if (!renderQueue->isUsingSorting())
+    {
+        // Far to near by view depth
+        auto compare = [](RenderElement *a, RenderElement *b)
+        { return (a->mModelViewProjection * Vector4(0.0f, 0.0f, 0.0f, 1.0f)).z > (b->mModelViewProjection * Vector4(0.0f, 0.0f, 0.0f, 1.0f)).z; };
+        std::sort(elements, elements + amount, compare);
+    }
+    for (int i = 0; i < amount; i++)
+        countBlendingElement(elements[i]);
+    lastShader = nullptr;
+    lastTexture = nullptr;
+    lastParameters = nullptr;
+    finishPhase(RenderPhase::Blending);
+
+    // === Debug phase ===
+    debug->renderAll(renderQueue->getViewProjectionMatrix());
+    debugLines.clear();
+    finishPhase(RenderPhase::Debug);
+    finishPhase(RenderPhase::Final);
+}
+
+Shader *RendererNull::getDefaultSpriteShader()
+{
+    return spriteShader;
+}
+
+Shader *RendererNull::getDefaultFramedSpriteShader()
+{
+    return framedSpriteShader;
+}
+
+Shader *RendererNull::getDefaultCubeMapShader()
+{
+    return cubeMapShader;
+}
+
+MeshStatic *RendererNull::getDefaultSpriteMesh()
+{
+    return spriteMesh;
+}
+
+MeshStatic *RendererNull::getDefaultCubeMesh()
+{
+    return cubeMesh;
+}
+
+PhongShader *RendererNull::createPhongShader()
+{
+    return new PhongShaderNull();
+}
+
+PhongShader *RendererNull::createPhongShader(const std::string &vertexCode, const std::string &fragmentCode)
+{
+    return new PhongShaderNull();
+}
+
+Shader *RendererNull::createShader(const std::string &fragmentCode)
+{
+    return new ShaderNull();
+}
+
+Shader *RendererNull::createShader(const std::string &vertexCode, const std::string &fragmentCode)
+{
+    return new ShaderNull();
+}
+
+void RendererNull::destroyShader(Shader *shader)
+{
+    delete shader;
+}
+
+EffectBuffer *RendererNull::createEffectBuffer()
+{
+    return new EffectBuffer();
+}
+
+void RendererNull::destroyEffectBuffer(EffectBuffer *effectBuffer)
+{
+    if (effectBuffer)
+        delete effectBuffer;
+}
+
+void RendererNull::countMainPhaseElement(RenderElement *element)
+{
+    if (!element->shader || !element->mesh)
+        return;
+
+    bool bShaderChanged = element->shader != lastShader;
+    countStateChange(bShaderChanged);
+    lastShader = element->shader;
+    if (bShaderChanged || element->shader->hasTextureBindings())
+        lastTexture = nullptr;
+
+    if (element->texture)
+    {
+        bool bTextureChanged = element->texture != lastTexture;
+        countStateChange(bTextureChanged);
+        lastTexture = element->texture;
+    }
+
+    if (element->parametersAmount > 0)
+    {
+        bool bParametersChanged = bShaderChanged || element->parameters != lastParameters;
+        countStateChange(bParametersChanged);
+        lastParameters = element->parameters;
+    }
+
+    element->mesh->renderLod(element->lod);
+    drawCalls++;
+}
+
+void RendererNull::countBlendingElement(RenderElement *element)
+{
+    if (!element->shader || !element->mesh)
+        return;
+
+    // Blend function is a part of the state only for transparent elements
+    bool bColorModeChanged = !lastShader || element->colorMode != lastColorMode;
+    countStateChange(bColorModeChanged);
+    lastColorMode = element->colorMode;
+
+    countMainPhaseElement(element);
+}
+
+void RendererNull::countLights(RenderTarget *renderTarget)
+{
+    // Initial light with ambient and environment
+    drawCalls++;
+
+    RenderElementLight *lightElements = renderQueue->getLightElements();
+    int amount = renderQueue->getLightElementsAmount();
+    bool bHasClusteredOmni = false;
+    for (int i = 0; i < amount; i++)
+    {
+        RenderElementLight *element = &lightElements[i];
+        if (element->type == LightType::Sun)
+        {
+            Vector3 normal = glm::length2(element->position) != 0 ? glm::normalize(element->position) : Vector3(0.0f, -1.0f, 0.0f);
+            if (element->bCastShadows)
+                countShadowCasters(renderTarget, normal, element->affectDistance);
+            drawCalls++;
+        }
+        if (element->type == LightType::Omni && omniLightMode == OmniLightMode::Volumes)
+            drawCalls++;
+        else if (element->type == LightType::Omni)
+            bHasClusteredOmni = true;
+    }
+
+    // All omni lights are shaded by one full screen pass
+    if (bHasClusteredOmni)
+        drawCalls++;
+}
+
+void RendererNull::countShadowCasters(RenderTarget *renderTarget, const Vector3 &direction, float affectDistance)
+{
+    RenderElement **elements = renderQueue->getShadowCasterElements();
+    int amount = renderQueue->getShadowCasterElementsAmount();
+
+    sunCascades.setup(shadowCascadesAmount, shadowSplitLambda);
+    int cascadesAmount = sunCascades.getCascadesAmount();
+    int tileSize = renderTarget->getShadowMapSize() / (cascadesAmount > 1 ? 2 : 1);
+    sunCascades.update(direction, *renderQueue->getViewMatrix(), *renderQueue->getProjectionMatrix(), affectDistance, tileSize);
+
+    for (int c = 0; c < cascadesAmount; c++)
+    {
+        // Casters are sorted by texture, so it changes only between groups
+        Texture *lastShadowTexture = nullptr;
+        for (int i = 0; i < amount; i++)
+        {
+            RenderElement *element = elements[i];
+            if (!element->mesh || !sunCascades.isSphereInCascade(c, element->boundsCenter, element->boundsRadius))
+                continue;
+
+            if (element->texture)
+            {
+                countStateChange(element->texture != lastShadowTexture);
+                lastShadowTexture = element->texture;
+            }
+            element->mesh->renderLod(element->lod);
+            drawCalls++;
+        }
+    }
+}
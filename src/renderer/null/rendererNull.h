@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "renderer/renderer.h"
+#include "renderer/shadowCascades.h"
+#include "connector/withLogger.h"
+#include "connector/withDebug.h"
+#include "connector/withCore.h"
+
+// Renderer without graphics API for servers, tests and CPU profiling
+// Consumes render queue the same way as GPU renderers: waits for it, sorts it and counts state changes and draw calls
+// Works with any SDL video driver including dummy one
+class RendererNull : public Renderer, public WithLogger, public WithDebug, public WithCore
+{
+public:
+    EXPORT RendererNull(Config *config);
+    EXPORT ~RendererNull();
+
+    EXPORT static bool isAvailable();
+
+    EXPORT bool init(void *window) final override;
+
+    EXPORT Texture *createTexture(int width, int height, int bytesPerPixel, const void *data, bool bCreateMipmaps) final override;
+    EXPORT Texture *createTextureEditable(int width, int height) final override;
+    EXPORT void destroyTexture(Texture *texture) override;
+    EXPORT Texture *createTextureCompressed(CompressedImage *image) override;
+    EXPORT bool isTextureFormatSupported(TextureFormat format) override;
+    EXPORT Texture *createTextureRegion(Texture *page, int x, int y, int width, int height) override;
+    EXPORT Texture *createTextureStreamed(const std::string &path, int width, int height) override;
+
+    EXPORT MeshStatic *createStaticMesh() override;
+
+    EXPORT unsigned int getWindowFlags() final override;
+    EXPORT bool isHeadless() final override;
+
+    EXPORT void render(RenderTarget *renderTarget) final override;
+
+    EXPORT Shader *getDefaultSpriteShader() override;
+    EXPORT Shader *getDefaultFramedSpriteShader() override;
+    EXPORT Shader *getDefaultCubeMapShader() override;
+
+    EXPORT MeshStatic *getDefaultSpriteMesh() override;
+    EXPORT MeshStatic *getDefaultCubeMesh() override;
+
+    EXPORT PhongShader *createPhongShader() override;
+    EXPORT PhongShader *createPhongShader(const std::string &vertexCode, const std::string &fragmentCode) override;
+
+    EXPORT Shader *createShader(const std::string &fragmentCode) override;
+    EXPORT Shader *createShader(const std::string &vertexCode, const std::string &fragmentCode) override;
+
+    EXPORT void destroyShader(Shader *shader) override;
+
+    EXPORT EffectBuffer *createEffectBuffer() override;
+    EXPORT void destroyEffectBuffer(EffectBuffer *effectBuffer) override;
+
+protected:
+    // Counts binds the element would need after the previous one and its draw
+    void countMainPhaseElement(RenderElement *element);
+    // Same for transparent elements, blend function follows color mode
+    void countBlendingElement(RenderElement *element);
+    // Full screen passes and volumes of every light, casters are split by cascades as GPU renderers do
+    void countLights(RenderTarget *renderTarget);
+    void countShadowCasters(RenderTarget *renderTarget, const Vector3 &direction, float affectDistance);
+
+    Shader *spriteShader = nullptr;
+    Shader *framedSpriteShader = nullptr;
+    Shader *cubeMapShader = nullptr;
+    MeshStatic *spriteMesh = nullptr;
+    MeshStatic *cubeMesh = nullptr;
+
+    // State set by the last counted element
+    Shader *lastShader = nullptr;
+    Texture *lastTexture = nullptr;
+    ShaderParameter **lastParameters = nullptr;
+    ColorMode lastColorMode = ColorMode::Lit;
+
+    ShadowCascades sunCascades;
+};
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/null/shaderNull.h"
+#include "renderer/null/shaderParameterNull.h"
+
+ShaderNull::ShaderNull()
+{
+    bIsReady = true;
+}
+
+ShaderNull::~ShaderNull()
+{
+    for (auto &binding : textureBindings)
+        delete binding;
+}
+
+bool ShaderNull::build()
+{
+    return true;
+}
+
+bool ShaderNull::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
+{
+    currentShader = this;
+    return true;
+}
+
+ShaderParameter *ShaderNull::createShaderParameter(const char *name, ShaderParameterType type)
+{
+    return new ShaderParameterNull(type);
+}
+
+void ShaderNull::destroyShaderParameter(ShaderParameter *parameter)
+{
+    delete parameter;
+}
+
+TextureBinding *ShaderNull::addTextureBinding(const std::string parameterName)
+{
+    TextureBinding *binding = new TextureBinding();
+    binding->setTexture(nullptr);
+    textureBindings.push_back(binding);
+    return binding;
+}
+
+bool ShaderNull::hasTextureBindings()
+{
+    return !textureBindings.empty();
+}
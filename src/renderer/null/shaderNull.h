@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "renderer/shader.h"
+#include <vector>
+
+// Shader without program, parameters and texture bindings are kept for owners that set them
+class ShaderNull : public Shader
+{
+public:
+    EXPORT ShaderNull();
+    EXPORT ~ShaderNull();
+
+    EXPORT bool build() override;
+    EXPORT bool use(Matrix4 &mModel, Matrix4 &mModelViewProjection) override;
+
+    EXPORT ShaderParameter *createShaderParameter(const char *name, ShaderParameterType type) override;
+    EXPORT void destroyShaderParameter(ShaderParameter *parameter) override;
+
+    EXPORT TextureBinding *addTextureBinding(const std::string parameterName) override;
+    EXPORT bool hasTextureBindings() override;
+
+protected:
+    std::vector<TextureBinding *> textureBindings;
+};
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/null/shaderParameterNull.h"
+
+ShaderParameterNull::ShaderParameterNull(ShaderParameterType type) : ShaderParameter(type)
+{
+}
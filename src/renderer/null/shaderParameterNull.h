@@ -0,0 +1,12 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "renderer/shaderParameter.h"
+
+// Keeps the value set by owner, applying it does nothing
+class ShaderParameterNull : public ShaderParameter
+{
+public:
+    EXPORT ShaderParameterNull(ShaderParameterType type);
+};
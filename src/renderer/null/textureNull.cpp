@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/null/textureNull.h"
+
+TextureNull::TextureNull(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+}
+
+TextureNull::TextureNull(Texture *page, int x, int y, int width, int height)
+{
+    setRegion(page, x, y, width, height);
+}
+
+Texture *TextureNull::clone()
+{
+    TextureNull *texture = new TextureNull(width, height);
+    texture->filter = filter;
+    return texture;
+}
@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "renderer/texture.h"
+
+// Keeps only size of the image, pixels are dropped
+class TextureNull : public Texture
+{
+public:
+    EXPORT TextureNull(int width, int height);
+    EXPORT TextureNull(Texture *page, int x, int y, int width, int height);
+
+    EXPORT Texture *clone() override;
+};
@@ -0,0 +1,242 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/occlusionCulling.h"
+#include <float.h>
+
+void OcclusionCulling::begin(const Matrix4 &mViewProjection)
+{
+    this->mViewProjection = mViewProjection;
+    triangles.clear();
+
+    for (int level = 0; level < OCCLUSION_LEVELS; level++)
+        depth[level].resize((OCCLUSION_WIDTH >> level) * (OCCLUSION_HEIGHT >> level));
+    std::fill(depth[0].begin(), depth[0].end(), 1.0f);
+}
+
+void OcclusionCulling::addOccluder(MeshStatic *mesh, const Matrix4 &mModel)
+{
+    const float *data = mesh->getVertexData();
+    int stride = mesh->getFloatsPerVertex();
+    if (!data || stride < 3)
+        return;
+
+    Matrix4 mModelViewProjection = mViewProjection * mModel;
+    int amount = mesh->getVertexAmount() - mesh->getVertexAmount() % 3;
+    for (int i = 0; i < amount; i += 3)
+    {
+        const float *a = &data[i * stride];
+        const float *b = &data[(i + 1) * stride];
+        const float *c = &data[(i + 2) * stride];
+        addTriangle(mModelViewProjection * Vector4(a[0], a[1], a[2], 1.0f),
+                    mModelViewProjection * Vector4(b[0], b[1], b[2], 1.0f),
+                    mModelViewProjection * Vector4(c[0], c[1], c[2], 1.0f));
+    }
+}
+
+// Bands of rows are independent, every job goes through all triangles but touches only its rows
+void OcclusionCulling::rasterize()
+{
+    int jobs = std::max(1, std::min(core->getMaxJobs(), OCCLUSION_HEIGHT / OCCLUSION_MIN_ROWS_PER_JOB));
+    int rowsPerJob = OCCLUSION_HEIGHT / jobs;
+    int currentRow = 0;
+    for (int i = 0; i < jobs; i++)
+    {
+        int end = (i == jobs - 1) ? OCCLUSION_HEIGHT : currentRow + rowsPerJob;
+        core->queueJob([this, currentRow, end]
+                       { rasterizeRows(currentRow, end); },
+                       &jobsInFlight);
+        currentRow = end;
+    }
+    core->waitForJobs(&jobsInFlight);
+
+    for (int level = 1; level < OCCLUSION_LEVELS; level++)
+        buildLevel(level);
+}
+
+bool OcclusionCulling::isOccluded(const AABB &aabb)
+{
+    Vector2 low = Vector2(FLT_MAX);
+    Vector2 high = Vector2(-FLT_MAX);
+    float nearest = FLT_MAX;
+    for (int i = 0; i < 8; i++)
+    {
+        Vector3 corner = Vector3((i & 1) ? aabb.end.x : aabb.start.x, (i & 2) ? aabb.end.y : aabb.start.y, (i & 4) ? aabb.end.z : aabb.start.z);
+        Vector4 clip = mViewProjection * Vector4(corner, 1.0f);
+
+        // Box crossing near plane covers the camera
+        if (clip.w <= 0.00001f || clip.z < -clip.w)
+            return false;
+
+        Vector3 ndc = Vector3(clip) / clip.w;
+        low = glm::min(low, Vector2(ndc));
+        high = glm::max(high, Vector2(ndc));
+        nearest = fminf(nearest, ndc.z);
+    }
+
+    int x0 = (int)floorf((low.x * 0.5f + 0.5f) * OCCLUSION_WIDTH);
+    int x1 = (int)floorf((high.x * 0.5f + 0.5f) * OCCLUSION_WIDTH);
+    int y0 = (int)floorf((low.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT);
+    int y1 = (int)floorf((high.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT);
+    if (x1 < 0 || y1 < 0 || x0 >= OCCLUSION_WIDTH || y0 >= OCCLUSION_HEIGHT)
+        return false;
+
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, OCCLUSION_WIDTH - 1);
+    y1 = std::min(y1, OCCLUSION_HEIGHT - 1);
+
+    // Level where box spans two texels or so, every texel keeps the farthest occluder depth of its pixels
+    int extent = std::max(x1 - x0, y1 - y0);
+    int level = 0;
+    while (level < OCCLUSION_LEVELS - 1 && (extent >> level) > 1)
+        level++;
+
+    int width = OCCLUSION_WIDTH >> level;
+    const float *levelDepth = depth[level].data();
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+            if (levelDepth[y * width + x] >= nearest)
+                return false;
+
+    return true;
+}
+
+void OcclusionCulling::addTriangle(const Vector4 &a, const Vector4 &b, const Vector4 &c)
+{
+    // Triangle outside of one of the planes can't hide anything
+    if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+        (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+        (a.z > a.w && b.z > b.w && c.z > c.w))
+        return;
+
+    // Clipping by near plane only, z + w is positive in front of it
+    const Vector4 *vertices[3] = {&a, &b, &c};
+    Vector4 polygon[4];
+    int amount = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        const Vector4 &p = *vertices[i];
+        const Vector4 &q = *vertices[(i + 1) % 3];
+        float dp = p.z + p.w;
+        float dq = q.z + q.w;
+        if (dp >= 0.0f)
+            polygon[amount++] = p;
+        if ((dp >= 0.0f) != (dq >= 0.0f))
+            polygon[amount++] = p + (q - p) * (dp / (dp - dq));
+    }
+    if (amount < 3)
+        return;
+
+    float screen[4][3];
+    for (int i = 0; i < amount; i++)
+    {
+        float w = fmaxf(polygon[i].w, 0.00001f);
+        screen[i][0] = (polygon[i].x / w * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+        screen[i][1] = (polygon[i].y / w * 0.5f + 0.5f) * OCCLUSION_HEIGHT;
+        screen[i][2] = polygon[i].z / w;
+    }
+
+    for (int i = 1; i < amount - 1; i++)
+    {
+        triangles.insert(triangles.end(), screen[0], screen[0] + 3);
+        triangles.insert(triangles.end(), screen[i], screen[i] + 3);
+        triangles.insert(triangles.end(), screen[i + 1], screen[i + 1] + 3);
+    }
+}
+
+// Edge functions and depth are planes in screen space, pixel is covered if its center is inside all edges
+void OcclusionCulling::rasterizeRows(int rowFrom, int rowTo)
+{
+    float *buffer = depth[0].data();
+    int amount = triangles.size() / 9;
+    for (int t = 0; t < amount; t++)
+    {
+        const float *v = &triangles[t * 9];
+        float x0 = v[0], y0 = v[1], z0 = v[2];
+        float x1 = v[3], y1 = v[4], z1 = v[5];
+        float x2 = v[6], y2 = v[7], z2 = v[8];
+
+        float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+        if (fabsf(area) < 0.00001f)
+            continue;
+        if (area < 0.0f)
+        {
+            std::swap(x1, x2);
+            std::swap(y1, y2);
+            std::swap(z1, z2);
+            area = -area;
+        }
+
+        int minX = std::max(0, (int)ceilf(fminf(x0, fminf(x1, x2)) - 0.5f));
+        int maxX = std::min(OCCLUSION_WIDTH - 1, (int)floorf(fmaxf(x0, fmaxf(x1, x2)) - 0.5f));
+        int minY = std::max(rowFrom, (int)ceilf(fminf(y0, fminf(y1, y2)) - 0.5f));
+        int maxY = std::min(rowTo - 1, (int)floorf(fmaxf(y0, fmaxf(y1, y2)) - 0.5f));
+        if (minX > maxX || minY > maxY)
+            continue;
+
+        // Edge from a to b is (ya - yb) * x + (xb - xa) * y + c, positive inside
+        float a12 = y1 - y2, b12 = x2 - x1, c12 = x1 * y2 - x2 * y1;
+        float a20 = y2 - y0, b20 = x0 - x2, c20 = x2 * y0 - x0 * y2;
+        float a01 = y0 - y1, b01 = x1 - x0, c01 = x0 * y1 - x1 * y0;
+
+        // Depth from barycentric weights, which are edges divided by area
+        float invArea = 1.0f / area;
+        float zA = (a12 * z0 + a20 * z1 + a01 * z2) * invArea;
+        float zB = (b12 * z0 + b20 * z1 + b01 * z2) * invArea;
+        float zC = (c12 * z0 + c20 * z1 + c01 * z2) * invArea;
+
+        int startX = minX & ~3;
+        for (int y = minY; y <= maxY; y++)
+        {
+            float cy = y + 0.5f;
+            float row12 = b12 * cy + c12;
+            float row20 = b20 * cy + c20;
+            float row01 = b01 * cy + c01;
+            float rowZ = zB * cy + zC;
+            float *line = &buffer[y * OCCLUSION_WIDTH];
+
+#if defined(OCCLUSION_SSE)
+            __m128 zero = _mm_setzero_ps();
+            __m128 stepX = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            for (int x = startX; x <= maxX; x += 4)
+            {
+                __m128 cx = _mm_add_ps(_mm_set1_ps((float)x), stepX);
+                __m128 e12 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a12), cx), _mm_set1_ps(row12));
+                __m128 e20 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a20), cx), _mm_set1_ps(row20));
+                __m128 e01 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a01), cx), _mm_set1_ps(row01));
+                __m128 inside = _mm_and_ps(_mm_cmpge_ps(e12, zero), _mm_and_ps(_mm_cmpge_ps(e20, zero), _mm_cmpge_ps(e01, zero)));
+                if (!_mm_movemask_ps(inside))
+                    continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), cx), _mm_set1_ps(rowZ));
+                __m128 old = _mm_loadu_ps(&line[x]);
+                __m128 nearer = _mm_min_ps(old, z);
+                _mm_storeu_ps(&line[x], _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for (int x = startX; x <= maxX; x++)
+            {
+                float cx = x + 0.5f;
+                if (a12 * cx + row12 >= 0.0f && a20 * cx + row20 >= 0.0f && a01 * cx + row01 >= 0.0f)
+                    line[x] = fminf(line[x], zA * cx + rowZ);
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCulling::buildLevel(int level)
+{
+    const float *source = depth[level - 1].data();
+    float *target = depth[level].data();
+    int sourceWidth = OCCLUSION_WIDTH >> (level - 1);
+    int width = OCCLUSION_WIDTH >> level;
+    int height = OCCLUSION_HEIGHT >> level;
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            const float *texel = &source[y * 2 * sourceWidth + x * 2];
+            target[y * width + x] = fmaxf(fmaxf(texel[0], texel[1]), fmaxf(texel[sourceWidth], texel[sourceWidth + 1]));
+        }
+}
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "math/math.h"
+#include "mesh/meshStatic.h"
+#include "connector/withCore.h"
+#include <vector>
+#include <atomic>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define OCCLUSION_SSE
+#endif
+
+// Depth buffer is small, only big occluders matter and a pixel of it is a few pixels of the screen
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_HEIGHT 128
+// Last level is 2x1
+#define OCCLUSION_LEVELS 8
+// Rows of depth buffer rasterized by one job at least
+#define OCCLUSION_MIN_ROWS_PER_JOB 8
+
+// Software rasterizer of occluder meshes into a low resolution depth buffer
+// Depth is z of normalized device coordinates, buffer keeps the nearest one and levels of hierarchy keep the farthest one of 2x2 texels below
+// Pixel is covered if its center is, so tiny gaps between occluders may hide things seen only through them
+class OcclusionCulling : public WithCore
+{
+public:
+    EXPORT void begin(const Matrix4 &mViewProjection);
+
+    // Triangles of mesh are rasterized as they are, proxy should be inside of the visible mesh
+    EXPORT void addOccluder(MeshStatic *mesh, const Matrix4 &mModel);
+    // Rasterizes occluders on workers and builds the hierarchy
+    EXPORT void rasterize();
+
+    // World space box, true only if every pixel it may cover has an occluder in front of it
+    EXPORT bool isOccluded(const AABB &aabb);
+
+    inline bool hasOccluders() { return !triangles.empty(); }
+    inline int getTrianglesAmount() { return triangles.size() / 9; }
+    inline const float *getDepth(int level) { return depth[level].data(); }
+
+protected:
+    void addTriangle(const Vector4 &a, const Vector4 &b, const Vector4 &c);
+    void rasterizeRows(int rowFrom, int rowTo);
+    void buildLevel(int level);
+
+    Matrix4 mViewProjection;
+
+    // Screen x, y and depth of every vertex, 3 vertices per triangle
+    std::vector<float> triangles;
+    std::vector<float> depth[OCCLUSION_LEVELS];
+
+    std::atomic<int> jobsInFlight = 0;
+};
@@ -4,6 +4,7 @@
 #include "renderer/opengl/effectBufferOpenGL.h"
 #include "renderer/opengl/shaders/commonOpenGLShaders.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 
 EffectBufferOpenGL::EffectBufferOpenGL()
 {
@@ -25,7 +26,7 @@ void EffectBufferOpenGL::prepare(int width, int height)
         glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
         glGenTextures(1, &renderedTexture);
-        glBindTexture(GL_TEXTURE_2D, renderedTexture);
+        StateOpenGL::bindTexture(GL_TEXTURE_2D, renderedTexture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
         glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, renderedTexture, 0);
 
@@ -33,11 +34,11 @@ void EffectBufferOpenGL::prepare(int width, int height)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     }
 
-    glBindTexture(GL_TEXTURE_2D, renderedTexture);
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, renderedTexture);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::disable(GL_CULL_FACE);
 }
 
 void EffectBufferOpenGL::render(Renderer *renderer, RenderTarget *renderTarget, ParametredShader *effect)
@@ -52,15 +53,14 @@ void EffectBufferOpenGL::render(Renderer *renderer, RenderTarget *renderTarget,
     Matrix4 m(1.0f);
 
     effect->shader->use(m, m);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getResultTexture());
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, renderTarget->getResultTexture());
     for (int i = 0; i < effect->parametersAmount; i++)
     {
         effect->parameters[i]->apply();
     }
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
@@ -68,10 +68,10 @@ void EffectBufferOpenGL::render(Renderer *renderer, RenderTarget *renderTarget,
     effectShader->use(m, m);
     effectShader->setOpacity(effect->shader->getOpacity());
 
-    glBindTexture(GL_TEXTURE_2D, renderedTexture);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, renderedTexture);
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
\ No newline at end of file
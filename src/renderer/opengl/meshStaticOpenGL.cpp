@@ -5,8 +5,11 @@
 #include "renderer/renderer.h"
 #include "math/math.h"
 #include "math/smallestEnclosingSphere.h"
+#include "mesh/vertexQuantizer.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include <string.h>
+#include <algorithm>
 
 MeshStaticOpenGL::MeshStaticOpenGL()
 {
@@ -23,14 +26,64 @@ void MeshStaticOpenGL::render()
     if (!vertexAmount)
         return;
 
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, vertexAmount);
+    StateOpenGL::bindVertexArray(vao);
+    setPositionAttributes();
+    if (ebo)
+        drawLod(0, 0);
+    else
+        glDrawArrays(GL_TRIANGLES, 0, vertexAmount);
+}
+
+void MeshStaticOpenGL::renderLod(int lod)
+{
+    if (!vertexAmount)
+        return;
+
+    StateOpenGL::bindVertexArray(vao);
+    setPositionAttributes();
+    if (ebo)
+        drawLod(lod, 0);
+    else
+        glDrawArrays(GL_TRIANGLES, 0, vertexAmount);
+}
+
+void MeshStaticOpenGL::renderInstanced(unsigned int instanceBuffer, int offset, int amount, int lod)
+{
+    if (!vertexAmount || amount <= 0)
+        return;
+
+    StateOpenGL::bindVertexArray(vao);
+    setPositionAttributes();
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+    // No base instance in 4.1, attributes are pointed to the start of the run instead
+    int stride = INSTANCE_FLOATS * sizeof(float);
+    size_t start = (size_t)offset * stride;
+    for (int i = 0; i < 5; i++)
+    {
+        int location = INSTANCE_ATTRIBUTE_MODEL + i;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void *)(start + i * 4 * sizeof(float)));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    if (ebo)
+        drawLod(lod, amount);
+    else
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexAmount, amount);
+
+    // Shared VAO is used by usual draws as well
+    for (int i = 0; i < 5; i++)
+        glDisableVertexAttribArray(INSTANCE_ATTRIBUTE_MODEL + i);
 }
 
 Mesh *MeshStaticOpenGL::createInstance()
 {
     MeshStaticOpenGL *newMesh = new MeshStaticOpenGL();
     newMesh->setupInstance(vao, vbo, vertexAmount, floatsPerVertex, attributesAmount, vertexData, boundVolume);
+    newMesh->setupInstanceLods(ebo, lods);
+    newMesh->setupInstanceFormat(vertexFormat, positionOffset, positionScale);
+    newMesh->sortId = sortId;
     newMesh->setDefaultShader(this->getDefaultShader());
     return newMesh;
 }
@@ -43,6 +96,7 @@ Geometry *MeshStaticOpenGL::getGeometry()
 void MeshStaticOpenGL::setupFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents)
 {
     clear();
+    vertexFormat = MeshVertexFormat::Float;
 
     floatsPerVertex = 0;
     for (int i = 0; i < attributesAmount; i++)
@@ -116,6 +170,88 @@ void MeshStaticOpenGL::setupFloatsArray(const float *data, int vertexAmount, int
     }
 }
 
+void MeshStaticOpenGL::setupLodChain(const MeshLodChain &chain, int attributesAmount, int *attributeSize, bool buildTangents)
+{
+    clear();
+    if (chain.lods.empty() || chain.floatsPerVertex <= 0)
+        return;
+
+    int sourceFloats = chain.floatsPerVertex;
+    int weldedAmount = chain.vertices.size() / sourceFloats;
+    floatsPerVertex = sourceFloats + (buildTangents ? 6 : 0);
+    std::vector<float> vertices(weldedAmount * floatsPerVertex, 0.0f);
+    for (int i = 0; i < weldedAmount; i++)
+        memcpy(&vertices[i * floatsPerVertex], &chain.vertices[i * sourceFloats], sourceFloats * sizeof(float));
+
+    // Vertices are shared by triangles, so tangents of the full level are summed up and normalized
+    if (buildTangents)
+    {
+        const MeshLod &full = chain.lods[0];
+        for (int i = 0; i + 2 < full.indexAmount; i += 3)
+        {
+            const unsigned int *tri = &chain.indexes[full.indexOffset + i];
+            float tg[6];
+            calcTangets(&vertices[tri[0] * floatsPerVertex], &vertices[tri[1] * floatsPerVertex], &vertices[tri[2] * floatsPerVertex], tg);
+            for (int k = 0; k < 3; k++)
+                for (int j = 0; j < 6; j++)
+                    vertices[tri[k] * floatsPerVertex + sourceFloats + j] += tg[j];
+        }
+        for (int i = 0; i < weldedAmount; i++)
+            for (int j = 0; j < 2; j++)
+            {
+                float *tangent = &vertices[i * floatsPerVertex + sourceFloats + j * 3];
+                float length = sqrtf(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+                if (length > 0.0f)
+                    tangent[0] /= length, tangent[1] /= length, tangent[2] /= length;
+            }
+    }
+
+    // Full level stays plain list of triangles for physics, occlusion and other CPU users
+    const MeshLod &full = chain.lods[0];
+    vertexAmount = full.indexAmount;
+    vertexData = new float[floatsPerVertex * vertexAmount];
+    for (int i = 0; i < vertexAmount; i++)
+        memcpy(&vertexData[i * floatsPerVertex], &vertices[chain.indexes[full.indexOffset + i] * floatsPerVertex], floatsPerVertex * sizeof(float));
+
+    Sphere volumeSphere = makeSmallestSphere(vertices.data(), weldedAmount, floatsPerVertex);
+    setBoundVolumeSphere(volumeSphere.center, volumeSphere.radius);
+
+    int newAttributeAmount = attributesAmount + (buildTangents ? 2 : 0);
+    std::vector<int> newAttributeSize(attributeSize, attributeSize + attributesAmount);
+    if (buildTangents)
+        newAttributeSize.insert(newAttributeSize.end(), {3, 3});
+
+    // Only the usual position, normal, uv layout is packed
+    bool bPackable = attributesAmount == 3 && attributeSize[0] == 3 && attributeSize[1] == 3 && attributeSize[2] == 2;
+    if (vertexFormat == MeshVertexFormat::Packed && bPackable)
+    {
+        VertexQuantizer::getPositionBounds(vertices.data(), weldedAmount, floatsPerVertex, positionOffset, positionScale);
+        std::vector<unsigned char> packed;
+        VertexQuantizer::pack(vertices.data(), weldedAmount, floatsPerVertex, buildTangents, positionOffset, positionScale, packed);
+
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+        makePackedVAO(buildTangents);
+    }
+    else
+    {
+        vertexFormat = MeshVertexFormat::Float;
+        makeVBO(vertices.data(), vertices.size());
+        makeVAO(newAttributeAmount, newAttributeSize.data());
+    }
+    this->attributesAmount = newAttributeAmount;
+
+    // Element buffer binding is part of VAO state
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, chain.indexes.size() * sizeof(unsigned int), chain.indexes.data(), GL_STATIC_DRAW);
+    StateOpenGL::bindVertexArray(0);
+
+    lods = chain.lods;
+    geometry = new Geometry(vertexData, vertexAmount, floatsPerVertex, 0);
+}
+
 void MeshStaticOpenGL::setupInstance(unsigned int vao, unsigned int vbo, int vertexAmount, int floatsPerVertex, int attributesAmount, float *vertexData, Sphere &boundVolume)
 {
     isInstance = true;
@@ -126,6 +262,21 @@ void MeshStaticOpenGL::setupInstance(unsigned int vao, unsigned int vbo, int ver
     this->attributesAmount = attributesAmount;
     this->vertexData = vertexData;
     this->boundVolume = boundVolume;
+    this->ebo = 0;
+    this->lods.clear();
+}
+
+void MeshStaticOpenGL::setupInstanceLods(unsigned int ebo, const std::vector<MeshLod> &lods)
+{
+    this->ebo = ebo;
+    this->lods = lods;
+}
+
+void MeshStaticOpenGL::setupInstanceFormat(MeshVertexFormat format, const Vector3 &positionOffset, const Vector3 &positionScale)
+{
+    this->vertexFormat = format;
+    this->positionOffset = positionOffset;
+    this->positionScale = positionScale;
 }
 
 EXPORT void MeshStaticOpenGL::setOtherMeshAsInstanceOfThis(MeshStatic *mesh)
@@ -133,6 +284,9 @@ EXPORT void MeshStaticOpenGL::setOtherMeshAsInstanceOfThis(MeshStatic *mesh)
     if (mesh)
     {
         reinterpret_cast<MeshStaticOpenGL *>(mesh)->setupInstance(vao, vbo, vertexAmount, floatsPerVertex, attributesAmount, vertexData, boundVolume);
+        reinterpret_cast<MeshStaticOpenGL *>(mesh)->setupInstanceLods(ebo, lods);
+        reinterpret_cast<MeshStaticOpenGL *>(mesh)->setupInstanceFormat(vertexFormat, positionOffset, positionScale);
+        reinterpret_cast<MeshStaticOpenGL *>(mesh)->sortId = sortId;
     }
 }
 
@@ -141,9 +295,18 @@ void MeshStaticOpenGL::clear()
     if (vbo)
         glDeleteBuffers(1, &vbo);
     if (vao)
+    {
         glDeleteVertexArrays(1, &vao);
+        StateOpenGL::forgetVertexArray(vao);
+    }
+    if (ebo)
+        glDeleteBuffers(1, &ebo);
     vbo = 0;
     vao = 0;
+    ebo = 0;
+    lods.clear();
+    positionOffset = Vector3(0.0f);
+    positionScale = Vector3(1.0f);
     if (vertexData)
         delete[] vertexData;
     vertexData = nullptr;
@@ -155,7 +318,7 @@ void MeshStaticOpenGL::clear()
 void MeshStaticOpenGL::useVertexArray()
 {
     if (vao)
-        glBindVertexArray(vao);
+        StateOpenGL::bindVertexArray(vao);
 }
 
 MeshStatic *MeshStaticOpenGL::getAsStatic()
@@ -163,6 +326,16 @@ MeshStatic *MeshStaticOpenGL::getAsStatic()
     return this;
 }
 
+void MeshStaticOpenGL::drawLod(int lod, int instances)
+{
+    const MeshLod &level = lods[std::max(0, std::min(lod, (int)lods.size() - 1))];
+    void *offset = (void *)(level.indexOffset * sizeof(unsigned int));
+    if (instances > 0)
+        glDrawElementsInstanced(GL_TRIANGLES, level.indexAmount, GL_UNSIGNED_INT, offset, instances);
+    else
+        glDrawElements(GL_TRIANGLES, level.indexAmount, GL_UNSIGNED_INT, offset);
+}
+
 void MeshStaticOpenGL::makeVBO(const float *data, int amount)
 {
     glGenBuffers(1, &vbo);
@@ -173,7 +346,7 @@ void MeshStaticOpenGL::makeVBO(const float *data, int amount)
 void MeshStaticOpenGL::makeVAO(int attributesAmount, int *attributeSize)
 {
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    StateOpenGL::bindVertexArray(vao);
 
     for (int i = 0; i < attributesAmount; i++)
         glEnableVertexAttribArray(i);
@@ -186,3 +359,32 @@ void MeshStaticOpenGL::makeVAO(int attributesAmount, int *attributeSize)
         shift += attributeSize[i];
     }
 }
+
+// Bitangent isn't stored, shaders restore it from normal, tangent and its sign in w of position
+void MeshStaticOpenGL::makePackedVAO(bool hasTangents)
+{
+    glGenVertexArrays(1, &vao);
+    StateOpenGL::bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    int stride = VertexQuantizer::getVertexSize(hasTangents);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void *)PACKED_VERTEX_NORMAL_OFFSET);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void *)PACKED_VERTEX_UV_OFFSET);
+    if (hasTangents)
+    {
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, stride, (void *)PACKED_VERTEX_TANGENT_OFFSET);
+    }
+}
+
+// Current values of disabled attributes aren't part of VAO, so every draw sets its own
+void MeshStaticOpenGL::setPositionAttributes()
+{
+    float packed = vertexFormat == MeshVertexFormat::Packed ? 1.0f : 0.0f;
+    glVertexAttrib4f(MESH_ATTRIBUTE_POSITION_SCALE, positionScale.x, positionScale.y, positionScale.z, packed);
+    glVertexAttrib4f(MESH_ATTRIBUTE_POSITION_OFFSET, positionOffset.x, positionOffset.y, positionOffset.z, 0.0f);
+}
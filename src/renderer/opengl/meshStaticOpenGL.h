@@ -6,6 +6,14 @@
 #include "mesh/meshStatic.h"
 #include "connector/withRenderer.h"
 
+// Per instance attributes: model matrix in 4 locations and one vector of parameters
+#define INSTANCE_ATTRIBUTE_MODEL 5
+#define INSTANCE_ATTRIBUTE_PARAMETER 9
+#define INSTANCE_FLOATS 20
+// Constant attributes set on every draw: position scale with packed flag in w and position offset
+#define MESH_ATTRIBUTE_POSITION_SCALE 10
+#define MESH_ATTRIBUTE_POSITION_OFFSET 11
+
 // Don't delete the main mesh if you have instances of it
 class MeshStaticOpenGL : public MeshStatic, WithRenderer
 {
@@ -14,6 +22,10 @@ public:
     EXPORT ~MeshStaticOpenGL();
 
     EXPORT void render() override;
+    EXPORT void renderLod(int lod) override;
+
+    // Draws amount of instances reading INSTANCE_FLOATS per instance from buffer, starting with instance at offset
+    EXPORT void renderInstanced(unsigned int instanceBuffer, int offset, int amount, int lod = 0);
 
     // Instance can have it's own default shader
     // Basically that's the only difference with main mesh
@@ -26,10 +38,13 @@ public:
 
     // Make original mesh by transfering geometry data to it
     EXPORT void setupFloatsArray(const float *data, int vertexAmount, int attributesAmount, int *attributeSize, bool buildTangents = false) override;
+    EXPORT void setupLodChain(const MeshLodChain &chain, int attributesAmount, int *attributeSize, bool buildTangents = false) override;
 
     // Trasfer data to this mesh, this mesh becoming an instance
     // Doesn't change the name
     EXPORT void setupInstance(unsigned int vao, unsigned int vbo, int vertexAmount, int floatsPerVertex, int attributesAmount, float *vertexData, Sphere &boundVolume);
+    EXPORT void setupInstanceLods(unsigned int ebo, const std::vector<MeshLod> &lods);
+    EXPORT void setupInstanceFormat(MeshVertexFormat format, const Vector3 &positionOffset, const Vector3 &positionScale);
 
     // Set VAO, VBO vertex data to the mesh.
     // Target mesh becoming an instance of this mesh
@@ -47,9 +62,14 @@ public:
 protected:
     void makeVBO(const float *data, int amount);
     void makeVAO(int attributesAmount, int *attributeSize);
+    void makePackedVAO(bool hasTangents);
+    void setPositionAttributes();
+    void drawLod(int lod, int instances);
 
     unsigned int vbo = 0;
     unsigned int vao = 0;
+    // Index buffer of all levels of detail, bound to VAO
+    unsigned int ebo = 0;
 
     Geometry *geometry = nullptr;
 };
\ No newline at end of file
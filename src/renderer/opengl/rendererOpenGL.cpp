@@ -4,16 +4,19 @@
 #include "rendererOpenGL.h"
 #include "renderer/renderTarget.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "renderer/opengl/textureOpenGL.h"
 #include "renderer/opengl/shaders/commonOpenGLShaders.h"
 #include "renderer/opengl/shaders/phongOpenGLShader.h"
 #include "renderer/opengl/shaderParameterOpenGL.h"
 #include "renderer/opengl/effectBufferOpenGL.h"
+#include "renderer/opengl/meshStaticOpenGL.h"
 #include "common/commonTextures.h"
 #include "math/glm/gtc/type_ptr.hpp"
 #include "actor/actor.h"
 #include <SDL.h>
 #include <algorithm>
+#include <thread>
 
 RendererOpenGL::RendererOpenGL(Config *config) : Renderer(config)
 {
@@ -66,23 +69,26 @@ void RendererOpenGL::presentToScreen(RenderTarget *renderTarget)
     Matrix4 m;
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::disable(GL_BLEND);
 
     auto screenShader = CommonOpenGLShaders::getScreenShader();
     screenShader->use(m, m);
 
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getResultTexture());
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, renderTarget->getResultTexture());
 
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
     glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    // Streamed textures go once per frame, after everything of the frame is sent
+    textureStream.process(streamingBudget);
 }
 
 Texture *RendererOpenGL::createTexture(int width, int height, int bytesPerPixel, const void *data, bool bCreateMipmaps)
 {
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, textureID);
 
     int pixelType = bytesPerPixel == 4 ? GL_RGBA : GL_RGB;
 
@@ -93,6 +99,85 @@ Texture *RendererOpenGL::createTexture(int width, int height, int bytesPerPixel,
     return new TextureOpengGL(textureID);
 }
 
+Texture *RendererOpenGL::createTextureCompressed(CompressedImage *image)
+{
+    if (!isTextureFormatSupported(image->getFormat()) || image->getLevelsAmount() == 0)
+        return nullptr;
+
+    unsigned int internalFormat;
+    switch (image->getFormat())
+    {
+    case TextureFormat::BC1:
+        internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        break;
+    case TextureFormat::BC3:
+        internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        break;
+    case TextureFormat::BC5:
+        internalFormat = GL_COMPRESSED_RG_RGTC2;
+        break;
+    case TextureFormat::BC7:
+        internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+        break;
+    case TextureFormat::ETC2RGB:
+        internalFormat = GL_COMPRESSED_RGB8_ETC2;
+        break;
+    default:
+        internalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+        break;
+    }
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, textureID);
+
+    // Compressed levels can't be generated by GL, texture is complete with the levels it has
+    for (int i = 0; i < image->getLevelsAmount(); i++)
+    {
+        auto level = image->getLevel(i);
+        glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, level->width, level->height, 0, level->data.size(), level->data.data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image->getLevelsAmount() - 1);
+
+    return new TextureOpengGL(textureID);
+}
+
+bool RendererOpenGL::isTextureFormatSupported(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC3:
+        return GLEW_EXT_texture_compression_s3tc;
+    case TextureFormat::BC5:
+        return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+    case TextureFormat::BC7:
+        return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+    default:
+        return GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+    }
+}
+
+Texture *RendererOpenGL::createTextureRegion(Texture *page, int x, int y, int width, int height)
+{
+    return new TextureOpengGL(reinterpret_cast<TextureOpengGL *>(page), x, y, width, height);
+}
+
+Texture *RendererOpenGL::createTextureStreamed(const std::string &path, int width, int height)
+{
+    return textureStream.queue(path, width, height);
+}
+
+int RendererOpenGL::getStreamingPendingBytes()
+{
+    return textureStream.getPendingBytes();
+}
+
+float RendererOpenGL::getStreamingThroughput()
+{
+    return textureStream.getThroughput();
+}
+
 Texture *RendererOpenGL::createTextureEditable(int width, int height)
 {
     return new TextureEditableOpenGL(width, height);
@@ -127,21 +212,24 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
     TextureOpengGL *HDRTexture =
         reinterpret_cast<TextureOpengGL *>(renderQueue->getHDRTexture() ? renderQueue->getHDRTexture() : CommonTextures::getBlackTexture());
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthMask(GL_TRUE);
+    startPhases();
+    StateOpenGL::resetCounters();
+    StateOpenGL::enable(GL_DEPTH_TEST);
+    StateOpenGL::depthMask(true);
 
     renderTarget->setupLightning();
     renderTarget->setupNewFrame();
+    uniformStream.beginFrame();
 
     // === Cube Map ===
-    glEnable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::disable(GL_CULL_FACE);
 
     if (renderQueue->isShowingEnvHDR())
     {
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glDisable(GL_DEPTH_TEST);
-        glDepthMask(GL_FALSE);
+        StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        StateOpenGL::disable(GL_DEPTH_TEST);
+        StateOpenGL::depthMask(false);
 
         Transformation t;
         t.setPosition(cameraPosition);
@@ -161,50 +249,57 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
     }
 
     // === Main phase ===
-    glBlendFunc(GL_ONE, GL_ZERO);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_CULL_FACE);
+    StateOpenGL::blendFunc(GL_ONE, GL_ZERO);
+    StateOpenGL::depthFunc(GL_LESS);
+    StateOpenGL::depthMask(true);
+    StateOpenGL::enable(GL_CULL_FACE);
 
     if (renderQueue->isUsingSorting())
-        glDisable(GL_DEPTH_TEST);
+        StateOpenGL::disable(GL_DEPTH_TEST);
     else
-        glEnable(GL_DEPTH_TEST);
+        StateOpenGL::enable(GL_DEPTH_TEST);
+
+    stateChanges = 0;
+    stateChangesAvoided = 0;
+    drawCalls = 0;
 
     elements = renderQueue->getMainPhaseElements();
-    int i = 0;
-    do
+    if (renderQueue->isUsingSorting())
     {
-        amount = renderQueue->getMainPhaseElementsAmount();
-        while (i < amount)
+        // Order is set by layer, elements are drawn while they are still being added
+        int i = 0;
+        do
         {
-            RenderElement *element = elements[i];
-            if (element->shader && element->mesh)
+            amount = renderQueue->getMainPhaseElementsAmount();
+            if (i < amount)
+                streamDrawBlocks(elements, i, amount, mViewProjection);
+            while (i < amount)
             {
-                element->shader->use(element->mModel, element->mModelViewProjection);
-
-                if (element->texture)
-                {
-                    reinterpret_cast<TextureOpengGL *>(element->texture)->bind(TextureSlot::TEXTURE_0);
-                }
+                renderMainPhaseElement(elements[i], drawBlockOffsets[i]);
+                i++;
+            }
+        } while (!renderQueue->bDone || i < renderQueue->getMainPhaseElementsAmount());
+    }
+    else
+    {
+        // Whole queue is needed to sort it by state
+        while (!renderQueue->bDone)
+            std::this_thread::yield();
 
-                if (element->parametersAmount > 0)
-                {
-                    setupShaderParameters(element->parameters, element->parametersAmount);
-                }
+        renderQueue->sortMainPhase();
+        renderQueue->sortShadowCasters();
 
-                element->mesh->render();
-            }
-            i++;
-        }
-    } while (!renderQueue->bDone || core->isBusy() || i < renderQueue->getMainPhaseElementsAmount());
+        renderMainPhaseSorted(mViewProjection);
+    }
+    resetStateCache();
+    finishPhase(RenderPhase::Main);
 
     // === Initial lightning phase ===
     renderTarget->setupLightning(false);
 
-    glEnable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::depthMask(false);
 
     auto initialLightShader = CommonOpenGLShaders::getInitialLightShader();
     initialLightShader->use(m1, m2);
@@ -220,13 +315,16 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
 
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
 
-    glBlendFunc(GL_ONE, GL_ONE);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    drawCalls++;
 
     // === Lightning phase ===
     RenderElementLight *lightElements = renderQueue->getLightElements();
     amount = renderQueue->getLightElementsAmount();
 
+    omniSources.clear();
+    omniData.clear();
     for (int i = 0; i < amount; i++)
     {
         RenderElementLight *element = &lightElements[i];
@@ -237,28 +335,32 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
                 renderSunWithShadows(renderTarget, normal, element->color, element->affectDistance);
             else
                 renderSun(normal, element->color);
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(GL_FALSE);
+            StateOpenGL::disable(GL_DEPTH_TEST);
+            StateOpenGL::depthMask(false);
         }
-        if (element->type == LightType::Omni)
+        // Omni lights don't cast shadows yet, they are gathered for clustered pass
+        if (element->type == LightType::Omni && omniLightMode == OmniLightMode::Volumes)
+            renderOmniVolume(element->position, element->color, element->affectDistance);
+        else if (element->type == LightType::Omni)
         {
-            if (element->bCastShadows)
-                renderOmniWithShadows(renderTarget, element->position, element->color, element->affectDistance);
-            else
-                renderOmni(element->position, element->color, element->affectDistance);
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(GL_FALSE);
+            // G buffer keeps positions scaled by 0.1, affect distance is in that space
+            omniSources.push_back({element->position, element->affectDistance * 10.0f});
+            omniData.insert(omniData.end(), {element->position.x * 0.1f, element->position.y * 0.1f, element->position.z * 0.1f, element->affectDistance,
+                                             element->color.x, element->color.y, element->color.z, 0.0f});
         }
     }
+    if (!omniSources.empty())
+        renderOmniClustered();
+    finishPhase(RenderPhase::Lightning);
 
     // === Blending phase ===
     elements = renderQueue->getBlendingPhaseElements();
     amount = renderQueue->getBlendingPhaseElementsAmount();
 
     if (renderQueue->isUsingSorting())
-        glDisable(GL_DEPTH_TEST);
+        StateOpenGL::disable(GL_DEPTH_TEST);
     else
-        glEnable(GL_DEPTH_TEST);
+        StateOpenGL::enable(GL_DEPTH_TEST);
 
     // Sorting
     if (!renderQueue->isUsingSorting())
@@ -276,14 +378,24 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
         std::sort(elements, elements + amount, comparesort);
     }
 
+    if (amount > 0)
+        streamDrawBlocks(elements, 0, amount, mViewProjection);
     for (int i = 0; i < amount; i++)
     {
 
         RenderElement *element = elements[i];
         if (element->shader && element->mesh)
         {
-            Matrix4 m = element->mModelViewProjection;
-            element->shader->use(element->mModel, m);
+            if (drawBlockOffsets[i] >= 0)
+            {
+                uniformStream.bind(UNIFORM_BINDING_DRAW, drawBlockOffsets[i], sizeof(PhongDrawBlock));
+                element->shader->useDrawBlock();
+            }
+            else
+            {
+                Matrix4 m = element->mModelViewProjection;
+                element->shader->use(element->mModel, m);
+            }
 
             if (element->texture)
             {
@@ -293,16 +405,16 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
             switch (element->colorMode)
             {
             case ColorMode::Lit:
-                glBlendFunc(GL_ONE, GL_ZERO);
+                StateOpenGL::blendFunc(GL_ONE, GL_ZERO);
                 break;
             case ColorMode::Alpha:
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
                 break;
             case ColorMode::Addition:
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+                StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE);
                 break;
             case ColorMode::Substraction:
-                glBlendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_COLOR);
+                StateOpenGL::blendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_COLOR);
                 break;
             }
 
@@ -312,16 +424,17 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
             }
 
             element->shader->setOpacity(element->opacity);
-            element->mesh->render();
+            element->mesh->renderLod(element->lod);
+            drawCalls++;
         }
     }
 
+    finishPhase(RenderPhase::Blending);
+
     // === Debug Phase ===
     RenderElementDebug *debugElements = renderQueue->getDebugElements();
     amount = renderQueue->getDebugElementsAmount();
 
-    glDisable(GL_DEPTH_TEST);
-
     for (int i = 0; i < amount; i++)
     {
         RenderElementDebug *element = &debugElements[i];
@@ -344,6 +457,7 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
                     auto vAmount = mesh->getVertexAmount();
                     auto floatsPerVertex = mesh->getFloatsPerVertex();
                     auto data = mesh->getVertexData();
+                    debugNormals.clear();
 
                     for (int i = 0; i < vAmount; i++)
                     {
@@ -355,8 +469,10 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
                         Vector3 vts3 = Vector3(vts4.x, vts4.y, vts4.z);
                         Vector3 nr = glm::rotate(element->actor->transform.getRotation() * component->transform.getRotation(), n);
 
-                        renderDebugLine(vts3, vts3 + nr * 0.1f, &mViewProjection, 0.01f, Vector3(0.2f, 0.9f, 0.2f));
+                        debugNormals.push_back({vts3, Vector3(0.2f, 0.9f, 0.2f)});
+                        debugNormals.push_back({vts3 + nr * 0.1f, Vector3(0.2f, 0.9f, 0.2f)});
                     }
+                    debugLines.addLines(debugNormals.data(), debugNormals.size());
                 }
             }
         }
@@ -369,18 +485,19 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
         }
     }
     debug->renderAll(&mViewProjection);
+    renderDebugLines(mViewProjection);
+    finishPhase(RenderPhase::Debug);
 
     // === Final result phase ===
     renderTarget->useResultBuffer();
-    glEnable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     ShaderOpenGL *gammaShader = (config->getAnialiasing() == AntiAliasing::FXAA) ? CommonOpenGLShaders::getGammaFXAAShader() : CommonOpenGLShaders::getGammaShader();
     gammaShader->use(m1, m2);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getLightningTexture());
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, renderTarget->getLightningTexture());
 
     float gammaEffector = 1.0f / renderQueue->getGamma();
 
@@ -390,63 +507,66 @@ void RendererOpenGL::render(RenderTarget *renderTarget)
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
-}
-
-void RendererOpenGL::renderDebugLine(Vector3 a, Vector3 b, Matrix4 *mProjectionView, float thickness, Vector3 color)
-{
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
-
-    auto shader = CommonOpenGLShaders::getDebugCubeShader();
-    if (!shader)
-        return;
 
-    int shaderColorLoc = shader->getUniformLocation("color");
-
-    Vector3 p = (a + b) / 2.0f;
-    Vector3 dif = glm::normalize(b - a);
-
-    float y = atan2f(dif.z, dif.x);
-    float len = sqrtf(dif.x * dif.x + dif.z * dif.z);
-    float x = atan2(len, dif.y);
-
-    float lineLength = glm::length(a - b);
-
-    Transformation tf;
-    tf.setPosition(p);
-    tf.setRotation(Vector3(CONST_PI / 2 - x, -y - CONST_PI / 2.0f, 0.0f));
-    tf.setScale(Vector3(thickness, thickness, lineLength));
-    Matrix4 *mOut = tf.getModelMatrix();
-
-    Matrix4 mModelViewProjection = *mProjectionView * *mOut;
-    shader->use(*mOut, mModelViewProjection);
-    float colorFloat[3] = {color.x, color.y, color.z};
-    shader->provideFloat3Value(shaderColorLoc, 1, colorFloat);
-
-    CommonOpenGLShaders::getCubeMesh()->useVertexArray();
-
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    uniformStream.endFrame();
+    stateCallsIssued = StateOpenGL::getCallsIssued();
+    stateCallsSkipped = StateOpenGL::getCallsSkipped();
+    finishPhase(RenderPhase::Final);
 }
 
-void RendererOpenGL::renderDebugLine(Matrix4 *mModel, Matrix4 *mProjectionView, Vector3 color)
+void RendererOpenGL::renderDebugLines(Matrix4 &mViewProjection)
 {
-    glEnable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
-
-    auto shader = CommonOpenGLShaders::getDebugCubeShader();
-    if (!shader)
+    auto &depthTested = debugLines.getDepthTested();
+    auto &overlay = debugLines.getOverlay();
+    int depthTestedAmount = depthTested.size();
+    int overlayAmount = overlay.size();
+    auto shader = CommonOpenGLShaders::getDebugLinesShader();
+    if (!shader || depthTestedAmount + overlayAmount == 0)
+    {
+        debugLines.clear();
         return;
+    }
 
-    int shaderColorLoc = shader->getUniformLocation("color");
-
-    Matrix4 mModelViewProjection = *mProjectionView * *mModel;
-    shader->use(*mModel, mModelViewProjection);
-    float colorFloat[3] = {color.x, color.y, color.z};
-    shader->provideFloat3Value(shaderColorLoc, 1, colorFloat);
+    if (!debugLinesVao)
+    {
+        glGenVertexArrays(1, &debugLinesVao);
+        glGenBuffers(1, &debugLinesBuffer);
+        StateOpenGL::bindVertexArray(debugLinesVao);
+        glBindBuffer(GL_ARRAY_BUFFER, debugLinesBuffer);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugLineVertex), (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DebugLineVertex), (void *)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    }
 
-    CommonOpenGLShaders::getCubeMesh()->useVertexArray();
+    // Both parts go to one orphaned buffer, overlay lines follow depth tested ones
+    int vertexSize = sizeof(DebugLineVertex);
+    StateOpenGL::bindVertexArray(debugLinesVao);
+    glBindBuffer(GL_ARRAY_BUFFER, debugLinesBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (depthTestedAmount + overlayAmount) * vertexSize, nullptr, GL_STREAM_DRAW);
+    if (depthTestedAmount > 0)
+        glBufferSubData(GL_ARRAY_BUFFER, 0, depthTestedAmount * vertexSize, depthTested.data());
+    if (overlayAmount > 0)
+        glBufferSubData(GL_ARRAY_BUFFER, depthTestedAmount * vertexSize, overlayAmount * vertexSize, overlay.data());
+
+    StateOpenGL::disable(GL_BLEND);
+    Matrix4 m(1.0f);
+    shader->use(m, mViewProjection);
+
+    if (depthTestedAmount > 0)
+    {
+        StateOpenGL::enable(GL_DEPTH_TEST);
+        glDrawArrays(GL_LINES, 0, depthTestedAmount);
+        drawCalls++;
+    }
+    if (overlayAmount > 0)
+    {
+        StateOpenGL::disable(GL_DEPTH_TEST);
+        glDrawArrays(GL_LINES, depthTestedAmount, overlayAmount);
+        drawCalls++;
+    }
 
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    debugLines.clear();
 }
 
 Shader *RendererOpenGL::getDefaultSpriteShader()
@@ -527,6 +647,155 @@ void RendererOpenGL::destroyEffectBuffer(EffectBuffer *effectBuffer)
     }
 }
 
+// Shader is used for every element to set its matrices, program itself is switched only if it differs
+// Matrices in a streamed draw block only need its range bound
+void RendererOpenGL::renderMainPhaseElement(RenderElement *element, int drawBlockOffset)
+{
+    if (!element->shader || !element->mesh)
+        return;
+
+    bool bShaderChanged = element->shader != lastShader;
+    countStateChange(bShaderChanged);
+    if (drawBlockOffset >= 0)
+    {
+        uniformStream.bind(UNIFORM_BINDING_DRAW, drawBlockOffset, sizeof(PhongDrawBlock));
+        element->shader->useDrawBlock();
+    }
+    else
+        element->shader->use(element->mModel, element->mModelViewProjection);
+    lastShader = element->shader;
+    if (bShaderChanged || element->shader->hasTextureBindings())
+        lastTexture = nullptr;
+
+    if (element->texture)
+    {
+        bool bTextureChanged = element->texture != lastTexture;
+        countStateChange(bTextureChanged);
+        if (bTextureChanged)
+        {
+            reinterpret_cast<TextureOpengGL *>(element->texture)->bind(TextureSlot::TEXTURE_0);
+            lastTexture = element->texture;
+        }
+    }
+
+    // Uniforms belong to program, same parameters after same program are already set
+    if (element->parametersAmount > 0)
+    {
+        bool bParametersChanged = bShaderChanged || element->parameters != lastParameters;
+        countStateChange(bParametersChanged);
+        if (bParametersChanged)
+        {
+            setupShaderParameters(element->parameters, element->parametersAmount);
+            lastParameters = element->parameters;
+        }
+    }
+
+    element->mesh->renderLod(element->lod);
+    drawCalls++;
+}
+
+// Runs of elements with the same state are drawn as instances, matrices go to instance buffer
+void RendererOpenGL::renderMainPhaseSorted(Matrix4 &mViewProjection)
+{
+    RenderElement **elements = renderQueue->getMainPhaseElements();
+    int amount = renderQueue->getMainPhaseElementsAmount();
+    Vector4 defaultUV = Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+
+    instanceData.clear();
+    instanceRuns.clear();
+    drawBlockOffsets.assign(amount, -1);
+    PhongFrameBlock frameBlock = {mViewProjection};
+    int frameOffset = uniformStream.push(&frameBlock, sizeof(frameBlock));
+    for (int i = 0; i < amount;)
+    {
+        int length = renderQueue->getMainPhaseRunLength(i);
+        bool bInstanced = length >= MIN_INSTANCED_RUN && elements[i]->shader->isInstancingSupported();
+        instanceRuns.push_back({i, length, bInstanced ? (int)(instanceData.size() / INSTANCE_FLOATS) : -1});
+        for (int j = i; j < i + length; j++)
+        {
+            if (bInstanced)
+                pushInstance(elements[j]->mModel, defaultUV);
+            else
+                drawBlockOffsets[j] = pushDrawBlock(elements[j]);
+        }
+        i += length;
+    }
+    uploadInstances();
+    uniformStream.upload();
+    uniformStream.bind(UNIFORM_BINDING_FRAME, frameOffset, sizeof(frameBlock));
+
+    for (auto &run : instanceRuns)
+    {
+        RenderElement *element = elements[run.start];
+        if (run.offset < 0 || !element->shader->useInstanced(mViewProjection))
+        {
+            for (int i = run.start; i < run.start + run.amount; i++)
+                renderMainPhaseElement(elements[i], drawBlockOffsets[i]);
+            continue;
+        }
+
+        countStateChange(element->shader != lastShader);
+        lastShader = element->shader;
+        lastTexture = nullptr;
+        if (element->texture)
+        {
+            countStateChange(true);
+            reinterpret_cast<TextureOpengGL *>(element->texture)->bind(TextureSlot::TEXTURE_0);
+            lastTexture = element->texture;
+        }
+
+        reinterpret_cast<MeshStaticOpenGL *>(element->mesh)->renderInstanced(instanceBuffer, run.offset, run.amount, element->lod);
+        drawCalls++;
+    }
+}
+
+void RendererOpenGL::streamDrawBlocks(RenderElement **elements, int start, int end, Matrix4 &mViewProjection)
+{
+    drawBlockOffsets.resize(std::max((int)drawBlockOffsets.size(), end), -1);
+    PhongFrameBlock frameBlock = {mViewProjection};
+    int frameOffset = uniformStream.push(&frameBlock, sizeof(frameBlock));
+    for (int i = start; i < end; i++)
+        drawBlockOffsets[i] = pushDrawBlock(elements[i]);
+    uniformStream.upload();
+    uniformStream.bind(UNIFORM_BINDING_FRAME, frameOffset, sizeof(frameBlock));
+}
+
+int RendererOpenGL::pushDrawBlock(RenderElement *element)
+{
+    if (!element->shader || !element->mesh || !element->shader->isDrawBlockSupported())
+        return -1;
+
+    PhongDrawBlock block = {element->mModelViewProjection, element->mModel, glm::transpose(glm::inverse(element->mModel))};
+    return uniformStream.push(&block, sizeof(block));
+}
+
+void RendererOpenGL::pushInstance(Matrix4 &mModel, const Vector4 &parameter)
+{
+    const float *matrix = value_ptr(mModel);
+    instanceData.insert(instanceData.end(), matrix, matrix + 16);
+    instanceData.insert(instanceData.end(), value_ptr(parameter), value_ptr(parameter) + 4);
+}
+
+// Buffer is orphaned on every upload, so driver doesn't wait for previous draws using it
+void RendererOpenGL::uploadInstances()
+{
+    if (instanceData.empty())
+        return;
+
+    if (!instanceBuffer)
+        glGenBuffers(1, &instanceBuffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(float), instanceData.data(), GL_STREAM_DRAW);
+}
+
+void RendererOpenGL::resetStateCache()
+{
+    lastShader = nullptr;
+    lastTexture = nullptr;
+    lastParameters = nullptr;
+}
+
 void RendererOpenGL::setupShaderParameters(ShaderParameter **parameters, int amount)
 {
     for (int i = 0; i < amount; i++)
@@ -581,8 +850,9 @@ void RendererOpenGL::renderSun(Vector3 &direction, Vector3 &color)
     lightShader->setCameraDirection(cameraDirection);
 
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
-    glBlendFunc(GL_ONE, GL_ONE);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    drawCalls++;
 }
 
 void RendererOpenGL::renderSunWithShadows(RenderTarget *renderTarget, Vector3 &direction, Vector3 &color, float affectDistance)
@@ -596,50 +866,67 @@ void RendererOpenGL::renderSunWithShadows(RenderTarget *renderTarget, Vector3 &d
     int shadowCasterElementsAmount = renderQueue->getShadowCasterElementsAmount();
     Matrix4 m;
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_CULL_FACE);
+    StateOpenGL::enable(GL_DEPTH_TEST);
+    StateOpenGL::depthMask(true);
+    StateOpenGL::enable(GL_CULL_FACE);
     if (useFrontFace)
         glFrontFace(GL_CW);
-    glDisable(GL_BLEND);
-
-    // prepare shadowed render
-    // View matrix is placement of sun
-    Vector3 sunPosition = cameraPosition + direction * (affectDistance / 2.0f);
-    Matrix4 rotation = glm::lookAt(sunPosition, cameraPosition, Vector3(0.0f, 1.0f, 0.0f));
-
-    // Light is using orthogonal projection matrix
-    float r = affectDistance / 2.0f;
-    float l = -r;
-    float b = -affectDistance / 2.0f;
-    float t = -b;
-    float f = affectDistance * 2.0f;
-    float n = 0.0f;
+    StateOpenGL::disable(GL_BLEND);
+
+    // Cascades cover camera frustum up to affect distance, every one is a tile of shadow map
+    sunCascades.setup(shadowCascadesAmount, shadowSplitLambda);
+    int cascadesAmount = sunCascades.getCascadesAmount();
+    int tilesPerRow = cascadesAmount > 1 ? 2 : 1;
+    int tileSize = renderTarget->getShadowMapSize() / tilesPerRow;
+    sunCascades.update(direction, *renderQueue->getViewMatrix(), *renderQueue->getProjectionMatrix(), affectDistance, tileSize);
+
+    // Casters are sorted by texture and mesh, every cascade takes the ones inside of its light volume keeping the order
+    // Runs of the same mesh are drawn as instances, data of all cascades goes in one upload
+    cascadeCasters.clear();
+    instanceData.clear();
+    instanceRuns.clear();
+    for (int c = 0; c < cascadesAmount; c++)
+    {
+        int casterStart = cascadeCasters.size();
+        for (int i = 0; i < shadowCasterElementsAmount; i++)
+        {
+            if (sunCascades.isSphereInCascade(c, elements[i]->boundsCenter, elements[i]->boundsRadius))
+                cascadeCasters.push_back(elements[i]);
+        }
 
-    Matrix4 mLightViewProjection = glm::ortho(l, r, b, t, n, f);
-    mLightViewProjection = mLightViewProjection * rotation;
+        cascadeRunsStart[c] = instanceRuns.size();
+        int casterEnd = cascadeCasters.size();
+        for (int i = casterStart; i < casterEnd;)
+        {
+            int length = RenderQueue::getShadowCasterRunLength(&cascadeCasters[casterStart], casterEnd - casterStart, i - casterStart);
+            bool bInstanced = length >= MIN_INSTANCED_RUN;
+            instanceRuns.push_back({i, length, bInstanced ? (int)(instanceData.size() / INSTANCE_FLOATS) : -1});
+            if (bInstanced)
+            {
+                for (int j = i; j < i + length; j++)
+                    pushInstance(cascadeCasters[j]->mModel, cascadeCasters[j]->uvShiftSize);
+            }
+            i += length;
+        }
+    }
+    cascadeRunsStart[cascadesAmount] = instanceRuns.size();
+    uploadInstances();
 
     renderTarget->setupShadowHQ();
 
-    for (int i = 0; i < shadowCasterElementsAmount; i++)
+    Matrix4 mLightSpaces[MAX_SHADOW_CASCADES];
+    Vector4 cascadeRects[MAX_SHADOW_CASCADES];
+    for (int c = 0; c < cascadesAmount; c++)
     {
-        RenderElement *element = elements[i];
-        if (element->mesh)
-        {
-            Matrix4 mModelViewProjection = mLightViewProjection * element->mModel;
-            if (element->texture)
-            {
-                reinterpret_cast<TextureOpengGL *>(element->texture)->bind(TextureSlot::TEXTURE_0);
-                CommonOpenGLShaders::getTexturedShadowShader()->use(element->mModel, mModelViewProjection);
-                CommonOpenGLShaders::getTexturedShadowShader()->setUVShiftSize(element->uvShiftSize);
-            }
-            else
-            {
-                CommonOpenGLShaders::getSimpleShadowShader()->use(element->mModel, mModelViewProjection);
-            }
+        int x = c % tilesPerRow;
+        int y = c / tilesPerRow;
+        renderTarget->setShadowViewport(x * tileSize, y * tileSize, tileSize);
 
-            element->mesh->render();
-        }
+        mLightSpaces[c] = sunCascades.getCascade(c)->mLightViewProjection;
+        float tilePart = 1.0f / tilesPerRow;
+        cascadeRects[c] = Vector4(x * tilePart, y * tilePart, tilePart, tilePart);
+
+        renderShadowCasters(cascadeCasters.data(), cascadeRunsStart[c], cascadeRunsStart[c + 1], mLightSpaces[c]);
     }
 
     if (useFrontFace)
@@ -651,50 +938,153 @@ void RendererOpenGL::renderSunWithShadows(RenderTarget *renderTarget, Vector3 &d
     auto lightShader = CommonOpenGLShaders::getSunWithShadowShader();
     lightShader->use(m, m);
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::disable(GL_CULL_FACE);
+    StateOpenGL::enable(GL_BLEND);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getAlbedoTexture());
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, renderTarget->getAlbedoTexture());
+    StateOpenGL::bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, renderTarget->getNormalTexture());
+    StateOpenGL::bindTextureUnit(GL_TEXTURE2, GL_TEXTURE_2D, renderTarget->getPositionTexture());
+    StateOpenGL::bindTextureUnit(GL_TEXTURE3, GL_TEXTURE_2D, renderTarget->getShadowTexture());
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getNormalTexture());
-
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getPositionTexture());
-
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, renderTarget->getShadowTexture());
-
-    lightShader->setLightSpaceMatrix(mLightViewProjection);
+    lightShader->setShadowCascades(mLightSpaces, cascadeRects, cascadesAmount);
     lightShader->setLightDirection(direction);
     lightShader->setLightColor(color);
     lightShader->setCameraPosition(cameraPosition);
     lightShader->setCameraDirection(cameraDirection);
 
     CommonOpenGLShaders::getScreenMesh()->useVertexArray();
-    glBlendFunc(GL_ONE, GL_ONE);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    drawCalls++;
 }
 
-void RendererOpenGL::renderOmni(Vector3 &position, Vector3 &color, float affectDistance)
+void RendererOpenGL::renderShadowCasters(RenderElement **elements, int runFrom, int runTo, Matrix4 &mLightViewProjection)
 {
     Matrix4 m;
+    Texture *lastShadowTexture = nullptr;
+    for (int r = runFrom; r < runTo; r++)
+    {
+        InstanceRun &run = instanceRuns[r];
+        RenderElement *element = elements[run.start];
+        if (run.offset >= 0)
+        {
+            if (element->texture)
+            {
+                bool bTextureChanged = element->texture != lastShadowTexture;
+                countStateChange(bTextureChanged);
+                if (bTextureChanged)
+                {
+                    reinterpret_cast<TextureOpengGL *>(element->texture)->bind(TextureSlot::TEXTURE_0);
+                    lastShadowTexture = element->texture;
+                }
+                CommonOpenGLShaders::getTexturedShadowInstancedShader()->use(m, mLightViewProjection);
+            }
+            else
+            {
+                CommonOpenGLShaders::getSimpleShadowInstancedShader()->use(m, mLightViewProjection);
+            }
 
-    auto lightShader = CommonOpenGLShaders::getOmniShader();
-    lightShader->use(m, m);
+            reinterpret_cast<MeshStaticOpenGL *>(element->mesh)->renderInstanced(instanceBuffer, run.offset, run.amount, element->lod);
+            drawCalls++;
+            continue;
+        }
+
+        for (int i = run.start; i < run.start + run.amount; i++)
+        {
+            element = elements[i];
+            if (!element->mesh)
+                continue;
 
+            Matrix4 mModelViewProjection = mLightViewProjection * element->mModel;
+            if (element->texture)
+            {
+                bool bTextureChanged = element->texture != lastShadowTexture;
+                countStateChange(bTextureChanged);
+                if (bTextureChanged)
+                {
+                    reinterpret_cast<TextureOpengGL *>(element->texture)->bind(TextureSlot::TEXTURE_0);
+                    lastShadowTexture = element->texture;
+                }
+                CommonOpenGLShaders::getTexturedShadowShader()->use(element->mModel, mModelViewProjection);
+                CommonOpenGLShaders::getTexturedShadowShader()->setUVShiftSize(element->uvShiftSize);
+            }
+            else
+            {
+                CommonOpenGLShaders::getSimpleShadowShader()->use(element->mModel, mModelViewProjection);
+            }
+
+            element->mesh->renderLod(element->lod);
+            drawCalls++;
+        }
+    }
+}
+
+// Box around affect distance limits fragments of the light
+// First pass marks in stencil pixels whose surface is inside the box, second one shades only them
+// Queue drawn in painter's order doesn't write depth, so the box is the only limit then
+void RendererOpenGL::renderOmniVolume(Vector3 &position, Vector3 &color, float affectDistance)
+{
+    // G buffer keeps positions scaled by 0.1, affect distance is in that space
+    float size = affectDistance * 10.0f * 2.0f;
+    Matrix4 mModel = glm::scale(glm::translate(Matrix4(1.0f), position), Vector3(size, size, size));
+    Matrix4 mModelViewProjection = *renderQueue->getViewProjectionMatrix() * mModel;
+    bool bUseStencil = !renderQueue->isUsingSorting();
+
+    auto lightShader = CommonOpenGLShaders::getOmniVolumeShader();
+    lightShader->use(mModel, mModelViewProjection);
     lightShader->setAffectDistance(affectDistance);
     lightShader->setLightColor(color);
     lightShader->setLightPosition(position);
 
-    CommonOpenGLShaders::getScreenMesh()->useVertexArray();
-    glBlendFunc(GL_ONE, GL_ONE);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    CommonOpenGLShaders::getCubeMesh()->useVertexArray();
+
+    if (bUseStencil)
+    {
+        StateOpenGL::enable(GL_STENCIL_TEST);
+        StateOpenGL::enable(GL_DEPTH_TEST);
+        StateOpenGL::depthFunc(GL_LESS);
+        StateOpenGL::disable(GL_CULL_FACE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+        // Shaded pixels are reset, so stencil is clean for the next light
+        glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+    }
+
+    // Back faces are still there when camera is inside of the box
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::enable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    drawCalls++;
+
+    glCullFace(GL_BACK);
+    StateOpenGL::disable(GL_STENCIL_TEST);
 }
 
-void RendererOpenGL::renderOmniWithShadows(RenderTarget *renderTarget, Vector3 &position, Vector3 &color, float affectDistance)
+// Lights are assigned to froxels on worker threads, then one full screen pass shades all of them
+void RendererOpenGL::renderOmniClustered()
 {
-    renderOmni(position, color, affectDistance);
+    Matrix4 m;
+    Matrix4 mView = *renderQueue->getViewMatrix();
+    Matrix4 mProjection = *renderQueue->getViewProjectionMatrix() * glm::inverse(mView);
+
+    lightClusters.build(mView, mProjection, omniSources.data(), omniSources.size());
+
+    auto lightShader = CommonOpenGLShaders::getClusteredLightShader();
+    lightShader->use(m, m);
+    lightShader->setViewMatrix(mView);
+    lightShader->uploadLights(&lightClusters, omniData.data(), omniSources.size());
+
+    CommonOpenGLShaders::getScreenMesh()->useVertexArray();
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    drawCalls++;
 }
\ No newline at end of file
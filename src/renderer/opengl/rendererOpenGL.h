@@ -3,10 +3,26 @@
 
 #pragma once
 #include "renderer/renderer.h"
+#include "renderer/lightClusters.h"
+#include "renderer/shadowCascades.h"
 #include "renderer/opengl/textureEditableOpenGL.h"
+#include "renderer/opengl/uniformStreamOpenGL.h"
+#include "renderer/opengl/textureStreamOpenGL.h"
 #include "connector/withLogger.h"
 #include "connector/withDebug.h"
 #include "connector/withCore.h"
+#include <vector>
+
+// Shorter runs of the same state are cheaper to draw one by one
+#define MIN_INSTANCED_RUN 4
+
+// Elements from start are drawn with one call if offset in instance buffer is set, or one by one if it's -1
+struct InstanceRun
+{
+    int start;
+    int amount;
+    int offset;
+};
 
 class RendererOpenGL : public Renderer, public WithLogger, public WithDebug, public WithCore
 {
@@ -26,14 +42,17 @@ public:
     EXPORT Texture *createTexture(int width, int height, int bytesPerPixel, const void *data, bool bCreateMipmaps) final override;
     EXPORT Texture *createTextureEditable(int width, int height) final override;
     EXPORT void destroyTexture(Texture *texture) override;
+    EXPORT Texture *createTextureCompressed(CompressedImage *image) override;
+    EXPORT bool isTextureFormatSupported(TextureFormat format) override;
+    EXPORT Texture *createTextureRegion(Texture *page, int x, int y, int width, int height) override;
+    EXPORT Texture *createTextureStreamed(const std::string &path, int width, int height) override;
+    EXPORT int getStreamingPendingBytes() override;
+    EXPORT float getStreamingThroughput() override;
 
     EXPORT unsigned int getWindowFlags() final override;
 
     EXPORT void render(RenderTarget *renderTarget) final override;
 
-    EXPORT void renderDebugLine(Vector3 a, Vector3 b, Matrix4 *mProjectionView, float thickness, Vector3 color) final override;
-    EXPORT void renderDebugLine(Matrix4 *mModel, Matrix4 *mProjectionView, Vector3 color) final override;
-
     EXPORT Shader *getDefaultSpriteShader() override;
     EXPORT Shader *getDefaultFramedSpriteShader() override;
     EXPORT virtual Shader *getDefaultCubeMapShader() override;
@@ -57,12 +76,52 @@ public:
 
 protected:
     void setupShaderParameters(ShaderParameter **parameters, int amount);
+    void renderMainPhaseElement(RenderElement *element, int drawBlockOffset = -1);
+    void renderMainPhaseSorted(Matrix4 &mViewProjection);
+    // Draw blocks of elements from start to end go to one batch with frame block, offsets are kept in drawBlockOffsets
+    void streamDrawBlocks(RenderElement **elements, int start, int end, Matrix4 &mViewProjection);
+    int pushDrawBlock(RenderElement *element);
+    void pushInstance(Matrix4 &mModel, const Vector4 &parameter);
+    void uploadInstances();
+    void resetStateCache();
 
     void renderSun(Vector3 &direction, Vector3 &colore);
     void renderSunWithShadows(RenderTarget *renderTarget, Vector3 &direction, Vector3 &color, float affectDistance);
-    void renderOmni(Vector3 &position, Vector3 &color, float affectDistance);
-    void renderOmniWithShadows(RenderTarget *renderTarget, Vector3 &position, Vector3 &color, float affectDistance);
+    void renderShadowCasters(RenderElement **elements, int runFrom, int runTo, Matrix4 &mLightViewProjection);
+    void renderOmniClustered();
+    void renderOmniVolume(Vector3 &position, Vector3 &color, float affectDistance);
+    // Draws and clears debug lines of the frame
+    void renderDebugLines(Matrix4 &mViewProjection);
 
     std::string oglVersion;
     std::string version;
+
+    // State set by the last drawn element
+    Shader *lastShader = nullptr;
+    Texture *lastTexture = nullptr;
+    ShaderParameter **lastParameters = nullptr;
+
+    // Streaming buffer with model matrix and parameter of every instance
+    unsigned int instanceBuffer = 0;
+    std::vector<float> instanceData;
+    std::vector<InstanceRun> instanceRuns;
+
+    // Per frame and per draw uniform blocks, element i of the current batch uses drawBlockOffsets[i] or -1 for plain uniforms
+    UniformStreamOpenGL uniformStream;
+    TextureStreamOpenGL textureStream;
+    std::vector<int> drawBlockOffsets;
+
+    // Casters of every cascade one after another, runs of cascade c are from cascadeRunsStart[c] to cascadeRunsStart[c + 1]
+    ShadowCascades sunCascades;
+    std::vector<RenderElement *> cascadeCasters;
+    int cascadeRunsStart[MAX_SHADOW_CASCADES + 1];
+
+    // Omni lights of the frame, shaded in one pass
+    LightClusters lightClusters;
+    std::vector<LightClusterSource> omniSources;
+    std::vector<float> omniData;
+
+    unsigned int debugLinesVao = 0;
+    unsigned int debugLinesBuffer = 0;
+    std::vector<DebugLineVertex> debugNormals;
 };
\ No newline at end of file
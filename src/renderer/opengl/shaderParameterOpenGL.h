@@ -4,12 +4,11 @@
 #pragma once
 #include "renderer/shaderParameter.h"
 
-class ShaderOpenGL;
-
 class ShaderParameterOpenGL : public ShaderParameter
 {
 public:
-    EXPORT ShaderParameterOpenGL(Shader *shader, const char *name, ShaderParameterType type);
+    // Location is resolved by the shader from uniforms it read after linking
+    EXPORT ShaderParameterOpenGL(int uniformLoc, ShaderParameterType type);
     EXPORT ~ShaderParameterOpenGL();
 
     EXPORT void apply() override;
@@ -18,5 +17,4 @@ public:
 
 protected:
     int uniformLoc = -1;
-    ShaderOpenGL *shader = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/opengl/shaders/clusteredLightOpenGLShader.h"
+#include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
+#include "math/glm/gtc/type_ptr.hpp"
+
+extern const std::string screenVertexShader;
+
+// Slots 3 and 4 are kept for shadow and environment maps of other light shaders
+#define CLUSTERS_FIRST_SLOT 5
+
+ClusteredLightOpenGLShader::ClusteredLightOpenGLShader() : ShaderOpenGL(screenVertexShader, internalFragmentShader)
+{
+    build();
+    locTAlbedoSpec = getUniformLocation("tAlbedoSpec");
+    locTNormal = getUniformLocation("tNormal");
+    locTPosition = getUniformLocation("tPosition");
+    locTLights = getUniformLocation("tLights");
+    locTClusters = getUniformLocation("tClusters");
+    locTLightIndexes = getUniformLocation("tLightIndexes");
+    locMView = getUniformLocation("mView");
+    locV3Slices = getUniformLocation("v3Slices");
+}
+
+ClusteredLightOpenGLShader::~ClusteredLightOpenGLShader()
+{
+    glDeleteTextures(3, textures);
+    glDeleteBuffers(3, buffers);
+    for (int i = 0; i < 3; i++)
+        StateOpenGL::forgetTexture(textures[i]);
+}
+
+bool ClusteredLightOpenGLShader::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
+{
+    if (!ShaderOpenGL::use(mModel, mModelViewProjection))
+        return false;
+
+    glUniform1i(locTAlbedoSpec, 0);
+    glUniform1i(locTNormal, 1);
+    glUniform1i(locTPosition, 2);
+    glUniform1i(locTLights, CLUSTERS_FIRST_SLOT);
+    glUniform1i(locTClusters, CLUSTERS_FIRST_SLOT + 1);
+    glUniform1i(locTLightIndexes, CLUSTERS_FIRST_SLOT + 2);
+
+    return true;
+}
+
+void ClusteredLightOpenGLShader::uploadLights(LightClusters *lightClusters, const float *lights, int lightsAmount)
+{
+    if (!buffers[0])
+    {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+    }
+
+    uploadBuffer(0, lights, lightsAmount * 8 * sizeof(float));
+    uploadBuffer(1, lightClusters->getClusters(), LIGHT_CLUSTERS_AMOUNT * 2 * sizeof(unsigned int));
+    uploadBuffer(2, lightClusters->getIndexes(), lightClusters->getIndexesAmount() * sizeof(unsigned int));
+
+    unsigned int formats[3] = {GL_RGBA32F, GL_RG32UI, GL_R32UI};
+    for (int i = 0; i < 3; i++)
+    {
+        StateOpenGL::activeTexture(GL_TEXTURE0 + CLUSTERS_FIRST_SLOT + i);
+        StateOpenGL::bindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+    }
+
+    Vector3 slices = Vector3(lightClusters->getSliceScale(), lightClusters->getSliceBias(), lightClusters->isLogarithmic() ? 1.0f : 0.0f);
+    glUniform3fv(locV3Slices, 1, value_ptr(slices));
+}
+
+void ClusteredLightOpenGLShader::setViewMatrix(Matrix4 &mView)
+{
+    glUniformMatrix4fv(locMView, 1, GL_FALSE, value_ptr(mView));
+}
+
+// Empty buffer can't back a texture, so there is always at least one element
+void ClusteredLightOpenGLShader::uploadBuffer(int index, const void *data, size_t size)
+{
+    unsigned int empty[4] = {0, 0, 0, 0};
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+    if (size > 0)
+        glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+    else
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(empty), empty, GL_STREAM_DRAW);
+}
+
+// Light evaluation is the same as in single omni light shader
+const std::string ClusteredLightOpenGLShader::internalFragmentShader =
+    "#version 410 core\n"
+    "#define CLUSTERS_X " + std::to_string(LIGHT_CLUSTERS_X) + "\n"
+    "#define CLUSTERS_Y " + std::to_string(LIGHT_CLUSTERS_Y) + "\n"
+    "#define CLUSTERS_Z " + std::to_string(LIGHT_CLUSTERS_Z) + "\n"
+    "out vec4 FragColor;\n"
+    "in vec2 texCoord;\n"
+    "uniform sampler2D tPosition;\n"
+    "uniform sampler2D tAlbedoSpec;\n"
+    "uniform sampler2D tNormal;\n"
+    "uniform samplerBuffer tLights;\n"
+    "uniform usamplerBuffer tClusters;\n"
+    "uniform usamplerBuffer tLightIndexes;\n"
+    "uniform mat4 mView;\n"
+    "uniform vec3 v3Slices;\n"
+    "void main() {\n"
+    "   vec3 FragPos = texture(tPosition, texCoord).rgb;\n"
+    "   vec3 Normal = texture(tNormal, texCoord).rgb;\n"
+    "   vec3 Albedo = texture(tAlbedoSpec, texCoord).rgb;\n"
+    "   float depth = -(mView * vec4(FragPos * 10.0, 1.0)).z;\n"
+    "   float sliceValue = v3Slices.z > 0.5 ? log(max(depth, 0.0001)) : depth;\n"
+    "   int slice = clamp(int(floor(sliceValue * v3Slices.x + v3Slices.y)), 0, CLUSTERS_Z - 1);\n"
+    "   ivec2 tile = clamp(ivec2(texCoord * vec2(CLUSTERS_X, CLUSTERS_Y)), ivec2(0), ivec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));\n"
+    "   uvec2 cluster = texelFetch(tClusters, tile.x + tile.y * CLUSTERS_X + slice * CLUSTERS_X * CLUSTERS_Y).rg;\n"
+    "   vec3 light = vec3(0.0);\n"
+    "   for (uint i = 0u; i < cluster.y; i++) {\n"
+    "      int index = int(texelFetch(tLightIndexes, int(cluster.x + i)).r);\n"
+    "      vec4 positionDistance = texelFetch(tLights, index * 2);\n"
+    "      vec3 lightColor = texelFetch(tLights, index * 2 + 1).rgb;\n"
+    "      vec3 dif = positionDistance.xyz - FragPos;\n"
+    "      float distPower = max(1.0 - (length(dif) / positionDistance.w), 0.0);\n"
+    "      light += max(dot(Normal, normalize(dif)), 0.0) * Albedo * lightColor * distPower;\n"
+    "   }\n"
+    "   FragColor = vec4(light, 0.0);\n"
+    "}\n";
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "renderer/opengl/shaders/shaderOpenGL.h"
+#include "renderer/lightClusters.h"
+#include <string>
+
+// All omni lights in one full screen pass, every pixel loops only over lights of its cluster
+// Light list, cluster ranges and light indexes are read from texture buffers
+class ClusteredLightOpenGLShader : public ShaderOpenGL
+{
+public:
+    EXPORT ClusteredLightOpenGLShader();
+    EXPORT ~ClusteredLightOpenGLShader();
+
+    EXPORT bool use(Matrix4 &mModel, Matrix4 &mModelViewProjection) override;
+
+    // Two vec4 per light: position with affect distance and color, in G buffer space
+    EXPORT void uploadLights(LightClusters *lightClusters, const float *lights, int lightsAmount);
+    EXPORT void setViewMatrix(Matrix4 &mView);
+
+protected:
+    void uploadBuffer(int index, const void *data, size_t size);
+
+    int locTAlbedoSpec;
+    int locTNormal;
+    int locTPosition;
+    int locTLights;
+    int locTClusters;
+    int locTLightIndexes;
+    int locMView;
+    int locV3Slices;
+
+    // Lights, clusters and indexes
+    unsigned int buffers[3] = {0, 0, 0};
+    unsigned int textures[3] = {0, 0, 0};
+
+    static const std::string internalFragmentShader;
+};
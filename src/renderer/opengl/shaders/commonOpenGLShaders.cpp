@@ -22,9 +22,11 @@ extern const std::string gammaFragmentShader;
 extern const std::string sunFragmentCode;
 extern const std::string sunWithShadowFragmentCode;
 extern const std::string omniFragmentCode;
+extern const std::string omniVolumeFragmentCode;
 
 extern const std::string debugCubeVertexCode;
-extern const std::string debugCubeFragmentCode;
+extern const std::string debugLinesVertexCode;
+extern const std::string debugLinesFragmentCode;
 
 extern const std::string simpleShadowVertexShader;
 extern const std::string simpleShadowFragmentShader;
@@ -32,6 +34,9 @@ extern const std::string simpleShadowFragmentShader;
 extern const std::string texturedShadowVertexShader;
 extern const std::string texturedShadowFragmentShader;
 
+extern const std::string simpleShadowInstancedVertexShader;
+extern const std::string texturedShadowInstancedVertexShader;
+
 MeshStatic *CommonOpenGLShaders::spriteMesh = nullptr;
 MeshStatic *CommonOpenGLShaders::cubeMesh = nullptr;
 MeshStatic *CommonOpenGLShaders::screenMesh = nullptr;
@@ -44,13 +49,17 @@ ShaderOpenGL *CommonOpenGLShaders::gammaFXAAShader = nullptr;
 ShaderOpenGL *CommonOpenGLShaders::effectShader = nullptr;
 ShaderOpenGL *CommonOpenGLShaders::simpleShadowShader = nullptr;
 ShaderOpenGL *CommonOpenGLShaders::texturedShadowShader = nullptr;
+ShaderOpenGL *CommonOpenGLShaders::simpleShadowInstancedShader = nullptr;
+ShaderOpenGL *CommonOpenGLShaders::texturedShadowInstancedShader = nullptr;
 
 InitialLightOpenGLShader *CommonOpenGLShaders::initialLightShader = nullptr;
 LightningOpenGLShader *CommonOpenGLShaders::sunShader = nullptr;
 LightningOpenGLShader *CommonOpenGLShaders::sunWithShadowShader = nullptr;
 LightningOpenGLShader *CommonOpenGLShaders::omniShader = nullptr;
+LightningOpenGLShader *CommonOpenGLShaders::omniVolumeShader = nullptr;
+ClusteredLightOpenGLShader *CommonOpenGLShaders::clusteredLightShader = nullptr;
 
-ShaderOpenGL *CommonOpenGLShaders::debugCubeShader = nullptr;
+ShaderOpenGL *CommonOpenGLShaders::debugLinesShader = nullptr;
 
 CubeMapOpenGLShader *CommonOpenGLShaders::cubeMapShader = nullptr;
 
@@ -93,6 +102,11 @@ void CommonOpenGLShaders::build(Renderer *renderer)
     omniShader = new LightningOpenGLShader(screenVertexShader, omniFragmentCode);
     sunShader->build();
 
+    omniVolumeShader = new LightningOpenGLShader(debugCubeVertexCode, omniVolumeFragmentCode);
+
+    logger->logff("compiling clustered light shader ...");
+    clusteredLightShader = new ClusteredLightOpenGLShader();
+
     logger->logff("compiling screen shader ...");
     screenShader = new ShaderOpenGL(screenVertexShader, screenFragmentShader);
     screenShader->build();
@@ -104,9 +118,9 @@ void CommonOpenGLShaders::build(Renderer *renderer)
     logger->logff("compiling initial lightning shader ...");
     initialLightShader = new InitialLightOpenGLShader();
 
-    logger->logff("compiling debug cube shader ...");
-    debugCubeShader = new ShaderOpenGL(debugCubeVertexCode, debugCubeFragmentCode);
-    debugCubeShader->build();
+    logger->logff("compiling debug lines shader ...");
+    debugLinesShader = new ShaderOpenGL(debugLinesVertexCode, debugLinesFragmentCode);
+    debugLinesShader->build();
 
     logger->logff("compiling cube map shader ...");
     cubeMapShader = new CubeMapOpenGLShader();
@@ -118,6 +132,8 @@ void CommonOpenGLShaders::build(Renderer *renderer)
     logger->logff("compiling shadow shaders ...");
     simpleShadowShader = new ShaderOpenGL(simpleShadowVertexShader, simpleShadowFragmentShader);
     texturedShadowShader = new ShaderOpenGL(texturedShadowVertexShader, texturedShadowFragmentShader);
+    simpleShadowInstancedShader = new ShaderOpenGL(simpleShadowInstancedVertexShader, simpleShadowFragmentShader);
+    texturedShadowInstancedShader = new ShaderOpenGL(texturedShadowInstancedVertexShader, texturedShadowFragmentShader);
 
     logger->logff("shaders compiled\n");
 }
@@ -167,6 +183,16 @@ ShaderOpenGL *CommonOpenGLShaders::getTexturedShadowShader()
     return texturedShadowShader;
 }
 
+ShaderOpenGL *CommonOpenGLShaders::getSimpleShadowInstancedShader()
+{
+    return simpleShadowInstancedShader;
+}
+
+ShaderOpenGL *CommonOpenGLShaders::getTexturedShadowInstancedShader()
+{
+    return texturedShadowInstancedShader;
+}
+
 LightningOpenGLShader *CommonOpenGLShaders::getSunShader()
 {
     return sunShader;
@@ -182,9 +208,19 @@ LightningOpenGLShader *CommonOpenGLShaders::getOmniShader()
     return omniShader;
 }
 
-ShaderOpenGL *CommonOpenGLShaders::getDebugCubeShader()
+LightningOpenGLShader *CommonOpenGLShaders::getOmniVolumeShader()
+{
+    return omniVolumeShader;
+}
+
+ClusteredLightOpenGLShader *CommonOpenGLShaders::getClusteredLightShader()
+{
+    return clusteredLightShader;
+}
+
+ShaderOpenGL *CommonOpenGLShaders::getDebugLinesShader()
 {
-    return debugCubeShader;
+    return debugLinesShader;
 }
 
 CubeMapOpenGLShader *CommonOpenGLShaders::getCubeMapShader()
@@ -547,31 +583,37 @@ const std::string sunWithShadowFragmentCode =
     "uniform sampler2D tShadowMap;\n"
     "uniform vec3 lightColor;\n"
     "uniform vec3 lightDir;\n"
-    "uniform mat4 mlightSpace;\n"
+    "uniform mat4 mlightSpaces[4];\n"
+    "uniform vec4 cascadeRects[4];\n"
+    "uniform int cascadesAmount;\n"
     "uniform vec3 cameraPos;\n"
     "uniform vec3 cameraDir;\n"
     ""
     "   vec2 texelSize = 1.0 / textureSize(tShadowMap, 0);\n"
     "   const float PI = 3.14159265359;\n"
     ""
-    "float ShadowCalculation(vec4 fragPosLightSpace, vec3 Normal)\n"
+    "float ShadowCalculation(vec3 FragPos, vec3 Normal)\n"
     "{\n"
-    "   vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;\n"
-    "   projCoords = projCoords * 0.5 + 0.5;\n"
-    "   float currentDepth = projCoords.z;\n"
-    "   float bias = max(0.002 * (1.0 - dot(Normal, lightDir)), 0.0006);\n"
-    "   float shadow = 0.0;\n"
-    "   for(int x = -2; x <= 2; ++x){\n"
-    "       for(int y = -2; y <= 2; ++y){\n"
-    "           vec2 coords = projCoords.xy + vec2(x, y) * texelSize;\n"
-    "           if (coords.x >= 0.0 && coords.x < 1.0 && coords.y >= 0.0 && coords.y < 1.0){\n"
-    "               float pcfDepth = texture(tShadowMap, coords).r;\n"
+    "   for(int i = 0; i < cascadesAmount; ++i){\n"
+    "       vec4 fragPosLightSpace = mlightSpaces[i] * vec4(FragPos, 1.0);\n"
+    "       vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;\n"
+    "       projCoords = projCoords * 0.5 + 0.5;\n"
+    "       vec2 margin = 3.0 * texelSize / cascadeRects[i].zw;\n"
+    "       if (any(lessThan(projCoords.xy, margin)) || any(greaterThan(projCoords.xy, 1.0 - margin)) || projCoords.z > 1.0)\n"
+    "           continue;\n"
+    "       vec2 tileCoords = cascadeRects[i].xy + projCoords.xy * cascadeRects[i].zw;\n"
+    "       float currentDepth = projCoords.z;\n"
+    "       float bias = max(0.002 * (1.0 - dot(Normal, lightDir)), 0.0006);\n"
+    "       float shadow = 0.0;\n"
+    "       for(int x = -2; x <= 2; ++x){\n"
+    "           for(int y = -2; y <= 2; ++y){\n"
+    "               float pcfDepth = texture(tShadowMap, tileCoords + vec2(x, y) * texelSize).r;\n"
     "               shadow += step(step(currentDepth - bias, pcfDepth) + currentDepth, 1.0);\n"
     "           }\n"
     "       }\n"
+    "       return shadow / 25.0;\n"
     "   }\n"
-    "   shadow /= 25.0;\n"
-    "   return shadow;\n"
+    "   return 0.0;\n"
     "}\n"
     ""
     "vec3 fresnelSchlick(float cosTheta, vec3 F0)\n"
@@ -629,8 +671,7 @@ const std::string sunWithShadowFragmentCode =
     "   vec3 kS = F;\n"
     "   vec3 kD = vec3(1.0) - kS;\n"
     "   kD *= 1.0 - Metallic;\n"
-    "   vec4 FragPosLightSpace = mlightSpace * vec4(FragPos, 1.0);\n"
-    "   float Shadow = ShadowCalculation(FragPosLightSpace, Normal);\n"
+    "   float Shadow = ShadowCalculation(FragPos, Normal);\n"
     "   float NdotL = max(dot(Normal, L), 0.0);\n"
     "   vec3 Light = (kD * Albedo / PI + Specular) * lightColor * NdotL * (1.0 - Shadow);\n"
     "   FragColor = vec4(Light, 0.0);\n"
@@ -668,6 +709,29 @@ const std::string omniFragmentCode =
     "   FragColor = vec4(light, 0.0);\n"
     "}\n";
 
+// Drawn over light volume, G buffer is read at the pixel of the fragment
+const std::string omniVolumeFragmentCode =
+    "#version 410 core\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2D tPosition;\n"
+    "uniform sampler2D tAlbedoSpec;\n"
+    "uniform sampler2D tNormal;\n"
+    "uniform vec3 lightColor;\n"
+    "uniform float affectDistance;\n"
+    "uniform vec3 v3Position;\n"
+    "void main() {\n"
+    "   vec2 texCoord = gl_FragCoord.xy / vec2(textureSize(tPosition, 0));\n"
+    "   vec3 FragPos = texture(tPosition, texCoord).rgb;\n"
+    "   vec3 dif = v3Position * 0.1 - FragPos;\n"
+    "   float dist = length(dif);\n"
+    "   if (dist >= affectDistance) { discard; }\n"
+    "   vec3 Normal = texture(tNormal, texCoord).rgb;\n"
+    "   vec3 Albedo = texture(tAlbedoSpec, texCoord).rgb;\n"
+    "   float distPower = 1.0 - dist / affectDistance;\n"
+    "   vec3 light = max(dot(Normal, dif / dist), 0.0) * Albedo * lightColor * distPower;\n"
+    "   FragColor = vec4(light, 0.0);\n"
+    "}\n";
+
 const std::string debugCubeVertexCode =
     "#version 410 core\n"
     "layout (location = 0) in vec3 aPos;\n"
@@ -676,10 +740,21 @@ const std::string debugCubeVertexCode =
     "   gl_Position = mModelViewProjection * vec4(aPos, 1.0);\n"
     "}\n";
 
-const std::string debugCubeFragmentCode =
+const std::string debugLinesVertexCode =
+    "#version 410 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aColor;\n"
+    "uniform mat4 mModelViewProjection;\n"
+    "out vec3 color;\n"
+    "void main() {\n"
+    "   color = aColor;\n"
+    "   gl_Position = mModelViewProjection * vec4(aPos, 1.0);\n"
+    "}\n";
+
+const std::string debugLinesFragmentCode =
     "#version 410 core\n"
+    "in vec3 color;\n"
     "out vec4 fragColor;\n"
-    "uniform vec3 color;\n"
     "void main() {\n"
     "   fragColor = vec4(color, 1.0);\n"
     "}\n";
@@ -687,9 +762,11 @@ const std::string debugCubeFragmentCode =
 const std::string simpleShadowVertexShader =
     "#version 410 core\n"
     "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 10) in vec4 aPositionScale;\n"
+    "layout (location = 11) in vec3 aPositionOffset;\n"
     "uniform mat4 mModelViewProjection;\n"
     "void main() {\n"
-    "   gl_Position = mModelViewProjection * vec4(aPos, 1.0);\n"
+    "   gl_Position = mModelViewProjection * vec4(aPositionOffset + aPos * aPositionScale.xyz, 1.0);\n"
     "}\n";
 
 const std::string simpleShadowFragmentShader =
@@ -704,11 +781,13 @@ const std::string texturedShadowVertexShader =
     "layout (location = 0) in vec3 aPos;\n"
     "layout (location = 1) in vec3 aNormal;\n"
     "layout (location = 2) in vec2 aTexCoord;\n"
+    "layout (location = 10) in vec4 aPositionScale;\n"
+    "layout (location = 11) in vec3 aPositionOffset;\n"
     "out vec2 texCoord;\n"
     "uniform mat4 mModelViewProjection;\n"
     "uniform vec4 v4uvShiftSize;\n"
     "void main() {\n"
-    "   gl_Position = mModelViewProjection * vec4(aPos, 1.0);\n"
+    "   gl_Position = mModelViewProjection * vec4(aPositionOffset + aPos * aPositionScale.xyz, 1.0);\n"
     "   texCoord = vec2(v4uvShiftSize.x, v4uvShiftSize.y) + aTexCoord * vec2(v4uvShiftSize.z, v4uvShiftSize.w);\n"
     "}\n";
 
@@ -721,3 +800,31 @@ const std::string texturedShadowFragmentShader =
     "   fragColor = texture(t, texCoord);\n"
     "   if (fragColor.a < 0.5){ discard; }\n"
     "}\n";
+
+// Model matrix is in locations 5 - 8, uv shift and size in 9
+const std::string simpleShadowInstancedVertexShader =
+    "#version 410 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 5) in mat4 aInstanceModel;\n"
+    "layout (location = 10) in vec4 aPositionScale;\n"
+    "layout (location = 11) in vec3 aPositionOffset;\n"
+    "uniform mat4 mModelViewProjection;\n"
+    "void main() {\n"
+    "   gl_Position = mModelViewProjection * aInstanceModel * vec4(aPositionOffset + aPos * aPositionScale.xyz, 1.0);\n"
+    "}\n";
+
+const std::string texturedShadowInstancedVertexShader =
+    "#version 410 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aNormal;\n"
+    "layout (location = 2) in vec2 aTexCoord;\n"
+    "layout (location = 5) in mat4 aInstanceModel;\n"
+    "layout (location = 9) in vec4 aInstanceParameter;\n"
+    "layout (location = 10) in vec4 aPositionScale;\n"
+    "layout (location = 11) in vec3 aPositionOffset;\n"
+    "out vec2 texCoord;\n"
+    "uniform mat4 mModelViewProjection;\n"
+    "void main() {\n"
+    "   gl_Position = mModelViewProjection * aInstanceModel * vec4(aPositionOffset + aPos * aPositionScale.xyz, 1.0);\n"
+    "   texCoord = aInstanceParameter.xy + aTexCoord * aInstanceParameter.zw;\n"
+    "}\n";
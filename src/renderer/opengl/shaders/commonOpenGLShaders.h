@@ -6,6 +6,7 @@
 #include "renderer/opengl/shaders/initialLightOpenGLShader.h"
 #include "renderer/opengl/shaders/lightningOpenGLShader.h"
 #include "renderer/opengl/shaders/cubeMapOpenGLShader.h"
+#include "renderer/opengl/shaders/clusteredLightOpenGLShader.h"
 #include "controller/resourceController.h"
 #include "connector/withLogger.h"
 #include "mesh/meshStatic.h"
@@ -25,13 +26,19 @@ public:
     EXPORT static ShaderOpenGL *getGammaFXAAShader();
     EXPORT static ShaderOpenGL *getSimpleShadowShader();
     EXPORT static ShaderOpenGL *getTexturedShadowShader();
+    // Instanced shadow shaders take light view projection as mModelViewProjection
+    EXPORT static ShaderOpenGL *getSimpleShadowInstancedShader();
+    EXPORT static ShaderOpenGL *getTexturedShadowInstancedShader();
 
     EXPORT static InitialLightOpenGLShader *getInitialLightShader();
     EXPORT static LightningOpenGLShader *getSunShader();
     EXPORT static LightningOpenGLShader *getSunWithShadowShader();
     EXPORT static LightningOpenGLShader *getOmniShader();
+    EXPORT static LightningOpenGLShader *getOmniVolumeShader();
+    EXPORT static ClusteredLightOpenGLShader *getClusteredLightShader();
 
-    EXPORT static ShaderOpenGL *getDebugCubeShader();
+    // Takes view projection as mModelViewProjection
+    EXPORT static ShaderOpenGL *getDebugLinesShader();
 
     EXPORT static CubeMapOpenGLShader *getCubeMapShader();
 
@@ -52,13 +59,17 @@ protected:
     static ShaderOpenGL *effectShader;
     static ShaderOpenGL *simpleShadowShader;
     static ShaderOpenGL *texturedShadowShader;
+    static ShaderOpenGL *simpleShadowInstancedShader;
+    static ShaderOpenGL *texturedShadowInstancedShader;
 
 
-    static ShaderOpenGL *debugCubeShader;
+    static ShaderOpenGL *debugLinesShader;
     static InitialLightOpenGLShader *initialLightShader;
     static CubeMapOpenGLShader *cubeMapShader;
 
     static LightningOpenGLShader *sunShader;
     static LightningOpenGLShader *sunWithShadowShader;
     static LightningOpenGLShader *omniShader;
+    static LightningOpenGLShader *omniVolumeShader;
+    static ClusteredLightOpenGLShader *clusteredLightShader;
 };
@@ -3,6 +3,7 @@
 
 #include "renderer/opengl/shaders/cubeMapOpenGLShader.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "renderer/opengl/textureOpenGL.h"
 
 CubeMapOpenGLShader::CubeMapOpenGLShader() : ShaderOpenGL(internalVertexShader, internalFragmentShader)
@@ -15,8 +16,7 @@ void CubeMapOpenGLShader::setCubeMap(Texture *texture)
 {
     if (texture)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, reinterpret_cast<TextureOpengGL *>(texture)->getGLTextureId());
+        StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, reinterpret_cast<TextureOpengGL *>(texture)->getGLTextureId());
         glUniform1i(locTCubeMap, 0);
     }
 }
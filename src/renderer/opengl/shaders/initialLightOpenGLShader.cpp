@@ -3,6 +3,7 @@
 
 #include "renderer/opengl/shaders/initialLightOpenGLShader.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "math/math.h"
 #include "math/glm/gtc/type_ptr.hpp"
 
@@ -21,36 +22,31 @@ InitialLightOpenGLShader::InitialLightOpenGLShader() : ShaderOpenGL(internalVert
 
 void InitialLightOpenGLShader::setTextureAlbedo(unsigned int albedoID)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, albedoID);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, albedoID);
     glUniform1i(locTDefuse, 0);
 }
 
 void InitialLightOpenGLShader::setTextureNormal(unsigned int normalID)
 {
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, normalID);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, normalID);
     glUniform1i(locTNormal, 1);
 }
 
 void InitialLightOpenGLShader::setTexturePosition(unsigned int positionID)
 {
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, positionID);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE2, GL_TEXTURE_2D, positionID);
     glUniform1i(locTPosition, 2);
 }
 
 void InitialLightOpenGLShader::setTextureRadiance(unsigned int radianceID)
 {
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, radianceID);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE3, GL_TEXTURE_2D, radianceID);
     glUniform1i(locTRadiance, 3);
 }
 
 void InitialLightOpenGLShader::setTextureEnvironment(unsigned int environmentID)
 {
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, environmentID);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE4, GL_TEXTURE_2D, environmentID);
     glUniform1i(locTEnvironment, 4);
 }
 
@@ -4,25 +4,29 @@
 #include "renderer/opengl/shaders/lightningOpenGLShader.h"
 #include "math/glm/gtc/type_ptr.hpp"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include <string.h>
 
 LightningOpenGLShader::LightningOpenGLShader(const std::string &vertex, const std::string &fragment) : ShaderOpenGL(vertex, fragment)
 {
     build();
-    locV3Position = glGetUniformLocation(programm, "v3Position");
-    locMLightSpace = glGetUniformLocation(programm, "mlightSpace");
-
-    locV3LightColor = glGetUniformLocation(programm, "lightColor");
-    locV3LightDirection = glGetUniformLocation(programm, "lightDir");
-    locFAffectDistance = glGetUniformLocation(programm, "affectDistance");
-    locV3CameraPosition = glGetUniformLocation(programm, "cameraPos");
-    locV3CameraDirection = glGetUniformLocation(programm, "cameraDir");
-
-    locTGAlbedoSpec = glGetUniformLocation(programm, "tAlbedoSpec");
-    locTGNormal = glGetUniformLocation(programm, "tNormal");
-    locTGPosition = glGetUniformLocation(programm, "tPosition");
-    locTShadowMap = glGetUniformLocation(programm, "tShadowMap");
-    locTEnvMap = glGetUniformLocation(programm, "tEnvironment");
+    locV3Position = getUniformLocation("v3Position");
+    locMLightSpace = getUniformLocation("mlightSpace");
+    locMLightSpaces = getUniformLocation("mlightSpaces");
+    locV4CascadeRects = getUniformLocation("cascadeRects");
+    locICascadesAmount = getUniformLocation("cascadesAmount");
+
+    locV3LightColor = getUniformLocation("lightColor");
+    locV3LightDirection = getUniformLocation("lightDir");
+    locFAffectDistance = getUniformLocation("affectDistance");
+    locV3CameraPosition = getUniformLocation("cameraPos");
+    locV3CameraDirection = getUniformLocation("cameraDir");
+
+    locTGAlbedoSpec = getUniformLocation("tAlbedoSpec");
+    locTGNormal = getUniformLocation("tNormal");
+    locTGPosition = getUniformLocation("tPosition");
+    locTShadowMap = getUniformLocation("tShadowMap");
+    locTEnvMap = getUniformLocation("tEnvironment");
 }
 
 bool LightningOpenGLShader::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
@@ -32,11 +36,8 @@ bool LightningOpenGLShader::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
     if (!bIsReady)
         return false;
 
-    if (currentShader != this)
-    {
-        currentShader = this;
-        glUseProgram(programm);
-    }
+    currentShader = this;
+    StateOpenGL::useProgram(programm);
 
     if (locTGAlbedoSpec != -1)
         glUniform1i(locTGAlbedoSpec, 0);
@@ -74,6 +75,13 @@ void LightningOpenGLShader::setLightSpaceMatrix(Matrix4 &mLightSpace)
     glUniformMatrix4fv(locMLightSpace, 1, GL_FALSE, value_ptr(mLightSpace));
 }
 
+void LightningOpenGLShader::setShadowCascades(const Matrix4 *mLightSpaces, const Vector4 *rects, int amount)
+{
+    glUniformMatrix4fv(locMLightSpaces, amount, GL_FALSE, value_ptr(mLightSpaces[0]));
+    glUniform4fv(locV4CascadeRects, amount, value_ptr(rects[0]));
+    glUniform1i(locICascadesAmount, amount);
+}
+
 void LightningOpenGLShader::setCameraPosition(Vector3 &v)
 {
     glUniform3fv(locV3CameraPosition, 1, value_ptr(v));
@@ -15,12 +15,17 @@ public:
     EXPORT void setLightDirection(Vector3 &v);
     EXPORT void setAffectDistance(float value);
     EXPORT void setLightSpaceMatrix(Matrix4 &mLightSpace);
+    // Matrix and rectangle of shadow map of every cascade, rectangle is offset and size in texture coordinates
+    EXPORT void setShadowCascades(const Matrix4 *mLightSpaces, const Vector4 *rects, int amount);
     EXPORT void setCameraPosition(Vector3 &v);
     EXPORT void setCameraDirection(Vector3 &v);
     EXPORT void setLightPosition(Vector3 &v);
 
     int locV3Position;
     int locMLightSpace;
+    int locMLightSpaces;
+    int locV4CascadeRects;
+    int locICascadesAmount;
 
     int locV3LightColor;
     int locV3LightDirection;
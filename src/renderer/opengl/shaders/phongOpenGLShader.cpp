@@ -4,14 +4,17 @@
 #include "renderer/opengl/shaders/phongOpenGLShader.h"
 #include "renderer/opengl/textureOpenGL.h"
 #include "renderer/opengl/shaderParameterOpenGL.h"
+#include "renderer/opengl/uniformStreamOpenGL.h"
 #include "math/glm/gtc/type_ptr.hpp"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "common/commonTextures.h"
 
 extern const char *gShaderVertexCode;
 extern const char *gShaderFragmentCode;
+extern const char *gShaderInstancedVertexCode;
 
-unsigned int PhongOpenGLShader::currentProgramm = 0;
+unsigned int PhongOpenGLShader::drawBlockBuffer = 0;
 unsigned int PhongOpenGLShader::tBlack = 0;
 unsigned int PhongOpenGLShader::tGrey = 0;
 unsigned int PhongOpenGLShader::tZeroNormal = 0;
@@ -19,6 +22,7 @@ unsigned int PhongOpenGLShader::tZeroNormal = 0;
 PhongOpenGLShader::PhongOpenGLShader()
 {
     setShaderCode(gShaderVertexCode, gShaderFragmentCode);
+    bSupportsInstancing = true;
     build();
     bUseOwnShadowShader = true;
 }
@@ -32,38 +36,52 @@ PhongOpenGLShader::PhongOpenGLShader(const std::string &vertexCode, const std::s
 
 bool PhongOpenGLShader::build()
 {
-    unsigned int vertexShader = 0, fragmentShader = 0;
-    if (!compile(GL_VERTEX_SHADER, vertexCode.c_str(), &vertexShader))
-    {
-        logger->logff("Unable to compile vertex shader:\n%s\n", vertexCode.c_str());
+    // Building usual pass programm
+    programm = linkProgramm(vertexCode, fragCode);
+    if (programm == 0)
         return false;
-    }
 
-    if (!compile(GL_FRAGMENT_SHADER, fragCode.c_str(), &fragmentShader))
-    {
-        logger->logff("Unable to compile fragment shader:\n%s\n", fragCode.c_str());
-        return false;
-    }
+    StateOpenGL::useProgram(programm);
 
-    // Building usual pass programm
-    programm = glCreateProgram();
-    if (programm == -1)
-        return false;
+    uniforms.read(programm);
+    locMModelViewProjection = uniforms.get("mModelViewProjection");
+    locMModel = uniforms.get("mModel");
+    locMNormal = uniforms.get("mNormal");
+    locTDefuse = uniforms.get("TextureDefuse");
+    locTNormal = uniforms.get("TextureNormal");
+    locTEmission = uniforms.get("TextureEmission");
+    locTRoughness = uniforms.get("TextureRoughness");
+    locUVControl = uniforms.get("uvControl");
+    locOpacity = uniforms.get("fOpacity");
 
-    glAttachShader(programm, fragmentShader);
-    glAttachShader(programm, vertexShader);
-    glLinkProgram(programm);
-    glUseProgram(programm);
-
-    locMModelViewProjection = glGetUniformLocation(programm, "mModelViewProjection");
-    locMModel = glGetUniformLocation(programm, "mModel");
-    locMNormal = glGetUniformLocation(programm, "mNormal");
-    locTDefuse = glGetUniformLocation(programm, "TextureDefuse");
-    locTNormal = glGetUniformLocation(programm, "TextureNormal");
-    locTEmission = glGetUniformLocation(programm, "TextureEmission");
-    locTRoughness = glGetUniformLocation(programm, "TextureRoughness");
-    locUVControl = glGetUniformLocation(programm, "uvControl");
-    locOpacity = glGetUniformLocation(programm, "fOpacity");
+    unsigned int drawBlock = glGetUniformBlockIndex(programm, "DrawData");
+    bSupportsDrawBlock = drawBlock != GL_INVALID_INDEX;
+    if (bSupportsDrawBlock)
+        glUniformBlockBinding(programm, drawBlock, UNIFORM_BINDING_DRAW);
+    bindSamplers(programm, locTDefuse, locTEmission, locTNormal, locTRoughness);
+
+    // Instanced programm shares fragment code, model matrix and uv control come from instance attributes
+    if (bSupportsInstancing)
+    {
+        instancedProgramm = linkProgramm(gShaderInstancedVertexCode, fragCode);
+        if (instancedProgramm != 0)
+        {
+            locInstancedViewProjection = glGetUniformLocation(instancedProgramm, "mViewProjection");
+            locInstancedTDefuse = glGetUniformLocation(instancedProgramm, "TextureDefuse");
+            locInstancedTNormal = glGetUniformLocation(instancedProgramm, "TextureNormal");
+            locInstancedTEmission = glGetUniformLocation(instancedProgramm, "TextureEmission");
+            locInstancedTRoughness = glGetUniformLocation(instancedProgramm, "TextureRoughness");
+            locInstancedOpacity = glGetUniformLocation(instancedProgramm, "fOpacity");
+
+            unsigned int frameBlock = glGetUniformBlockIndex(instancedProgramm, "FrameData");
+            bInstancedFrameBlock = frameBlock != GL_INVALID_INDEX;
+            if (bInstancedFrameBlock)
+                glUniformBlockBinding(instancedProgramm, frameBlock, UNIFORM_BINDING_FRAME);
+            bindSamplers(instancedProgramm, locInstancedTDefuse, locInstancedTEmission, locInstancedTNormal, locInstancedTRoughness);
+        }
+        else
+            bSupportsInstancing = false;
+    }
 
     tBlack = reinterpret_cast<TextureOpengGL *>(CommonTextures::getBlackTexture())->getGLTextureId();
     tGrey = reinterpret_cast<TextureOpengGL *>(CommonTextures::getGreyTexture())->getGLTextureId();
@@ -73,6 +91,31 @@ bool PhongOpenGLShader::build()
     return true;
 }
 
+unsigned int PhongOpenGLShader::linkProgramm(const std::string &vertexCode, const std::string &fragmentCode)
+{
+    unsigned int vertexShader = 0, fragmentShader = 0;
+    if (!compile(GL_VERTEX_SHADER, vertexCode.c_str(), &vertexShader))
+    {
+        logger->logff("Unable to compile vertex shader:\n%s\n", vertexCode.c_str());
+        return 0;
+    }
+
+    if (!compile(GL_FRAGMENT_SHADER, fragmentCode.c_str(), &fragmentShader))
+    {
+        logger->logff("Unable to compile fragment shader:\n%s\n", fragmentCode.c_str());
+        return 0;
+    }
+
+    unsigned int newProgramm = glCreateProgram();
+    if (newProgramm == 0)
+        return 0;
+
+    glAttachShader(newProgramm, fragmentShader);
+    glAttachShader(newProgramm, vertexShader);
+    glLinkProgram(newProgramm);
+    return newProgramm;
+}
+
 void PhongOpenGLShader::setTexture(TextureType type, Texture *texture)
 {
     switch (type)
@@ -105,44 +148,114 @@ bool PhongOpenGLShader::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
     if (!bIsReady)
         return false;
 
-    if (currentShader != this || currentProgramm != programm)
+    useProgramm(programm);
+
+    auto mnMatrix = glm::transpose(glm::inverse(mModel));
+
+    if (bSupportsDrawBlock)
+    {
+        // Slow path for draws outside of renderer stream, one small buffer is rewritten for every draw
+        PhongDrawBlock block = {mModelViewProjection, mModel, mnMatrix};
+        if (!drawBlockBuffer)
+            glGenBuffers(1, &drawBlockBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, drawBlockBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(block), &block, GL_STREAM_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, UNIFORM_BINDING_DRAW, drawBlockBuffer);
+    }
+    else
     {
-        currentShader = this;
-        currentProgramm = programm;
-        glUseProgram(programm);
+        glUniformMatrix4fv(locMModelViewProjection, 1, GL_FALSE, value_ptr(mModelViewProjection));
+        glUniformMatrix4fv(locMModel, 1, GL_FALSE, value_ptr(mModel));
+        glUniformMatrix4fv(locMNormal, 1, GL_FALSE, value_ptr(mnMatrix));
     }
+    Vector4 defUV = Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+    glUniform4fv(locUVControl, 1, value_ptr(defUV));
+    glUniform1f(locOpacity, opacity);
 
-    auto mnMatrix = glm::transpose(glm::inverse(mModel));
+    bindTextures();
+
+    return true;
+}
+
+bool PhongOpenGLShader::isDrawBlockSupported()
+{
+    return bSupportsDrawBlock;
+}
+
+// Uv control stays a uniform, shader parameters may change it
+bool PhongOpenGLShader::useDrawBlock()
+{
+    if (!bIsReady)
+        build();
+    if (!bIsReady || !bSupportsDrawBlock)
+        return false;
+
+    useProgramm(programm);
 
-    glUniformMatrix4fv(locMModelViewProjection, 1, GL_FALSE, value_ptr(mModelViewProjection));
-    glUniformMatrix4fv(locMModel, 1, GL_FALSE, value_ptr(mModel));
-    glUniformMatrix4fv(locMNormal, 1, GL_FALSE, value_ptr(mnMatrix));
     Vector4 defUV = Vector4(0.0f, 0.0f, 1.0f, 1.0f);
     glUniform4fv(locUVControl, 1, value_ptr(defUV));
     glUniform1f(locOpacity, opacity);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tAlbedo ? tAlbedo : tGrey);
-    glUniform1i(locTDefuse, 0);
+    bindTextures();
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, tEmission ? tEmission : tBlack);
-    glUniform1i(locTEmission, 1);
+    return true;
+}
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, tNormal ? tNormal : tZeroNormal);
-    glUniform1i(locTNormal, 2);
+bool PhongOpenGLShader::hasTextureBindings()
+{
+    return true;
+}
 
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, tRoughness ? tRoughness : tGrey);
-    glUniform1i(locTRoughness, 3);
+bool PhongOpenGLShader::isInstancingSupported()
+{
+    return bSupportsInstancing;
+}
+
+bool PhongOpenGLShader::useInstanced(Matrix4 &mViewProjection)
+{
+    if (!bIsReady)
+        build();
+    if (!bIsReady || !bSupportsInstancing)
+        return false;
+
+    useProgramm(instancedProgramm);
+
+    // Frame block is bound by renderer
+    if (!bInstancedFrameBlock)
+        glUniformMatrix4fv(locInstancedViewProjection, 1, GL_FALSE, value_ptr(mViewProjection));
+    glUniform1f(locInstancedOpacity, opacity);
+    bindTextures();
 
     return true;
 }
 
+// Sampler units are the same for every draw, they are set once after linking
+void PhongOpenGLShader::bindTextures()
+{
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, tAlbedo ? tAlbedo : tGrey);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, tEmission ? tEmission : tBlack);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE2, GL_TEXTURE_2D, tNormal ? tNormal : tZeroNormal);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE3, GL_TEXTURE_2D, tRoughness ? tRoughness : tGrey);
+}
+
+void PhongOpenGLShader::bindSamplers(unsigned int programm, int locDefuse, int locEmission, int locNormal, int locRoughness)
+{
+    StateOpenGL::useProgram(programm);
+    glUniform1i(locDefuse, 0);
+    glUniform1i(locEmission, 1);
+    glUniform1i(locNormal, 2);
+    glUniform1i(locRoughness, 3);
+}
+
+void PhongOpenGLShader::useProgramm(unsigned int programm)
+{
+    currentShader = this;
+    StateOpenGL::useProgram(programm);
+}
+
 ShaderParameter *PhongOpenGLShader::createShaderParameter(const char *name, ShaderParameterType type)
 {
-    return new ShaderParameterOpenGL(this, name, type);
+    return new ShaderParameterOpenGL(uniforms.get(name), type);
 }
 
 ShaderParameter *PhongOpenGLShader::createShaderUVParameter()
@@ -182,28 +295,84 @@ void PhongOpenGLShader::setShaderCode(const std::string &vertexCode, const std::
     this->fragCode = fragmentCode;
 }
 
+// Packed meshes set w of position scale to 1, their normal and tangent are octahedral and bitangent is restored by its sign
+// Float meshes set zero offset and scale of 1, so the same code reads both
+#define SHADER_VERTEX_DECODE_CODE \
+    "vec3 decodeOctahedral(vec2 e) {\n" \
+    "   vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n" \
+    "   if (v.z < 0.0) { v.xy = (1.0 - abs(v.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(v.xy, vec2(0.0))); }\n" \
+    "   return normalize(v);\n" \
+    "}\n"
+#define SHADER_VERTEX_DECODE_CALL \
+    "   vec3 position = aPositionOffset + aPos.xyz * aPositionScale.xyz;\n" \
+    "   vec3 normal = aNormal;\n" \
+    "   vec3 tangent = aTangent;\n" \
+    "   vec3 bitangent = aBitangent;\n" \
+    "   if (aPositionScale.w > 0.5) {\n" \
+    "      normal = decodeOctahedral(aNormal.xy);\n" \
+    "      tangent = decodeOctahedral(aTangent.xy);\n" \
+    "      bitangent = cross(normal, tangent) * (aPos.w * 2.0 - 1.0);\n" \
+    "   }\n"
+
 // Straight go shader
 const char *gShaderVertexCode =
     "#version 410 core\n"
-    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 0) in vec4 aPos;\n"
     "layout (location = 1) in vec3 aNormal;\n"
     "layout (location = 2) in vec2 aTexCoord;\n"
     "layout (location = 3) in vec3 aTangent;\n"
     "layout (location = 4) in vec3 aBitangent;\n"
-    "uniform mat4 mModelViewProjection;\n"
-    "uniform mat4 mModel;\n"
-    "uniform mat4 mNormal;\n"
+    "layout (location = 10) in vec4 aPositionScale;\n"
+    "layout (location = 11) in vec3 aPositionOffset;\n"
+    "layout (std140) uniform DrawData {\n"
+    "   mat4 mModelViewProjection;\n"
+    "   mat4 mModel;\n"
+    "   mat4 mNormal;\n"
+    "};\n"
     "uniform vec4 uvControl;\n"
     "out vec2 TexCoords;\n"
     "out vec3 FragPos;\n"
     "out mat3 mTBN;\n"
+    SHADER_VERTEX_DECODE_CODE
     "void main() {\n"
-    "   gl_Position = mModelViewProjection * vec4(aPos, 1.0);\n"
-    "   FragPos = (mModel * vec4(aPos, 1.0)).xyz * 0.1;\n"
+    SHADER_VERTEX_DECODE_CALL
+    "   gl_Position = mModelViewProjection * vec4(position, 1.0);\n"
+    "   FragPos = (mModel * vec4(position, 1.0)).xyz * 0.1;\n"
     "   TexCoords = vec2(uvControl.x, uvControl.y) + aTexCoord * vec2(uvControl.z, uvControl.w);\n"
-    "   vec3 T = normalize((mNormal * vec4(aTangent,   0.0)).xyz);\n"
-    "   vec3 B = normalize((mNormal * vec4(aBitangent, 0.0)).xyz);\n"
-    "   vec3 N = normalize((mNormal * vec4(aNormal,    0.0)).xyz);\n"
+    "   vec3 T = normalize((mNormal * vec4(tangent,   0.0)).xyz);\n"
+    "   vec3 B = normalize((mNormal * vec4(bitangent, 0.0)).xyz);\n"
+    "   vec3 N = normalize((mNormal * vec4(normal,    0.0)).xyz);\n"
+    "   mTBN = mat3(T, B, N);\n"
+    "}\n";
+
+// Same as straight go shader, model matrix is in locations 5 - 8 and uv control in 9, view projection is per frame
+const char *gShaderInstancedVertexCode =
+    "#version 410 core\n"
+    "layout (location = 0) in vec4 aPos;\n"
+    "layout (location = 1) in vec3 aNormal;\n"
+    "layout (location = 2) in vec2 aTexCoord;\n"
+    "layout (location = 3) in vec3 aTangent;\n"
+    "layout (location = 4) in vec3 aBitangent;\n"
+    "layout (location = 5) in mat4 aInstanceModel;\n"
+    "layout (location = 9) in vec4 aInstanceParameter;\n"
+    "layout (location = 10) in vec4 aPositionScale;\n"
+    "layout (location = 11) in vec3 aPositionOffset;\n"
+    "layout (std140) uniform FrameData {\n"
+    "   mat4 mViewProjection;\n"
+    "};\n"
+    "out vec2 TexCoords;\n"
+    "out vec3 FragPos;\n"
+    "out mat3 mTBN;\n"
+    SHADER_VERTEX_DECODE_CODE
+    "void main() {\n"
+    SHADER_VERTEX_DECODE_CALL
+    "   gl_Position = mViewProjection * aInstanceModel * vec4(position, 1.0);\n"
+    "   FragPos = (aInstanceModel * vec4(position, 1.0)).xyz * 0.1;\n"
+    "   TexCoords = aInstanceParameter.xy + aTexCoord * aInstanceParameter.zw;\n"
+    "   mat4 mNormal = transpose(inverse(aInstanceModel));\n"
+    "   vec3 T = normalize((mNormal * vec4(tangent,   0.0)).xyz);\n"
+    "   vec3 B = normalize((mNormal * vec4(bitangent, 0.0)).xyz);\n"
+    "   vec3 N = normalize((mNormal * vec4(normal,    0.0)).xyz);\n"
     "   mTBN = mat3(T, B, N);\n"
     "}\n";
 
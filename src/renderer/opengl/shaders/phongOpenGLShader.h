@@ -4,6 +4,21 @@
 #pragma once
 #include "renderer/phongShader.h"
 #include "renderer/texture.h"
+#include "renderer/opengl/uniformLocationsOpenGL.h"
+
+// std140 layout of DrawData block of the default shader, one per drawn element
+struct PhongDrawBlock
+{
+    Matrix4 mModelViewProjection;
+    Matrix4 mModel;
+    Matrix4 mNormal;
+};
+
+// std140 layout of FrameData block, shared by all draws of a frame
+struct PhongFrameBlock
+{
+    Matrix4 mViewProjection;
+};
 
 class PhongOpenGLShader : public PhongShader
 {
@@ -14,6 +29,17 @@ public:
     EXPORT void setTexture(TextureType type, Texture *texture) override;
     EXPORT bool use(Matrix4 &mModel, Matrix4 &mModelViewProjection) override;
 
+    // Material textures are bound on every use
+    EXPORT bool hasTextureBindings() override;
+
+    // Only shader with default code has instanced variant
+    EXPORT bool isInstancingSupported() override;
+    EXPORT bool useInstanced(Matrix4 &mViewProjection) override;
+
+    // Default code reads matrices from DrawData block, custom code may declare it as well
+    EXPORT bool isDrawBlockSupported() override;
+    EXPORT bool useDrawBlock() override;
+
     EXPORT ShaderParameter *createShaderParameter(const char *name, ShaderParameterType type) override;
     // x, y - uv shift, z, w - uv size
     EXPORT ShaderParameter *createShaderUVParameter() override;
@@ -24,6 +50,10 @@ public:
 protected:
     EXPORT bool compile(unsigned short type, const char *code, unsigned int *shader) override;
     EXPORT void setShaderCode(const std::string &vertexCode, const std::string &fragmentCode);
+    unsigned int linkProgramm(const std::string &vertexCode, const std::string &fragmentCode);
+    void bindTextures();
+    void bindSamplers(unsigned int programm, int locDefuse, int locEmission, int locNormal, int locRoughness);
+    void useProgramm(unsigned int programm);
 
     std::string vertexCode;
     std::string fragCode;
@@ -37,6 +67,18 @@ protected:
     int locTEmission = 0;
     int locTRoughness = 0;
     int locUVControl = 0;
+    UniformLocationsOpenGL uniforms;
+    bool bSupportsDrawBlock = false;
+
+    bool bSupportsInstancing = false;
+    unsigned int instancedProgramm = 0;
+    int locInstancedViewProjection = 0;
+    int locInstancedTDefuse = 0;
+    int locInstancedTNormal = 0;
+    int locInstancedOpacity = 0;
+    int locInstancedTEmission = 0;
+    int locInstancedTRoughness = 0;
+    bool bInstancedFrameBlock = false;
 
     unsigned int tAlbedo = 0;
     unsigned int tNormal = 0;
@@ -45,7 +87,8 @@ protected:
     unsigned int tRoughness = 0;
     Texture *shadowTexture = nullptr;
 
-    static unsigned int currentProgramm;
+    // Matrices of use() for block programms when renderer doesn't stream them
+    static unsigned int drawBlockBuffer;
     static unsigned int tBlack;
     static unsigned int tGrey;
     static unsigned int tZeroNormal;
@@ -3,6 +3,7 @@
 
 #include "renderer/opengl/shaders/shaderOpenGL.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "renderer/opengl/shaderParameterOpenGL.h"
 #include "renderer/opengl/textureBindingOpenGL.h"
 #include "math/glm/gtc/type_ptr.hpp"
@@ -53,11 +54,12 @@ bool ShaderOpenGL::build()
                 return false;
             }
 
-            locMModelViewProjection = glGetUniformLocation(programm, "mModelViewProjection");
-            locMModel = glGetUniformLocation(programm, "mModel");
-            locMNormal = glGetUniformLocation(programm, "mNormal");
-            locFOpacity = glGetUniformLocation(programm, "fOpacity");
-            locUVShiftSize = glGetUniformLocation(programm, "v4uvShiftSize");
+            uniforms.read(programm);
+            locMModelViewProjection = uniforms.get("mModelViewProjection");
+            locMModel = uniforms.get("mModel");
+            locMNormal = uniforms.get("mNormal");
+            locFOpacity = uniforms.get("fOpacity");
+            locUVShiftSize = uniforms.get("v4uvShiftSize");
 
             bIsReady = true;
             return true;
@@ -75,11 +77,8 @@ bool ShaderOpenGL::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
     if (!bIsReady)
         return false;
 
-    if (currentShader != this)
-    {
-        currentShader = this;
-        glUseProgram(programm);
-    }
+    currentShader = this;
+    StateOpenGL::useProgram(programm);
 
     if (locMModelViewProjection != -1)
     {
@@ -98,8 +97,7 @@ bool ShaderOpenGL::use(Matrix4 &mModel, Matrix4 &mModelViewProjection)
     int slot = 0;
     for (auto &binding : bindings)
     {
-        glActiveTexture(slotLinking[slot]);
-        glBindTexture(GL_TEXTURE_2D, binding->textureId);
+        StateOpenGL::bindTextureUnit(slotLinking[slot], GL_TEXTURE_2D, binding->textureId);
         glUniform1i(binding->locTexture, slot);
 
         slot++;
@@ -132,6 +130,11 @@ TextureBinding *ShaderOpenGL::addTextureBinding(std::string parameterName)
     return newBinding;
 }
 
+bool ShaderOpenGL::hasTextureBindings()
+{
+    return !bindings.empty();
+}
+
 void ShaderOpenGL::setOpacity(float value)
 {
     this->opacity = value;
@@ -140,9 +143,7 @@ void ShaderOpenGL::setOpacity(float value)
 
 int ShaderOpenGL::getUniformLocation(const char *name)
 {
-    if (programm != -1)
-        return glGetUniformLocation(programm, name);
-    return -1;
+    return uniforms.get(name);
 }
 
 void ShaderOpenGL::provideFloatValue(int uniform, int amount, float *value)
@@ -195,7 +196,7 @@ void ShaderOpenGL::provideInt4Value(int uniform, int amount, int *value)
 
 ShaderParameter *ShaderOpenGL::createShaderParameter(const char *name, ShaderParameterType type)
 {
-    return new ShaderParameterOpenGL(this, name, type);
+    return new ShaderParameterOpenGL(getUniformLocation(name), type);
 }
 
 void ShaderOpenGL::showCompilationError(unsigned int shader)
@@ -5,6 +5,7 @@
 #include "common/utils.h"
 #include "renderer/shader.h"
 #include "renderer/opengl/textureBindingOpenGL.h"
+#include "renderer/opengl/uniformLocationsOpenGL.h"
 #include <vector>
 
 class ShaderOpenGL : public Shader
@@ -18,9 +19,11 @@ public:
     EXPORT virtual bool compile(unsigned short type, const char *code, unsigned int *shader) override;
 
     TextureBinding *addTextureBinding(std::string parameterName) override;
+    EXPORT bool hasTextureBindings() override;
 
     EXPORT void setOpacity(float value) override;
 
+    // Locations are read once after linking, lookup doesn't go to GL
     EXPORT int getUniformLocation(const char *name);
     EXPORT void provideFloatValue(int uniform, int amount, float *value);
     EXPORT void provideFloat2Value(int uniform, int amount, float *value);
@@ -51,5 +54,7 @@ protected:
 
     int locUVShiftSize = -1;
 
+    UniformLocationsOpenGL uniforms;
+
     std::vector<TextureBindingOpenGL *> bindings;
 };
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/opengl/stateOpenGL.h"
+#include "renderer/opengl/glew.h"
+
+// Value no real name or enum has, so the first call always goes to GL
+#define STATE_UNKNOWN 0xffffffffu
+
+unsigned int StateOpenGL::programm = STATE_UNKNOWN;
+unsigned int StateOpenGL::vao = STATE_UNKNOWN;
+unsigned int StateOpenGL::activeUnit = STATE_UNKNOWN;
+unsigned int StateOpenGL::textures[STATE_TEXTURE_UNITS][3];
+int StateOpenGL::capabilities[3] = {-1, -1, -1};
+unsigned int StateOpenGL::blendSource = STATE_UNKNOWN;
+unsigned int StateOpenGL::blendDestination = STATE_UNKNOWN;
+int StateOpenGL::depthWrite = -1;
+unsigned int StateOpenGL::depthFunction = STATE_UNKNOWN;
+int StateOpenGL::callsIssued = 0;
+int StateOpenGL::callsSkipped = 0;
+
+void StateOpenGL::useProgram(unsigned int programm)
+{
+    if (isChanged(StateOpenGL::programm != programm))
+    {
+        StateOpenGL::programm = programm;
+        glUseProgram(programm);
+    }
+}
+
+void StateOpenGL::bindVertexArray(unsigned int vao)
+{
+    if (isChanged(StateOpenGL::vao != vao))
+    {
+        StateOpenGL::vao = vao;
+        glBindVertexArray(vao);
+    }
+}
+
+void StateOpenGL::activeTexture(unsigned int unit)
+{
+    if (isChanged(activeUnit != unit))
+    {
+        activeUnit = unit;
+        glActiveTexture(unit);
+    }
+}
+
+void StateOpenGL::bindTexture(unsigned int target, unsigned int texture)
+{
+    int index = getTargetIndex(target);
+    unsigned int unit = activeUnit - GL_TEXTURE0;
+    if (index < 0 || activeUnit == STATE_UNKNOWN || unit >= STATE_TEXTURE_UNITS)
+    {
+        callsIssued++;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (isChanged(textures[unit][index] != texture + 1))
+    {
+        textures[unit][index] = texture + 1;
+        glBindTexture(target, texture);
+    }
+}
+
+void StateOpenGL::bindTextureUnit(unsigned int unit, unsigned int target, unsigned int texture)
+{
+    int index = getTargetIndex(target);
+    unsigned int slot = unit - GL_TEXTURE0;
+    if (index >= 0 && slot < STATE_TEXTURE_UNITS && textures[slot][index] == texture + 1)
+    {
+        callsSkipped += 2;
+        return;
+    }
+
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+void StateOpenGL::enable(unsigned int capability)
+{
+    setCapability(capability, true);
+}
+
+void StateOpenGL::disable(unsigned int capability)
+{
+    setCapability(capability, false);
+}
+
+void StateOpenGL::blendFunc(unsigned int source, unsigned int destination)
+{
+    if (isChanged(blendSource != source || blendDestination != destination))
+    {
+        blendSource = source;
+        blendDestination = destination;
+        glBlendFunc(source, destination);
+    }
+}
+
+void StateOpenGL::depthMask(bool bWrite)
+{
+    if (isChanged(depthWrite != (int)bWrite))
+    {
+        depthWrite = bWrite;
+        glDepthMask(bWrite ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void StateOpenGL::depthFunc(unsigned int function)
+{
+    if (isChanged(depthFunction != function))
+    {
+        depthFunction = function;
+        glDepthFunc(function);
+    }
+}
+
+void StateOpenGL::forgetTexture(unsigned int texture)
+{
+    for (int i = 0; i < STATE_TEXTURE_UNITS; i++)
+        for (int j = 0; j < 3; j++)
+            if (textures[i][j] == texture + 1)
+                textures[i][j] = 0;
+}
+
+void StateOpenGL::forgetVertexArray(unsigned int vao)
+{
+    if (StateOpenGL::vao == vao)
+        StateOpenGL::vao = STATE_UNKNOWN;
+}
+
+void StateOpenGL::invalidate()
+{
+    programm = STATE_UNKNOWN;
+    vao = STATE_UNKNOWN;
+    activeUnit = STATE_UNKNOWN;
+    for (int i = 0; i < STATE_TEXTURE_UNITS; i++)
+        for (int j = 0; j < 3; j++)
+            textures[i][j] = 0;
+    for (int i = 0; i < 3; i++)
+        capabilities[i] = -1;
+    blendSource = STATE_UNKNOWN;
+    blendDestination = STATE_UNKNOWN;
+    depthWrite = -1;
+    depthFunction = STATE_UNKNOWN;
+}
+
+void StateOpenGL::resetCounters()
+{
+    callsIssued = 0;
+    callsSkipped = 0;
+}
+
+void StateOpenGL::setCapability(unsigned int capability, bool bEnabled)
+{
+    int index = -1;
+    if (capability == GL_BLEND)
+        index = 0;
+    else if (capability == GL_DEPTH_TEST)
+        index = 1;
+    else if (capability == GL_CULL_FACE)
+        index = 2;
+
+    if (index < 0)
+        callsIssued++;
+    else if (!isChanged(capabilities[index] != (int)bEnabled))
+        return;
+    else
+        capabilities[index] = bEnabled;
+
+    if (bEnabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+int StateOpenGL::getTargetIndex(unsigned int target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_CUBE_MAP:
+        return 1;
+    case GL_TEXTURE_BUFFER:
+        return 2;
+    default:
+        return -1;
+    }
+}
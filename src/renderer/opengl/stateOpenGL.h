@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+
+#define STATE_TEXTURE_UNITS 32
+
+// Shadows GL state set through it and drops calls that wouldn't change anything
+// All code of the backend goes through it, code calling GL directly has to invalidate it afterwards
+class StateOpenGL
+{
+public:
+    EXPORT static void useProgram(unsigned int programm);
+    EXPORT static void bindVertexArray(unsigned int vao);
+
+    // Unit is GL_TEXTURE0 + n, texture is bound to the active unit
+    EXPORT static void activeTexture(unsigned int unit);
+    EXPORT static void bindTexture(unsigned int target, unsigned int texture);
+    // Switches active unit only when texture of the unit has to change
+    EXPORT static void bindTextureUnit(unsigned int unit, unsigned int target, unsigned int texture);
+
+    // Blend, depth test and cull face are cached, other capabilities go straight to GL
+    EXPORT static void enable(unsigned int capability);
+    EXPORT static void disable(unsigned int capability);
+    EXPORT static void blendFunc(unsigned int source, unsigned int destination);
+    EXPORT static void depthMask(bool bWrite);
+    EXPORT static void depthFunc(unsigned int function);
+
+    // GL unbinds deleted objects and may give their names to new ones
+    EXPORT static void forgetTexture(unsigned int texture);
+    EXPORT static void forgetVertexArray(unsigned int vao);
+
+    // Everything is unknown after it, next call of every kind goes to GL
+    EXPORT static void invalidate();
+
+    EXPORT static inline int getCallsIssued() { return callsIssued; }
+    EXPORT static inline int getCallsSkipped() { return callsSkipped; }
+    EXPORT static void resetCounters();
+
+protected:
+    static void setCapability(unsigned int capability, bool bEnabled);
+    static int getTargetIndex(unsigned int target);
+    static inline bool isChanged(bool bChanged)
+    {
+        if (bChanged)
+            callsIssued++;
+        else
+            callsSkipped++;
+        return bChanged;
+    }
+
+    static unsigned int programm;
+    static unsigned int vao;
+    static unsigned int activeUnit;
+    // 2D, cube map and buffer textures of every unit, names are kept plus one so zero is unknown
+    static unsigned int textures[STATE_TEXTURE_UNITS][3];
+    // Blend, depth test, cull face: 0 disabled, 1 enabled, -1 unknown
+    static int capabilities[3];
+    static unsigned int blendSource;
+    static unsigned int blendDestination;
+    static int depthWrite;
+    static unsigned int depthFunction;
+
+    static int callsIssued;
+    static int callsSkipped;
+};
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/opengl/streamRingOpenGL.h"
+#include "renderer/opengl/glew.h"
+
+StreamRingOpenGL::~StreamRingOpenGL()
+{
+    destroy();
+}
+
+void StreamRingOpenGL::create(unsigned int target, int sectionSize)
+{
+    destroy();
+    this->target = target;
+    this->sectionSize = sectionSize;
+    section = 0;
+    // Mapping that failed once is not tried again
+    bPersistent = bPersistent && GLEW_ARB_buffer_storage;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    if (bPersistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        int size = sectionSize * STREAM_RING_FRAMES;
+        glBufferStorage(target, size, nullptr, flags);
+        mapped = (unsigned char *)glMapBufferRange(target, 0, size, flags);
+        if (!mapped)
+        {
+            bPersistent = false;
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+        }
+    }
+    glBindBuffer(target, 0);
+}
+
+void StreamRingOpenGL::destroy()
+{
+    for (int i = 0; i < STREAM_RING_FRAMES; i++)
+    {
+        if (fences[i])
+            glDeleteSync((GLsync)fences[i]);
+        fences[i] = nullptr;
+    }
+    if (buffer)
+    {
+        if (mapped)
+        {
+            glBindBuffer(target, buffer);
+            glUnmapBuffer(target);
+            glBindBuffer(target, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    mapped = nullptr;
+}
+
+bool StreamRingOpenGL::nextSection(bool bBlocking)
+{
+    if (!bPersistent)
+        return true;
+
+    section = (section + 1) % STREAM_RING_FRAMES;
+    if (!fences[section])
+        return true;
+
+    GLsync fence = (GLsync)fences[section];
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        if (!bBlocking)
+            return false;
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+    glDeleteSync(fence);
+    fences[section] = nullptr;
+    return true;
+}
+
+void StreamRingOpenGL::fenceSection()
+{
+    if (bPersistent && buffer && !fences[section])
+        fences[section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+
+// Frames in flight, section of a frame is written again only after GPU finished reading it
+#define STREAM_RING_FRAMES 3
+
+// Buffer of streamed data split into a section per frame in flight
+// Uses persistently mapped ring with fences where buffer storage is supported, orphaned buffer otherwise
+class StreamRingOpenGL
+{
+public:
+    EXPORT ~StreamRingOpenGL();
+
+    // Makes new buffer for the target, GL deletes the old one after draws still reading it
+    // Starts from the first section, falls back to orphaning if mapping fails
+    EXPORT void create(unsigned int target, int sectionSize);
+    EXPORT void destroy();
+
+    // Moves to the next section and waits until GPU is done with it
+    // Without blocking returns false if the section is still read, nothing should be written this frame
+    EXPORT bool nextSection(bool bBlocking);
+    // Call after the commands reading the current section
+    EXPORT void fenceSection();
+
+    inline bool isPersistent() { return bPersistent; }
+    inline unsigned int getBuffer() { return buffer; }
+    inline int getSectionSize() { return sectionSize; }
+    // Offset of the current section in the buffer, mapped memory is valid for persistent ring only
+    inline int getSectionOffset() { return section * sectionSize; }
+    inline unsigned char *getMapped() { return mapped; }
+
+protected:
+    bool bPersistent = true;
+    unsigned int target = 0;
+    unsigned int buffer = 0;
+    unsigned char *mapped = nullptr;
+    int sectionSize = 0;
+    int section = 0;
+    void *fences[STREAM_RING_FRAMES] = {};
+};
@@ -3,6 +3,7 @@
 
 #include "renderer/opengl/textureEditableOpenGL.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "math/transformation.h"
 #include "renderer/opengl/shaders/commonOpenGLShaders.h"
 
@@ -57,30 +58,29 @@ void TextureEditableOpenGL::drawImage(Texture *texture, Matrix4 *model, Shader *
     shader->use(*model, *model);
     if (texture)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, reinterpret_cast<TextureOpengGL *>(texture)->getGLTextureId());
+        StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, reinterpret_cast<TextureOpengGL *>(texture)->getGLTextureId());
     }
     shader->setOpacity(1.0f);
 
     CommonOpenGLShaders::getSpriteMesh()->useVertexArray();
 
-    glEnable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::disable(GL_CULL_FACE);
+    StateOpenGL::disable(GL_DEPTH_TEST);
     switch (colorMode)
     {
     case ColorMode::Lit:
-        glBlendFunc(GL_ONE, GL_ZERO);
+        StateOpenGL::blendFunc(GL_ONE, GL_ZERO);
         break;
     case ColorMode::Alpha:
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         break;
     case ColorMode::Addition:
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE);
         break;
     case ColorMode::Substraction:
         glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE);
         break;
     }
     glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -95,8 +95,8 @@ void TextureEditableOpenGL::drawImage(Texture *texture, Matrix4 *model, Shader *
 
 void TextureEditableOpenGL::recreateMipMaps()
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::activeTexture(GL_TEXTURE0);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, textureID);
     glGenerateMipmap(GL_TEXTURE_2D);
 }
 
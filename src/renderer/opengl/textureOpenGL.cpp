@@ -3,13 +3,15 @@
 
 #include "renderer/opengl/textureOpenGL.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
+#include "renderer/opengl/textureStreamOpenGL.h"
 #include <algorithm>
 
 TextureOpengGL::TextureOpengGL(unsigned int textureID)
 {
     this->textureID = textureID;
 
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, textureID);
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
 
@@ -19,7 +21,7 @@ TextureOpengGL::TextureOpengGL(unsigned int textureID)
 TextureOpengGL::TextureOpengGL(int width, int height)
 {
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, textureID);
 
     unsigned char *data = new unsigned char[width * height * 4];
     for (int i = 0; i < width * height; i++)
@@ -38,25 +40,42 @@ TextureOpengGL::TextureOpengGL(int width, int height)
     setFiltering(this->filter);
 }
 
+TextureOpengGL::TextureOpengGL(int width, int height, unsigned int placeholderID, TextureStreamOpenGL *stream)
+{
+    this->textureID = placeholderID;
+    this->stream = stream;
+    this->width = width;
+    this->height = height;
+}
+
+TextureOpengGL::TextureOpengGL(TextureOpengGL *page, int x, int y, int width, int height)
+{
+    this->textureID = page->getGLTextureId();
+    this->filter = page->getFiltering();
+    setRegion(page, x, y, width, height);
+}
+
 TextureOpengGL::~TextureOpengGL()
 {
-    if (glIsTexture(textureID))
+    // Placeholder belongs to the stream, page belongs to the atlas
+    if (stream)
+        stream->cancel(this);
+    else if (!atlasPage && glIsTexture(textureID))
     {
         glDeleteTextures(1, &textureID);
+        StateOpenGL::forgetTexture(textureID);
         textureID = 0;
     }
 }
 
 void TextureOpengGL::bind()
 {
-    glActiveTexture((unsigned int)TextureSlot::TEXTURE_0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::bindTextureUnit((unsigned int)TextureSlot::TEXTURE_0, GL_TEXTURE_2D, textureID);
 }
 
 void TextureOpengGL::bind(TextureSlot slot)
 {
-    glActiveTexture((unsigned int)slot);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::bindTextureUnit((unsigned int)slot, GL_TEXTURE_2D, textureID);
 }
 
 unsigned int TextureOpengGL::getGLTextureId()
@@ -67,8 +86,11 @@ unsigned int TextureOpengGL::getGLTextureId()
 void TextureOpengGL::setFiltering(TextureFilter filter)
 {
     this->filter = filter;
+    // Placeholder is shared, filter is applied when streaming finishes
+    if (isStreaming())
+        return;
 
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, textureID);
     if (filter == TextureFilter::Nearest)
     {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -81,8 +103,20 @@ void TextureOpengGL::setFiltering(TextureFilter filter)
     }
 }
 
+void TextureOpengGL::finishStreaming(unsigned int textureID)
+{
+    this->textureID = textureID;
+    stream = nullptr;
+    if (textureID)
+        setFiltering(filter);
+}
+
 Texture *TextureOpengGL::clone()
 {
+    // Pixels are not uploaded yet, copy looks like the placeholder
+    if (isStreaming())
+        return new TextureOpengGL(getWidth(), getHeight());
+
     unsigned int gBuffer;
     glGenFramebuffers(1, &gBuffer);
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
@@ -90,15 +124,15 @@ Texture *TextureOpengGL::clone()
 
     glReadBuffer(GL_COLOR_ATTACHMENT0);
 
-    glActiveTexture(GL_TEXTURE0);
+    StateOpenGL::activeTexture(GL_TEXTURE0);
     unsigned int newTexture;
 
     glGenTextures(1, &newTexture);
-    glBindTexture(GL_TEXTURE_2D, newTexture);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, newTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, getWidth(), getHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, getWidth(), getHeight(), 0);
+    glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, regionX, regionY, getWidth(), getHeight(), 0);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glDeleteFramebuffers(1, &gBuffer);
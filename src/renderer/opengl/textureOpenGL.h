@@ -40,11 +40,17 @@ enum class TextureSlot
     TEXTURE_31 = 0x84DF
 };
 
+class TextureStreamOpenGL;
+
 class TextureOpengGL : public Texture
 {
 public:
     EXPORT TextureOpengGL(unsigned int textureID);
     EXPORT TextureOpengGL(int width, int height);
+    // Texture of the stream, placeholder is bound until its pixels are uploaded
+    EXPORT TextureOpengGL(int width, int height, unsigned int placeholderID, TextureStreamOpenGL *stream);
+    // Region of atlas page, binds the page and never deletes it, filtering of the region is the one of the page
+    EXPORT TextureOpengGL(TextureOpengGL *page, int x, int y, int width, int height);
     EXPORT ~TextureOpengGL();
 
     EXPORT void bind();
@@ -56,6 +62,11 @@ public:
 
     EXPORT Texture *clone() final override;
 
+    // Zero leaves the texture empty
+    EXPORT void finishStreaming(unsigned int textureID);
+    inline bool isStreaming() { return stream != nullptr; }
+
 protected:
     unsigned int textureID = 0;
+    TextureStreamOpenGL *stream = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/opengl/textureStreamOpenGL.h"
+#include "renderer/opengl/textureOpenGL.h"
+#include "renderer/opengl/stateOpenGL.h"
+#include "renderer/opengl/glew.h"
+#include "renderer/renderer.h"
+#include "loaders/stb_image.h"
+#include <string.h>
+#include <algorithm>
+
+TextureStreamOpenGL::~TextureStreamOpenGL()
+{
+    core->waitForJobs(&decodeJobsInFlight);
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+    {
+        if ((*it)->texture)
+            (*it)->texture->finishStreaming(0);
+        releaseJob(*it);
+    }
+    jobs.clear();
+
+    if (bReady)
+    {
+        ring.destroy();
+        glDeleteTextures(1, &placeholder);
+        StateOpenGL::forgetTexture(placeholder);
+    }
+}
+
+TextureOpengGL *TextureStreamOpenGL::queue(const std::string &path, int width, int height)
+{
+    if (!bReady)
+        setup();
+
+    auto job = new TextureStreamJob();
+    job->texture = new TextureOpengGL(width, height, placeholder, this);
+    job->path = path;
+    job->width = width;
+    job->height = height;
+    job->pixels = nullptr;
+    job->state = TextureStreamState::Decoding;
+    job->textureID = 0;
+    job->rowsUploaded = 0;
+    jobs.push_back(job);
+
+    core->queueJob([job]
+                   {
+                        int width, height, channels;
+                        job->pixels = stbi_load(job->path.c_str(), &width, &height, &channels, 4);
+                        // File changed since its size was read
+                        if (job->pixels && (width != job->width || height != job->height))
+                        {
+                            stbi_image_free(job->pixels);
+                            job->pixels = nullptr;
+                        }
+                        job->state = job->pixels ? TextureStreamState::Decoded : TextureStreamState::Failed; },
+                   &decodeJobsInFlight);
+
+    return job->texture;
+}
+
+void TextureStreamOpenGL::cancel(TextureOpengGL *texture)
+{
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        if ((*it)->texture == texture)
+            (*it)->texture = nullptr;
+}
+
+void TextureStreamOpenGL::process(int budget)
+{
+    auto now = std::chrono::steady_clock::now();
+    float elapsed = std::chrono::duration<float>(now - windowStart).count();
+    if (elapsed >= 1.0f)
+    {
+        throughput = windowBytes / elapsed;
+        windowBytes = 0;
+        windowStart = now;
+    }
+
+    if (jobs.empty())
+        return;
+
+    // Uploads wait for the next frame instead of stalling this one
+    if (!ring.nextSection(false))
+        return;
+
+    if (budget > ring.getSectionSize())
+        ring.create(GL_PIXEL_UNPACK_BUFFER, budget);
+
+    int used = 0;
+    auto it = jobs.begin();
+    while (it != jobs.end())
+    {
+        TextureStreamJob *job = *it;
+        TextureStreamState state = job->state;
+        if (state == TextureStreamState::Decoding)
+        {
+            ++it;
+            continue;
+        }
+
+        bool bFinished = !job->texture || state == TextureStreamState::Failed;
+        if (!bFinished)
+        {
+            if (!uploadRows(job, budget, used))
+                break;
+            bFinished = job->rowsUploaded == job->height;
+        }
+
+        if (bFinished)
+        {
+            // Texture of a broken file is left empty
+            if (job->texture)
+            {
+                if (state == TextureStreamState::Decoded)
+                {
+                    StateOpenGL::bindTexture(GL_TEXTURE_2D, job->textureID);
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                }
+                job->texture->finishStreaming(job->textureID);
+                job->textureID = 0;
+            }
+            releaseJob(job);
+            it = jobs.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    if (used > 0)
+        ring.fenceSection();
+    windowBytes += used;
+}
+
+int TextureStreamOpenGL::getPendingBytes()
+{
+    int bytes = 0;
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        if ((*it)->texture)
+            bytes += ((*it)->height - (*it)->rowsUploaded) * (*it)->width * 4;
+    return bytes;
+}
+
+void TextureStreamOpenGL::setup()
+{
+    unsigned char grey[4] = {64, 64, 64, 255};
+    glGenTextures(1, &placeholder);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, placeholder);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    ring.create(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STREAM_DEFAULT_BUDGET);
+    bReady = true;
+}
+
+void TextureStreamOpenGL::releaseJob(TextureStreamJob *job)
+{
+    if (job->pixels)
+        stbi_image_free(job->pixels);
+    if (job->textureID)
+    {
+        glDeleteTextures(1, &job->textureID);
+        StateOpenGL::forgetTexture(job->textureID);
+    }
+    delete job;
+}
+
+// Band of rows that fits into what is left of the budget, at least one row goes if nothing was uploaded this frame
+bool TextureStreamOpenGL::uploadRows(TextureStreamJob *job, int budget, int &used)
+{
+    int rowSize = job->width * 4;
+    int rows = std::min(job->height - job->rowsUploaded, (budget - used) / rowSize);
+    if (rows <= 0)
+    {
+        if (used > 0)
+            return false;
+        rows = 1;
+    }
+
+    int size = rows * rowSize;
+    if (used + size > ring.getSectionSize())
+    {
+        // Row wider than the whole budget, ring is free as nothing was written this frame
+        ring.create(GL_PIXEL_UNPACK_BUFFER, size);
+    }
+
+    if (!job->textureID)
+    {
+        glGenTextures(1, &job->textureID);
+        StateOpenGL::bindTexture(GL_TEXTURE_2D, job->textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, job->width, job->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    const unsigned char *source = job->pixels + (size_t)job->rowsUploaded * rowSize;
+    size_t offset = 0;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.getBuffer());
+    if (ring.isPersistent())
+    {
+        offset = (size_t)ring.getSectionOffset() + used;
+        memcpy(ring.getMapped() + offset, source, size);
+    }
+    else
+    {
+        // Orphaning gives new storage, uploads of previous bands keep reading the old one
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, source);
+    }
+
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, job->textureID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->rowsUploaded, job->width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (void *)offset);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    job->rowsUploaded += rows;
+    used += size;
+    return true;
+}
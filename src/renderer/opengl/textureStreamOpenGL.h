@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "connector/withCore.h"
+#include "renderer/opengl/streamRingOpenGL.h"
+#include <string>
+#include <list>
+#include <atomic>
+#include <chrono>
+
+class TextureOpengGL;
+
+enum class TextureStreamState
+{
+    Decoding = 0,
+    Decoded,
+    Failed
+};
+
+struct TextureStreamJob
+{
+    TextureOpengGL *texture;
+    std::string path;
+    int width;
+    int height;
+    // Written by worker, read after state is not decoding
+    unsigned char *pixels;
+    std::atomic<TextureStreamState> state;
+    unsigned int textureID;
+    int rowsUploaded;
+};
+
+// Image files are decoded by workers, pixels go to GL through pixel buffer ring in bands of rows
+// Every frame uploads not more than the budget, textures show placeholder until their last row is uploaded
+// Section of the ring holds one frame of uploads, without persistent ring every band orphans the buffer
+class TextureStreamOpenGL : public WithCore
+{
+public:
+    EXPORT ~TextureStreamOpenGL();
+
+    EXPORT TextureOpengGL *queue(const std::string &path, int width, int height);
+    // Texture destroyed before its upload is dropped from the stream
+    EXPORT void cancel(TextureOpengGL *texture);
+
+    // Uploads decoded rows, call once per frame with GL context current
+    // Frame is skipped if GPU still reads the section of the ring
+    EXPORT void process(int budget);
+
+    // Bytes of queued textures not uploaded yet
+    EXPORT int getPendingBytes();
+    // Bytes per second uploaded during the last second
+    inline float getThroughput() { return throughput; }
+
+protected:
+    void setup();
+    void releaseJob(TextureStreamJob *job);
+    bool uploadRows(TextureStreamJob *job, int budget, int &used);
+
+    bool bReady = false;
+    unsigned int placeholder = 0;
+
+    StreamRingOpenGL ring;
+
+    std::list<TextureStreamJob *> jobs;
+    std::atomic<int> decodeJobsInFlight = 0;
+
+    int windowBytes = 0;
+    float throughput = 0.0f;
+    std::chrono::steady_clock::time_point windowStart = std::chrono::steady_clock::now();
+};
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/opengl/uniformLocationsOpenGL.h"
+#include "renderer/opengl/glew.h"
+
+void UniformLocationsOpenGL::read(unsigned int programm)
+{
+    locations.clear();
+
+    int amount = 0, maxLength = 0;
+    glGetProgramiv(programm, GL_ACTIVE_UNIFORMS, &amount);
+    glGetProgramiv(programm, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    if (amount <= 0 || maxLength <= 0)
+        return;
+
+    std::string name(maxLength, '\0');
+    for (int i = 0; i < amount; i++)
+    {
+        int length = 0, size = 0;
+        unsigned int type = 0;
+        glGetActiveUniform(programm, i, maxLength, &length, &size, &type, &name[0]);
+        std::string uniform = name.substr(0, length);
+
+        // Members of uniform blocks have no location
+        int location = glGetUniformLocation(programm, uniform.c_str());
+        if (location == -1)
+            continue;
+
+        locations[uniform] = location;
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+            locations[uniform.substr(0, uniform.size() - 3)] = location;
+        else if (size > 1)
+            locations[uniform + "[0]"] = location;
+    }
+}
+
+void UniformLocationsOpenGL::clear()
+{
+    locations.clear();
+}
+
+int UniformLocationsOpenGL::get(const char *name)
+{
+    auto it = locations.find(name);
+    return it != locations.end() ? it->second : -1;
+}
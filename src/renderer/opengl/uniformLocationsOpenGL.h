@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include <string>
+#include <unordered_map>
+
+// Locations of all active uniforms of a program, read once after linking
+// Lookup doesn't go to GL, arrays are available both as "name" and "name[0]"
+class UniformLocationsOpenGL
+{
+public:
+    EXPORT void read(unsigned int programm);
+    EXPORT void clear();
+
+    // Returns -1 for uniforms the program doesn't have, same as GL does
+    EXPORT int get(const char *name);
+
+protected:
+    std::unordered_map<std::string, int> locations;
+};
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/opengl/uniformStreamOpenGL.h"
+#include "renderer/opengl/glew.h"
+#include <algorithm>
+#include <string.h>
+
+void UniformStreamOpenGL::setup()
+{
+    int value = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+    alignment = std::max(value, 16);
+    createRing(UNIFORM_STREAM_INITIAL_SIZE);
+    bReady = true;
+}
+
+void UniformStreamOpenGL::beginFrame()
+{
+    if (!bReady)
+        setup();
+
+    batch.clear();
+    cursor = 0;
+    batchBase = 0;
+    ring.nextSection(true);
+}
+
+void UniformStreamOpenGL::endFrame()
+{
+    if (bReady)
+        ring.fenceSection();
+}
+
+int UniformStreamOpenGL::push(const void *data, int size)
+{
+    int offset = (batch.size() + alignment - 1) / alignment * alignment;
+    batch.resize(offset + size);
+    memcpy(&batch[offset], data, size);
+    return offset;
+}
+
+void UniformStreamOpenGL::upload()
+{
+    if (batch.empty())
+        return;
+
+    int size = batch.size();
+    if (!ring.isPersistent())
+    {
+        // Orphaning gives new storage, draws of the previous batch keep reading the old one
+        glBindBuffer(GL_UNIFORM_BUFFER, ring.getBuffer());
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, size, batch.data());
+        batchBase = 0;
+        batch.clear();
+        return;
+    }
+
+    // New buffer doesn't disturb draws still reading the old one, GL deletes it after them
+    int start = (cursor + alignment - 1) / alignment * alignment;
+    if (start + size > ring.getSectionSize())
+    {
+        createRing(std::max(ring.getSectionSize() * 2, size * 2));
+        start = 0;
+    }
+
+    batchBase = ring.getSectionOffset() + start;
+    memcpy(ring.getMapped() + batchBase, batch.data(), size);
+    cursor = start + size;
+    batch.clear();
+}
+
+void UniformStreamOpenGL::bind(int binding, int offset, int size)
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, ring.getBuffer(), batchBase + offset, size);
+}
+
+void UniformStreamOpenGL::createRing(int sectionSize)
+{
+    ring.create(GL_UNIFORM_BUFFER, (sectionSize + alignment - 1) / alignment * alignment);
+}
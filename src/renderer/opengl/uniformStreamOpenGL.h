@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "renderer/opengl/streamRingOpenGL.h"
+#include <vector>
+
+#define UNIFORM_STREAM_INITIAL_SIZE (1024 * 1024)
+
+// Binding points of std140 blocks shared by built-in shaders
+#define UNIFORM_BINDING_FRAME 0
+#define UNIFORM_BINDING_DRAW 1
+
+// Streams uniform block data of a frame, draws only bind ranges of it
+// Blocks are gathered into a batch and uploaded with one copy, offsets of a batch are valid until the next upload
+// Persistent ring takes batches one after another, without it every batch orphans the buffer
+class UniformStreamOpenGL
+{
+public:
+    EXPORT void setup();
+
+    // Waits until GPU is done with the section of this frame
+    EXPORT void beginFrame();
+    EXPORT void endFrame();
+
+    // Returns offset of the block in the batch, aligned for binding
+    EXPORT int push(const void *data, int size);
+    EXPORT void upload();
+    EXPORT void bind(int binding, int offset, int size);
+
+    inline bool isPersistent() { return ring.isPersistent(); }
+    inline bool hasBatch() { return !batch.empty(); }
+
+protected:
+    void createRing(int sectionSize);
+
+    bool bReady = false;
+    int alignment = 256;
+
+    StreamRingOpenGL ring;
+    int cursor = 0;
+    int batchBase = 0;
+
+    std::vector<unsigned char> batch;
+};
@@ -4,6 +4,104 @@
 #include "renderer/renderQueue.h"
 #include "actor/actor.h"
 #include <mutex>
+#include <cstring>
+
+// Least significant digit radix sort, 8 bits per pass
+// Passes where every key has the same digit are skipped, usually layer and pass bytes
+void _radixSort(RenderElement **elements, int amount, std::vector<RenderSortItem> &items, std::vector<RenderSortItem> &temp)
+{
+    if (amount < 2)
+        return;
+
+    if ((int)items.size() < amount)
+    {
+        items.resize(amount);
+        temp.resize(amount);
+    }
+
+    for (int i = 0; i < amount; i++)
+        items[i] = {elements[i]->sortKey, elements[i]};
+
+    RenderSortItem *source = items.data();
+    RenderSortItem *target = temp.data();
+    int counts[256];
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < amount; i++)
+            counts[(source[i].key >> shift) & 0xFF]++;
+
+        if (counts[(source[0].key >> shift) & 0xFF] == amount)
+            continue;
+
+        int offset = 0;
+        for (int i = 0; i < 256; i++)
+        {
+            int count = counts[i];
+            counts[i] = offset;
+            offset += count;
+        }
+
+        for (int i = 0; i < amount; i++)
+            target[counts[(source[i].key >> shift) & 0xFF]++] = source[i];
+
+        std::swap(source, target);
+    }
+
+    for (int i = 0; i < amount; i++)
+        elements[i] = source[i].element;
+}
+
+// Segment of the worker thread, add calls from other threads go straight to the queue
+static thread_local RenderQueueSegment *currentSegment = nullptr;
+
+void _setSegmentPointers(RenderQueueSegment *segment, std::vector<int> &indexes, std::vector<RenderElement *> &pointers)
+{
+    pointers.resize(indexes.size());
+    for (int i = 0; i < (int)indexes.size(); i++)
+        pointers[i] = &segment->elements[indexes[i]];
+}
+
+// Appends elements of segments to target, sorted segments are merged by key, otherwise joined in order
+int _mergeSegments(RenderElement **target, int amount, RenderQueueSegment *segments, int segmentsAmount,
+                   std::vector<RenderElement *> RenderQueueSegment::*phase, bool bSorted)
+{
+    if (!bSorted)
+    {
+        for (int i = 0; i < segmentsAmount; i++)
+        {
+            for (auto element : segments[i].*phase)
+            {
+                if (amount >= MAX_RENDER_ELEMENTS)
+                    return amount;
+                target[amount++] = element;
+            }
+        }
+        return amount;
+    }
+
+    // Few segments, so the smallest head is simply searched every time
+    std::vector<int> heads(segmentsAmount, 0);
+    while (amount < MAX_RENDER_ELEMENTS)
+    {
+        int best = -1;
+        uint64_t bestKey = 0;
+        for (int i = 0; i < segmentsAmount; i++)
+        {
+            auto &elements = segments[i].*phase;
+            if (heads[i] < (int)elements.size() && (best == -1 || elements[heads[i]]->sortKey < bestKey))
+            {
+                best = i;
+                bestKey = elements[heads[i]]->sortKey;
+            }
+        }
+        if (best == -1)
+            break;
+        target[amount++] = (segments[best].*phase)[heads[best]++];
+    }
+    return amount;
+}
 
 RenderQueue::RenderQueue()
 {
@@ -23,55 +121,79 @@ void RenderQueue::reset()
     lastShadowCasterElement = 0;
     lastElementLight = 0;
     lastDebugElement = 0;
+    bMainPhaseMerged = false;
+    bShadowCastersMerged = false;
 }
 
-void RenderQueue::addMainPhase(Matrix4 &mModel, Shader *shader, Texture *texture, MeshStatic *mesh, ShaderParameter **parameters, int parametersAmount)
+void RenderQueue::setProjectionMatrix(Matrix4 &mProjection)
 {
-    if (lastElementMainPhase < MAX_RENDER_ELEMENTS && lastElement < MAX_RENDER_ELEMENTS && shader && mesh)
-    {
-        Matrix4 mv = mView * mModel;
-        if (!mesh->getBoundVolumeSphere()->isSphereInFrustum(&mv, getCullingPlanes()))
-            return;
+    this->mProjection = mProjection;
+    projectionScale = mProjection[1][1];
+    bPerspectiveProjection = mProjection[2][3] != 0.0f;
+}
 
-        RenderElement *element = &renderElements[lastElement];
-        mainPhaseElements[lastElementMainPhase] = element;
+void RenderQueue::addMainPhase(Matrix4 &mModel, Shader *shader, Texture *texture, MeshStatic *mesh, ShaderParameter **parameters, int parametersAmount, int *lodState)
+{
+    RenderQueueSegment *segment = currentSegment;
+    if (!shader || !mesh || (!segment && (lastElementMainPhase >= MAX_RENDER_ELEMENTS || lastElement >= MAX_RENDER_ELEMENTS)))
+        return;
+
+    Matrix4 mv = mView * mModel;
+    if (!mesh->getBoundVolumeSphere()->isSphereInFrustum(&mv, getCullingPlanes()))
+        return;
+
+    RenderElement *element = segment ? segment->add(segment->mainPhase) : &renderElements[lastElement];
+
+    element->mModel = mModel;
+    element->mModelViewProjection = mViewProjection * mModel;
+    element->colorMode = ColorMode::Lit;
+    element->shader = shader;
+    element->texture = texture;
+    element->mesh = mesh;
+    element->lod = selectLod(mesh, mModel, element->mModelViewProjection, lodState);
+    element->opacity = 1.0f;
+    element->parameters = parameters;
+    element->parametersAmount = parametersAmount;
 
-        element->mModel = mModel;
-        element->mModelViewProjection = mViewProjection * mModel;
-        element->colorMode = ColorMode::Lit;
-        element->shader = shader;
-        element->texture = texture;
-        element->mesh = mesh;
-        element->opacity = 1.0f;
-        element->parameters = parameters;
-        element->parametersAmount = parametersAmount;
+    // Parameters are unique for component, so they stand for material if there is no texture
+    unsigned int material = texture ? texture->getSortId() : (unsigned int)(reinterpret_cast<uintptr_t>(parameters) >> 4);
+    element->sortKey = makeSortKey(layerIndex, RENDER_KEY_PASS_MAIN, shader->getSortId(), material, (mesh->getSortId() << 2) | element->lod, element->mModelViewProjection[3][3]);
 
+    // Amount is increased after element is ready, renderer may already draw it
+    if (!segment)
+    {
+        mainPhaseElements[lastElementMainPhase] = element;
         lastElementMainPhase++;
         lastElement++;
     }
 }
 
-void RenderQueue::addBlendingPhase(Matrix4 &mModel, ColorMode colorMode, Shader *shader, Texture *texture, MeshStatic *mesh, float opacity, ShaderParameter **parameters, int parametersAmount)
+void RenderQueue::addBlendingPhase(Matrix4 &mModel, ColorMode colorMode, Shader *shader, Texture *texture, MeshStatic *mesh, float opacity, ShaderParameter **parameters, int parametersAmount, int *lodState)
 {
-    if (lastElementMainPhase < MAX_RENDER_ELEMENTS && lastElement < MAX_RENDER_ELEMENTS && shader && mesh)
-    {
-        Matrix4 mv = mView * mModel;
-        if (!mesh->getBoundVolumeSphere()->isSphereInFrustum(&mv, getCullingPlanes()))
-            return;
+    RenderQueueSegment *segment = currentSegment;
+    if (!shader || !mesh || (!segment && (lastElementBlendPhase >= MAX_RENDER_ELEMENTS || lastElement >= MAX_RENDER_ELEMENTS)))
+        return;
 
-        RenderElement *element = &renderElements[lastElement];
-        blendPhaseElements[lastElementBlendPhase] = element;
+    Matrix4 mv = mView * mModel;
+    if (!mesh->getBoundVolumeSphere()->isSphereInFrustum(&mv, getCullingPlanes()))
+        return;
 
-        element->mModel = mModel;
-        element->mModelViewProjection = mViewProjection * mModel;
-        element->colorMode = colorMode;
-        element->shader = shader;
-        element->texture = texture;
-        element->mesh = mesh;
-        element->opacity = opacity;
-        element->parameters = parameters;
-        element->parametersAmount = parametersAmount;
+    RenderElement *element = segment ? segment->add(segment->blendPhase) : &renderElements[lastElement];
 
+    element->mModel = mModel;
+    element->mModelViewProjection = mViewProjection * mModel;
+    element->colorMode = colorMode;
+    element->shader = shader;
+    element->texture = texture;
+    element->mesh = mesh;
+    element->lod = selectLod(mesh, mModel, element->mModelViewProjection, lodState);
+    element->opacity = opacity;
+    element->parameters = parameters;
+    element->parametersAmount = parametersAmount;
+
+    if (!segment)
+    {
+        blendPhaseElements[lastElementBlendPhase] = element;
         lastElementBlendPhase++;
         lastElement++;
     }
@@ -79,68 +201,222 @@ void RenderQueue::addBlendingPhase(Matrix4 &mModel, ColorMode colorMode, Shader
 
 void RenderQueue::addShadowCaster(Matrix4 &mModel, MeshStatic *mesh, Texture *texture, Vector4 &uvShiftSize)
 {
-    if (lastShadowCasterElement < MAX_RENDER_ELEMENTS && lastElement < MAX_RENDER_ELEMENTS && mesh)
-    {
-        // Culling if too far
-        Vector4 position = mModel * Vector4(0.0f, 0.0f, 0.0f, 1.0f);
-        if (glm::length2(cameraPosition - Vector3(position)) < 1200.0f)
-        {
-            RenderElement *element = &renderElements[lastElement];
-            shadowCasterElements[lastShadowCasterElement] = element;
+    RenderQueueSegment *segment = currentSegment;
+    if (!mesh || (!segment && (lastShadowCasterElement >= MAX_RENDER_ELEMENTS || lastElement >= MAX_RENDER_ELEMENTS)))
+        return;
 
-            element->mModel = mModel;
-            element->mesh = mesh;
-            element->texture = texture;
-            element->uvShiftSize = uvShiftSize;
+    // Coarse culling by distance to bounds, renderer culls casters by every cascade of light
+    Sphere *volume = mesh->getBoundVolumeSphere();
+    Vector3 center = Vector3(mModel * Vector4(volume->center, 1.0f));
+    float radius = volume->recalcRadius(&mModel);
+    if (glm::length(cameraPosition - center) - radius >= shadowCastersDistance)
+        return;
 
-            lastShadowCasterElement++;
-            lastElement++;
-        }
+    RenderElement *element = segment ? segment->add(segment->shadowCasters) : &renderElements[lastElement];
+
+    // Level is seen from the camera, shadow of a far mesh is as small as the mesh
+    Matrix4 mModelViewProjection = mViewProjection * mModel;
+    element->mModel = mModel;
+    element->mesh = mesh;
+    element->lod = selectLod(mesh, mModel, mModelViewProjection, nullptr);
+    element->texture = texture;
+    element->uvShiftSize = uvShiftSize;
+    element->boundsCenter = center;
+    element->boundsRadius = radius;
+    element->sortKey = makeSortKey(layerIndex, RENDER_KEY_PASS_SHADOW, texture ? 1 : 0, texture ? texture->getSortId() : 0, (mesh->getSortId() << 2) | element->lod, 0.0f);
+
+    if (!segment)
+    {
+        shadowCasterElements[lastShadowCasterElement] = element;
+        lastShadowCasterElement++;
+        lastElement++;
     }
 }
 
 void RenderQueue::addLight(LightType type, Vector3 position, Vector3 color, float affectDistance, bool bCastShadows)
 {
-    if (lastElementLight < MAX_LIGHTS)
-    {
-        RenderElementLight *element = &lightElements[lastElementLight];
+    RenderElementLight light = {type, position, color, affectDistance, bCastShadows};
+    if (currentSegment)
+        currentSegment->lights.push_back(light);
+    else if (lastElementLight < MAX_LIGHTS)
+        lightElements[lastElementLight++] = light;
+}
+
+void RenderQueue::addDebugBody(PhysicsBody *body, float symScale, float lineThickness)
+{
+    if (!body)
+        return;
+
+    RenderElementDebug debug = {body, nullptr, symScale, lineThickness};
+    if (currentSegment)
+        currentSegment->debug.push_back(debug);
+    else if (lastDebugElement < MAX_DEBUG_ELEMENTS)
+        debugElements[lastDebugElement++] = debug;
+}
 
-        element->type = type;
-        element->position = position;
-        element->color = color;
-        element->affectDistance = affectDistance;
-        element->bCastShadows = bCastShadows;
+void RenderQueue::addDebugActor(Actor *actor, float lineThickness)
+{
+    if (!actor)
+        return;
 
-        lastElementLight++;
+    RenderElementDebug debug = {nullptr, actor, 1.0f, lineThickness};
+    if (currentSegment)
+        currentSegment->debug.push_back(debug);
+    else if (lastDebugElement < MAX_DEBUG_ELEMENTS)
+        debugElements[lastDebugElement++] = debug;
+}
+
+void RenderQueue::setupSegments(int amount)
+{
+    if ((int)segments.size() < amount)
+        segments.resize(amount);
+    segmentsAmount = amount;
+}
+
+void RenderQueue::fillSegment(int index, const std::function<void()> &fill)
+{
+    RenderQueueSegment *segment = &segments[index];
+    segment->elements.clear();
+    segment->mainPhase.clear();
+    segment->blendPhase.clear();
+    segment->shadowCasters.clear();
+    segment->lights.clear();
+    segment->debug.clear();
+
+    // Previous segment is restored in case fill is a job executed while other job waits
+    RenderQueueSegment *previousSegment = currentSegment;
+    currentSegment = segment;
+    fill();
+    currentSegment = previousSegment;
+
+    _setSegmentPointers(segment, segment->mainPhase, segment->mainPhaseElements);
+    _setSegmentPointers(segment, segment->blendPhase, segment->blendPhaseElements);
+    _setSegmentPointers(segment, segment->shadowCasters, segment->shadowCasterElements);
+
+    // Painter's order is the order of adding
+    if (!bUseSort)
+    {
+        _radixSort(segment->mainPhaseElements.data(), segment->mainPhaseElements.size(), segment->sortItems, segment->sortItemsTemp);
+        _radixSort(segment->shadowCasterElements.data(), segment->shadowCasterElements.size(), segment->sortItems, segment->sortItemsTemp);
     }
 }
 
-void RenderQueue::addDebugBody(PhysicsBody *body, float symScale, float lineThickness)
+void RenderQueue::mergeSegments()
 {
-    if (body && lastDebugElement < MAX_DEBUG_ELEMENTS)
+    for (int i = 0; i < segmentsAmount; i++)
     {
-        RenderElementDebug *element = &debugElements[lastDebugElement];
+        RenderQueueSegment *segment = &segments[i];
+        for (auto &light : segment->lights)
+        {
+            if (lastElementLight < MAX_LIGHTS)
+                lightElements[lastElementLight++] = light;
+        }
+        for (auto &debug : segment->debug)
+        {
+            if (lastDebugElement < MAX_DEBUG_ELEMENTS)
+                debugElements[lastDebugElement++] = debug;
+        }
+    }
+
+    // Sorted segments stay sorted after merge if nothing was added around them
+    bool bMergeSorted = !bUseSort;
+    lastElementBlendPhase = _mergeSegments(blendPhaseElements, lastElementBlendPhase, segments.data(), segmentsAmount, &RenderQueueSegment::blendPhaseElements, false);
 
-        element->body = body;
-        element->actor = nullptr;
-        element->symScale = symScale;
-        element->lineThickness = lineThickness;
+    bShadowCastersMerged = bMergeSorted && lastShadowCasterElement == 0;
+    lastShadowCasterElement = _mergeSegments(shadowCasterElements, lastShadowCasterElement, segments.data(), segmentsAmount, &RenderQueueSegment::shadowCasterElements, bShadowCastersMerged);
 
-        lastDebugElement++;
+    // Main phase is the last, renderer in painter's order starts drawing as soon as amount changes
+    bMainPhaseMerged = bMergeSorted && lastElementMainPhase == 0;
+    lastElementMainPhase = _mergeSegments(mainPhaseElements, lastElementMainPhase, segments.data(), segmentsAmount, &RenderQueueSegment::mainPhaseElements, bMainPhaseMerged);
+}
+
+void RenderQueue::sortMainPhase()
+{
+    if (bMainPhaseMerged)
+        return;
+    _radixSort(mainPhaseElements, lastElementMainPhase, sortItems, sortItemsTemp);
+}
+
+void RenderQueue::sortShadowCasters()
+{
+    if (bShadowCastersMerged)
+        return;
+    _radixSort(shadowCasterElements, lastShadowCasterElement, sortItems, sortItemsTemp);
+}
+
+// Same shader, texture and geometry, elements with own shader parameters are drawn one by one
+int RenderQueue::getMainPhaseRunLength(int start)
+{
+    RenderElement *first = mainPhaseElements[start];
+    if (!first->shader || !first->mesh || first->parametersAmount > 0)
+        return 1;
+
+    int end = start + 1;
+    while (end < lastElementMainPhase)
+    {
+        RenderElement *element = mainPhaseElements[end];
+        if (element->shader != first->shader || element->texture != first->texture || !element->mesh ||
+            element->mesh->getSortId() != first->mesh->getSortId() || element->lod != first->lod || element->parametersAmount > 0)
+            break;
+        end++;
     }
+    return end - start;
 }
 
-void RenderQueue::addDebugActor(Actor *actor, float lineThickness)
+int RenderQueue::getShadowCasterRunLength(int start)
+{
+    return getShadowCasterRunLength(shadowCasterElements, lastShadowCasterElement, start);
+}
+
+int RenderQueue::getShadowCasterRunLength(RenderElement **elements, int amount, int start)
 {
-    if (actor && lastDebugElement < MAX_DEBUG_ELEMENTS)
+    RenderElement *first = elements[start];
+    if (!first->mesh)
+        return 1;
+
+    int end = start + 1;
+    while (end < amount)
     {
-        RenderElementDebug *element = &debugElements[lastDebugElement];
+        RenderElement *element = elements[end];
+        if (element->texture != first->texture || !element->mesh || element->mesh->getSortId() != first->mesh->getSortId() || element->lod != first->lod)
+            break;
+        end++;
+    }
+    return end - start;
+}
 
-        element->body = nullptr;
-        element->actor = actor;
-        element->symScale = 1.0f;
-        element->lineThickness = lineThickness;
+// Error of level in space of the mesh is scaled by model and projection, perspective divides it by distance to the nearest point of bounds
+int RenderQueue::selectLod(MeshStatic *mesh, Matrix4 &mModel, Matrix4 &mModelViewProjection, int *lodState)
+{
+    if (mesh->getLodsAmount() < 2)
+        return 0;
 
-        lastDebugElement++;
+    float modelScale = glm::compMax(Vector3(glm::length(Vector3(mModel[0])), glm::length(Vector3(mModel[1])), glm::length(Vector3(mModel[2]))));
+    float errorScale = modelScale * projectionScale;
+    if (bPerspectiveProjection)
+    {
+        Sphere *bounds = mesh->getBoundVolumeSphere();
+        float distance = (mModelViewProjection * Vector4(bounds->center, 1.0f)).w - bounds->radius * modelScale;
+        errorScale /= fmaxf(distance, 0.0001f);
     }
-}
\ No newline at end of file
+
+    int lod = mesh->selectLod(errorScale, lodThreshold, lodState ? *lodState : -1);
+    if (lodState)
+        *lodState = lod;
+    return lod;
+}
+
+uint64_t RenderQueue::makeSortKey(int layer, int pass, unsigned int shader, unsigned int material, unsigned int mesh, float depth)
+{
+    // Bits of positive float grow together with its value, top 16 bits are enough to order by distance
+    uint32_t depthBits = 0;
+    if (depth > 0.0f)
+        memcpy(&depthBits, &depth, sizeof(float));
+
+    return ((uint64_t)(layer & 0xF) << 60) |
+           ((uint64_t)(pass & 0x3) << 58) |
+           ((uint64_t)(shader & 0xFFF) << 46) |
+           ((uint64_t)(material & 0x3FFF) << 32) |
+           ((uint64_t)(mesh & 0xFFFF) << 16) |
+           (uint64_t)(depthBits >> 16);
+}
@@ -9,6 +9,8 @@
 #include "mesh/meshStatic.h"
 #include "physics/physicsBody.h"
 #include <vector>
+#include <functional>
+#include <cstdint>
 
 class Actor;
 
@@ -16,6 +18,17 @@ class Actor;
 #define MAX_LIGHTS 16000
 #define MAX_DEBUG_ELEMENTS 1000
 
+// Distance from camera to bounds of shadow casters beyond which they are skipped before culling by cascades of light
+// Covers default shadow distance of sun and extension of cascades towards the light
+#define SHADOW_CASTERS_DISTANCE 72.0f
+
+// Size of simplification error on screen in normalized device units above which finer level of detail is taken
+#define RENDER_LOD_THRESHOLD 0.002f
+
+// Sort key layout from the highest bits: layer 4, pass 2, shader 12, material 14, mesh 14, level of detail 2, depth 16
+#define RENDER_KEY_PASS_MAIN 0
+#define RENDER_KEY_PASS_SHADOW 1
+
 struct RenderElement
 {
     Matrix4 mModelViewProjection;
@@ -24,10 +37,21 @@ struct RenderElement
     Shader *shader;
     Texture *texture;
     MeshStatic *mesh;
+    int lod;
     float opacity;
     ShaderParameter **parameters;
     int parametersAmount;
     Vector4 uvShiftSize;
+    // World space bounding sphere, set for shadow casters
+    Vector3 boundsCenter;
+    float boundsRadius;
+    uint64_t sortKey;
+};
+
+struct RenderSortItem
+{
+    uint64_t key;
+    RenderElement *element;
 };
 
 struct RenderElementLight
@@ -47,6 +71,33 @@ struct RenderElementDebug
     float lineThickness;
 };
 
+// Part of the queue filled by one worker, keeps indexes while elements can still move
+struct RenderQueueSegment
+{
+    inline RenderElement *add(std::vector<int> &phase)
+    {
+        phase.push_back(elements.size());
+        elements.emplace_back();
+        return &elements.back();
+    }
+
+    std::vector<RenderElement> elements;
+    std::vector<int> mainPhase;
+    std::vector<int> blendPhase;
+    std::vector<int> shadowCasters;
+
+    // Set when the worker is done
+    std::vector<RenderElement *> mainPhaseElements;
+    std::vector<RenderElement *> blendPhaseElements;
+    std::vector<RenderElement *> shadowCasterElements;
+
+    std::vector<RenderElementLight> lights;
+    std::vector<RenderElementDebug> debug;
+
+    std::vector<RenderSortItem> sortItems;
+    std::vector<RenderSortItem> sortItemsTemp;
+};
+
 class RenderQueue
 {
 public:
@@ -57,15 +108,41 @@ public:
     EXPORT inline Matrix4 *getViewProjectionMatrix() { return &mViewProjection; }
     EXPORT inline void setViewMatrix(Matrix4 &mView) { this->mView = mView; }
     EXPORT inline Matrix4 *getViewMatrix() { return &mView; }
-
-    EXPORT void addMainPhase(Matrix4 &mModel, Shader *shader, Texture *texture, MeshStatic *mesh, ShaderParameter **parameters, int parametersAmount);
-    EXPORT void addBlendingPhase(Matrix4 &mModel, ColorMode colorMode, Shader *shader, Texture *texture, MeshStatic *mesh, float opacity, ShaderParameter **parameters, int parametersAmount);
+    // Projection sets how big simplification error of level of detail is on screen
+    EXPORT void setProjectionMatrix(Matrix4 &mProjection);
+    EXPORT inline Matrix4 *getProjectionMatrix() { return &mProjection; }
+    EXPORT inline void setLodThreshold(float threshold) { this->lodThreshold = threshold; }
+    EXPORT inline float getLodThreshold() { return lodThreshold; }
+
+    // Level of detail keeps in lodState between frames to apply hysteresis, without it level is picked from scratch
+    EXPORT void addMainPhase(Matrix4 &mModel, Shader *shader, Texture *texture, MeshStatic *mesh, ShaderParameter **parameters, int parametersAmount, int *lodState = nullptr);
+    EXPORT void addBlendingPhase(Matrix4 &mModel, ColorMode colorMode, Shader *shader, Texture *texture, MeshStatic *mesh, float opacity, ShaderParameter **parameters, int parametersAmount, int *lodState = nullptr);
     EXPORT void addShadowCaster(Matrix4 &mModel, MeshStatic *mesh, Texture *texture, Vector4 &uvShiftSize);
     EXPORT void addLight(LightType type, Vector3 position, Vector3 color, float affectDistance, bool bCastShadows);
 
     EXPORT void addDebugBody(PhysicsBody *body, float symScale, float lineThickness);
     EXPORT void addDebugActor(Actor *actor, float lineThickness);
 
+    // Add calls made inside of fill go to the segment, so several workers can fill the queue at once
+    // Every segment is culled and sorted by its worker, merge keeps order of segment indexes
+    EXPORT void setupSegments(int amount);
+    EXPORT void fillSegment(int index, const std::function<void()> &fill);
+    EXPORT void mergeSegments();
+
+    // Orders elements by sort key so elements with the same state are next to each other
+    // Does nothing if merge of segments already did it
+    EXPORT void sortMainPhase();
+    EXPORT void sortShadowCasters();
+    // Amount of elements starting from start that can be drawn as instances of one draw call, call after sorting
+    EXPORT int getMainPhaseRunLength(int start);
+    EXPORT int getShadowCasterRunLength(int start);
+    EXPORT static int getShadowCasterRunLength(RenderElement **elements, int amount, int start);
+    EXPORT static uint64_t makeSortKey(int layer, int pass, unsigned int shader, unsigned int material, unsigned int mesh, float depth);
+    EXPORT int selectLod(MeshStatic *mesh, Matrix4 &mModel, Matrix4 &mModelViewProjection, int *lodState);
+
+    inline void setLayerIndex(int layerIndex) { this->layerIndex = layerIndex; }
+    inline int getLayerIndex() { return layerIndex; }
+
     inline void enableSorting() { bUseSort = true; };
     inline void disableSorting() { bUseSort = false; }
     inline bool isUsingSorting() { return bUseSort; };
@@ -109,9 +186,19 @@ public:
     inline void setEnvHDRRotation(float rotation) { this->envHDRRotation = rotation; }
     inline float getEnvHDRRotation() { return this->envHDRRotation; }
 
-    inline void setCullingPlanes(Vector4 *cullingPlanes) { this->cullingPlanes = cullingPlanes; }
+    // Planes are copied, so a queue rendered later keeps planes of its own frame
+    inline void setCullingPlanes(Vector4 *cullingPlanes)
+    {
+        this->cullingPlanes = cullingPlanes ? cullingPlanesData : nullptr;
+        if (cullingPlanes)
+            for (int i = 0; i < 6; i++)
+                cullingPlanesData[i] = cullingPlanes[i];
+    }
     inline Vector4 *getCullingPlanes() { return this->cullingPlanes; }
 
+    inline void setShadowCastersDistance(float distance) { this->shadowCastersDistance = distance; }
+    inline float getShadowCastersDistance() { return this->shadowCastersDistance; }
+
     inline void setUseCameraDirectionForLights(bool state) { this->bUseCameraDirectionForLights = state; }
     inline bool isUsingCameraDirectionForLights() { return this->bUseCameraDirectionForLights; }
 
@@ -120,6 +207,10 @@ public:
 protected:
     Matrix4 mViewProjection;
     Matrix4 mView;
+    Matrix4 mProjection;
+    float projectionScale = 1.0f;
+    bool bPerspectiveProjection = true;
+    float lodThreshold = RENDER_LOD_THRESHOLD;
 
     RenderElement renderElements[MAX_RENDER_ELEMENTS];
     std::atomic<int> lastElement = 0;
@@ -152,4 +243,15 @@ protected:
     float envHDRRotation = 0.0f;
 
     Vector4 *cullingPlanes = nullptr;
+    Vector4 cullingPlanesData[6];
+    float shadowCastersDistance = SHADOW_CASTERS_DISTANCE;
+
+    int layerIndex = 0;
+    std::vector<RenderSortItem> sortItems;
+
+    std::vector<RenderQueueSegment> segments;
+    int segmentsAmount = 0;
+    bool bMainPhaseMerged = false;
+    bool bShadowCastersMerged = false;
+    std::vector<RenderSortItem> sortItemsTemp;
 };
\ No newline at end of file
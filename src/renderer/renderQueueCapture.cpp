@@ -0,0 +1,509 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/renderQueueCapture.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static const char captureMagic[4] = {'R', 'T', 'R', 'Q'};
+// Stand-in meshes allocate every index their levels point to
+static const int maxCapturedIndexes = 64 * 1024 * 1024;
+
+// Structures go to the file as they are in memory, so a capture is read by the same build of the engine
+template <typename T>
+static void writeValue(FILE *file, const T &value)
+{
+    fwrite(&value, sizeof(T), 1, file);
+}
+
+template <typename T>
+static void writeVector(FILE *file, const std::vector<T> &values)
+{
+    writeValue(file, (int)values.size());
+    if (!values.empty())
+        fwrite(values.data(), sizeof(T), values.size(), file);
+}
+
+template <typename T>
+static bool readValue(FILE *file, T &value)
+{
+    return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+// Amount is limited, so broken file doesn't allocate everything
+template <typename T>
+static bool readVector(FILE *file, std::vector<T> &values, int limit)
+{
+    int amount = 0;
+    if (!readValue(file, amount) || amount < 0 || amount > limit)
+        return false;
+    values.resize(amount);
+    return amount == 0 || fread(values.data(), sizeof(T), amount, file) == (size_t)amount;
+}
+
+RenderQueueCapture::~RenderQueueCapture()
+{
+}
+
+void RenderQueueCapture::capture(RenderQueue *queue)
+{
+    clear();
+
+    mView = *queue->getViewMatrix();
+    mProjection = *queue->getProjectionMatrix();
+    mViewProjection = *queue->getViewProjectionMatrix();
+    ambientLight = queue->getAmbientLight();
+    cameraPosition = queue->getCameraPosition();
+    cameraDirection = queue->getCameraDirection();
+    gamma = queue->getGamma();
+    envHDRRotation = queue->getEnvHDRRotation();
+    lodThreshold = queue->getLodThreshold();
+    shadowCastersDistance = queue->getShadowCastersDistance();
+    layerIndex = queue->getLayerIndex();
+    bUseSort = queue->isUsingSorting();
+    bUseCameraDirectionForLights = queue->isUsingCameraDirectionForLights();
+    bShowEnvHDR = queue->isShowingEnvHDR();
+    HDRTexture = captureTexture(queue->getHDRTexture());
+    HDRRadianceTexture = captureTexture(queue->getHDRRadianceTexture());
+
+    // Plane of zero normal and positive distance keeps everything, queue without planes culls nothing
+    Vector4 *planes = queue->getCullingPlanes();
+    for (int i = 0; i < 6; i++)
+        cullingPlanes[i] = planes ? planes[i] : Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+
+    captureElements(queue->getMainPhaseElements(), queue->getMainPhaseElementsAmount(), mainPhase);
+    captureElements(queue->getBlendingPhaseElements(), queue->getBlendingPhaseElementsAmount(), blendPhase);
+    captureElements(queue->getShadowCasterElements(), queue->getShadowCasterElementsAmount(), shadowCasters, true);
+
+    RenderElementLight *lightElements = queue->getLightElements();
+    lights.assign(lightElements, lightElements + queue->getLightElementsAmount());
+
+    capturedIds.clear();
+}
+
+bool RenderQueueCapture::save(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        logger->logff("Can't write render queue capture %s\n", path.c_str());
+        return false;
+    }
+
+    fwrite(captureMagic, 1, sizeof(captureMagic), file);
+    writeValue(file, (int)RENDER_CAPTURE_VERSION);
+
+    writeValue(file, mView);
+    writeValue(file, mProjection);
+    writeValue(file, mViewProjection);
+    writeValue(file, ambientLight);
+    writeValue(file, cameraPosition);
+    writeValue(file, cameraDirection);
+    writeValue(file, cullingPlanes);
+    writeValue(file, gamma);
+    writeValue(file, envHDRRotation);
+    writeValue(file, lodThreshold);
+    writeValue(file, shadowCastersDistance);
+    writeValue(file, layerIndex);
+    writeValue(file, HDRTexture);
+    writeValue(file, HDRRadianceTexture);
+    writeValue(file, bUseSort);
+    writeValue(file, bUseCameraDirectionForLights);
+    writeValue(file, bShowEnvHDR);
+
+    writeValue(file, shadersAmount);
+    writeVector(file, textures);
+    writeValue(file, (int)meshes.size());
+    for (auto &mesh : meshes)
+    {
+        writeValue(file, mesh.sortId);
+        writeValue(file, mesh.vertexAmount);
+        writeValue(file, mesh.bounds);
+        writeVector(file, mesh.lods);
+    }
+    writeValue(file, (int)parameters.size());
+    for (auto &set : parameters)
+    {
+        writeValue(file, (int)set.size());
+        for (auto &parameter : set)
+        {
+            writeValue(file, parameter.type);
+            writeValue(file, parameter.amount);
+            writeVector(file, parameter.data);
+        }
+    }
+
+    writeVector(file, mainPhase);
+    writeVector(file, blendPhase);
+    writeVector(file, shadowCasters);
+    writeVector(file, lights);
+
+    bool bWritten = !ferror(file);
+    fclose(file);
+    if (bWritten)
+        logger->logff("Render queue captured to %s: %i main, %i blending, %i shadow casters, %i lights\n", path.c_str(),
+                      (int)mainPhase.size(), (int)blendPhase.size(), (int)shadowCasters.size(), (int)lights.size());
+    return bWritten;
+}
+
+bool RenderQueueCapture::load(const std::string &path)
+{
+    clear();
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        logger->logff("Can't open render queue capture %s\n", path.c_str());
+        return false;
+    }
+
+    char magic[4];
+    int version = 0;
+    bool bRead = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, captureMagic, sizeof(magic)) == 0;
+    bRead = bRead && readValue(file, version) && version == RENDER_CAPTURE_VERSION;
+
+    bRead = bRead && readValue(file, mView) && readValue(file, mProjection) && readValue(file, mViewProjection);
+    bRead = bRead && readValue(file, ambientLight) && readValue(file, cameraPosition) && readValue(file, cameraDirection);
+    bRead = bRead && readValue(file, cullingPlanes) && readValue(file, gamma) && readValue(file, envHDRRotation);
+    bRead = bRead && readValue(file, lodThreshold) && readValue(file, shadowCastersDistance) && readValue(file, layerIndex);
+    bRead = bRead && readValue(file, HDRTexture) && readValue(file, HDRRadianceTexture);
+    bRead = bRead && readValue(file, bUseSort) && readValue(file, bUseCameraDirectionForLights) && readValue(file, bShowEnvHDR);
+
+    int amount = 0;
+    bRead = bRead && readValue(file, shadersAmount) && shadersAmount >= 0 && shadersAmount <= MAX_RENDER_ELEMENTS;
+    bRead = bRead && readVector(file, textures, MAX_RENDER_ELEMENTS);
+    bRead = bRead && readValue(file, amount) && amount >= 0 && amount <= MAX_RENDER_ELEMENTS;
+    if (bRead)
+        meshes.resize(amount);
+    for (int i = 0; bRead && i < amount; i++)
+    {
+        CapturedMesh &mesh = meshes[i];
+        bRead = readValue(file, mesh.sortId) && readValue(file, mesh.vertexAmount) && readValue(file, mesh.bounds);
+        bRead = bRead && readVector(file, mesh.lods, MESH_MAX_LODS) && mesh.vertexAmount >= 0 && mesh.vertexAmount <= maxCapturedIndexes;
+        for (auto &lod : mesh.lods)
+            bRead = bRead && lod.indexOffset >= 0 && lod.indexAmount >= 0 && lod.indexAmount <= maxCapturedIndexes - lod.indexOffset;
+    }
+
+    bRead = bRead && readValue(file, amount) && amount >= 0 && amount <= MAX_RENDER_ELEMENTS;
+    if (bRead)
+        parameters.resize(amount);
+    for (int i = 0; bRead && i < amount; i++)
+    {
+        int setAmount = 0;
+        bRead = readValue(file, setAmount) && setAmount >= 0 && setAmount <= 256;
+        if (bRead)
+            parameters[i].resize(setAmount);
+        for (int j = 0; bRead && j < setAmount; j++)
+        {
+            CapturedParameter &parameter = parameters[i][j];
+            bRead = readValue(file, parameter.type) && readValue(file, parameter.amount);
+            bRead = bRead && (int)parameter.type >= (int)ShaderParameterType::Float && (int)parameter.type <= (int)ShaderParameterType::Int4;
+            bRead = bRead && parameter.amount >= 0 && parameter.amount <= 1024 * 1024;
+            bRead = bRead && readVector(file, parameter.data, 1024 * 1024);
+            // Parameter without data is captured empty, otherwise data covers every value
+            bRead = bRead && (parameter.data.empty() || (int)parameter.data.size() == getParameterSize(parameter.type) * parameter.amount);
+        }
+    }
+
+    bRead = bRead && readVector(file, mainPhase, MAX_RENDER_ELEMENTS);
+    bRead = bRead && readVector(file, blendPhase, MAX_RENDER_ELEMENTS);
+    bRead = bRead && readVector(file, shadowCasters, MAX_RENDER_ELEMENTS);
+    bRead = bRead && readVector(file, lights, MAX_LIGHTS);
+    fclose(file);
+
+    // Indexes are checked once here, so submit can trust them
+    auto isValid = [this](std::vector<CapturedElement> &elements)
+    {
+        for (auto &element : elements)
+        {
+            if (element.shader >= shadersAmount || element.texture >= (int)textures.size() ||
+                element.mesh < 0 || element.mesh >= (int)meshes.size() || element.parameters >= (int)parameters.size())
+                return false;
+        }
+        return true;
+    };
+    bRead = bRead && isValid(mainPhase) && isValid(blendPhase) && isValid(shadowCasters);
+    bRead = bRead && HDRTexture < (int)textures.size() && HDRRadianceTexture < (int)textures.size();
+
+    if (!bRead)
+    {
+        logger->logff("Render queue capture %s is broken or made by other version\n", path.c_str());
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void RenderQueueCapture::submit(Renderer *renderer)
+{
+    if (standInMeshes.empty() && !meshes.empty())
+        makeResources(renderer);
+
+    RenderQueue *queue = renderer->getRenderQueue();
+    queue->reset();
+    queue->setLayerIndex(layerIndex);
+    queue->setViewMatrix(mView);
+    queue->setViewProjectionMatrix(mViewProjection);
+    queue->setProjectionMatrix(mProjection);
+    queue->setLodThreshold(lodThreshold);
+    queue->setShadowCastersDistance(shadowCastersDistance);
+    queue->setAmbientLight(ambientLight);
+    queue->setCameraPosition(cameraPosition);
+    queue->setCameraDirection(cameraDirection);
+    queue->setHDRTexture(HDRTexture >= 0 ? standInTextures[HDRTexture] : nullptr);
+    queue->setHDRRadianceTexture(HDRRadianceTexture >= 0 ? standInTextures[HDRRadianceTexture] : nullptr);
+    queue->setGamma(gamma);
+    queue->setUseCameraDirectionForLights(bUseCameraDirectionForLights);
+    queue->setCullingPlanes(cullingPlanes);
+    queue->setShowEnvHDR(bShowEnvHDR && HDRTexture >= 0);
+    queue->setEnvHDRRotation(envHDRRotation);
+    if (bUseSort)
+        queue->enableSorting();
+    else
+        queue->disableSorting();
+
+    queue->bDone = false;
+    for (auto &element : mainPhase)
+    {
+        Shader *shader = element.shader >= 0 ? standInShaders[element.shader] : nullptr;
+        Texture *texture = element.texture >= 0 ? standInTextures[element.texture] : nullptr;
+        ShaderParameter **elementParameters = getParameters(element.parameters, shader);
+        int parametersAmount = elementParameters ? parameters[element.parameters].size() : 0;
+        queue->addMainPhase(element.mModel, shader, texture, standInMeshes[element.mesh], elementParameters, parametersAmount, &element.lod);
+    }
+    for (auto &element : blendPhase)
+    {
+        Shader *shader = element.shader >= 0 ? standInShaders[element.shader] : nullptr;
+        Texture *texture = element.texture >= 0 ? standInTextures[element.texture] : nullptr;
+        ShaderParameter **elementParameters = getParameters(element.parameters, shader);
+        int parametersAmount = elementParameters ? parameters[element.parameters].size() : 0;
+        queue->addBlendingPhase(element.mModel, element.colorMode, shader, texture, standInMeshes[element.mesh], element.opacity,
+                                elementParameters, parametersAmount, &element.lod);
+    }
+    for (auto &element : shadowCasters)
+    {
+        Texture *texture = element.texture >= 0 ? standInTextures[element.texture] : nullptr;
+        queue->addShadowCaster(element.mModel, standInMeshes[element.mesh], texture, element.uvShiftSize);
+    }
+    for (auto &light : lights)
+        queue->addLight(light.type, light.position, light.color, light.affectDistance, light.bCastShadows);
+    queue->bDone = true;
+}
+
+void RenderQueueCapture::releaseResources(Renderer *renderer)
+{
+    for (int i = 0; i < (int)standInParameters.size(); i++)
+    {
+        for (auto parameter : standInParameters[i])
+            delete parameter;
+    }
+    standInParameters.clear();
+
+    // Instances go first, main mesh of them is the first one with the same sort id
+    for (int i = standInMeshes.size() - 1; i >= 0; i--)
+        delete standInMeshes[i];
+    standInMeshes.clear();
+
+    for (auto texture : standInTextures)
+        renderer->destroyTexture(texture);
+    standInTextures.clear();
+
+    for (auto shader : standInShaders)
+        renderer->destroyShader(shader);
+    standInShaders.clear();
+}
+
+int RenderQueueCapture::getParameterSize(ShaderParameterType type)
+{
+    switch (type)
+    {
+    case ShaderParameterType::Float2:
+    case ShaderParameterType::Int2:
+        return 8;
+    case ShaderParameterType::Float3:
+    case ShaderParameterType::Int3:
+        return 12;
+    case ShaderParameterType::Float4:
+    case ShaderParameterType::Int4:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+void RenderQueueCapture::clear()
+{
+    mainPhase.clear();
+    blendPhase.clear();
+    shadowCasters.clear();
+    lights.clear();
+    shadersAmount = 0;
+    textures.clear();
+    meshes.clear();
+    parameters.clear();
+    capturedIds.clear();
+    HDRTexture = -1;
+    HDRRadianceTexture = -1;
+}
+
+// Shadow casters set only model, mesh, texture and uv, other fields are left from previous frames
+void RenderQueueCapture::captureElements(RenderElement **elements, int amount, std::vector<CapturedElement> &target, bool bShadowCasters)
+{
+    target.reserve(amount);
+    for (int i = 0; i < amount; i++)
+    {
+        RenderElement *element = elements[i];
+        if (!element->mesh)
+            continue;
+
+        CapturedElement captured;
+        captured.mModel = element->mModel;
+        captured.colorMode = bShadowCasters ? ColorMode::Lit : element->colorMode;
+        captured.shader = bShadowCasters ? -1 : captureShader(element->shader);
+        captured.texture = captureTexture(element->texture);
+        captured.mesh = captureMesh(element->mesh);
+        captured.parameters = bShadowCasters ? -1 : captureParameters(element->parameters, element->parametersAmount);
+        captured.lod = bShadowCasters ? -1 : element->lod;
+        captured.opacity = bShadowCasters ? 1.0f : element->opacity;
+        captured.uvShiftSize = bShadowCasters ? element->uvShiftSize : Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+        target.push_back(captured);
+    }
+}
+
+int RenderQueueCapture::captureShader(Shader *shader)
+{
+    if (!shader)
+        return -1;
+
+    auto it = capturedIds.find(shader);
+    if (it != capturedIds.end())
+        return it->second;
+    capturedIds[shader] = shadersAmount;
+    return shadersAmount++;
+}
+
+int RenderQueueCapture::captureTexture(Texture *texture)
+{
+    if (!texture)
+        return -1;
+
+    auto it = capturedIds.find(texture);
+    if (it != capturedIds.end())
+        return it->second;
+    capturedIds[texture] = textures.size();
+    textures.push_back({texture->getWidth(), texture->getHeight()});
+    return textures.size() - 1;
+}
+
+int RenderQueueCapture::captureMesh(MeshStatic *mesh)
+{
+    auto it = capturedIds.find(mesh);
+    if (it != capturedIds.end())
+        return it->second;
+    capturedIds[mesh] = meshes.size();
+
+    CapturedMesh captured;
+    captured.sortId = mesh->getSortId();
+    captured.vertexAmount = mesh->getVertexAmount();
+    captured.bounds = *mesh->getBoundVolumeSphere();
+    captured.lods.assign(mesh->getLods(), mesh->getLods() + mesh->getLodsAmount());
+    meshes.push_back(captured);
+    return meshes.size() - 1;
+}
+
+// Elements of one component share the array, so its pointer is the key
+int RenderQueueCapture::captureParameters(ShaderParameter **parameters, int amount)
+{
+    if (!parameters || amount <= 0)
+        return -1;
+
+    auto it = capturedIds.find(parameters);
+    if (it != capturedIds.end())
+        return it->second;
+    capturedIds[parameters] = this->parameters.size();
+
+    std::vector<CapturedParameter> set;
+    for (int i = 0; i < amount; i++)
+    {
+        ShaderParameter *parameter = parameters[i];
+        CapturedParameter captured = {parameter->getType(), parameter->getAmount()};
+        if (parameter->getData())
+        {
+            unsigned char *data = reinterpret_cast<unsigned char *>(parameter->getData());
+            captured.data.assign(data, data + getParameterSize(captured.type) * captured.amount);
+        }
+        set.push_back(captured);
+    }
+    this->parameters.push_back(set);
+    return this->parameters.size() - 1;
+}
+
+void RenderQueueCapture::makeResources(Renderer *renderer)
+{
+    for (int i = 0; i < shadersAmount; i++)
+        standInShaders.push_back(renderer->createPhongShader());
+
+    for (auto &texture : textures)
+        standInTextures.push_back(renderer->createTexture(std::max(texture.width, 1), std::max(texture.height, 1), 4, nullptr, false));
+
+    // Every index points to the only vertex, so triangles are degenerate and cost vertex work only
+    int attributeSizes[3] = {3, 3, 2};
+    std::map<unsigned int, MeshStatic *> mainMeshes;
+    for (auto &mesh : meshes)
+    {
+        auto main = mainMeshes.find(mesh.sortId);
+        if (main != mainMeshes.end())
+        {
+            standInMeshes.push_back(main->second->createInstance()->getAsStatic());
+            continue;
+        }
+
+        MeshStatic *standIn = renderer->createStaticMesh();
+        MeshLodChain chain;
+        chain.floatsPerVertex = 8;
+        chain.vertices.assign(8, 0.0f);
+        chain.lods = mesh.lods;
+        if (chain.lods.empty())
+            chain.lods.push_back({0, mesh.vertexAmount, 0.0f});
+
+        int indexAmount = 0;
+        for (auto &lod : chain.lods)
+            indexAmount = std::max(indexAmount, lod.indexOffset + lod.indexAmount);
+        chain.indexes.assign(indexAmount, 0);
+
+        if (indexAmount > 0)
+            standIn->setupLodChain(chain, 3, attributeSizes);
+        standIn->setBoundVolumeSphere(mesh.bounds.center, mesh.bounds.radius);
+        mainMeshes[mesh.sortId] = standIn;
+        standInMeshes.push_back(standIn);
+    }
+
+    // Uniform names are unknown, values are still set on every change of parameters
+    standInParameters.resize(parameters.size());
+}
+
+ShaderParameter **RenderQueueCapture::getParameters(int index, Shader *shader)
+{
+    if (index < 0 || !shader)
+        return nullptr;
+
+    std::vector<ShaderParameter *> &set = standInParameters[index];
+    if (set.empty())
+    {
+        for (auto &captured : parameters[index])
+        {
+            std::string name = "capturedParameter" + std::to_string(set.size());
+            ShaderParameter *parameter = shader->createShaderParameter(name.c_str(), captured.type);
+            if (!parameter)
+            {
+                for (auto made : set)
+                    delete made;
+                set.clear();
+                return nullptr;
+            }
+            parameter->set(captured.amount, captured.data.empty() ? nullptr : captured.data.data());
+            set.push_back(parameter);
+        }
+    }
+    return set.data();
+}
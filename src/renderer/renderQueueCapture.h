@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "connector/withLogger.h"
+#include "renderer/renderQueue.h"
+#include "renderer/renderer.h"
+#include <string>
+#include <vector>
+#include <map>
+
+#define RENDER_CAPTURE_VERSION 1
+
+// Elements point to tables of the capture, -1 means none
+// Level of detail is the state of hysteresis, replay starts from the captured level and keeps it between submits
+struct CapturedElement
+{
+    Matrix4 mModel;
+    ColorMode colorMode;
+    int shader;
+    int texture;
+    int mesh;
+    int parameters;
+    int lod;
+    float opacity;
+    Vector4 uvShiftSize;
+};
+
+// Instances of one mesh share sort id, so they are drawn as one
+struct CapturedMesh
+{
+    unsigned int sortId;
+    int vertexAmount;
+    Sphere bounds;
+    std::vector<MeshLod> lods;
+};
+
+struct CapturedTexture
+{
+    int width;
+    int height;
+};
+
+struct CapturedParameter
+{
+    ShaderParameterType type;
+    int amount;
+    std::vector<unsigned char> data;
+};
+
+// Frame of render queue kept in a file and put back into a queue to measure renderers on scenes of users
+// Resources are replaced with stand-ins made by the renderer of replay:
+// meshes keep bounds, vertex amount and levels of detail of degenerate triangles, shaders become phong shaders,
+// textures keep only size, parameters keep values but not uniform names
+// Debug elements point to bodies and actors and are not captured
+class RenderQueueCapture : public WithLogger
+{
+public:
+    EXPORT ~RenderQueueCapture();
+
+    // Takes elements, lights and camera of the queue, call when the queue is complete
+    EXPORT void capture(RenderQueue *queue);
+    EXPORT bool save(const std::string &path);
+    EXPORT bool load(const std::string &path);
+
+    // Fills queue of the renderer the way layer does, with culling, levels of detail and sort keys made again
+    // Stand-ins are made by the first call
+    EXPORT void submit(Renderer *renderer);
+    // Destroys stand-ins, call while the renderer is still alive
+    EXPORT void releaseResources(Renderer *renderer);
+
+    EXPORT inline int getMainPhaseAmount() { return mainPhase.size(); }
+    EXPORT inline int getBlendingPhaseAmount() { return blendPhase.size(); }
+    EXPORT inline int getShadowCastersAmount() { return shadowCasters.size(); }
+    EXPORT inline int getLightsAmount() { return lights.size(); }
+
+    EXPORT static int getParameterSize(ShaderParameterType type);
+
+protected:
+    void clear();
+    void captureElements(RenderElement **elements, int amount, std::vector<CapturedElement> &target, bool bShadowCasters = false);
+    int captureShader(Shader *shader);
+    int captureTexture(Texture *texture);
+    int captureMesh(MeshStatic *mesh);
+    int captureParameters(ShaderParameter **parameters, int amount);
+    void makeResources(Renderer *renderer);
+    ShaderParameter **getParameters(int index, Shader *shader);
+
+    // Camera and settings of the queue
+    Matrix4 mView, mProjection, mViewProjection;
+    Vector3 ambientLight, cameraPosition, cameraDirection;
+    Vector4 cullingPlanes[6];
+    float gamma = 1.0f;
+    float envHDRRotation = 0.0f;
+    float lodThreshold = RENDER_LOD_THRESHOLD;
+    float shadowCastersDistance = SHADOW_CASTERS_DISTANCE;
+    int layerIndex = 0;
+    int HDRTexture = -1;
+    int HDRRadianceTexture = -1;
+    bool bUseSort = false;
+    bool bUseCameraDirectionForLights = false;
+    bool bShowEnvHDR = false;
+
+    std::vector<CapturedElement> mainPhase;
+    std::vector<CapturedElement> blendPhase;
+    std::vector<CapturedElement> shadowCasters;
+    std::vector<RenderElementLight> lights;
+
+    int shadersAmount = 0;
+    std::vector<CapturedTexture> textures;
+    std::vector<CapturedMesh> meshes;
+    std::vector<std::vector<CapturedParameter>> parameters;
+
+    // Pointers of the captured frame, only used while capturing
+    std::map<void *, int> capturedIds;
+
+    // Stand-ins made for replay
+    std::vector<Shader *> standInShaders;
+    std::vector<Texture *> standInTextures;
+    std::vector<MeshStatic *> standInMeshes;
+    std::vector<std::vector<ShaderParameter *>> standInParameters;
+};
@@ -3,11 +3,14 @@
 
 #include "renderer/renderTarget.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "renderer/opengl/textureOpenGL.h"
+#include "renderer/null/textureNull.h"
 
-RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float multiSampling)
+RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float multiSampling, bool bHeadless)
 {
     this->multiSampling = multiSampling;
+    this->bHeadless = bHeadless;
     if (multiSampling == 1.0f)
     {
         this->width = width;
@@ -41,27 +44,33 @@ RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float m
         break;
     }
 
+    if (bHeadless)
+    {
+        resultTextureAsClass = new TextureNull(resultWidth, resultHeight);
+        return;
+    }
+
     // Rendering images
     glGenTextures(1, &gAlbedoSpec);
-    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, gAlbedoSpec);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->width, this->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, gNormal);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, this->width, this->height, 0, GL_RGBA, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, gPosition);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, this->width, this->height, 0, GL_RGBA, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     glGenTextures(1, &lightningTexture);
-    glBindTexture(GL_TEXTURE_2D, lightningTexture);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, lightningTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, this->width, this->height, 0, GL_RGBA, GL_FLOAT, NULL);
     if (multiSampling == 1.0f)
     {
@@ -75,13 +84,13 @@ RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float m
     }
 
     glGenTextures(1, &resultTexture);
-    glBindTexture(GL_TEXTURE_2D, resultTexture);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, resultTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, resultWidth, resultHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     glGenTextures(1, &shadowTexture);
-    glBindTexture(GL_TEXTURE_2D, shadowTexture);
+    StateOpenGL::bindTexture(GL_TEXTURE_2D, shadowTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, shadowMapSize, shadowMapSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -113,8 +122,8 @@ RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float m
     // Depth buffer
     glGenRenderbuffers(1, &depthbuffer);
     glBindRenderbuffer(GL_RENDERBUFFER, depthbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, this->width, this->height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, this->width, this->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthbuffer);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -129,10 +138,10 @@ RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float m
     unsigned int lightningAttachments[1] = {GL_COLOR_ATTACHMENT0};
     glDrawBuffers(1, lightningAttachments);
 
-    // Lightning is using same depth buffer
+    // Lightning is using same depth buffer, stencil marks pixels inside of light volumes
     glBindRenderbuffer(GL_RENDERBUFFER, depthbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, this->width, this->height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, this->width, this->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthbuffer);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -157,6 +166,9 @@ RenderTarget::RenderTarget(int width, int height, RenderQuality quality, float m
 
 RenderTarget::~RenderTarget()
 {
+    if (bHeadless)
+        return;
+
     // Deleting buffers
     glDeleteFramebuffers(1, &gBuffer);
     glDeleteFramebuffers(1, &lightningBuffer);
@@ -169,6 +181,13 @@ RenderTarget::~RenderTarget()
     glDeleteTextures(1, &lightningTexture);
     glDeleteTextures(1, &shadowTexture);
     glDeleteTextures(1, &resultTexture);
+
+    StateOpenGL::forgetTexture(gAlbedoSpec);
+    StateOpenGL::forgetTexture(gNormal);
+    StateOpenGL::forgetTexture(gPosition);
+    StateOpenGL::forgetTexture(lightningTexture);
+    StateOpenGL::forgetTexture(shadowTexture);
+    StateOpenGL::forgetTexture(resultTexture);
 }
 
 unsigned int RenderTarget::getPositionTexture()
@@ -203,12 +222,16 @@ unsigned int RenderTarget::getResultTexture()
 
 void RenderTarget::useResultBuffer()
 {
+    if (bHeadless)
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, resultBuffer);
     glViewport(0, 0, resultWidth, resultHeight);
 }
 
 void RenderTarget::setupResultBuffer(bool clear, Vector4 clearColor)
 {
+    if (bHeadless)
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, resultBuffer);
     glViewport(0, 0, resultWidth, resultHeight);
     if (clear)
@@ -220,17 +243,21 @@ void RenderTarget::setupResultBuffer(bool clear, Vector4 clearColor)
 
 void RenderTarget::setupNewFrame(bool clear)
 {
+    if (bHeadless)
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
     glViewport(0, 0, width, height);
     if (clear)
     {
         glClearColor(0.0, 0.0, 0.0, 0.0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     }
 }
 
 void RenderTarget::setupLightning(bool clear)
 {
+    if (bHeadless)
+        return;
     glBindFramebuffer(GL_FRAMEBUFFER, lightningBuffer);
     glViewport(0, 0, width, height);
     if (clear)
@@ -242,12 +269,21 @@ void RenderTarget::setupLightning(bool clear)
 
 void RenderTarget::setupShadowHQ(bool clear)
 {
+    if (bHeadless)
+        return;
     glViewport(0, 0, shadowMapSize, shadowMapSize);
     glBindFramebuffer(GL_FRAMEBUFFER, shadowBuffer);
     if (clear)
         glClear(GL_DEPTH_BUFFER_BIT);
 }
 
+void RenderTarget::setShadowViewport(int x, int y, int size)
+{
+    if (bHeadless)
+        return;
+    glViewport(x, y, size, size);
+}
+
 int RenderTarget::getShadowMapSize()
 {
     return shadowMapSize;
@@ -9,7 +9,8 @@
 class RenderTarget
 {
 public:
-    RenderTarget(int width, int height, RenderQuality quality, float multiSampling);
+    // Headless target keeps sizes only, for renderers without graphics context
+    RenderTarget(int width, int height, RenderQuality quality, float multiSampling, bool bHeadless = false);
     ~RenderTarget();
 
     inline int getWidth() { return resultWidth; }
@@ -29,20 +30,23 @@ public:
     void setupNewFrame(bool clear = true);
     void setupLightning(bool clear = true);
     void setupShadowHQ(bool clear = true);
+    // Part of shadow map to draw into, cascades are tiles of it
+    void setShadowViewport(int x, int y, int size);
     int getShadowMapSize();
+    inline bool isHeadless() { return bHeadless; }
 
 protected:
-    unsigned int gBuffer, depthbuffer;
-    unsigned int gPosition, gNormal, gAlbedoSpec;
+    unsigned int gBuffer = 0, depthbuffer = 0;
+    unsigned int gPosition = 0, gNormal = 0, gAlbedoSpec = 0;
 
-    unsigned int lightningBuffer;
-    unsigned int lightningTexture;
+    unsigned int lightningBuffer = 0;
+    unsigned int lightningTexture = 0;
 
-    unsigned int shadowBuffer;
-    unsigned int shadowTexture;
+    unsigned int shadowBuffer = 0;
+    unsigned int shadowTexture = 0;
 
-    unsigned int resultBuffer;
-    unsigned int resultTexture;
+    unsigned int resultBuffer = 0;
+    unsigned int resultTexture = 0;
 
     int width, height;
     int resultWidth, resultHeight;
@@ -50,4 +54,5 @@ protected:
 
     Texture *resultTextureAsClass = nullptr;
     float multiSampling = 1.0f;
+    bool bHeadless = false;
 };
\ No newline at end of file
@@ -32,25 +32,74 @@ MeshStatic *Renderer::createStaticMesh()
     return new MeshStaticOpenGL();
 }
 
+Texture *Renderer::createTextureCompressed(CompressedImage *image)
+{
+    return nullptr;
+}
+
+bool Renderer::isTextureFormatSupported(TextureFormat format)
+{
+    return false;
+}
+
+Texture *Renderer::createTextureRegion(Texture *page, int x, int y, int width, int height)
+{
+    return nullptr;
+}
+
+Texture *Renderer::createTextureStreamed(const std::string &path, int width, int height)
+{
+    return nullptr;
+}
+
+int Renderer::getStreamingPendingBytes()
+{
+    return 0;
+}
+
+float Renderer::getStreamingThroughput()
+{
+    return 0.0f;
+}
+
 unsigned int Renderer::getWindowFlags()
 {
     return 0;
 }
 
+bool Renderer::isHeadless()
+{
+    return false;
+}
+
 void Renderer::renderDebugLine(Vector3 a, Vector3 b, Matrix4 *mProjectionView, float thickness, Vector3 color)
 {
-    printf("Warning: wrong\n");
+    debugLines.addLine(a, b, color);
 }
 
 void Renderer::renderDebugLine(Matrix4 *model, Matrix4 *mProjectionView, Vector3 color)
 {
-    printf("Warning: wrong\n");
+    debugLines.addBox(*model, color);
 }
 
 void Renderer::render(RenderTarget *renderTarget)
 {
 }
 
+void Renderer::startPhases()
+{
+    for (int i = 0; i < RENDER_PHASES; i++)
+        phaseTimes[i] = 0.0f;
+    phaseMark = std::chrono::steady_clock::now();
+}
+
+void Renderer::finishPhase(RenderPhase phase)
+{
+    auto now = std::chrono::steady_clock::now();
+    phaseTimes[(int)phase] += std::chrono::duration<float, std::milli>(now - phaseMark).count();
+    phaseMark = now;
+}
+
 Shader *Renderer::getDefaultSpriteShader()
 {
     return nullptr;
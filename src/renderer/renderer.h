@@ -4,15 +4,40 @@
 #pragma once
 #include "math/math.h"
 #include "renderer/texture.h"
+#include "renderer/compressedImage.h"
 #include "renderer/renderQueue.h"
 #include "renderer/phongShader.h"
 #include "renderer/shader.h"
+#include "renderer/shadowCascades.h"
+#include "renderer/debugLines.h"
 #include "common/config.h"
 #include <vector>
+#include <chrono>
 
 class EffectBuffer;
 class RenderTarget;
 
+// Clustered shades all omni lights in one pass, volumes draw every light as a box around its affect distance
+enum class OmniLightMode
+{
+    Clustered = 0,
+    Volumes = 1
+};
+
+// Parts of a render call timed on CPU, GPU may still work on them after the call
+enum class RenderPhase
+{
+    Main = 0,
+    Lightning,
+    Blending,
+    Debug,
+    Final
+};
+
+#define RENDER_PHASES 5
+// Bytes of streamed textures uploaded per frame
+#define TEXTURE_STREAM_DEFAULT_BUDGET (4 * 1024 * 1024)
+
 class Renderer
 {
 public:
@@ -30,15 +55,58 @@ public:
     EXPORT virtual Texture *createTexture(int width, int height, int bytesPerPixel, const void *data, bool bCreateMipmaps) = 0;
     EXPORT virtual Texture *createTextureEditable(int width, int height) = 0;
     EXPORT virtual void destroyTexture(Texture *texture) = 0;
+    // Levels of the image are uploaded as they are, returns nullptr if the format can't be sampled
+    EXPORT virtual Texture *createTextureCompressed(CompressedImage *image);
+    EXPORT virtual bool isTextureFormatSupported(TextureFormat format);
+    // Texture sampling the rectangle of the page in pixels, page stays owned by the caller and outlives the region
+    EXPORT virtual Texture *createTextureRegion(Texture *page, int x, int y, int width, int height);
+
+    // Image file is decoded by workers and uploaded during the next frames, placeholder is drawn until then
+    // Returns nullptr if the renderer can't stream, width and height are known from the header of the file
+    EXPORT virtual Texture *createTextureStreamed(const std::string &path, int width, int height);
+    // Bytes of streamed textures not uploaded yet and bytes per second uploaded during the last second
+    EXPORT virtual int getStreamingPendingBytes();
+    EXPORT virtual float getStreamingThroughput();
+    // Bytes of streamed textures uploaded per frame, a row wider than the budget still goes as a whole
+    EXPORT inline void setStreamingBudget(int bytesPerFrame) { streamingBudget = bytesPerFrame; }
+    EXPORT inline int getStreamingBudget() { return streamingBudget; }
 
     EXPORT virtual MeshStatic *createStaticMesh();
 
+    // Lines go to debug lines of the frame and are drawn one pixel wide, thickness is kept for compatibility
     EXPORT virtual void renderDebugLine(Vector3 a, Vector3 b, Matrix4 *mProjectionView, float thickness, Vector3 color);
     EXPORT virtual void renderDebugLine(Matrix4 *mModel, Matrix4 *mProjectionView, Vector3 color);
+    EXPORT inline DebugLines *getDebugLines() { return &debugLines; }
 
     EXPORT virtual unsigned int getWindowFlags();
+    // Headless renderer has no graphics context, render targets and UI drawing skip GL with it
+    EXPORT virtual bool isHeadless();
 
     EXPORT inline RenderQueue *getRenderQueue() { return renderQueue; }
+    // Queue drawn by render calls, layers with queues of their own put them in and back around the call
+    EXPORT inline void setRenderQueue(RenderQueue *renderQueue) { this->renderQueue = renderQueue; }
+
+    // Binds of shaders, textures and parameters made and skipped during the last render call
+    EXPORT inline int getStateChanges() { return stateChanges; }
+    EXPORT inline int getStateChangesAvoided() { return stateChangesAvoided; }
+    EXPORT inline int getDrawCalls() { return drawCalls; }
+    // GL state calls sent to driver and dropped as redundant during the last render call
+    EXPORT inline int getStateCallsIssued() { return stateCallsIssued; }
+    EXPORT inline int getStateCallsSkipped() { return stateCallsSkipped; }
+    // Milliseconds spent in the phase during the last render call
+    EXPORT inline float getPhaseTime(RenderPhase phase) { return phaseTimes[(int)phase]; }
+
+    EXPORT inline void setOmniLightMode(OmniLightMode mode) { omniLightMode = mode; }
+    EXPORT inline OmniLightMode getOmniLightMode() { return omniLightMode; }
+
+    // Sun shadows are split into cascades by depth, split lambda blends logarithmic (1) and even (0) splits
+    EXPORT inline void setShadowCascades(int amount, float splitLambda = SHADOW_CASCADES_SPLIT_LAMBDA)
+    {
+        shadowCascadesAmount = amount;
+        shadowSplitLambda = splitLambda;
+    }
+    EXPORT inline int getShadowCascadesAmount() { return shadowCascadesAmount; }
+    EXPORT inline float getShadowSplitLambda() { return shadowSplitLambda; }
 
     EXPORT virtual void render(RenderTarget *renderTarget);
 
@@ -60,6 +128,33 @@ public:
     EXPORT virtual void destroyEffectBuffer(EffectBuffer *effectBuffer);
 
 protected:
+    inline void countStateChange(bool bChanged)
+    {
+        if (bChanged)
+            stateChanges++;
+        else
+            stateChangesAvoided++;
+    }
+    // Phase lasts from the previous mark to this one
+    void startPhases();
+    void finishPhase(RenderPhase phase);
+
     RenderQueue *renderQueue;
     Config *config;
+
+    int stateChanges = 0;
+    int stateChangesAvoided = 0;
+    int drawCalls = 0;
+    int stateCallsIssued = 0;
+    int stateCallsSkipped = 0;
+    float phaseTimes[RENDER_PHASES] = {};
+    std::chrono::steady_clock::time_point phaseMark;
+
+    DebugLines debugLines;
+
+    OmniLightMode omniLightMode = OmniLightMode::Clustered;
+    int shadowCascadesAmount = SHADOW_CASCADES_DEFAULT;
+    float shadowSplitLambda = SHADOW_CASCADES_SPLIT_LAMBDA;
+
+    int streamingBudget = TEXTURE_STREAM_DEFAULT_BUDGET;
 };
\ No newline at end of file
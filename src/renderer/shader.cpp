@@ -4,6 +4,7 @@
 #include "shader.h"
 
 Shader *Shader::currentShader = nullptr;
+std::atomic<unsigned int> Shader::nextSortId = 1;
 
 Shader::~Shader()
 {
@@ -49,4 +50,29 @@ void Shader::setUVShiftSize(Vector4 &v)
 TextureBinding *Shader::addTextureBinding(const std::string parameterName)
 {
     return nullptr;
-}
\ No newline at end of file
+}
+
+bool Shader::hasTextureBindings()
+{
+    return false;
+}
+
+bool Shader::isInstancingSupported()
+{
+    return false;
+}
+
+bool Shader::useInstanced(Matrix4 &mViewProjection)
+{
+    return false;
+}
+
+bool Shader::isDrawBlockSupported()
+{
+    return false;
+}
+
+bool Shader::useDrawBlock()
+{
+    return false;
+}
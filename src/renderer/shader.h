@@ -8,6 +8,7 @@
 #include "renderer/shaderParameter.h"
 #include "renderer/texture.h"
 #include "renderer/textureBinding.h"
+#include <atomic>
 
 class Shader : public WithLogger
 {
@@ -32,15 +33,30 @@ public:
     EXPORT virtual void setUVShiftSize(Vector4 &v);
 
     EXPORT virtual TextureBinding *addTextureBinding(const std::string parameterName);
+    // Shader with bindings rebinds own textures on every use
+    EXPORT virtual bool hasTextureBindings();
+
+    // Instanced variant takes model matrix and per instance vector from vertex attributes
+    EXPORT virtual bool isInstancingSupported();
+    EXPORT virtual bool useInstanced(Matrix4 &mViewProjection);
+
+    // Draw block variant takes matrices from uniform block range bound by renderer, so a draw sets no matrix uniforms
+    EXPORT virtual bool isDrawBlockSupported();
+    EXPORT virtual bool useDrawBlock();
+
+    // Small sequential number used in sort keys of render queue
+    EXPORT inline unsigned int getSortId() { return sortId; }
 
 protected:
     EXPORT virtual void showCompilationError(unsigned int shader);
 
     static Shader *currentShader;
+    static std::atomic<unsigned int> nextSortId;
 
     bool bIsReady = false;
     bool bUseOwnShadowShader = false;
     unsigned int programm = -1;
     unsigned int shadowProgramm = -1;
     float opacity = 1.0f;
+    unsigned int sortId = nextSortId++;
 };
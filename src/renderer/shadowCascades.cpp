@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/shadowCascades.h"
+#include <algorithm>
+
+void ShadowCascades::setup(int cascadesAmount, float splitLambda)
+{
+    this->cascadesAmount = std::max(1, std::min(cascadesAmount, MAX_SHADOW_CASCADES));
+    this->splitLambda = glm::clamp(splitLambda, 0.0f, 1.0f);
+}
+
+void ShadowCascades::update(const Vector3 &lightDirection, const Matrix4 &mView, const Matrix4 &mProjection, float shadowDistance, int mapSize)
+{
+    // Edges of camera frustum in view space, depth changes linearly along them for both kinds of projection
+    Matrix4 mInverseProjection = glm::inverse(mProjection);
+    Matrix4 mInverseView = glm::inverse(mView);
+    Vector3 nearCorners[4];
+    Vector3 farCorners[4];
+    for (int i = 0; i < 4; i++)
+    {
+        float x = (i & 1) ? 1.0f : -1.0f;
+        float y = (i & 2) ? 1.0f : -1.0f;
+        Vector4 nearCorner = mInverseProjection * Vector4(x, y, -1.0f, 1.0f);
+        Vector4 farCorner = mInverseProjection * Vector4(x, y, 1.0f, 1.0f);
+        nearCorners[i] = Vector3(nearCorner) / nearCorner.w;
+        farCorners[i] = Vector3(farCorner) / farCorner.w;
+    }
+    float nearDepth = -nearCorners[0].z;
+    float farDepth = -farCorners[0].z;
+    float distance = fminf(shadowDistance, farDepth);
+
+    Vector3 up = fabsf(lightDirection.y) > 0.99f ? Vector3(0.0f, 0.0f, 1.0f) : Vector3(0.0f, 1.0f, 0.0f);
+    for (int c = 0; c < cascadesAmount; c++)
+    {
+        ShadowCascade &cascade = cascades[c];
+        cascade.splitNear = getSplitDistance(c, cascadesAmount, nearDepth, distance, splitLambda);
+        cascade.splitFar = getSplitDistance(c + 1, cascadesAmount, nearDepth, distance, splitLambda);
+
+        Vector3 corners[8];
+        Vector3 center = Vector3(0.0f);
+        for (int i = 0; i < 8; i++)
+        {
+            float depth = (i < 4) ? cascade.splitNear : cascade.splitFar;
+            float t = (depth - nearDepth) / (farDepth - nearDepth);
+            Vector3 corner = glm::mix(nearCorners[i % 4], farCorners[i % 4], t);
+            corners[i] = Vector3(mInverseView * Vector4(corner, 1.0f));
+            center += corners[i] / 8.0f;
+        }
+
+        // Radius is rounded so small float errors don't change size of texels
+        float radius = 0.0f;
+        for (int i = 0; i < 8; i++)
+            radius = fmaxf(radius, glm::length(corners[i] - center));
+        radius = ceilf(radius * 16.0f) / 16.0f;
+        cascade.center = center;
+        cascade.radius = radius;
+
+        Matrix4 mLightView = glm::lookAt(center + lightDirection * (radius + casterExtension), center, up);
+        Matrix4 mLightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, radius * 2.0f + casterExtension);
+
+        // World origin is put on a texel corner, so is every other texel
+        Vector4 origin = mLightProjection * mLightView * Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+        Vector2 texels = Vector2(origin) * (mapSize * 0.5f);
+        Vector2 offset = (glm::round(texels) - texels) * (2.0f / mapSize);
+        mLightProjection[3][0] += offset.x;
+        mLightProjection[3][1] += offset.y;
+
+        cascade.mLightViewProjection = mLightProjection * mLightView;
+        getPlanes(cascade.mLightViewProjection, cascade.planes);
+    }
+}
+
+bool ShadowCascades::isSphereInCascade(int cascade, const Vector3 &center, float radius)
+{
+    const Vector4 *planes = cascades[cascade].planes;
+    for (int i = 0; i < 6; i++)
+    {
+        if (glm::dot(Vector3(planes[i]), center) + planes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// Practical split scheme, logarithmic splits keep texel size on screen even, linear ones don't make near cascades too small
+float ShadowCascades::getSplitDistance(int split, int cascadesAmount, float near, float far, float splitLambda)
+{
+    if (split <= 0)
+        return near;
+    if (split >= cascadesAmount)
+        return far;
+
+    float part = (float)split / (float)cascadesAmount;
+    float logNear = fmaxf(near, 0.01f);
+    float logarithmic = logNear * powf(far / logNear, part);
+    float linear = near + (far - near) * part;
+    return splitLambda * logarithmic + (1.0f - splitLambda) * linear;
+}
+
+// Planes of clip space box are sums and differences of rows of the matrix
+void ShadowCascades::getPlanes(const Matrix4 &mViewProjection, Vector4 *planes)
+{
+    Vector4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = Vector4(mViewProjection[0][i], mViewProjection[1][i], mViewProjection[2][i], mViewProjection[3][i]);
+
+    for (int i = 0; i < 3; i++)
+    {
+        planes[i * 2] = rows[3] + rows[i];
+        planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(Vector3(planes[i]));
+}
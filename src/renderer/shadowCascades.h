@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "math/math.h"
+
+#define MAX_SHADOW_CASCADES 4
+#define SHADOW_CASCADES_DEFAULT 3
+// Blend of logarithmic and even splits, 1 is fully logarithmic
+#define SHADOW_CASCADES_SPLIT_LAMBDA 0.75f
+// How far towards the light casters of a cascade are kept, they are out of view but their shadows aren't
+#define SHADOW_CASCADES_CASTER_EXTENSION 36.0f
+
+struct ShadowCascade
+{
+    Matrix4 mLightViewProjection;
+    // World space, normalized, positive inside, near plane is moved towards the light by caster extension
+    Vector4 planes[6];
+    // Depth range of the camera covered by the cascade
+    float splitNear;
+    float splitFar;
+    // World space sphere around the part of camera frustum
+    Vector3 center;
+    float radius;
+};
+
+// Splits camera frustum by depth and covers every part with an orthogonal light projection
+// Size of a cascade is the bounding sphere of its part of frustum, it doesn't change while camera rotates
+// Projection is moved by less than a texel so texels stay on the same places in the world, edges of shadows don't crawl
+class ShadowCascades
+{
+public:
+    EXPORT void setup(int cascadesAmount, float splitLambda);
+    EXPORT inline void setCasterExtension(float extension) { this->casterExtension = extension; }
+
+    // Light direction points towards the light, shadow distance limits depth covered by cascades
+    EXPORT void update(const Vector3 &lightDirection, const Matrix4 &mView, const Matrix4 &mProjection, float shadowDistance, int mapSize);
+
+    EXPORT bool isSphereInCascade(int cascade, const Vector3 &center, float radius);
+
+    EXPORT static float getSplitDistance(int split, int cascadesAmount, float near, float far, float splitLambda);
+    EXPORT static void getPlanes(const Matrix4 &mViewProjection, Vector4 *planes);
+
+    inline int getCascadesAmount() { return cascadesAmount; }
+    inline float getSplitLambda() { return splitLambda; }
+    inline float getCasterExtension() { return casterExtension; }
+    inline ShadowCascade *getCascade(int cascade) { return &cascades[cascade]; }
+
+protected:
+    ShadowCascade cascades[MAX_SHADOW_CASCADES];
+    int cascadesAmount = SHADOW_CASCADES_DEFAULT;
+    float splitLambda = SHADOW_CASCADES_SPLIT_LAMBDA;
+    float casterExtension = SHADOW_CASCADES_CASTER_EXTENSION;
+};
@@ -4,6 +4,8 @@
 #include "renderer/texture.h"
 #include <algorithm>
 
+std::atomic<unsigned int> Texture::nextSortId = 1;
+
 Texture::Texture()
 {
 }
@@ -27,6 +29,28 @@ bool Texture::isEditable()
     return false;
 }
 
+void Texture::toPageCoords(const float *shift, const float *size, float *pageShift, float *pageSize)
+{
+    pageShift[0] = regionShift[0] + shift[0] * regionSize[0];
+    pageShift[1] = regionShift[1] + shift[1] * regionSize[1];
+    pageSize[0] = size[0] * regionSize[0];
+    pageSize[1] = size[1] * regionSize[1];
+}
+
+void Texture::setRegion(Texture *page, int x, int y, int width, int height)
+{
+    atlasPage = page;
+    sortId = page->getSortId();
+    regionX = x;
+    regionY = y;
+    this->width = width;
+    this->height = height;
+    regionShift[0] = (float)x / (float)page->getWidth();
+    regionShift[1] = (float)y / (float)page->getHeight();
+    regionSize[0] = (float)width / (float)page->getWidth();
+    regionSize[1] = (float)height / (float)page->getHeight();
+}
+
 void Texture::drawImage(Texture *texture, Vector2 position, ColorMode colorMode)
 {
 }
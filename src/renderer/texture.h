@@ -7,6 +7,7 @@
 #include "common/utils.h"
 #include "connector/withLogger.h"
 #include "math/math.h"
+#include <atomic>
 
 class Shader;
 
@@ -34,6 +35,17 @@ public:
     inline int getWidth() { return width; }
     inline int getHeight() { return height; }
 
+    // Small sequential number used in sort keys of render queue, regions of one atlas page share it
+    inline unsigned int getSortId() { return sortId; }
+
+    // Part of atlas page, texture coordinates of the region go to the page as shift + coordinates * size
+    inline bool isAtlasRegion() { return atlasPage != nullptr; }
+    inline Texture *getAtlasPage() { return atlasPage; }
+    inline const float *getRegionShift() { return regionShift; }
+    inline const float *getRegionSize() { return regionSize; }
+    // Moves shift and size given in coordinates of the texture to coordinates of what is bound, unchanged for plain texture
+    EXPORT void toPageCoords(const float *shift, const float *size, float *pageShift, float *pageSize);
+
     EXPORT virtual void drawImage(Texture *texture, Vector2 position, ColorMode colorMode = ColorMode::Alpha);
     EXPORT virtual void drawImage(Texture *texture, Vector2 position, Vector2 Scale, ColorMode colorMode = ColorMode::Alpha);
     EXPORT virtual void drawImage(Texture *texture, Vector2 position, Vector2 Scale, Vector2 alignPoint, float rotation, ColorMode colorMode = ColorMode::Alpha);
@@ -42,7 +54,17 @@ public:
     EXPORT virtual void recreateMipMaps();
 
 protected:
+    void setRegion(Texture *page, int x, int y, int width, int height);
+
     TextureFilter filter = TextureFilter::Linear;
 
     int width = 0, height = 0, nrChannels = 0;
+
+    static std::atomic<unsigned int> nextSortId;
+    unsigned int sortId = nextSortId++;
+
+    Texture *atlasPage = nullptr;
+    int regionX = 0, regionY = 0;
+    float regionShift[2] = {0.0f, 0.0f};
+    float regionSize[2] = {1.0f, 1.0f};
 };
\ No newline at end of file
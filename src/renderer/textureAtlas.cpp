@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "renderer/textureAtlas.h"
+#include "renderer/renderer.h"
+#include <string.h>
+#include <algorithm>
+
+TextureAtlas::TextureAtlas(int pageSize, int padding)
+{
+    this->pageSize = pageSize;
+    this->padding = std::max(padding, 0);
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+        if (it->region)
+            getRenderer()->destroyTexture(it->region);
+    for (auto it = pages.begin(); it != pages.end(); ++it)
+    {
+        if ((*it)->texture)
+            getRenderer()->destroyTexture((*it)->texture);
+        delete *it;
+    }
+}
+
+int TextureAtlas::add(const unsigned char *rgba, int width, int height)
+{
+    if (!rgba || width <= 0 || height <= 0)
+        return -1;
+
+    // Rectangle sizes are multiples of padding, so every rectangle starts on the grid
+    int grid = std::max(padding, 1);
+    int rectWidth = (width + padding * 2 + grid - 1) / grid * grid;
+    int rectHeight = (height + padding * 2 + grid - 1) / grid * grid;
+    if (rectWidth > pageSize || rectHeight > pageSize)
+        return -1;
+
+    int x = 0, y = 0, pageIndex = -1;
+    for (int i = 0; i < (int)pages.size(); i++)
+    {
+        if (!pages[i]->texture && pages[i]->packer.insert(rectWidth, rectHeight, &x, &y))
+        {
+            pageIndex = i;
+            break;
+        }
+    }
+    if (pageIndex < 0)
+    {
+        pages.push_back(new TextureAtlasPage(pageSize));
+        pageIndex = pages.size() - 1;
+        pages[pageIndex]->packer.insert(rectWidth, rectHeight, &x, &y);
+    }
+
+    copyWithGutter(pages[pageIndex], rgba, width, height, x, y, rectWidth, rectHeight);
+    entries.push_back({pageIndex, x + padding, y + padding, width, height, nullptr});
+    return entries.size() - 1;
+}
+
+void TextureAtlas::build()
+{
+    for (int i = 0; i < (int)pages.size(); i++)
+    {
+        TextureAtlasPage *page = pages[i];
+        if (page->texture)
+            continue;
+        page->texture = getRenderer()->createTexture(pageSize, pageSize, 4, page->pixels.data(), true);
+        std::vector<unsigned char>().swap(page->pixels);
+        logger->logf("Atlas page %i built, %i%% occupied", i, (int)(page->packer.getOccupancy() * 100.0f));
+    }
+
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+        if (!it->region)
+            it->region = getRenderer()->createTextureRegion(pages[it->page]->texture, it->x, it->y, it->width, it->height);
+}
+
+Texture *TextureAtlas::getRegion(int index)
+{
+    if (index < 0 || index >= (int)entries.size())
+        return nullptr;
+    if (!entries[index].region)
+        build();
+    return entries[index].region;
+}
+
+int TextureAtlas::getPagesAmount()
+{
+    return pages.size();
+}
+
+Texture *TextureAtlas::getPage(int index)
+{
+    return index >= 0 && index < (int)pages.size() ? pages[index]->texture : nullptr;
+}
+
+// Pixels outside of the image repeat its nearest edge pixel up to the rectangle bounds
+void TextureAtlas::copyWithGutter(TextureAtlasPage *page, const unsigned char *rgba, int width, int height, int x, int y, int rectWidth, int rectHeight)
+{
+    size_t pageRow = (size_t)pageSize * 4;
+    for (int row = 0; row < rectHeight; row++)
+    {
+        int sourceY = std::min(std::max(row - padding, 0), height - 1);
+        const unsigned char *source = rgba + (size_t)sourceY * width * 4;
+        unsigned char *target = page->pixels.data() + (size_t)(y + row) * pageRow + (size_t)x * 4;
+
+        for (int column = 0; column < padding; column++)
+            memcpy(target + column * 4, source, 4);
+        memcpy(target + padding * 4, source, (size_t)width * 4);
+        for (int column = padding + width; column < rectWidth; column++)
+            memcpy(target + column * 4, source + (width - 1) * 4, 4);
+    }
+}
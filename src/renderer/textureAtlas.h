@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include "common/utils.h"
+#include "renderer/texture.h"
+#include "renderer/atlasPacker.h"
+#include "connector/withLogger.h"
+#include "connector/withRenderer.h"
+#include <vector>
+
+#define TEXTURE_ATLAS_PAGE_SIZE 2048
+#define TEXTURE_ATLAS_PADDING 4
+
+struct TextureAtlasPage
+{
+    TextureAtlasPage(int size) : packer(size, size), pixels((size_t)size * size * 4, 0) {}
+
+    AtlasPacker packer;
+    // Dropped once the page is uploaded
+    std::vector<unsigned char> pixels;
+    Texture *texture = nullptr;
+};
+
+struct TextureAtlasEntry
+{
+    int page;
+    int x;
+    int y;
+    int width;
+    int height;
+    Texture *region;
+};
+
+// Packs small RGBA8 images into shared pages so sprites and UI images of one page are drawn with one texture
+// Every image is surrounded by a gutter of its edge pixels and lies on the grid of padding size,
+// so neither filtering nor mip levels up to padding times smaller take pixels of neighbours
+class TextureAtlas : public WithLogger, public WithRenderer
+{
+public:
+    EXPORT TextureAtlas(int pageSize = TEXTURE_ATLAS_PAGE_SIZE, int padding = TEXTURE_ATLAS_PADDING);
+    // Regions given away are destroyed together with pages
+    EXPORT ~TextureAtlas();
+
+    // Copies pixels into a page not uploaded yet, returns index of the image or -1 if it is larger than a page
+    EXPORT int add(const unsigned char *rgba, int width, int height);
+    // Uploads pages with new images, those pages are closed and images added later go to new pages
+    EXPORT void build();
+    // Builds the atlas if the image is not uploaded yet, nullptr if renderer has no regions
+    EXPORT Texture *getRegion(int index);
+
+    EXPORT int getPagesAmount();
+    EXPORT Texture *getPage(int index);
+    inline int getPageSize() { return pageSize; }
+    inline int getPadding() { return padding; }
+
+protected:
+    void copyWithGutter(TextureAtlasPage *page, const unsigned char *rgba, int width, int height, int x, int y, int rectWidth, int rectHeight);
+
+    int pageSize;
+    int padding;
+    std::vector<TextureAtlasPage *> pages;
+    std::vector<TextureAtlasEntry> entries;
+};
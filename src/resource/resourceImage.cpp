@@ -19,6 +19,27 @@ Texture *ResourceImage::getAsTexture()
     if (texture)
         return texture;
 
+    if (atlas)
+    {
+        texture = atlas->getRegion(atlasIndex);
+        if (texture)
+            return texture;
+    }
+
+    texture = loadCompressed();
+    if (texture)
+        return texture;
+
+    if (bStreaming && stbi_info(path.c_str(), &width, &height, &nrChannels))
+    {
+        texture = getRenderer()->createTextureStreamed(path, width, height);
+        if (texture)
+        {
+            logger->logf("Image `%s` queued for streaming", path.c_str());
+            return texture;
+        }
+    }
+
     unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
     if (data)
     {
@@ -33,11 +54,85 @@ Texture *ResourceImage::getAsTexture()
     return texture;
 }
 
+// Cooked image next to the source one is taken when renderer can sample its format, otherwise the source is decoded
+Texture *ResourceImage::loadCompressed()
+{
+    std::vector<std::string> paths;
+    if (CompressedImage::isCompressedImagePath(path))
+        paths.push_back(path);
+    else
+    {
+        std::string base = path.substr(0, path.find_last_of('.'));
+        paths.push_back(base + ".ktx2");
+        paths.push_back(base + ".dds");
+    }
+
+    for (auto it = paths.begin(); it != paths.end(); ++it)
+    {
+        CompressedImage image;
+        if (!image.load(*it))
+            continue;
+
+        if (!getRenderer()->isTextureFormatSupported(image.getFormat()))
+        {
+            logger->logf("Image `%s` has format unsupported by renderer", it->c_str());
+            continue;
+        }
+
+        Texture *result = getRenderer()->createTextureCompressed(&image);
+        if (result)
+        {
+            logger->logf("Image `%s` loaded", it->c_str());
+            width = image.getWidth();
+            height = image.getHeight();
+            nrChannels = 4;
+            return result;
+        }
+    }
+    return nullptr;
+}
+
 void ResourceImage::preload()
 {
     getAsTexture();
 }
 
+void ResourceImage::setStreaming(bool state)
+{
+    bStreaming = state;
+}
+
+bool ResourceImage::isStreaming()
+{
+    return bStreaming;
+}
+
+bool ResourceImage::setAtlas(TextureAtlas *atlas)
+{
+    int width, height, channels;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data)
+    {
+        logger->logff("ERROR: %s couldn't be loaded\n", path.c_str());
+        return false;
+    }
+
+    int index = atlas->add(data, width, height);
+    stbi_image_free(data);
+    if (index < 0)
+    {
+        logger->logf("Image `%s` is too large for atlas", path.c_str());
+        return false;
+    }
+
+    this->atlas = atlas;
+    this->atlasIndex = index;
+    this->width = width;
+    this->height = height;
+    nrChannels = 4;
+    return true;
+}
+
 int ResourceImage::getWidth()
 {
     if (!width)
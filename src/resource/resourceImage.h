@@ -5,6 +5,7 @@
 
 #include "resource/resource.h"
 #include "renderer/texture.h"
+#include "renderer/textureAtlas.h"
 #include "connector/withLogger.h"
 #include "connector/withRenderer.h"
 
@@ -23,6 +24,13 @@ public:
     EXPORT Texture *getAsTexture();
     EXPORT void preload();
 
+    // Texture is given right away and streamed in by renderer, placeholder is drawn until pixels are uploaded
+    EXPORT void setStreaming(bool state);
+    EXPORT bool isStreaming();
+    // Image is decoded right away and packed into the atlas, its texture becomes a region of an atlas page
+    // Images too large for a page keep own texture, should be called before the texture is taken
+    EXPORT bool setAtlas(TextureAtlas *atlas);
+
     EXPORT int getWidth();
     EXPORT int getHeight();
 
@@ -31,6 +39,7 @@ public:
 
 protected:
     void generateByteMap();
+    Texture *loadCompressed();
 
     Texture *texture = nullptr;
 
@@ -39,4 +48,7 @@ protected:
     int mapWidth = 0, mapHeight = 0;
 
     unsigned char *bytemapData = nullptr;
+    bool bStreaming = false;
+    TextureAtlas *atlas = nullptr;
+    int atlasIndex = -1;
 };
\ No newline at end of file
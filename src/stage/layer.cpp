@@ -16,3 +16,7 @@ void Layer::process(float delta)
 void Layer::render(Renderer* renderer, RenderTarget *renderTarget)
 {
 }
+
+void Layer::finishRender()
+{
+}
@@ -16,6 +16,8 @@ protected:
 public:
     virtual void process(float delta);
     virtual void render(Renderer* renderer, RenderTarget *renderTarget);
+    // Called for every layer after the stage is presented, work left in flight by render has to be done by the return
+    virtual void finishRender();
 
     inline void setVisible(bool state) { bIsVisible = state; }
     inline bool isVisible() { return bIsVisible; }
@@ -7,6 +7,7 @@
 #include "actor/actorGUIElement.h"
 #include "component/componentLight.h"
 #include "common/commonTextures.h"
+#include "renderer/renderQueueCapture.h"
 #include <math.h>
 #include <algorithm>
 
@@ -28,6 +29,9 @@ void LayerActors::process(float delta)
     if (!bProcessingEnabled)
         return;
 
+    // Actors are not changed while workers put them into the queue, pipelined fill of the previous frame may still run here
+    core->waitForJobs(&fillJobsInFlight);
+
     profiler->startTracking(processingTrackerId);
 
     for (auto actor = actors.begin(); actor != actors.end(); ++actor)
@@ -38,18 +42,36 @@ void LayerActors::process(float delta)
         physicsWorld->process(delta);
     profiler->stopTracking(physicsTrackerId);
 
+    // Spatial index is updated after physics moved bodies, only changed actors touch the tree
     auto actor = actors.begin();
     while (actor != actors.end())
         if ((*actor)->isDestroyed())
         {
-            delete (*actor);
+            removeFromSpatialIndex(*actor);
+            if (bPipelinedRendering)
+                retiredActors.push_back(*actor);
+            else
+                delete (*actor);
             actor = actors.erase(actor);
         }
         else
+        {
+            updateSpatialIndex(*actor);
             ++actor;
+        }
+
+    if (bUnboundedActorsChanged)
+    {
+        unboundedActors.clear();
+        for (auto it = actors.begin(); it != actors.end(); ++it)
+            if ((*it)->spatial.bUnbounded)
+                unboundedActors.push_back(*it);
+        bUnboundedActorsChanged = false;
+    }
 
+    // Bodies of retired actors stay until their actors are deleted
     profiler->startTracking(physicsTrackerId);
-    if (physicsWorld)
+    if (physicsWorld && !bPipelinedRendering)
         physicsWorld->removeDestroyed();
     profiler->stopTracking(physicsTrackerId);
 
@@ -79,10 +101,20 @@ void LayerActors::render(Renderer *renderer, RenderTarget *renderTarget)
     Vector3 cmDirection = activeCamera->getDirection();
 
     RenderQueue *renderQueue = renderer->getRenderQueue();
+    if (bPipelinedRendering)
+    {
+        core->waitForJobs(&fillJobsInFlight);
+        RenderQueue *rendererQueue = renderQueue;
+        renderQueue = pipelineQueues[pipelineFrame % RENDER_PIPELINE_FRAMES];
+        renderQueue->setLodThreshold(rendererQueue->getLodThreshold());
+        renderQueue->setShadowCastersDistance(rendererQueue->getShadowCastersDistance());
+    }
 
     renderQueue->reset();
+    renderQueue->setLayerIndex(index);
     renderQueue->setViewMatrix(mView);
     renderQueue->setViewProjectionMatrix(mProjectionView);
+    renderQueue->setProjectionMatrix(*activeCamera->getProjectionMatrix());
     renderQueue->setAmbientLight(ambientColor);
     renderQueue->setCameraPosition(cmPosition);
     renderQueue->setCameraDirection(cmDirection);
@@ -101,33 +133,247 @@ void LayerActors::render(Renderer *renderer, RenderTarget *renderTarget)
     renderQueue->setEnvHDRRotation(HDRRotation);
 
     // Put elements to queues
-    if (!actors.empty())
+    PhysicsDebris *debris = (physicsWorld && physicsWorld->hasDebris()) ? physicsWorld->getDebris() : nullptr;
+    if (!actors.empty() || debris)
     {
-        auto &actorsList = this->actors;
+        gatherRenderActors(mView, mProjectionView, cmPosition, renderQueue->getShadowCastersDistance());
         renderQueue->bDone = false;
-        core->queueJob([actorsList, renderQueue]
+        core->queueJob([this, renderQueue, debris]
                        {
-                            for (auto &actor : actorsList)
-                            {
-                                if (actor->isVisible())
-                                {
-                                    actor->onRenderQueue(renderQueue);
-                                }
-                            }
-                            renderQueue->bDone = true; });
+                            fillRenderQueue(renderQueue, debris);
+                            renderQueue->bDone = true; },
+                       &fillJobsInFlight);
     }
+    else
+        renderQueue->bDone = true;
+
+    if (physicsWorld && physicsWorld->isContactPointsKept())
+        showContactPoints();
 
     // Render queue
-    renderer->render(renderTarget);
+    bool bRendered = true;
+    if (bPipelinedRendering)
+    {
+        // Queue of the previous frame is complete, it is drawn while workers fill the new one
+        RenderQueue *rendererQueue = renderer->getRenderQueue();
+        renderQueue = pipelineQueues[(pipelineFrame + RENDER_PIPELINE_FRAMES - 1) % RENDER_PIPELINE_FRAMES];
+        bRendered = bPipelineFrameReady;
+        if (bRendered)
+        {
+            renderer->setRenderQueue(renderQueue);
+            renderer->render(renderTarget);
+            renderer->setRenderQueue(rendererQueue);
+        }
+        pipelineFrame++;
+        bPipelineFrameReady = true;
+        bPipelineFrameFilled = true;
+    }
+    else
+        renderer->render(renderTarget);
+
+    if (!capturePath.empty() && bRendered)
+    {
+        RenderQueueCapture capture;
+        capture.capture(renderQueue);
+        capture.save(capturePath);
+        capturePath.clear();
+    }
 
     profiler->stopTracking(renderingTrackerId);
 }
 
+void LayerActors::finishRender()
+{
+    // Pipelined fill keeps going while the next frame starts, process waits for it before actors are changed
+    if (!bPipelinedRendering)
+    {
+        core->waitForJobs(&fillJobsInFlight);
+        return;
+    }
+
+    // Frame filled before the layer stopped being rendered is outdated and may refer to retired actors
+    if (!bPipelineFrameFilled)
+        bPipelineFrameReady = false;
+    bPipelineFrameFilled = false;
+
+    // Queue that could use retired actors and resources is rendered, the one being filled was gathered after they were retired
+    releaseRetired();
+}
+
+void LayerActors::releaseRetired()
+{
+    for (auto it = retiredActors.begin(); it != retiredActors.end(); ++it)
+        delete (*it);
+    retiredActors.clear();
+
+    if (physicsWorld)
+        physicsWorld->removeDestroyed();
+
+    for (auto it = retiredReleases.begin(); it != retiredReleases.end(); ++it)
+        (*it)();
+    retiredReleases.clear();
+}
+
+// Every worker takes its own range of actors, ranges are merged in order so painter's order is kept
+void LayerActors::fillRenderQueue(RenderQueue *renderQueue, PhysicsDebris *debris)
+{
+    int actorsAmount = renderActors.size();
+    int segments = std::max(1, std::min(core->getMaxJobs(), actorsAmount / MIN_ACTORS_PER_SEGMENT));
+    int actorsPerSegment = actorsAmount / segments;
+    renderQueue->setupSegments(segments + (debris ? 1 : 0));
+
+    int currentActor = 0;
+    for (int i = 0; i < segments; i++)
+    {
+        int end = (i == segments - 1) ? actorsAmount : currentActor + actorsPerSegment;
+        core->queueJob([this, renderQueue, i, currentActor, end]
+                       { renderQueue->fillSegment(i, [this, renderQueue, currentActor, end]
+                                                  {
+                                                      for (int a = currentActor; a < end; a++)
+                                                      {
+                                                          if (renderActors[a]->isVisible())
+                                                              renderActors[a]->onRenderQueue(renderQueue);
+                                                      } }); },
+                       &renderJobsInFlight);
+        currentActor = end;
+    }
+
+    if (debris)
+        core->queueJob([renderQueue, debris, segments]
+                       { renderQueue->fillSegment(segments, [renderQueue, debris]
+                                                  { debris->onRenderQueue(renderQueue); }); },
+                       &renderJobsInFlight);
+
+    core->waitForJobs(&renderJobsInFlight);
+    renderQueue->mergeSegments();
+}
+
+// Painter's order needs every actor in order of the list, so does a layer without processing as the index is not updated
+void LayerActors::gatherRenderActors(const Matrix4 &mView, const Matrix4 &mProjectionView, const Vector3 &cameraPosition, float shadowDistance)
+{
+    if (bUseSorting || !bProcessingEnabled)
+    {
+        renderActors.assign(actors.begin(), actors.end());
+        return;
+    }
+
+    // Culling planes of camera are in view space, view matrix may have scale of camera in it
+    Vector4 *cullingPlanes = activeCamera->getCullingPlanes();
+    Vector4 planes[6];
+    for (int i = 0; i < 6; i++)
+    {
+        planes[i] = cullingPlanes[i] * mView;
+        planes[i] /= glm::length(Vector3(planes[i]));
+    }
+
+    // Shadow casters around camera are needed even if they are out of view
+    Sphere shadowCasters;
+    shadowCasters.setup(cameraPosition, shadowDistance);
+
+    visibleActors.clear();
+    actorsTree.queryFrustum(planes, 6, &visibleActors, &shadowCasters);
+
+    // Shadow casters near camera are kept even if they are hidden, their shadows may be not
+    bool bOcclusion = bOcclusionCullingEnabled && rasterizeOccluders(mProjectionView);
+    float shadowRadius2 = shadowDistance * shadowDistance;
+    renderActors.clear();
+    for (auto item : visibleActors)
+    {
+        Actor *actor = reinterpret_cast<Actor *>(item);
+        if (bOcclusion)
+        {
+            const AABB &bounds = actorsTree.getFatAABB(actor->spatial.proxy);
+            Vector3 closest = glm::clamp(cameraPosition, bounds.start, bounds.end);
+            if (glm::length2(closest - cameraPosition) > shadowRadius2 && occlusion.isOccluded(bounds))
+                continue;
+        }
+        renderActors.push_back(actor);
+    }
+    renderActors.insert(renderActors.end(), unboundedActors.begin(), unboundedActors.end());
+}
+
+bool LayerActors::rasterizeOccluders(const Matrix4 &mProjectionView)
+{
+    occlusion.begin(mProjectionView);
+    for (auto item : visibleActors)
+        addOccluders(reinterpret_cast<Actor *>(item));
+    for (auto actor : unboundedActors)
+        addOccluders(actor);
+
+    if (!occlusion.hasOccluders())
+        return false;
+
+    occlusion.rasterize();
+    return true;
+}
+
+void LayerActors::addOccluders(Actor *actor)
+{
+    if (!actor->spatial.bOccluder || !actor->isVisible())
+        return;
+
+    auto components = actor->getComponents();
+    for (auto component = components->begin(); component != components->end(); component++)
+    {
+        MeshStatic *occluder = (*component)->getOccluder();
+        if (occluder && (*component)->isVisible())
+            occlusion.addOccluder(occluder, (*component)->getWorldModelMatrix());
+    }
+}
+
+void LayerActors::updateSpatialIndex(Actor *actor)
+{
+    ActorSpatialState &spatial = actor->spatial;
+    unsigned int version = actor->getRenderBoundsVersion();
+
+    // Unbounded actors may be waiting for their meshes to load, so they are checked every time
+    if (spatial.bIndexed && !spatial.bUnbounded && spatial.version == version)
+        return;
+
+    AABB bounds;
+    bool bBounded = actor->getRenderBounds(bounds);
+    if (bBounded)
+    {
+        if (spatial.proxy == AABB_TREE_NULL)
+            spatial.proxy = actorsTree.createProxy(bounds, actor);
+        else
+            actorsTree.moveProxy(spatial.proxy, bounds);
+    }
+    else if (spatial.proxy != AABB_TREE_NULL)
+    {
+        actorsTree.destroyProxy(spatial.proxy);
+        spatial.proxy = AABB_TREE_NULL;
+    }
+
+    if (!spatial.bIndexed || spatial.bUnbounded == bBounded)
+        bUnboundedActorsChanged = true;
+    spatial.bIndexed = true;
+    spatial.bUnbounded = !bBounded;
+    spatial.bOccluder = actor->hasOccluders();
+    spatial.version = version;
+}
+
+void LayerActors::removeFromSpatialIndex(Actor *actor)
+{
+    ActorSpatialState &spatial = actor->spatial;
+    if (spatial.proxy != AABB_TREE_NULL)
+    {
+        actorsTree.destroyProxy(spatial.proxy);
+        spatial.proxy = AABB_TREE_NULL;
+    }
+    if (spatial.bUnbounded || !spatial.bIndexed)
+        bUnboundedActorsChanged = true;
+}
+
 void LayerActors::prepareNewActor(Actor *actor)
 {
     if (physicsWorld)
         actor->setPhysicsWorld(physicsWorld);
 
+    // Actor is rendered without culling until the next processing puts it into the index
+    unboundedActors.push_back(actor);
+    bUnboundedActorsChanged = true;
+
     actors.push_back(actor);
     actor->setCurrentLayer(this);
     actor->onSpawned();
@@ -276,6 +522,40 @@ void LayerActors::clear()
             (*actor)->destroy();
 }
 
+void LayerActors::setPipelinedRendering(bool state)
+{
+    if (bPipelinedRendering == state)
+        return;
+
+    core->waitForJobs(&fillJobsInFlight);
+    bPipelinedRendering = state;
+    bPipelineFrameReady = false;
+    bPipelineFrameFilled = false;
+    pipelineFrame = 0;
+
+    for (int i = 0; i < RENDER_PIPELINE_FRAMES; i++)
+    {
+        if (pipelineQueues[i])
+            delete pipelineQueues[i];
+        pipelineQueues[i] = state ? new RenderQueue() : nullptr;
+    }
+
+    releaseRetired();
+}
+
+bool LayerActors::isPipelinedRendering()
+{
+    return bPipelinedRendering;
+}
+
+void LayerActors::releaseAfterFrame(const std::function<void()> &release)
+{
+    if (bPipelinedRendering)
+        retiredReleases.push_back(release);
+    else
+        release();
+}
+
 void LayerActors::setVisible(bool state)
 {
     bIsVisible = state;
@@ -295,6 +575,16 @@ bool LayerActors::isProcessingEnabled()
     return bProcessingEnabled;
 }
 
+void LayerActors::setOcclusionCullingEnabled(bool state)
+{
+    bOcclusionCullingEnabled = state;
+}
+
+bool LayerActors::isOcclusionCullingEnabled()
+{
+    return bOcclusionCullingEnabled;
+}
+
 Camera *LayerActors::getActiveCamera()
 {
     return activeCamera;
@@ -328,6 +618,11 @@ void LayerActors::setHDREnvVisibility(bool state)
     HDREnvVisibility = state;
 }
 
+void LayerActors::captureNextFrame(const std::string &path)
+{
+    capturePath = path;
+}
+
 PhysicsWorld *LayerActors::getPhysicsWorld()
 {
     return physicsWorld;
@@ -344,3 +639,17 @@ void LayerActors::showDebugBox(const Vector3 &p, float size, const Vector3 &colo
     size *= activeCamera->getLineThickness();
     debug->addDebugBox(p, size, showTime, color);
 }
+
+void LayerActors::showContactPoints()
+{
+    if (!physicsWorld)
+        return;
+
+    float size = activeCamera->getLineThickness() * 4.0f;
+    auto &points = physicsWorld->getContactPoints();
+    for (int i = 0; i + 1 < (int)points.size(); i += 2)
+    {
+        debug->renderPoint(points[i], size, Vector3(1.0f, 0.2f, 0.2f));
+        debug->renderPoint(points[i + 1], size, Vector3(1.0f, 0.9f, 0.2f));
+    }
+}
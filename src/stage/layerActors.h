@@ -8,11 +8,22 @@
 #include "os/view.h"
 #include "camera/camera.h"
 #include "math/math.h"
+#include "math/AABBTree.h"
 #include "physics/physicsWorld.h"
 #include "connector/withProfiler.h"
 #include "connector/withCore.h"
 #include "renderer/renderer.h"
+#include "renderer/occlusionCulling.h"
 #include <list>
+#include <vector>
+#include <atomic>
+#include <functional>
+
+// Small layers are not worth splitting between workers
+#define MIN_ACTORS_PER_SEGMENT 256
+
+// Queues of pipelined rendering, one is filled while the previous one is rendered
+#define RENDER_PIPELINE_FRAMES 2
 
 class LayerActors : public Layer,
                     public WithDebug,
@@ -32,6 +43,7 @@ public:
 
     EXPORT void process(float delta) override;
     EXPORT void render(Renderer *renderer, RenderTarget *renderTarget) override;
+    EXPORT void finishRender() override;
     EXPORT void prepareNewActor(Actor *actor);
     EXPORT void enablePhisics(const Vector3 &gravity, float simScale = 1.0f, int stepsPerSecond = 100);
     EXPORT void enableSorting();
@@ -54,6 +66,10 @@ public:
     EXPORT void setProcessingEnabled(bool state);
     EXPORT bool isProcessingEnabled();
 
+    // Actors hidden behind occluders of components are not rendered, works only if there are occluders in view
+    EXPORT void setOcclusionCullingEnabled(bool state);
+    EXPORT bool isOcclusionCullingEnabled();
+
     EXPORT Camera *getActiveCamera();
     EXPORT void setActiveCamera(Camera *activeCamera);
 
@@ -71,12 +87,47 @@ public:
     void inline setGamma(float gamma) { this->gamma = gamma; }
     float inline getGamma() { return gamma; }
 
+    // Render queue of the next rendered frame is written to the file, it can be replayed with RenderQueueCapture
+    EXPORT void captureNextFrame(const std::string &path);
+
+    // Workers fill queue of the frame while the previous frame is rendered, the stage presents the rest and the next frame
+    // starts until process of the layer, so picture is one frame behind. Actors destroyed meanwhile are deleted once the frame
+    // showing them is rendered. Code outside of process should not change actors of the layer between present and process
+    EXPORT void setPipelinedRendering(bool state);
+    EXPORT bool isPipelinedRendering();
+    // Frame in flight may still use textures, shaders and meshes the code is done with, they are released through it
+    // Without pipelined rendering release is called right away
+    EXPORT void releaseAfterFrame(const std::function<void()> &release);
+
 protected:
+    void fillRenderQueue(RenderQueue *renderQueue, PhysicsDebris *debris);
+    void gatherRenderActors(const Matrix4 &mView, const Matrix4 &mProjectionView, const Vector3 &cameraPosition, float shadowDistance);
+    bool rasterizeOccluders(const Matrix4 &mProjectionView);
+    void addOccluders(Actor *actor);
+    void updateSpatialIndex(Actor *actor);
+    void removeFromSpatialIndex(Actor *actor);
+    void releaseRetired();
+    // Contact points of the last physics step, drawn every frame while the world keeps them
+    void showContactPoints();
+
     bool bIsVisible = true;
     bool bProcessingEnabled = true;
+    bool bOcclusionCullingEnabled = true;
     Vector3 ambientColor = Vector3(1.0f);
 
     std::list<Actor *> actors;
+
+    // Actors with known render bounds, the rest is visited every frame
+    AABBTree actorsTree;
+    std::vector<Actor *> unboundedActors;
+    std::vector<void *> visibleActors;
+    bool bUnboundedActorsChanged = false;
+    OcclusionCulling occlusion;
+
+    // Snapshot of actors for the render queue workers
+    std::vector<Actor *> renderActors;
+    std::atomic<int> renderJobsInFlight = 0;
+    std::atomic<int> fillJobsInFlight = 0;
     PhysicsWorld *physicsWorld = nullptr;
     bool bUseSorting = false;
     Camera *activeCamera = nullptr;
@@ -92,4 +143,15 @@ protected:
     bool HDREnvVisibility = true;
 
     float gamma = 1.0f;
+
+    std::string capturePath;
+
+    bool bPipelinedRendering = false;
+    RenderQueue *pipelineQueues[RENDER_PIPELINE_FRAMES] = {};
+    int pipelineFrame = 0;
+    // Previous queue holds a frame to render, it is dropped if the layer skipped rendering
+    bool bPipelineFrameReady = false;
+    bool bPipelineFrameFilled = false;
+    std::vector<Actor *> retiredActors;
+    std::vector<std::function<void()>> retiredReleases;
 };
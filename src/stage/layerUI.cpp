@@ -3,6 +3,7 @@
 
 #include "stage/layerUI.h"
 #include "renderer/opengl/glew.h"
+#include "renderer/opengl/stateOpenGL.h"
 #include "rtengine.h"
 #include <array>
 #include <functional>
@@ -180,21 +181,23 @@ void LayerUI::render(Renderer *renderer, RenderTarget *renderTarget)
 {
     screenWidth = renderTarget->getWidth();
     screenHeight = renderTarget->getHeight();
+    if (renderer->isHeadless())
+        return;
 
     renderTarget->useResultBuffer();
 
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDepthMask(GL_FALSE);
-    glDisable(GL_CULL_FACE);
+    StateOpenGL::disable(GL_DEPTH_TEST);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateOpenGL::depthMask(false);
+    StateOpenGL::disable(GL_CULL_FACE);
 
     UINodeAbsolutePosition node;
     node.node = rootContainer;
 
-    glEnable(GL_SCISSOR_TEST);
+    StateOpenGL::enable(GL_SCISSOR_TEST);
     treeElement.render(renderTarget, &renderSharedData);
-    glDisable(GL_SCISSOR_TEST);
+    StateOpenGL::disable(GL_SCISSOR_TEST);
 }
 
 void LayerUI::initSharedData()
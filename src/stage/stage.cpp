@@ -51,7 +51,7 @@ void Stage::process(float delta)
 void Stage::present(View *view)
 {
     auto viewRenderTarget = view->getRenderTarget();
-    present(view->getRenderer(), viewRenderTarget);
+    presentLayers(view->getRenderer(), viewRenderTarget);
 
     profiler->startTracking(presentTrackerId);
 
@@ -63,9 +63,17 @@ void Stage::present(View *view)
     profiler->startTracking(buffersSwapTrackerId);
     view->swapBuffers();
     profiler->stopTracking(buffersSwapTrackerId);
+
+    finishLayers();
 }
 
 void Stage::present(Renderer *renderer, RenderTarget *renderTarget)
+{
+    presentLayers(renderer, renderTarget);
+    finishLayers();
+}
+
+void Stage::presentLayers(Renderer *renderer, RenderTarget *renderTarget)
 {
     profiler->startTracking(presentTrackerId);
 
@@ -82,6 +90,13 @@ void Stage::present(Renderer *renderer, RenderTarget *renderTarget)
     }
 }
 
+// Layers may keep filling their queues on workers while the stage presents the rest, swaps buffers and the next frame starts
+void Stage::finishLayers()
+{
+    for (auto it = layers.begin(); it != layers.end(); ++it)
+        (*it)->finishRender();
+}
+
 void Stage::sortLayers()
 {
     layers.sort([](Layer *layer1, Layer *layer2)
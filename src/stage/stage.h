@@ -36,6 +36,8 @@ public:
     const int debugLayerIndex = 9999;
 
 protected:
+    void presentLayers(Renderer *renderer, RenderTarget *renderTarget);
+    void finishLayers();
     void sortLayers();
 
     RenderTarget *renderTarget = nullptr;
@@ -60,9 +60,12 @@ void UIRenderElement::render(RenderTarget *renderTarget, UIRenderSharedData *sha
         Matrix4 mModelProjection = *sharedData->view * m;
         sharedData->imageShader->use(m, mModelProjection);
         sharedData->imageShader->setOpacity(renderData->imageAlpha);
-        sharedData->imageShiftShaderParameter->set(1, renderData->imageShift);
+        // Atlas region moves the frame into its page
+        float imageShift[2], imageFrame[2];
+        renderData->image->toPageCoords(renderData->imageShift, renderData->imageFrame, imageShift, imageFrame);
+        sharedData->imageShiftShaderParameter->set(1, imageShift);
         sharedData->imageShiftShaderParameter->apply();
-        sharedData->imageFrameShaderParameter->set(1, renderData->imageFrame);
+        sharedData->imageFrameShaderParameter->set(1, imageFrame);
         sharedData->imageFrameShaderParameter->apply();
 
         imageTexture->bind();
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/math/AABBBatch.h"
+#include "check.h"
+#include <stdlib.h>
+#include <vector>
+
+// One million boxes tested against a query box and a ray by AABB::test and by the batch kernels
+// Both have to give the same boxes, timings are only printed since they depend on load of the machine
+static float random(float from, float to)
+{
+    return from + (to - from) * (float)rand() / (float)RAND_MAX;
+}
+
+int main()
+{
+    const int amount = 1000000;
+    srand(27);
+
+    std::vector<AABB> boxes(amount);
+    AABBBatch batch;
+    batch.resize(amount);
+    for (int i = 0; i < amount; i++)
+    {
+        Vector3 start(random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-100.0f, 100.0f));
+        Vector3 size(random(0.1f, 4.0f), random(0.1f, 4.0f), random(0.1f, 4.0f));
+        boxes[i] = AABB(start, start + size);
+        batch.set(i, boxes[i]);
+    }
+
+    AABB query(Vector3(-20.0f, -20.0f, -20.0f), Vector3(20.0f, 20.0f, 20.0f));
+    std::vector<int> scalarOverlaps, batchOverlaps;
+    scalarOverlaps.reserve(amount);
+    batchOverlaps.reserve(amount);
+
+    double scalarTime = measureMs(5, [&]
+                                  {
+                                      scalarOverlaps.clear();
+                                      for (int i = 0; i < amount; i++)
+                                          if (boxes[i].test(query))
+                                              scalarOverlaps.push_back(i); });
+    double batchTime = measureMs(5, [&]
+                                 {
+                                     batchOverlaps.clear();
+                                     batch.testAABB(query, 0, amount, &batchOverlaps); });
+
+    printf("overlaps: %i boxes, AABB::test %.2f ms, batch %.2f ms\n", (int)scalarOverlaps.size(), scalarTime, batchTime);
+    CHECK(!scalarOverlaps.empty());
+    CHECK(scalarOverlaps == batchOverlaps);
+
+    Segment ray(Vector3(-100.0f, -90.0f, -80.0f), Vector3(100.0f, 90.0f, 80.0f));
+    std::vector<int> scalarCrossed, batchCrossed;
+    double scalarRayTime = measureMs(5, [&]
+                                     {
+                                         scalarCrossed.clear();
+                                         for (int i = 0; i < amount; i++)
+                                             if (boxes[i].test(ray))
+                                                 scalarCrossed.push_back(i); });
+    double batchRayTime = measureMs(5, [&]
+                                    {
+                                        batchCrossed.clear();
+                                        batch.testRay(ray, 0, amount, &batchCrossed); });
+
+    printf("ray: %i boxes, AABB::test %.2f ms, batch %.2f ms\n", (int)scalarCrossed.size(), scalarRayTime, batchRayTime);
+    CHECK(!batchCrossed.empty());
+    CHECK(scalarCrossed == batchCrossed);
+
+    CHECK_RESULT();
+}
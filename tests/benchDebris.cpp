@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/physics/physicsWorld.h"
+#include "../src/physics/shapes/shapeBox.h"
+#include "../src/connector/withCore.h"
+#include "../src/connector/withLogger.h"
+#include "check.h"
+#include <vector>
+
+// Debris pieces fall on two floor halves and fall asleep, then one half is lowered
+// Prints time of a step with falling, sleeping and waking pieces, only pieces over the lowered half have to wake up
+static const int PIECES_AMOUNT = 50000;
+static const int ROW_AMOUNT = 250;
+
+static int countSleeping(PhysicsDebris *debris, bool bLeft)
+{
+    int amount = 0;
+    for (int i = 0; i < debris->getPiecesAmount(); i++)
+    {
+        DebrisPiece &piece = debris->getPieces()[i];
+        if (piece.bIsSleeping && (piece.position.x < 0.0f) == bLeft)
+            amount++;
+    }
+    return amount;
+}
+
+static double measureStep(PhysicsWorld *world, int steps)
+{
+    return measureMs(steps, [&]
+                     { world->process(1.0f / 60.0f + 0.000001f); });
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("benchDebris.log"));
+    WithCore::setGlobalCore(new Core());
+
+    PhysicsWorld world(Vector3(0.0f, -9.8f, 0.0f), 1.0f, 60);
+    Transformation leftTransform, rightTransform;
+    leftTransform.setPosition(Vector3(-50.0f, -0.5f, 0.0f));
+    rightTransform.setPosition(Vector3(50.0f, -0.5f, 0.0f));
+    auto left = world.createPhysicsBody(new ShapeBox(Vector3(0.0f), Vector3(100.0f, 1.0f, 200.0f), &world));
+    left->setRelation(&leftTransform, nullptr);
+    auto right = world.createPhysicsBody(new ShapeBox(Vector3(0.0f), Vector3(100.0f, 1.0f, 200.0f), &world));
+    right->setRelation(&rightTransform, nullptr);
+
+    PhysicsDebris *debris = world.getDebris();
+    for (int i = 0; i < PIECES_AMOUNT; i++)
+    {
+        Vector3 position = Vector3((i % ROW_AMOUNT) * 0.35f - 43.6f, 1.0f + (i / (ROW_AMOUNT * ROW_AMOUNT)) * 0.5f, ((i / ROW_AMOUNT) % ROW_AMOUNT) * 0.35f - 43.6f);
+        DebrisShape shape = i % 2 ? DebrisShape::Box : DebrisShape::Sphere;
+        CHECK(debris->spawn(shape, position, Quat(1.0f, 0.0f, 0.0f, 0.0f), Vector3(0.2f), Vector3(0.0f), Vector3(0.0f), 1000.0f));
+    }
+
+    double fallingTime = measureStep(&world, 30);
+    for (int i = 0; i < 120; i++)
+        world.process(1.0f / 60.0f + 0.000001f);
+    int sleepingLeft = countSleeping(debris, true);
+    int sleepingRight = countSleeping(debris, false);
+    double sleepingTime = measureStep(&world, 30);
+    printf("falling: %.2f ms, sleeping: %.2f ms, %i of %i pieces asleep\n", fallingTime, sleepingTime, sleepingLeft + sleepingRight, PIECES_AMOUNT);
+    CHECK(sleepingLeft + sleepingRight == PIECES_AMOUNT);
+
+    // Pieces over the lowered half lose their support and wake up, the other half keeps sleeping
+    rightTransform.setPosition(Vector3(50.0f, -5.5f, 0.0f));
+    double wakingTime = measureStep(&world, 1);
+    printf("waking: %.2f ms, %i left asleep, %i right asleep\n", wakingTime, countSleeping(debris, true), countSleeping(debris, false));
+    CHECK(countSleeping(debris, true) == sleepingLeft);
+    CHECK(countSleeping(debris, false) == 0);
+
+    for (int i = 0; i < 60; i++)
+        world.process(1.0f / 60.0f + 0.000001f);
+    int fallen = 0;
+    for (int i = 0; i < debris->getPiecesAmount(); i++)
+        if (debris->getPieces()[i].position.y < -4.0f)
+            fallen++;
+    CHECK(fallen == sleepingRight);
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/null/rendererNull.h"
+#include "../src/renderer/renderTarget.h"
+#include "../src/connector/withRenderer.h"
+#include "../src/math/glm/gtc/matrix_access.hpp"
+#include "check.h"
+#include <vector>
+
+// Frame of a synthetic scene rendered by null renderer, prints frame and phase times with draw calls and state changes
+// Numbers are CPU cost of queue filling and renderer side work, usable to compare changes of the render path without GPU
+static const int MESHES_AMOUNT = 20000;
+static const int SPRITES_AMOUNT = 2000;
+static const int OMNI_AMOUNT = 16;
+
+struct Scene
+{
+    std::vector<Shader *> shaders;
+    std::vector<Texture *> textures;
+    std::vector<Matrix4> models;
+    std::vector<Matrix4> spriteModels;
+};
+
+static void fillQueue(Renderer *renderer, Scene &scene, bool bSunShadows)
+{
+    RenderQueue *queue = renderer->getRenderQueue();
+    Matrix4 mView = glm::lookAt(Vector3(0.0f, 20.0f, 60.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+    Matrix4 mProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    Matrix4 mViewProjection = mProjection * mView;
+    Vector4 uvShiftSize = Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+    MeshStatic *cube = renderer->getDefaultCubeMesh();
+    MeshStatic *sprite = renderer->getDefaultSpriteMesh();
+
+    queue->reset();
+    queue->bDone = false;
+    queue->setViewMatrix(mView);
+    queue->setProjectionMatrix(mProjection);
+    queue->setViewProjectionMatrix(mViewProjection);
+
+    // View space planes as perspective camera makes them
+    Vector4 planes[6];
+    for (int i = 0; i < 3; i++)
+    {
+        planes[i * 2] = glm::row(mProjection, 3) + glm::row(mProjection, i);
+        planes[i * 2 + 1] = glm::row(mProjection, 3) - glm::row(mProjection, i);
+    }
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(Vector3(planes[i]));
+    queue->setCullingPlanes(planes);
+
+    for (int i = 0; i < MESHES_AMOUNT; i++)
+    {
+        Shader *shader = scene.shaders[i % scene.shaders.size()];
+        Texture *texture = scene.textures[(i / 3) % scene.textures.size()];
+        queue->addMainPhase(scene.models[i], shader, texture, cube, nullptr, 0);
+        queue->addShadowCaster(scene.models[i], cube, texture, uvShiftSize);
+    }
+    for (int i = 0; i < SPRITES_AMOUNT; i++)
+    {
+        ColorMode colorMode = i % 4 ? ColorMode::Alpha : ColorMode::Addition;
+        queue->addBlendingPhase(scene.spriteModels[i], colorMode, scene.shaders[0], scene.textures[i % 2], sprite, 0.5f, nullptr, 0);
+    }
+
+    queue->addLight(LightType::Sun, Vector3(0.3f, 1.0f, 0.2f), Vector3(1.0f, 1.0f, 1.0f), 100.0f, bSunShadows);
+    for (int i = 0; i < OMNI_AMOUNT; i++)
+        queue->addLight(LightType::Omni, Vector3(i * 4.0f - 32.0f, 2.0f, 0.0f), Vector3(1.0f, 0.8f, 0.6f), 8.0f, false);
+    queue->bDone = true;
+}
+
+static double measureFrame(RendererNull *renderer, RenderTarget *renderTarget, Scene &scene, bool bSunShadows)
+{
+    return measureMs(10, [&]
+                     {
+                         fillQueue(renderer, scene, bSunShadows);
+                         renderer->render(renderTarget); });
+}
+
+static void printFrame(const char *name, RendererNull *renderer, double time)
+{
+    printf("%s: %.2f ms, main %.2f ms, lightning %.2f ms, blending %.2f ms, %i draw calls, %i state changes, %i avoided\n", name, time,
+           renderer->getPhaseTime(RenderPhase::Main), renderer->getPhaseTime(RenderPhase::Lightning), renderer->getPhaseTime(RenderPhase::Blending),
+           renderer->getDrawCalls(), renderer->getStateChanges(), renderer->getStateChangesAvoided());
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("benchRendererNull.log"));
+    WithCore::setGlobalCore(new Core());
+    WithDebug::setDebugController(new DebugController());
+
+    RendererNull *renderer = new RendererNull(nullptr);
+    WithRenderer::setCurrentRenderer(renderer);
+    renderer->init(nullptr);
+    RenderTarget *renderTarget = new RenderTarget(1280, 720, RenderQuality::Balanced, 1.0f, true);
+
+    Scene scene;
+    for (int i = 0; i < 4; i++)
+        scene.shaders.push_back(renderer->createPhongShader());
+    for (int i = 0; i < 16; i++)
+        scene.textures.push_back(renderer->createTexture(64, 64, 4, nullptr, false));
+    for (int i = 0; i < MESHES_AMOUNT; i++)
+        scene.models.push_back(glm::translate(Matrix4(1.0f), Vector3((i % 200) * 1.5f - 150.0f, 0.0f, -(i / 200) * 1.5f)));
+    for (int i = 0; i < SPRITES_AMOUNT; i++)
+        scene.spriteModels.push_back(glm::translate(Matrix4(1.0f), Vector3((i % 50) - 25.0f, 1.0f + (i / 50) * 0.1f, (i / 50) * -2.0f)));
+
+    // Without shadows every element and light is one draw
+    double plainTime = measureFrame(renderer, renderTarget, scene, false);
+    printFrame("no shadows", renderer, plainTime);
+    int mainAmount = renderer->getRenderQueue()->getMainPhaseElementsAmount();
+    int blendingAmount = renderer->getRenderQueue()->getBlendingPhaseElementsAmount();
+    int plainDrawCalls = renderer->getDrawCalls();
+    CHECK(mainAmount > 0 && blendingAmount == SPRITES_AMOUNT);
+    // Initial light, sun and clustered omni pass
+    CHECK(plainDrawCalls == mainAmount + blendingAmount + 3);
+    // Sorting groups elements by state, so most binds are skipped
+    CHECK(renderer->getStateChanges() < renderer->getStateChangesAvoided());
+
+    // Casters are drawn again for every cascade they touch, the ones beyond sun affect distance are not
+    double shadowsTime = measureFrame(renderer, renderTarget, scene, true);
+    printFrame("sun shadows", renderer, shadowsTime);
+    CHECK(renderer->getDrawCalls() > plainDrawCalls);
+
+    // Every omni volume is a draw of its own
+    renderer->setOmniLightMode(OmniLightMode::Volumes);
+    double volumesTime = measureFrame(renderer, renderTarget, scene, false);
+    printFrame("omni volumes", renderer, volumesTime);
+    CHECK(renderer->getDrawCalls() == plainDrawCalls - 1 + OMNI_AMOUNT);
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <stdio.h>
+#include <chrono>
+
+// Failed checks are printed and counted, test returns the amount of them so make check stops on it
+static int checkFailures = 0;
+
+#define CHECK(condition)                                                       \
+    do                                                                         \
+    {                                                                          \
+        if (!(condition))                                                      \
+        {                                                                      \
+            printf("%s:%i: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            checkFailures++;                                                   \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_RESULT()                                 \
+    do                                                 \
+    {                                                  \
+        if (checkFailures)                             \
+            printf("%i checks failed\n", checkFailures); \
+        else                                           \
+            printf("all checks passed\n");             \
+        return checkFailures;                          \
+    } while (0)
+
+// Milliseconds spent in the call, best of several runs
+template <typename F>
+static double measureMs(int runs, F call)
+{
+    double best = 0.0;
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        call();
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || time < best)
+            best = time;
+    }
+    return best;
+}
@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/blockEncoder.h"
+#include "check.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+// Reference decoders of the formats written by the encoder, pixels are RGBA8 of 4x4 block row by row
+static unsigned int getBits(const unsigned char *block, int &position, int amount)
+{
+    unsigned int value = 0;
+    for (int i = 0; i < amount; i++, position++)
+        if (block[position >> 3] & (1 << (position & 7)))
+            value |= 1u << i;
+    return value;
+}
+
+static void decodeColorsBC1(const unsigned char *block, unsigned char *pixels)
+{
+    unsigned int colors[2] = {(unsigned int)(block[0] | block[1] << 8), (unsigned int)(block[2] | block[3] << 8)};
+    int palette[4][3];
+    for (int k = 0; k < 2; k++)
+    {
+        int r = colors[k] >> 11, g = (colors[k] >> 5) & 63, b = colors[k] & 31;
+        palette[k][0] = (r << 3) | (r >> 2);
+        palette[k][1] = (g << 2) | (g >> 4);
+        palette[k][2] = (b << 3) | (b >> 2);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        bool bFour = colors[0] > colors[1];
+        palette[2][c] = bFour ? (2 * palette[0][c] + palette[1][c]) / 3 : (palette[0][c] + palette[1][c]) / 2;
+        palette[3][c] = bFour ? (palette[0][c] + 2 * palette[1][c]) / 3 : 0;
+    }
+    int position = 32;
+    for (int i = 0; i < 16; i++)
+    {
+        int index = getBits(block, position, 2);
+        for (int c = 0; c < 3; c++)
+            pixels[i * 4 + c] = palette[index][c];
+    }
+}
+
+static void decodeBC4(const unsigned char *block, int channel, unsigned char *pixels)
+{
+    int a = block[0], b = block[1];
+    int palette[8] = {a, b, 0, 0, 0, 0, 0, 255};
+    for (int i = 2; i < 8; i++)
+        palette[i] = a > b ? ((8 - i) * a + (i - 1) * b) / 7 : (i < 6 ? ((6 - i) * a + (i - 1) * b) / 5 : palette[i]);
+    int position = 16;
+    for (int i = 0; i < 16; i++)
+        pixels[i * 4 + channel] = palette[getBits(block, position, 3)];
+}
+
+// Mode 6 only, single subset with 7 bit endpoints, p bits and 4 bit indexes
+static bool decodeBC7(const unsigned char *block, unsigned char *pixels)
+{
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    int position = 0;
+    if (getBits(block, position, 7) != 64)
+        return false;
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++)
+        for (int e = 0; e < 2; e++)
+            endpoints[e][c] = getBits(block, position, 7) << 1;
+    for (int e = 0; e < 2; e++)
+    {
+        int pBit = getBits(block, position, 1);
+        for (int c = 0; c < 4; c++)
+            endpoints[e][c] |= pBit;
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        int weight = weights[getBits(block, position, i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++)
+            pixels[i * 4 + c] = ((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6;
+    }
+    return position == 128;
+}
+
+static bool decodeBlock(TextureFormat format, const unsigned char *block, unsigned char *pixels)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+        decodeColorsBC1(block, pixels);
+        return true;
+    case TextureFormat::BC3:
+        decodeBC4(block, 3, pixels);
+        decodeColorsBC1(block + 8, pixels);
+        return true;
+    case TextureFormat::BC5:
+        decodeBC4(block, 0, pixels);
+        decodeBC4(block + 8, 1, pixels);
+        return true;
+    case TextureFormat::BC7:
+        return decodeBC7(block, pixels);
+    default:
+        return false;
+    }
+}
+
+// Root mean square error of the first level over channels the format keeps
+static float getError(CompressedImage *image, const std::vector<unsigned char> &rgba, int width, int height)
+{
+    TextureFormat format = image->getFormat();
+    int channels = format == TextureFormat::BC1 ? 3 : (format == TextureFormat::BC5 ? 2 : 4);
+    int blockSize = CompressedImage::getBlockSize(format);
+    CompressedImageLevel *level = image->getLevel(0);
+    double sum = 0.0;
+    for (int by = 0; by < height / 4; by++)
+    {
+        for (int bx = 0; bx < width / 4; bx++)
+        {
+            unsigned char pixels[64] = {};
+            if (!decodeBlock(format, &level->data[(by * (width / 4) + bx) * blockSize], pixels))
+                return 255.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                const unsigned char *source = &rgba[((by * 4 + i / 4) * width + bx * 4 + i % 4) * 4];
+                for (int c = 0; c < channels; c++)
+                    sum += (pixels[i * 4 + c] - source[c]) * (pixels[i * 4 + c] - source[c]);
+            }
+        }
+    }
+    return sqrtf(sum / (width * height * channels));
+}
+
+static bool isSameImage(CompressedImage *a, CompressedImage *b)
+{
+    if (a->getFormat() != b->getFormat() || a->getWidth() != b->getWidth() || a->getHeight() != b->getHeight() || a->getLevelsAmount() != b->getLevelsAmount())
+        return false;
+    for (int i = 0; i < a->getLevelsAmount(); i++)
+        if (a->getLevel(i)->data != b->getLevel(i)->data)
+            return false;
+    return true;
+}
+
+static std::vector<unsigned char> readFile(const char *path)
+{
+    std::vector<unsigned char> data;
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return data;
+    int c;
+    while ((c = fgetc(file)) != EOF)
+        data.push_back(c);
+    fclose(file);
+    return data;
+}
+
+int main()
+{
+    // Smooth gradients in every channel, the way most textures look inside of a block
+    const int width = 64, height = 48;
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            unsigned char pixel[4] = {(unsigned char)(x * 4), (unsigned char)(y * 5), (unsigned char)(128 + x - y), (unsigned char)((x + y) * 2)};
+            memcpy(&rgba[(y * width + x) * 4], pixel, 4);
+        }
+    }
+
+    TextureFormat formats[4] = {TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC5, TextureFormat::BC7};
+    float errorBounds[4] = {6.0f, 6.0f, 1.0f, 3.0f};
+    const char *names[4] = {"BC1", "BC3", "BC5", "BC7"};
+    for (int f = 0; f < 4; f++)
+    {
+        CompressedImage image;
+        CHECK(BlockEncoder::encode(rgba.data(), width, height, formats[f], true, &image));
+        CHECK(image.getLevelsAmount() == 7);
+        CHECK(image.getLevel(6)->width == 1 && image.getLevel(6)->height == 1);
+        float error = getError(&image, rgba, width, height);
+        printf("%s error %.2f\n", names[f], error);
+        CHECK(error < errorBounds[f]);
+
+        // Both containers give back the same blocks
+        std::string path = std::string("testCompressedImage") + names[f];
+        CompressedImage fromDDS, fromKTX2;
+        CHECK(image.saveDDS(path + ".dds") && fromDDS.load(path + ".dds"));
+        CHECK(image.saveKTX2(path + ".ktx2") && fromKTX2.load(path + ".ktx2"));
+        CHECK(isSameImage(&image, &fromDDS));
+        CHECK(isSameImage(&image, &fromKTX2));
+    }
+
+    // Block of one color is kept exactly when the color fits endpoints, all channels share the p bit
+    unsigned char color[4] = {0x80, 0x40, 0x20, 0xFE};
+    unsigned char flat[64], block[16], decoded[64];
+    for (int i = 0; i < 16; i++)
+        memcpy(flat + i * 4, color, 4);
+    BlockEncoder::encodeBlockBC7(flat, block);
+    CHECK(decodeBC7(block, decoded) && memcmp(decoded, flat, 64) == 0);
+
+    // Level offset near the top of 64 bits wraps around when added to the length
+    std::vector<unsigned char> ktx2 = readFile("testCompressedImageBC5.ktx2");
+    CHECK(ktx2.size() > 100);
+    CompressedImage broken;
+    CHECK(broken.loadKTX2(ktx2.data(), ktx2.size()));
+    std::vector<unsigned char> wrapped = ktx2;
+    memset(&wrapped[12 + 68], 0xFF, 8);
+    wrapped[12 + 68] = 0xF0;
+    CHECK(!broken.loadKTX2(wrapped.data(), wrapped.size()));
+    // Signed BC5 is not read as unsigned one
+    std::vector<unsigned char> signedBC5 = ktx2;
+    signedBC5[12] = 142;
+    CHECK(!broken.loadKTX2(signedBC5.data(), signedBC5.size()));
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/physics/physicsWorld.h"
+#include "../src/physics/shapes/shapeSphere.h"
+#include "../src/physics/shapes/shapePlain.h"
+#include "../src/connector/withCore.h"
+#include "../src/connector/withLogger.h"
+#include "../src/actor/actor.h"
+#include "check.h"
+#include <vector>
+#include <deque>
+
+// FNV-1a over positions and orientations
+static unsigned long long hashBodies(const std::vector<PhysicsBody *> &bodies)
+{
+    unsigned long long hash = 1469598103934665603ULL;
+    for (auto &body : bodies)
+    {
+        Vector3 position = body->getCenterOfMass();
+        Quat orientation = body->getOrientation();
+        float values[7] = {position.x, position.y, position.z, orientation.x, orientation.y, orientation.z, orientation.w};
+        unsigned char *bytes = reinterpret_cast<unsigned char *>(values);
+        for (int i = 0; i < (int)sizeof(values); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// Ground that drops a new sphere above every sphere touching it, bodies are created in the middle of a step
+class Spawner : public Actor
+{
+public:
+    Spawner(PhysicsWorld *world) : world(world) {}
+
+    void onCollide(Actor *hitWith, Vector3 v) override
+    {
+        if ((int)spawned.size() >= 300)
+            return;
+        transforms.emplace_back();
+        transforms.back().setPosition(Vector3(v.x, 4.0f + (spawned.size() % 5) * 0.5f, v.z));
+        auto body = world->createPhysicsBody(new ShapeSphere(Vector3(0.0f), 0.2f, world));
+        body->setRelation(&transforms.back(), nullptr);
+        body->setDynamicMotionType();
+        spawned.push_back(body);
+    }
+
+    PhysicsWorld *world;
+    std::vector<PhysicsBody *> spawned;
+    std::deque<Transformation> transforms;
+};
+
+// Pile of spheres falling on a plain, state of bodies after several seconds is hashed
+// Deterministic world has to give the same hash for any amount of threads
+static unsigned long long simulate(int threads)
+{
+    PhysicsWorld world(Vector3(0.0f, -9.8f, 0.0f), 1.0f, 60);
+    world.setMaxThreads(threads);
+    world.setDeterministic(true);
+
+    Transformation groundTransform;
+    auto ground = world.createPhysicsBody(new ShapePlain(Vector3(0.0f, 1.0f, 0.0f), 0.0f, &world));
+    ground->setRelation(&groundTransform, nullptr);
+
+    const int amount = 600;
+    std::vector<Transformation> transforms(amount);
+    std::vector<PhysicsBody *> bodies;
+    for (int i = 0; i < amount; i++)
+    {
+        transforms[i].setPosition(Vector3((i % 10) * 0.35f + (i / 100) * 0.05f, 0.5f + (i / 10) * 0.35f, ((i / 10) % 10) * 0.35f));
+        auto body = world.createPhysicsBody(new ShapeSphere(Vector3(0.0f), 0.2f, &world));
+        body->setRelation(&transforms[i], nullptr);
+        body->setDynamicMotionType();
+        bodies.push_back(body);
+    }
+
+    for (int step = 0; step < 300; step++)
+        world.process(1.0f / 60.0f + 0.000001f);
+
+    return hashBodies(bodies);
+}
+
+// Bodies are spawned by collision events between sub steps of one process call and some are removed between calls
+static unsigned long long simulateSpawning(int threads)
+{
+    PhysicsWorld world(Vector3(0.0f, -9.8f, 0.0f), 1.0f, 60);
+    world.setMaxThreads(threads);
+    world.setDeterministic(true);
+
+    Spawner spawner(&world);
+    Transformation groundTransform;
+    auto ground = world.createPhysicsBody(new ShapePlain(Vector3(0.0f, 1.0f, 0.0f), 0.0f, &world));
+    ground->setRelation(&groundTransform, &spawner);
+
+    const int amount = 200;
+    std::vector<Transformation> transforms(amount);
+    std::vector<PhysicsBody *> bodies;
+    for (int i = 0; i < amount; i++)
+    {
+        transforms[i].setPosition(Vector3((i % 10) * 0.45f, 0.3f + (i / 10) * 0.45f, ((i / 10) % 4) * 0.45f));
+        auto body = world.createPhysicsBody(new ShapeSphere(Vector3(0.0f), 0.2f, &world));
+        body->setRelation(&transforms[i], nullptr);
+        body->setDynamicMotionType();
+        bodies.push_back(body);
+    }
+
+    int removed = 0;
+    for (int step = 0; step < 100; step++)
+    {
+        world.process(4.0f / 60.0f + 0.000001f);
+        // Bodies are removed from the front, so the rest is renumbered
+        if (step % 10 == 9)
+        {
+            for (int i = removed; i < removed + 10; i++)
+                bodies[i]->destroy();
+            removed += 10;
+            world.removeDestroyed();
+        }
+    }
+
+    CHECK(spawner.spawned.size() == 300);
+    bodies.erase(bodies.begin(), bodies.begin() + removed);
+    bodies.insert(bodies.end(), spawner.spawned.begin(), spawner.spawned.end());
+    return hashBodies(bodies);
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("testDeterminism.log"));
+    WithCore::setGlobalCore(new Core());
+
+    unsigned long long reference = simulate(1);
+    printf("1 thread: %016llx\n", reference);
+    for (int threads : {2, 4, 16})
+    {
+        unsigned long long hash = simulate(threads);
+        printf("%i threads: %016llx\n", threads, hash);
+        CHECK(hash == reference);
+    }
+
+    reference = simulateSpawning(1);
+    printf("spawning, 1 thread: %016llx\n", reference);
+    for (int threads : {2, 4, 16})
+    {
+        unsigned long long hash = simulateSpawning(threads);
+        printf("spawning, %i threads: %016llx\n", threads, hash);
+        CHECK(hash == reference);
+    }
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/physics/physicsWorld.h"
+#include "../src/physics/shapes/shapeSphere.h"
+#include "../src/connector/withCore.h"
+#include "../src/connector/withLogger.h"
+#include "check.h"
+#include <math.h>
+#include <vector>
+
+// Chain of spheres hanging from the world swings down from horizontal position
+// Gaps between anchors of joints are measured on every step, long chains drift apart when the solver is weak
+static const int LINKS_AMOUNT = 20;
+static const float LINK_LENGTH = 0.5f;
+
+int main()
+{
+    WithLogger::setLogController(new LogController("testJointChain.log"));
+    WithCore::setGlobalCore(new Core());
+
+    PhysicsWorld *world = new PhysicsWorld(Vector3(0.0f, -9.8f, 0.0f), 1.0f, 60);
+    Constraint6DOFDescriptor ball = {false, false, false, true, true, true};
+
+    std::vector<Transformation> transforms(LINKS_AMOUNT);
+    std::vector<PhysicsBody *> links;
+    PhysicsBody *previous = nullptr;
+    for (int i = 0; i < LINKS_AMOUNT; i++)
+    {
+        transforms[i].setPosition(Vector3((i + 1) * LINK_LENGTH, 10.0f, 0.0f));
+        auto body = world->createPhysicsBody(new ShapeSphere(Vector3(0.0f), 0.15f, world));
+        body->setRelation(&transforms[i], nullptr);
+        body->setDynamicMotionType();
+        Vector3 anchor = Vector3((i + 0.5f) * LINK_LENGTH, 10.0f, 0.0f);
+        CHECK(world->createJoint6DOF(body, previous, i == 0 ? Vector3(0.0f, 10.0f, 0.0f) : anchor, ball) != nullptr);
+        links.push_back(body);
+        previous = body;
+    }
+
+    float maxGap = 0.0f;
+    float maxLength = 0.0f;
+    bool bFinite = true;
+    for (int step = 0; step < 600; step++)
+    {
+        world->process(1.0f / 60.0f + 0.000001f);
+        maxGap = fmaxf(maxGap, glm::length(links[0]->getCenterOfMass() - Vector3(0.0f, 10.0f, 0.0f)) - LINK_LENGTH);
+        for (int i = 1; i < LINKS_AMOUNT; i++)
+            maxGap = fmaxf(maxGap, glm::length(links[i]->getCenterOfMass() - links[i - 1]->getCenterOfMass()) - LINK_LENGTH);
+        Vector3 end = links[LINKS_AMOUNT - 1]->getCenterOfMass();
+        maxLength = fmaxf(maxLength, glm::length(end - Vector3(0.0f, 10.0f, 0.0f)));
+        bFinite = bFinite && std::isfinite(end.x) && std::isfinite(end.y) && std::isfinite(end.z);
+    }
+
+    Vector3 end = links[LINKS_AMOUNT - 1]->getCenterOfMass();
+    printf("largest gap %.4f, longest chain %.3f of %.3f, end at %.3f %.3f %.3f\n", maxGap, maxLength, LINKS_AMOUNT * LINK_LENGTH, end.x, end.y, end.z);
+    CHECK(bFinite);
+    // Every link keeps within a few percent of its length, the whole chain doesn't stretch
+    CHECK(maxGap < LINK_LENGTH * 0.05f);
+    CHECK(maxLength < LINKS_AMOUNT * LINK_LENGTH * 1.02f);
+    // Chain has swung down and hangs below its anchor
+    CHECK(end.y < 10.0f - LINKS_AMOUNT * LINK_LENGTH * 0.5f);
+
+    // Joints are freed with their world
+    delete world;
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/lightClusters.h"
+#include "../src/connector/withCore.h"
+#include "../src/connector/withLogger.h"
+#include "check.h"
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+// Every light touching a visible point has to be listed in the cluster of that point
+static int countMissedLights(LightClusters *clusters, const Matrix4 &mView, const Matrix4 &mProjection, std::vector<LightClusterSource> &lights)
+{
+    Matrix4 mProjectionView = mProjection * mView;
+    const unsigned int *clusterList = clusters->getClusters();
+    const unsigned int *indexes = clusters->getIndexes();
+    int missed = 0;
+
+    for (int i = 0; i < 50000; i++)
+    {
+        Vector3 point((rand() % 2000) / 10.0f - 100.0f, (rand() % 100) / 10.0f, (rand() % 2000) / 10.0f - 100.0f);
+        Vector4 clip = mProjectionView * Vector4(point, 1.0f);
+        if (clip.w <= 0.0f)
+            continue;
+        Vector3 ndc = Vector3(clip) / clip.w;
+        if (fabsf(ndc.x) >= 1.0f || fabsf(ndc.y) >= 1.0f || fabsf(ndc.z) >= 1.0f)
+            continue;
+
+        float depth = -(mView * Vector4(point, 1.0f)).z;
+        // Tile is clamped like in the shader, points at the edge may round to the next tile
+        int x = std::min((int)((ndc.x * 0.5f + 0.5f) * LIGHT_CLUSTERS_X), LIGHT_CLUSTERS_X - 1);
+        int y = std::min((int)((ndc.y * 0.5f + 0.5f) * LIGHT_CLUSTERS_Y), LIGHT_CLUSTERS_Y - 1);
+        int cluster = clusters->getClusterIndex(x, y, clusters->getSlice(depth));
+
+        for (int l = 0; l < (int)lights.size(); l++)
+        {
+            if (glm::length(lights[l].position - point) >= lights[l].radius)
+                continue;
+
+            bool bFound = false;
+            for (unsigned int k = 0; k < clusterList[cluster * 2 + 1]; k++)
+                if ((int)indexes[clusterList[cluster * 2] + k] == l)
+                    bFound = true;
+            if (!bFound)
+                missed++;
+        }
+    }
+    return missed;
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("testLightClusters.log"));
+    WithCore::setGlobalCore(new Core());
+
+    srand(1);
+    std::vector<LightClusterSource> lights;
+    for (int i = 0; i < 200; i++)
+        lights.push_back({Vector3(rand() % 200 - 100, rand() % 10, rand() % 200 - 100), 3.0f + rand() % 10});
+
+    Matrix4 mView = glm::lookAt(Vector3(0.0f, 5.0f, 10.0f), Vector3(0.0f), Vector3(0.0f, 1.0f, 0.0f));
+    LightClusters clusters;
+
+    // Perspective projection uses logarithmic slices between its planes
+    Matrix4 mPerspective = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.5f, 500.0f);
+    clusters.build(mView, mPerspective, lights.data(), lights.size());
+    CHECK(clusters.isLogarithmic());
+    CHECK(fabsf(clusters.getNear() - 0.5f) < 0.01f);
+    CHECK(fabsf(clusters.getFar() - 500.0f) < 1.0f);
+    CHECK(clusters.getSlice(clusters.getNear()) == 0);
+    CHECK(clusters.getSlice(clusters.getFar() * 0.999f) == LIGHT_CLUSTERS_Z - 1);
+    CHECK(clusters.getIndexesAmount() > 0);
+    CHECK(countMissedLights(&clusters, mView, mPerspective, lights) == 0);
+
+    // Orthogonal projection uses even slices
+    Matrix4 mOrtho = glm::ortho(-20.0f, 20.0f, -10.0f, 10.0f, -50.0f, 50.0f);
+    clusters.build(mView, mOrtho, lights.data(), lights.size());
+    CHECK(!clusters.isLogarithmic());
+    CHECK(countMissedLights(&clusters, mView, mOrtho, lights) == 0);
+
+    // No lights leaves every cluster empty
+    clusters.build(mView, mPerspective, nullptr, 0);
+    CHECK(clusters.getIndexesAmount() == 0);
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/mesh/meshOptimizer.h"
+#include "check.h"
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <random>
+
+// Indexed sphere, position and texture coordinates, seam column is duplicated
+static void makeSphere(int stacks, int slices, std::vector<float> &vertices, std::vector<unsigned int> &indexes)
+{
+    for (int i = 0; i <= stacks; i++)
+    {
+        for (int j = 0; j <= slices; j++)
+        {
+            float theta = 3.14159265f * i / stacks;
+            float phi = 6.2831853f * j / slices;
+            float vertex[5] = {sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi), (float)j / slices, (float)i / stacks};
+            vertices.insert(vertices.end(), vertex, vertex + 5);
+        }
+    }
+    for (int i = 0; i < stacks; i++)
+    {
+        for (int j = 0; j < slices; j++)
+        {
+            unsigned int a = i * (slices + 1) + j;
+            unsigned int b = a + slices + 1;
+            unsigned int triangles[6] = {a, b, b + 1, a, b + 1, a + 1};
+            indexes.insert(indexes.end(), triangles, triangles + 6);
+        }
+    }
+}
+
+// Triangles by their vertex data, first corner is the smallest one so winding is kept
+static std::vector<std::array<float, 15>> getTriangles(const std::vector<float> &vertices, const std::vector<unsigned int> &indexes)
+{
+    std::vector<std::array<float, 15>> out;
+    for (int t = 0; t < (int)indexes.size(); t += 3)
+    {
+        int first = 0;
+        for (int k = 1; k < 3; k++)
+            if (std::lexicographical_compare(&vertices[indexes[t + k] * 5], &vertices[indexes[t + k] * 5] + 5, &vertices[indexes[t + first] * 5], &vertices[indexes[t + first] * 5] + 5))
+                first = k;
+
+        std::array<float, 15> triangle;
+        for (int k = 0; k < 3; k++)
+            std::copy(&vertices[indexes[t + (first + k) % 3] * 5], &vertices[indexes[t + (first + k) % 3] * 5] + 5, &triangle[k * 5]);
+        out.push_back(triangle);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+int main()
+{
+    std::vector<float> vertices;
+    std::vector<unsigned int> indexes;
+    makeSphere(64, 128, vertices, indexes);
+    int vertexAmount = vertices.size() / 5;
+    auto triangles = getTriangles(vertices, indexes);
+
+    // Rows of a grid are already fine, random order is the worst case
+    std::vector<unsigned int> shuffled = indexes;
+    std::mt19937 random(1);
+    for (int t = shuffled.size() / 3 - 1; t > 0; t--)
+    {
+        int other = random() % (t + 1);
+        for (int k = 0; k < 3; k++)
+            std::swap(shuffled[t * 3 + k], shuffled[other * 3 + k]);
+    }
+
+    for (auto *source : {&indexes, &shuffled})
+    {
+        std::vector<unsigned int> optimized = *source;
+        float before = MeshOptimizer::getACMR(source->data(), source->size(), vertexAmount);
+        MeshOptimizer::optimizeVertexCache(optimized.data(), optimized.size(), vertexAmount);
+        float after = MeshOptimizer::getACMR(optimized.data(), optimized.size(), vertexAmount);
+        printf("ACMR %.3f -> %.3f\n", before, after);
+        CHECK(after < before);
+        CHECK(after < 0.8f);
+        CHECK(getTriangles(vertices, optimized) == triangles);
+
+        // Overdraw order may only lose a bit of the cache order
+        MeshOptimizer::optimizeOverdraw(optimized.data(), optimized.size(), vertices.data(), vertexAmount, 5);
+        float overdraw = MeshOptimizer::getACMR(optimized.data(), optimized.size(), vertexAmount);
+        CHECK(overdraw <= after * OPTIMIZER_OVERDRAW_THRESHOLD + 0.001f);
+        CHECK(getTriangles(vertices, optimized) == triangles);
+
+        // Vertices go in order of the first use
+        std::vector<float> fetched = vertices;
+        MeshOptimizer::optimizeVertexFetch(fetched, 5, optimized.data(), optimized.size());
+        unsigned int next = 0;
+        bool bOrdered = true;
+        for (auto index : optimized)
+        {
+            if (index > next)
+                bOrdered = false;
+            if (index == next)
+                next++;
+        }
+        CHECK(bOrdered);
+        CHECK(getTriangles(fetched, optimized) == triangles);
+    }
+
+    // Two triangles sharing an edge transform four vertices
+    unsigned int quad[6] = {0, 1, 2, 2, 1, 3};
+    CHECK(fabsf(MeshOptimizer::getACMR(quad, 6, 4) - 2.0f) < 0.0001f);
+
+    CHECK_RESULT();
+}
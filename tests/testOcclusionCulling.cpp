@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/occlusionCulling.h"
+#include "../src/connector/withCore.h"
+#include "../src/connector/withLogger.h"
+#include "check.h"
+#include <vector>
+
+// Positions only, data stays owned by the test
+class OccluderMesh : public MeshStatic
+{
+public:
+    OccluderMesh(std::vector<float> &positions)
+    {
+        vertexData = positions.data();
+        vertexAmount = positions.size() / 3;
+        floatsPerVertex = 3;
+    }
+};
+
+static bool isBoxOccluded(OcclusionCulling *culling, const Vector3 &center, float halfSize)
+{
+    return culling->isOccluded(AABB(center - Vector3(halfSize), center + Vector3(halfSize)));
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("testOcclusionCulling.log"));
+    WithCore::setGlobalCore(new Core());
+
+    Matrix4 mProjection = glm::perspective(1.2f, 2.0f, 0.1f, 1000.0f);
+    Matrix4 mView = Matrix4(1.0f);
+    OcclusionCulling culling;
+
+    // Wall 10x10 facing the camera at distance 10
+    std::vector<float> wall = {-5.0f, -5.0f, -10.0f, 5.0f, -5.0f, -10.0f, 5.0f, 5.0f, -10.0f,
+                               -5.0f, -5.0f, -10.0f, 5.0f, 5.0f, -10.0f, -5.0f, 5.0f, -10.0f};
+    OccluderMesh wallMesh(wall);
+
+    // Empty buffer hides nothing
+    culling.begin(mProjection * mView);
+    culling.rasterize();
+    CHECK(!culling.hasOccluders());
+    CHECK(!isBoxOccluded(&culling, Vector3(0.0f, 0.0f, -20.0f), 1.0f));
+
+    culling.begin(mProjection * mView);
+    culling.addOccluder(&wallMesh, Matrix4(1.0f));
+    culling.rasterize();
+    CHECK(culling.getTrianglesAmount() == 2);
+
+    // Behind the wall
+    CHECK(isBoxOccluded(&culling, Vector3(0.0f, 0.0f, -20.0f), 1.0f));
+    CHECK(isBoxOccluded(&culling, Vector3(1.0f, 1.0f, -200.0f), 1.0f));
+    // Beside the wall or partly out of its shadow
+    CHECK(!isBoxOccluded(&culling, Vector3(11.0f, 0.0f, -20.0f), 1.0f));
+    CHECK(!isBoxOccluded(&culling, Vector3(20.0f, 0.0f, -20.0f), 1.0f));
+    CHECK(!isBoxOccluded(&culling, Vector3(0.0f, 0.0f, -200.0f), 200.0f));
+    // In front of the wall, touching it or crossing the near plane
+    CHECK(!isBoxOccluded(&culling, Vector3(0.0f, 0.0f, -5.0f), 1.0f));
+    CHECK(!isBoxOccluded(&culling, Vector3(0.0f, 0.0f, -11.0f), 1.5f));
+    CHECK(!isBoxOccluded(&culling, Vector3(0.0f, 0.0f, 0.0f), 1.0f));
+
+    // Moved occluder hides boxes behind its new place only
+    culling.begin(mProjection * mView);
+    culling.addOccluder(&wallMesh, glm::translate(Matrix4(1.0f), Vector3(-10.0f, 0.0f, 0.0f)));
+    culling.rasterize();
+    CHECK(isBoxOccluded(&culling, Vector3(-20.0f, 0.0f, -20.0f), 1.0f));
+    CHECK(!isBoxOccluded(&culling, Vector3(0.0f, 0.0f, -20.0f), 1.0f));
+
+    // Wall along the view direction crosses the near plane and is clipped
+    std::vector<float> sideWall = {-1.0f, -50.0f, 5.0f, -1.0f, 50.0f, 5.0f, -1.0f, 50.0f, -50.0f,
+                                   -1.0f, -50.0f, 5.0f, -1.0f, 50.0f, -50.0f, -1.0f, -50.0f, -50.0f};
+    OccluderMesh sideWallMesh(sideWall);
+    culling.begin(mProjection * mView);
+    culling.addOccluder(&sideWallMesh, Matrix4(1.0f));
+    culling.rasterize();
+    CHECK(culling.getTrianglesAmount() > 0);
+    CHECK(isBoxOccluded(&culling, Vector3(-10.0f, 0.0f, -20.0f), 1.0f));
+    CHECK(!isBoxOccluded(&culling, Vector3(10.0f, 0.0f, -20.0f), 1.0f));
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/null/rendererNull.h"
+#include "../src/renderer/renderQueueCapture.h"
+#include "../src/connector/withRenderer.h"
+#include "check.h"
+#include <limits.h>
+#include <string.h>
+#include <vector>
+
+// Tables are changed in memory before saving, so every broken file is made the way the engine writes it
+class InspectedCapture : public RenderQueueCapture
+{
+public:
+    std::vector<CapturedMesh> &getMeshes() { return meshes; }
+    std::vector<std::vector<CapturedParameter>> &getParameterSets() { return parameters; }
+};
+
+static void fillQueue(Renderer *renderer, Shader *shader, ShaderParameter **parameters)
+{
+    RenderQueue *queue = renderer->getRenderQueue();
+    Matrix4 mView = glm::lookAt(Vector3(0.0f, 5.0f, 20.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+    Matrix4 mProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    Matrix4 mViewProjection = mProjection * mView;
+    Vector4 uvShiftSize = Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+    queue->reset();
+    queue->bDone = false;
+    queue->setViewMatrix(mView);
+    queue->setProjectionMatrix(mProjection);
+    queue->setViewProjectionMatrix(mViewProjection);
+
+    // Planes that keep everything, culling of replay doesn't drop elements
+    Vector4 planes[6];
+    for (int i = 0; i < 6; i++)
+        planes[i] = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+    queue->setCullingPlanes(planes);
+
+    for (int i = 0; i < 10; i++)
+    {
+        Matrix4 mModel = glm::translate(Matrix4(1.0f), Vector3(i * 2.0f - 10.0f, 0.0f, 0.0f));
+        queue->addMainPhase(mModel, shader, nullptr, renderer->getDefaultCubeMesh(), parameters, 2);
+        queue->addShadowCaster(mModel, renderer->getDefaultCubeMesh(), nullptr, uvShiftSize);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        Matrix4 mModel = glm::translate(Matrix4(1.0f), Vector3(i * 1.0f, 2.0f, 0.0f));
+        queue->addBlendingPhase(mModel, ColorMode::Alpha, shader, nullptr, renderer->getDefaultSpriteMesh(), 0.5f, parameters, 2);
+    }
+    queue->addLight(LightType::Sun, Vector3(0.3f, 1.0f, 0.2f), Vector3(1.0f, 1.0f, 1.0f), 100.0f, false);
+    queue->addLight(LightType::Omni, Vector3(0.0f, 2.0f, 0.0f), Vector3(1.0f, 0.8f, 0.6f), 8.0f, false);
+    queue->bDone = true;
+}
+
+static bool isRejected(InspectedCapture &capture, const char *path)
+{
+    RenderQueueCapture loaded;
+    bool bSaved = capture.save(path);
+    return bSaved && !loaded.load(path) && loaded.getMainPhaseAmount() == 0 && loaded.getLightsAmount() == 0;
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("testRenderQueueCapture.log"));
+    WithCore::setGlobalCore(new Core());
+    WithDebug::setDebugController(new DebugController());
+
+    RendererNull *renderer = new RendererNull(nullptr);
+    WithRenderer::setCurrentRenderer(renderer);
+    renderer->init(nullptr);
+
+    Shader *shader = renderer->createPhongShader();
+    ShaderParameter *parameters[2] = {shader->createShaderParameter("color", ShaderParameterType::Float3),
+                                      shader->createShaderParameter("index", ShaderParameterType::Int)};
+    float color[6] = {0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f};
+    int index = 7;
+    parameters[0]->set(2, color);
+    parameters[1]->set(1, &index);
+    fillQueue(renderer, shader, parameters);
+
+    // Round trip keeps every table, replay gives the same queue
+    InspectedCapture capture;
+    capture.capture(renderer->getRenderQueue());
+    CHECK(capture.getMainPhaseAmount() == 10 && capture.getBlendingPhaseAmount() == 3);
+    CHECK(capture.getShadowCastersAmount() == 10 && capture.getLightsAmount() == 2);
+    CHECK(capture.save("testRenderQueueCapture.bin"));
+
+    RenderQueueCapture loaded;
+    CHECK(loaded.load("testRenderQueueCapture.bin"));
+    CHECK(loaded.getMainPhaseAmount() == 10 && loaded.getBlendingPhaseAmount() == 3);
+    CHECK(loaded.getShadowCastersAmount() == 10 && loaded.getLightsAmount() == 2);
+
+    loaded.submit(renderer);
+    RenderQueue *queue = renderer->getRenderQueue();
+    CHECK(queue->getMainPhaseElementsAmount() == 10);
+    CHECK(queue->getBlendingPhaseElementsAmount() == 3);
+    CHECK(queue->getMainPhaseElements()[0]->parametersAmount == 2);
+    ShaderParameter *replayed = queue->getMainPhaseElements()[0]->parameters[0];
+    CHECK(replayed->getType() == ShaderParameterType::Float3 && replayed->getAmount() == 2);
+    CHECK(memcmp(replayed->getData(), color, sizeof(color)) == 0);
+    loaded.releaseResources(renderer);
+
+    // Type out of the enum
+    auto &set = capture.getParameterSets()[0];
+    set[0].type = (ShaderParameterType)100;
+    CHECK(isRejected(capture, "testRenderQueueCaptureType.bin"));
+    set[0].type = ShaderParameterType::Float3;
+
+    // Data shorter than amount of values
+    set[0].amount = 3;
+    CHECK(isRejected(capture, "testRenderQueueCaptureData.bin"));
+    set[0].amount = -1;
+    CHECK(isRejected(capture, "testRenderQueueCaptureAmount.bin"));
+    set[0].amount = 2;
+
+    // Level of detail past the limit, sum of both wraps around int
+    auto &lods = capture.getMeshes()[0].lods;
+    lods.push_back({INT_MAX - 4, 8, 0.0f});
+    CHECK(isRejected(capture, "testRenderQueueCaptureLod.bin"));
+    lods.back() = {-8, 4, 0.0f};
+    CHECK(isRejected(capture, "testRenderQueueCaptureLod.bin"));
+    lods.back() = {0, 36, 0.0f};
+    CHECK(capture.save("testRenderQueueCaptureLod.bin") && loaded.load("testRenderQueueCaptureLod.bin"));
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/shadowCascades.h"
+#include "check.h"
+
+static bool isNear(float a, float b)
+{
+    return fabsf(a - b) <= 0.0001f * fmaxf(1.0f, fabsf(b));
+}
+
+static void checkSplits()
+{
+    for (float lambda : {0.0f, 0.5f, 0.75f, 1.0f})
+    {
+        for (int amount = 1; amount <= MAX_SHADOW_CASCADES; amount++)
+        {
+            CHECK(ShadowCascades::getSplitDistance(0, amount, 0.1f, 100.0f, lambda) == 0.1f);
+            CHECK(ShadowCascades::getSplitDistance(amount, amount, 0.1f, 100.0f, lambda) == 100.0f);
+            for (int split = 1; split <= amount; split++)
+                CHECK(ShadowCascades::getSplitDistance(split, amount, 0.1f, 100.0f, lambda) > ShadowCascades::getSplitDistance(split - 1, amount, 0.1f, 100.0f, lambda));
+        }
+    }
+
+    // Lambda 0 splits evenly and lambda 1 splits by a constant ratio
+    CHECK(isNear(ShadowCascades::getSplitDistance(1, 4, 0.0f, 100.0f, 0.0f), 25.0f));
+    CHECK(isNear(ShadowCascades::getSplitDistance(2, 4, 0.0f, 100.0f, 0.0f), 50.0f));
+    CHECK(isNear(ShadowCascades::getSplitDistance(1, 3, 1.0f, 1000.0f, 1.0f), 10.0f));
+    CHECK(isNear(ShadowCascades::getSplitDistance(2, 3, 1.0f, 1000.0f, 1.0f), 100.0f));
+    // Lambda in between is the blend of both
+    float half = ShadowCascades::getSplitDistance(1, 3, 1.0f, 1000.0f, 0.5f);
+    CHECK(isNear(half, 0.5f * 10.0f + 0.5f * 334.0f));
+}
+
+static void checkPlanes()
+{
+    Matrix4 mViewProjection = glm::ortho(-2.0f, 2.0f, -3.0f, 3.0f, 1.0f, 11.0f);
+    Vector4 planes[6];
+    ShadowCascades::getPlanes(mViewProjection, planes);
+
+    // Normals are unit length and point inside
+    for (int i = 0; i < 6; i++)
+    {
+        CHECK(isNear(glm::length(Vector3(planes[i])), 1.0f));
+        CHECK(glm::dot(Vector3(planes[i]), Vector3(0.0f, 0.0f, -6.0f)) + planes[i].w > 0.0f);
+    }
+    // Left, right, bottom, top, near and far with distances to the center of the box
+    CHECK(isNear(planes[0].x, 1.0f) && isNear(planes[0].w, 2.0f));
+    CHECK(isNear(planes[1].x, -1.0f) && isNear(planes[1].w, 2.0f));
+    CHECK(isNear(planes[2].y, 1.0f) && isNear(planes[2].w, 3.0f));
+    CHECK(isNear(planes[3].y, -1.0f) && isNear(planes[3].w, 3.0f));
+    CHECK(isNear(planes[4].z, -1.0f) && isNear(planes[4].w, -1.0f));
+    CHECK(isNear(planes[5].z, 1.0f) && isNear(planes[5].w, 11.0f));
+}
+
+static void checkSpheres()
+{
+    ShadowCascades cascades;
+    cascades.setup(3, 0.75f);
+    cascades.setCasterExtension(36.0f);
+
+    Vector3 lightDirection = glm::normalize(Vector3(0.3f, 1.0f, 0.2f));
+    Matrix4 mProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    Matrix4 mView = glm::lookAt(Vector3(0.0f, 2.0f, 0.0f), Vector3(1.0f, 1.8f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+    cascades.update(lightDirection, mView, mProjection, 60.0f, 1024);
+
+    CHECK(cascades.getCascade(0)->splitNear == 0.1f);
+    CHECK(isNear(cascades.getCascade(2)->splitFar, 60.0f));
+    for (int c = 0; c < 3; c++)
+    {
+        ShadowCascade *cascade = cascades.getCascade(c);
+        // Towards the right border of the light projection
+        Vector3 side = Vector3(cascade->planes[0]);
+        CHECK(fabsf(glm::dot(side, lightDirection)) < 0.001f);
+
+        // Inside
+        CHECK(cascades.isSphereInCascade(c, cascade->center, 0.0f));
+        CHECK(cascades.isSphereInCascade(c, cascade->center + side * cascade->radius * 0.5f, 0.1f));
+        // Straddling the side border
+        CHECK(cascades.isSphereInCascade(c, cascade->center + side * (cascade->radius + 0.5f), 1.0f));
+        // Outside of the side border
+        CHECK(!cascades.isSphereInCascade(c, cascade->center + side * (cascade->radius + 2.0f), 1.0f));
+        // Casters towards the light are kept within the extension, the ones behind the cascade are dropped
+        CHECK(cascades.isSphereInCascade(c, cascade->center + lightDirection * (cascade->radius + 30.0f), 1.0f));
+        CHECK(!cascades.isSphereInCascade(c, cascade->center + lightDirection * (cascade->radius + 40.0f), 1.0f));
+        CHECK(!cascades.isSphereInCascade(c, cascade->center - lightDirection * (cascade->radius + 5.0f), 1.0f));
+
+        // Snapping keeps world origin on a texel
+        Vector4 origin = cascade->mLightViewProjection * Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+        Vector2 texel = Vector2(origin) * 512.0f;
+        CHECK(fabsf(texel.x - roundf(texel.x)) < 0.01f && fabsf(texel.y - roundf(texel.y)) < 0.01f);
+    }
+}
+
+int main()
+{
+    checkSplits();
+    checkPlanes();
+    checkSpheres();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/opengl/glew.h"
+#include "../src/renderer/opengl/stateOpenGL.h"
+#include "check.h"
+
+// Mock of the GL functions the state cache calls, test links only the cache itself and needs no context
+static int glCalls = 0;
+
+extern "C"
+{
+    void GLAPIENTRY glBindTexture(GLenum, GLuint) { glCalls++; }
+    void GLAPIENTRY glEnable(GLenum) { glCalls++; }
+    void GLAPIENTRY glDisable(GLenum) { glCalls++; }
+    void GLAPIENTRY glBlendFunc(GLenum, GLenum) { glCalls++; }
+    void GLAPIENTRY glDepthMask(GLboolean) { glCalls++; }
+    void GLAPIENTRY glDepthFunc(GLenum) { glCalls++; }
+}
+
+static void GLAPIENTRY mockUseProgram(GLuint) { glCalls++; }
+static void GLAPIENTRY mockBindVertexArray(GLuint) { glCalls++; }
+static void GLAPIENTRY mockActiveTexture(GLenum) { glCalls++; }
+PFNGLUSEPROGRAMPROC __glewUseProgram = mockUseProgram;
+PFNGLBINDVERTEXARRAYPROC __glewBindVertexArray = mockBindVertexArray;
+PFNGLACTIVETEXTUREPROC __glewActiveTexture = mockActiveTexture;
+
+// Same state for every element, like sprites of one material, up to 9 calls with texture unit switches
+static void drawElement(int i)
+{
+    StateOpenGL::useProgram(3);
+    StateOpenGL::bindVertexArray(i % 2 ? 5 : 6);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, 7);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, 8);
+    StateOpenGL::enable(GL_BLEND);
+    StateOpenGL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateOpenGL::depthMask(false);
+}
+
+int main()
+{
+    // First element sets everything, the rest only switch vertex arrays
+    StateOpenGL::resetCounters();
+    for (int i = 0; i < 100; i++)
+        drawElement(i);
+    CHECK(glCalls == 9 + 99);
+    CHECK(StateOpenGL::getCallsIssued() == glCalls);
+    CHECK(StateOpenGL::getCallsSkipped() == 100 * 9 - glCalls);
+
+    // Next frame with known state issues nothing but vertex arrays
+    glCalls = 0;
+    StateOpenGL::resetCounters();
+    for (int i = 0; i < 100; i++)
+        drawElement(i);
+    CHECK(glCalls == 100);
+    CHECK(StateOpenGL::getCallsSkipped() == 800);
+
+    // Changed values go through, equal ones don't
+    glCalls = 0;
+    StateOpenGL::disable(GL_BLEND);
+    StateOpenGL::disable(GL_BLEND);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
+    StateOpenGL::blendFunc(GL_ONE, GL_ONE);
+    StateOpenGL::depthFunc(GL_LEQUAL);
+    StateOpenGL::depthFunc(GL_LEQUAL);
+    CHECK(glCalls == 3);
+
+    // Capabilities which are not cached always go to GL
+    glCalls = 0;
+    StateOpenGL::enable(GL_SCISSOR_TEST);
+    StateOpenGL::enable(GL_SCISSOR_TEST);
+    CHECK(glCalls == 2);
+
+    // Deleted texture may come back with the same name, it has to be bound again on its unit
+    glCalls = 0;
+    StateOpenGL::forgetTexture(7);
+    StateOpenGL::bindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, 7);
+    CHECK(glCalls == 2);
+    StateOpenGL::forgetVertexArray(5);
+    StateOpenGL::bindVertexArray(5);
+    CHECK(glCalls == 3);
+
+    // Direct GL calls elsewhere make everything unknown
+    glCalls = 0;
+    StateOpenGL::invalidate();
+    drawElement(0);
+    CHECK(glCalls == 9);
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/renderer/textureAtlas.h"
+#include "../src/connector/withLogger.h"
+#include "check.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+struct PackedRect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Pages are checked before upload, so no renderer is needed
+class InspectedAtlas : public TextureAtlas
+{
+public:
+    InspectedAtlas(int pageSize, int padding) : TextureAtlas(pageSize, padding) {}
+
+    const unsigned char *getPixel(int page, int x, int y) { return &pages[page]->pixels[((size_t)y * pageSize + x) * 4]; }
+    TextureAtlasEntry *getEntry(int index) { return &entries[index]; }
+};
+
+static void checkPacker()
+{
+    for (int trial = 0; trial < 20; trial++)
+    {
+        AtlasPacker packer(512, 512);
+        std::vector<PackedRect> rects;
+        srand(trial);
+        int overlaps = 0, outside = 0;
+        long long area = 0;
+        for (int i = 0; i < 500; i++)
+        {
+            PackedRect rect = {-1, -1, 4 + rand() % 60, 4 + rand() % 60};
+            if (!packer.insert(rect.width, rect.height, &rect.x, &rect.y))
+                continue;
+            if (rect.x < 0 || rect.y < 0 || rect.x + rect.width > 512 || rect.y + rect.height > 512)
+                outside++;
+            for (auto &other : rects)
+                if (rect.x < other.x + other.width && other.x < rect.x + rect.width && rect.y < other.y + other.height && other.y < rect.y + rect.height)
+                    overlaps++;
+            rects.push_back(rect);
+            area += (long long)rect.width * rect.height;
+        }
+        CHECK(overlaps == 0);
+        CHECK(outside == 0);
+        CHECK(fabsf(packer.getOccupancy() - area / (512.0f * 512.0f)) < 0.0001f);
+        // Random sizes still fill most of the page before it runs out
+        CHECK(packer.getOccupancy() > 0.7f);
+    }
+
+    // Rectangle of the whole page takes it all, nothing fits after it
+    AtlasPacker packer(64, 64);
+    int x = -1, y = -1;
+    CHECK(packer.insert(64, 64, &x, &y) && x == 0 && y == 0);
+    x = y = -1;
+    CHECK(!packer.insert(1, 1, &x, &y) && x == -1 && y == -1);
+    CHECK(!packer.insert(0, 4, &x, &y));
+
+    // Larger than the page
+    AtlasPacker small(32, 32);
+    CHECK(!small.insert(33, 1, &x, &y));
+    CHECK(!small.insert(1, 33, &x, &y));
+}
+
+static void checkGutter()
+{
+    const int padding = 4;
+    InspectedAtlas atlas(64, padding);
+
+    // 3x2 image with distinct pixels
+    unsigned char image[3 * 2 * 4];
+    for (int i = 0; i < 6; i++)
+    {
+        unsigned char pixel[4] = {(unsigned char)(i * 10 + 10), (unsigned char)(i + 1), 7, 255};
+        memcpy(image + i * 4, pixel, 4);
+    }
+
+    int first = atlas.add(image, 3, 2);
+    int second = atlas.add(image, 3, 2);
+    CHECK(first == 0 && second == 1);
+    TextureAtlasEntry *entry = atlas.getEntry(first);
+    CHECK(entry->width == 3 && entry->height == 2);
+    // Image starts after the gutter and rectangles lie on the padding grid
+    CHECK(entry->x % padding == 0 && entry->y % padding == 0);
+    CHECK(entry->x >= padding && entry->y >= padding);
+
+    // Every pixel of the padded rectangle repeats the nearest image pixel
+    int rectSize = 12;
+    int mismatches = 0;
+    for (int index : {first, second})
+    {
+        entry = atlas.getEntry(index);
+        for (int y = -padding; y < rectSize - padding; y++)
+        {
+            for (int x = -padding; x < rectSize - padding; x++)
+            {
+                int sourceX = std::min(std::max(x, 0), 2);
+                int sourceY = std::min(std::max(y, 0), 1);
+                if (memcmp(atlas.getPixel(entry->page, entry->x + x, entry->y + y), image + (sourceY * 3 + sourceX) * 4, 4) != 0)
+                    mismatches++;
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+    // Rectangles of both images don't overlap
+    TextureAtlasEntry *a = atlas.getEntry(first);
+    TextureAtlasEntry *b = atlas.getEntry(second);
+    CHECK(abs(a->x - b->x) >= rectSize || abs(a->y - b->y) >= rectSize || a->page != b->page);
+
+    // Image larger than a page with its gutter is refused, full page goes to a new page
+    CHECK(atlas.add(image, 60, 1) == -1);
+    std::vector<unsigned char> large(56 * 56 * 4, 200);
+    int index = atlas.add(large.data(), 56, 56);
+    CHECK(index == 2 && atlas.getEntry(index)->page == 1);
+    CHECK(atlas.getPagesAmount() == 2);
+    CHECK(atlas.add(nullptr, 4, 4) == -1);
+}
+
+int main()
+{
+    WithLogger::setLogController(new LogController("testTextureAtlas.log"));
+
+    checkPacker();
+    checkGutter();
+
+    CHECK_RESULT();
+}
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2023 Dmitrii Shashkov
+// SPDX-License-Identifier: MIT
+
+#include "../src/mesh/vertexQuantizer.h"
+#include "check.h"
+#include <vector>
+#include <random>
+
+// Random vertices of 3,3,2,3,3 layout, texture coordinates are in -uvRange..uvRange
+static std::vector<float> makeVertices(int amount, float uvRange)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<float> vertices(amount * 14);
+    for (int i = 0; i < amount; i++)
+    {
+        float *v = &vertices[i * 14];
+        Vector3 normal = glm::normalize(Vector3(unit(random), unit(random), unit(random)));
+        Vector3 tangent = glm::normalize(glm::cross(normal, Vector3(unit(random), unit(random), unit(random))));
+        Vector3 bitangent = glm::cross(normal, tangent) * (unit(random) < 0.0f ? -1.0f : 1.0f);
+        float vertex[14] = {unit(random) * 50.0f, unit(random) * 5.0f, unit(random) * 0.5f,
+                            normal.x, normal.y, normal.z,
+                            unit(random) * uvRange, unit(random) * uvRange,
+                            tangent.x, tangent.y, tangent.z,
+                            bitangent.x, bitangent.y, bitangent.z};
+        memcpy(v, vertex, sizeof(vertex));
+    }
+    return vertices;
+}
+
+// Half float keeps 11 bits of mantissa, rounding error is at most half of the last one
+static float getHalfErrorBound(float value)
+{
+    return fmaxf(fabsf(value), 1.0f / 16384.0f) / 2048.0f;
+}
+
+static void checkRoundTrip(float uvRange)
+{
+    const int amount = 20000;
+    std::vector<float> vertices = makeVertices(amount, uvRange);
+
+    Vector3 offset, scale;
+    VertexQuantizer::getPositionBounds(vertices.data(), amount, 14, offset, scale);
+    std::vector<unsigned char> packed;
+    VertexQuantizer::pack(vertices.data(), amount, 14, true, offset, scale, packed);
+    CHECK((int)packed.size() == amount * PACKED_VERTEX_TANGENTS_SIZE);
+    std::vector<float> unpacked(amount * 14);
+    VertexQuantizer::unpack(packed.data(), amount, true, offset, scale, unpacked.data());
+
+    int positionFails = 0, uvFails = 0, signFails = 0;
+    float normalAngle = 0.0f, tangentAngle = 0.0f;
+    for (int i = 0; i < amount; i++)
+    {
+        const float *a = &vertices[i * 14];
+        const float *b = &unpacked[i * 14];
+        for (int k = 0; k < 3; k++)
+            if (fabsf(a[k] - b[k]) > scale[k] / 65535.0f * 0.5f + 0.00001f)
+                positionFails++;
+        for (int k = 6; k < 8; k++)
+            if (fabsf(a[k] - b[k]) > getHalfErrorBound(a[k]))
+                uvFails++;
+        // Chord of unit vectors is their angle in radians when it's small
+        normalAngle = fmaxf(normalAngle, glm::length(Vector3(a[3], a[4], a[5]) - Vector3(b[3], b[4], b[5])));
+        tangentAngle = fmaxf(tangentAngle, glm::length(Vector3(a[8], a[9], a[10]) - Vector3(b[8], b[9], b[10])));
+        if (glm::dot(Vector3(a[11], a[12], a[13]), Vector3(b[11], b[12], b[13])) < 0.99f)
+            signFails++;
+    }
+    CHECK(positionFails == 0);
+    CHECK(uvFails == 0);
+    CHECK(signFails == 0);
+    // 16 bit octahedral encoding is within about 0.01 degree
+    CHECK(normalAngle < glm::radians(0.01f));
+    CHECK(tangentAngle < glm::radians(0.01f));
+
+    VertexQuantizerError error = VertexQuantizer::measureError(vertices.data(), amount, 14, true);
+    printf("uv range %g: position %g, normal %g deg, uv %g, tangent %g deg\n", uvRange, error.position, error.normalAngle, error.uv, error.tangentAngle);
+    CHECK(error.uv <= getHalfErrorBound(uvRange));
+    CHECK(error.normalAngle < 0.01f && error.tangentAngle < 0.01f);
+    CHECK(error.bitangentSignMismatches == 0);
+}
+
+int main()
+{
+    // Usual texture coordinates and tiled ones well above 1
+    checkRoundTrip(1.0f);
+    checkRoundTrip(8.0f);
+    checkRoundTrip(300.0f);
+
+    // Axes and poles of the octahedron are exact
+    Vector3 axes[6] = {Vector3(1.0f, 0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f),
+                       Vector3(0.0f, -1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f)};
+    for (auto &axis : axes)
+    {
+        short encoded[2];
+        VertexQuantizer::encodeOctahedral(axis, encoded);
+        CHECK(glm::length(VertexQuantizer::decodeOctahedral(encoded) - axis) < 0.0001f);
+    }
+
+    // Every finite half survives the round trip, larger values become infinity
+    int halfFails = 0;
+    for (int half = 0; half < 0x7c00; half++)
+    {
+        if (VertexQuantizer::floatToHalf(VertexQuantizer::halfToFloat(half)) != half)
+            halfFails++;
+        if (VertexQuantizer::floatToHalf(VertexQuantizer::halfToFloat(half | 0x8000)) != (half | 0x8000))
+            halfFails++;
+    }
+    CHECK(halfFails == 0);
+    CHECK(VertexQuantizer::halfToFloat(VertexQuantizer::floatToHalf(65504.0f)) == 65504.0f);
+    CHECK(VertexQuantizer::floatToHalf(70000.0f) == 0x7c00);
+    CHECK(VertexQuantizer::halfToFloat(VertexQuantizer::floatToHalf(1000.25f)) == 1000.0f);
+
+    CHECK_RESULT();
+}